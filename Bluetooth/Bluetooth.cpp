@@ -73,6 +73,7 @@ const string WPEFramework::Plugin::Bluetooth::EVT_PLAYBACK_NEW_TRACK = "onPlayba
 const string WPEFramework::Plugin::Bluetooth::EVT_DEVICE_FOUND = "onDeviceFound";
 const string WPEFramework::Plugin::Bluetooth::EVT_DEVICE_LOST_OR_OUT_OF_RANGE = "onDeviceLost";
 const string WPEFramework::Plugin::Bluetooth::EVT_DEVICE_DISCOVERY_UPDATE = "onDiscoveredDevice";
+const string WPEFramework::Plugin::Bluetooth::EVT_DEVICES_CHANGED = "onDevicesChanged";
 
 const string WPEFramework::Plugin::Bluetooth::STATUS_NO_BLUETOOTH_HARDWARE = "NO_BLUETOOTH_HARDWARE";
 const string WPEFramework::Plugin::Bluetooth::STATUS_SOFTWARE_DISABLED = "SOFTWARE_DISABLED";
@@ -116,6 +117,34 @@ namespace WPEFramework
         Bluetooth* Bluetooth::_instance = nullptr;
         static Core::TimerType<DiscoveryTimer> _discoveryTimer(64 * 1024, "DiscoveryTimer");
 
+        static BluetoothDeviceRegistry::Device toRegistryDevice(const BTRMGR_DiscoveredDevices_t& discoveredDevice)
+        {
+            BluetoothDeviceRegistry::Device device;
+            device.deviceID = discoveredDevice.m_deviceHandle;
+            device.name = string(discoveredDevice.m_name);
+            device.deviceType = string(BTRMGR_GetDeviceTypeAsString(discoveredDevice.m_deviceType));
+            device.rawDeviceType = std::to_string(discoveredDevice.m_ui32DevClassBtSpec);
+            device.paired = discoveredDevice.m_isPairedDevice ? true : false;
+            device.connected = discoveredDevice.m_isConnected ? true : false;
+            device.lastConnectedState = discoveredDevice.m_isLastConnectedDevice ? true : false;
+            device.hasRssi = true;
+            device.rssi = discoveredDevice.m_i32RSSI;
+            return device;
+        }
+
+        static BluetoothDeviceRegistry::Device toRegistryDevice(const BTRMGR_PairedDevices_t& pairedDevice, bool paired = true)
+        {
+            BluetoothDeviceRegistry::Device device;
+            device.deviceID = pairedDevice.m_deviceHandle;
+            device.name = string(pairedDevice.m_name);
+            device.deviceType = string(BTRMGR_GetDeviceTypeAsString(pairedDevice.m_deviceType));
+            device.rawDeviceType = std::to_string(pairedDevice.m_ui32DevClassBtSpec);
+            device.paired = paired;
+            device.connected = pairedDevice.m_isConnected ? true : false;
+            device.lastConnectedState = pairedDevice.m_isLastConnectedDevice ? true : false;
+            return device;
+        }
+
         BTRMGR_Result_t bluetoothSrv_EventCallback (BTRMGR_EventMessage_t eventMsg)
         {
             if (!Bluetooth::_instance) {
@@ -340,59 +369,62 @@ namespace WPEFramework
 
         JsonArray Bluetooth::getDiscoveredDevices()
         {
-            JsonArray deviceArray;
+            loadDeviceRegistry();
+            return m_deviceRegistry.getDiscoveredDevices();
+        }
+
+        JsonArray Bluetooth::getPairedDevices()
+        {
+            loadDeviceRegistry();
+            return m_deviceRegistry.getPairedDevices();
+        }
+
+        // The Bluetooth Manager lists are only read once, the events keep the registry up to date afterwards
+        void Bluetooth::loadDeviceRegistry()
+        {
+            if (m_deviceRegistry.isLoaded())
+                return;
+
             BTRMGR_DiscoveredDevicesList_t discoveredDevices;
+            BTRMGR_PairedDevicesList_t pairedDevices;
 
             memset (&discoveredDevices, 0, sizeof(discoveredDevices));
             BTRMGR_Result_t rc = BTRMGR_GetDiscoveredDevices(0, &discoveredDevices);
             if (BTRMGR_RESULT_SUCCESS != rc)
             {
                 LOGERR("Failed to get the discovered devices");
+                return;
             }
-            else
-            {
-                int i = 0;
-                JsonObject deviceDetails;
-                LOGINFO ("Success....   Discovered %d Devices", discoveredDevices.m_numOfDevices);
-                for (; i < discoveredDevices.m_numOfDevices; i++)
-                {
-                    deviceDetails["deviceID"] = std::to_string(discoveredDevices.m_deviceProperty[i].m_deviceHandle);
-                    deviceDetails["name"] = string(discoveredDevices.m_deviceProperty[i].m_name);
-                    deviceDetails["deviceType"] = string(BTRMGR_GetDeviceTypeAsString(discoveredDevices.m_deviceProperty[i].m_deviceType));
-                    deviceDetails["connected"] = discoveredDevices.m_deviceProperty[i].m_isConnected?true:false;
-                    deviceDetails["paired"] = discoveredDevices.m_deviceProperty[i].m_isPairedDevice?true:false;
-                    deviceArray.Add(deviceDetails);
-                }
-            }
-            return deviceArray;
-        }
-
-        JsonArray Bluetooth::getPairedDevices()
-        {
-            JsonArray deviceArray;
-            BTRMGR_PairedDevicesList_t pairedDevices;
 
             memset (&pairedDevices, 0, sizeof(pairedDevices));
-            BTRMGR_Result_t rc = BTRMGR_GetPairedDevices(0, &pairedDevices);
+            rc = BTRMGR_GetPairedDevices(0, &pairedDevices);
             if (BTRMGR_RESULT_SUCCESS != rc)
             {
                 LOGERR("Failed to get the paired devices");
+                return;
             }
-            else
-            {
-                int i = 0;
-                JsonObject deviceDetails;
-                LOGINFO ("Success....   Paired %d Devices", pairedDevices.m_numOfDevices);
-                for (; i < pairedDevices.m_numOfDevices; i++)
-                {
-                    deviceDetails["deviceID"] = std::to_string(pairedDevices.m_deviceProperty[i].m_deviceHandle);
-                    deviceDetails["name"] = string(pairedDevices.m_deviceProperty[i].m_name);
-                    deviceDetails["deviceType"] = string(BTRMGR_GetDeviceTypeAsString(pairedDevices.m_deviceProperty[i].m_deviceType));
-                    deviceDetails["connected"] = pairedDevices.m_deviceProperty[i].m_isConnected?true:false;
-                    deviceArray.Add(deviceDetails);
-                }
-            }
-            return deviceArray;
+
+            std::vector<BluetoothDeviceRegistry::Device> discovered;
+            std::vector<BluetoothDeviceRegistry::Device> paired;
+            for (int i = 0; i < discoveredDevices.m_numOfDevices; i++)
+                discovered.push_back(toRegistryDevice(discoveredDevices.m_deviceProperty[i]));
+            for (int i = 0; i < pairedDevices.m_numOfDevices; i++)
+                paired.push_back(toRegistryDevice(pairedDevices.m_deviceProperty[i]));
+
+            LOGINFO ("Success....   Discovered %d Devices, Paired %d Devices", discoveredDevices.m_numOfDevices, pairedDevices.m_numOfDevices);
+            m_deviceRegistry.load(discovered, paired);
+        }
+
+        void Bluetooth::notifyDeviceRegistryChanges(const BluetoothDeviceRegistry::Delta& delta)
+        {
+            if (delta.isEmpty())
+                return;
+
+            JsonObject params;
+            params["added"] = delta.added;
+            params["changed"] = delta.changed;
+            params["removed"] = delta.removed;
+            sendNotify(C_STR(EVT_DEVICES_CHANGED), params);
         }
 
         JsonArray Bluetooth::getConnectedDevices()
@@ -530,6 +562,13 @@ namespace WPEFramework
             {
                 LOGERR("Failed to do setBluetoothEnabled");
             }
+            else
+            {
+                // The lists are read again from Bluetooth Manager once the adapter changed
+                BluetoothDeviceRegistry::Delta delta;
+                m_deviceRegistry.clear(delta);
+                notifyDeviceRegistryChanges(delta);
+            }
 
             return BTRMGR_RESULT_SUCCESS == rc;
         }
@@ -752,12 +791,14 @@ namespace WPEFramework
             JsonObject params;
             string profileInfo;
             string eventId;
+            BluetoothDeviceRegistry::Delta delta;
             LOGINFO ("Event notification: event of type %d received", eventMsg.m_eventType);
             switch (eventMsg.m_eventType) {
                 case BTRMGR_EVENT_DEVICE_DISCOVERY_COMPLETE:
                     LOGINFO ("Received %s Event from BTRMgr", C_STR(STATUS_DISCOVERY_COMPLETED));
                     params["newStatus"] = STATUS_DISCOVERY_COMPLETED;
                     eventId = EVT_STATUS_CHANGED;
+                    m_deviceRegistry.onDiscoveryCompleted(delta);
 
                     // TODO: Stopping the discovery timer and resetting the flag should not be needed on Discovery completed.
                     //       But is it logical to expect DISCOVERY_COMPLETED, when Bluetooth Service has not asked BTRMgr to
@@ -779,6 +820,7 @@ namespace WPEFramework
                     params["connected"] = eventMsg.m_discoveredDevice.m_isConnected ? true : false;
 
                     eventId = EVT_STATUS_CHANGED;
+                    m_deviceRegistry.onPairing(toRegistryDevice(eventMsg.m_discoveredDevice), delta);
                     break;
 
                 case BTRMGR_EVENT_DEVICE_UNPAIRING_COMPLETE:
@@ -793,10 +835,12 @@ namespace WPEFramework
                     params["connected"] = eventMsg.m_pairedDevice.m_isConnected ? true : false;
 
                     eventId = EVT_STATUS_CHANGED;
+                    m_deviceRegistry.onPairing(toRegistryDevice(eventMsg.m_pairedDevice, false), delta);
                     break;
 
                 case BTRMGR_EVENT_DEVICE_CONNECTION_COMPLETE:
                 case BTRMGR_EVENT_DEVICE_DISCONNECT_COMPLETE: /* Allow only AudioIn/Out & HID Connection Event propogation to XRE for now */
+                    m_deviceRegistry.onConnection(toRegistryDevice(eventMsg.m_pairedDevice), delta);
                     if ((eventMsg.m_pairedDevice.m_deviceType == BTRMGR_DEVICE_TYPE_WEARABLE_HEADSET)   ||
                         (eventMsg.m_pairedDevice.m_deviceType == BTRMGR_DEVICE_TYPE_HANDSFREE)          ||
                         (eventMsg.m_pairedDevice.m_deviceType == BTRMGR_DEVICE_TYPE_LOUDSPEAKER)        ||
@@ -826,6 +870,7 @@ namespace WPEFramework
                     LOGINFO ("Received %s Event from BTRMgr", C_STR(STATUS_DISCOVERY_STARTED));
                     params["newStatus"] = STATUS_DISCOVERY_STARTED;
                     eventId = EVT_STATUS_CHANGED;
+                    m_deviceRegistry.onDiscoveryStarted();
                     break;
 
                 case BTRMGR_EVENT_RECEIVED_EXTERNAL_PAIR_REQUEST:
@@ -1016,6 +1061,7 @@ namespace WPEFramework
                     params["lastConnectedState"] = eventMsg.m_pairedDevice.m_isLastConnectedDevice?true:false;
 
                     eventId = EVT_DEVICE_FOUND;
+                    m_deviceRegistry.onInRange(toRegistryDevice(eventMsg.m_pairedDevice), delta);
                     break;
 
                 case BTRMGR_EVENT_DEVICE_OUT_OF_RANGE:
@@ -1025,6 +1071,7 @@ namespace WPEFramework
                     params["rawDeviceType"] = std::to_string(eventMsg.m_pairedDevice.m_ui32DevClassBtSpec);
                     params["lastConnectedState"] = eventMsg.m_pairedDevice.m_isLastConnectedDevice?true:false;
                     eventId = EVT_DEVICE_LOST_OR_OUT_OF_RANGE;
+                    m_deviceRegistry.onLost(toRegistryDevice(eventMsg.m_pairedDevice), delta);
                     break;
 
                 case BTRMGR_EVENT_DEVICE_DISCOVERY_UPDATE:
@@ -1037,6 +1084,10 @@ namespace WPEFramework
                     params["paired"] = eventMsg.m_discoveredDevice.m_isPairedDevice ? true:false;
 
                     eventId = EVT_DEVICE_DISCOVERY_UPDATE;
+                    if (eventMsg.m_discoveredDevice.m_isDiscovered)
+                        m_deviceRegistry.onFound(toRegistryDevice(eventMsg.m_discoveredDevice), delta);
+                    else
+                        m_deviceRegistry.onLost(toRegistryDevice(eventMsg.m_discoveredDevice), delta);
                     break;
 
                     // TODO: implement or delete these values from enum
@@ -1086,6 +1137,7 @@ namespace WPEFramework
             {
                 sendNotify(C_STR(eventId), params);
             }
+            notifyDeviceRegistryChanges(delta);
             return;
         }
         //
@@ -24,6 +24,7 @@
 #include "Module.h"
 #include "utils.h"
 #include "AbstractPlugin.h"
+#include "BluetoothDeviceRegistry.h"
 
 #include "btmgr.h" //TODO: can we move it to the module? Required by notifyEventWrapper()
 
@@ -109,6 +110,8 @@ namespace WPEFramework {
             JsonArray getDiscoveredDevices();
             JsonArray getPairedDevices();
             JsonArray getConnectedDevices();
+            void loadDeviceRegistry();
+            void notifyDeviceRegistryChanges(const BluetoothDeviceRegistry::Delta& delta);
             bool setDeviceConnection(long long int deviceID, const string &enable, const string &deviceType = "UNKNOWN DEVICE");
             bool setAudioStream(long long int deviceID, const string &audioStreamName);
             bool setDevicePairing(long long int deviceID, bool pair);
@@ -162,6 +165,7 @@ namespace WPEFramework {
             static const string EVT_DEVICE_FOUND;
             static const string EVT_DEVICE_LOST_OR_OUT_OF_RANGE;
             static const string EVT_DEVICE_DISCOVERY_UPDATE;
+            static const string EVT_DEVICES_CHANGED;
 
             Bluetooth();
             virtual ~Bluetooth();
@@ -212,6 +216,7 @@ namespace WPEFramework {
             bool m_discoveryRunning;
             DiscoveryTimer m_discoveryTimer;
             friend class DiscoveryTimer;
+            BluetoothDeviceRegistry m_deviceRegistry;
         };
 	} // Plugin
 } // WPEFramework
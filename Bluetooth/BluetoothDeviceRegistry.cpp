@@ -0,0 +1,310 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+
+#include "BluetoothDeviceRegistry.h"
+
+#include <cmath>
+
+namespace
+{
+    // Weight of a new reading in the smoothed RSSI
+    const double rssiSmoothing = 0.5;
+    // A smoothed RSSI change smaller than this is not reported
+    const double rssiChangeThreshold = 5.0;
+    // Discovery rounds a device can be missing from before it is dropped
+    const unsigned maxMissedDiscoveries = 2;
+}
+
+namespace WPEFramework
+{
+    namespace Plugin
+    {
+        BluetoothDeviceRegistry::BluetoothDeviceRegistry()
+        : m_discovery(0)
+        , m_loaded(false)
+        {
+        }
+
+        bool BluetoothDeviceRegistry::isLoaded() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_loaded;
+        }
+
+        // Seeds the registry with the Bluetooth Manager lists, devices already known from events are kept
+        void BluetoothDeviceRegistry::load(const std::vector<Device>& discovered, const std::vector<Device>& paired)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            bool added;
+
+            for (const Device& device : discovered) {
+                Entry& entry = findOrAdd(device, added);
+                entry.discovered = true;
+                if (!added)
+                    merge(entry, device);
+            }
+            for (const Device& device : paired) {
+                Entry& entry = findOrAdd(device, added);
+                if (!added)
+                    merge(entry, device);
+            }
+            m_loaded = true;
+        }
+
+        void BluetoothDeviceRegistry::clear(Delta& delta)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            for (const auto& entry : m_entries) {
+                JsonObject removed;
+                removed["deviceID"] = std::to_string(entry.first);
+                removed["name"] = entry.second.device.name;
+                delta.removed.Add(removed);
+            }
+            m_entries.clear();
+            m_loaded = false;
+        }
+
+        void BluetoothDeviceRegistry::onDiscoveryStarted()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_discovery++;
+        }
+
+        void BluetoothDeviceRegistry::onDiscoveryCompleted(Delta& delta)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            for (auto it = m_entries.begin(); it != m_entries.end(); ) {
+                Entry& entry = it->second;
+                if (!entry.discovered || (entry.discovery == m_discovery) || (++entry.missedDiscoveries < maxMissedDiscoveries)) {
+                    ++it;
+                    continue;
+                }
+
+                entry.discovered = false;
+                if (entry.device.paired) {
+                    delta.changed.Add(toJson(entry));
+                    ++it;
+                } else {
+                    JsonObject removed;
+                    removed["deviceID"] = std::to_string(it->first);
+                    removed["name"] = entry.device.name;
+                    delta.removed.Add(removed);
+                    it = m_entries.erase(it);
+                }
+            }
+        }
+
+        void BluetoothDeviceRegistry::onFound(const Device& device, Delta& delta)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            bool added;
+
+            Entry& entry = findOrAdd(device, added);
+            bool changed = !added && merge(entry, device);
+            if (!entry.discovered) {
+                entry.discovered = true;
+                changed = true;
+            }
+            entry.discovery = m_discovery;
+            entry.missedDiscoveries = 0;
+
+            update(m_entries.find(device.deviceID), added, changed, delta);
+        }
+
+        void BluetoothDeviceRegistry::onLost(const Device& device, Delta& delta)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            auto it = m_entries.find(device.deviceID);
+            if (it == m_entries.end())
+                return;
+
+            bool changed = merge(it->second, device);
+            if (it->second.discovered) {
+                it->second.discovered = false;
+                changed = true;
+            }
+            update(it, false, changed, delta);
+        }
+
+        void BluetoothDeviceRegistry::onInRange(const Device& device, Delta& delta)
+        {
+            onPairing(device, delta);
+        }
+
+        void BluetoothDeviceRegistry::onPairing(const Device& device, Delta& delta)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            bool added;
+
+            Entry& entry = findOrAdd(device, added);
+            bool changed = !added && merge(entry, device);
+            update(m_entries.find(device.deviceID), added, changed, delta);
+        }
+
+        void BluetoothDeviceRegistry::onConnection(const Device& device, Delta& delta)
+        {
+            onPairing(device, delta);
+        }
+
+        JsonArray BluetoothDeviceRegistry::getDiscoveredDevices() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            JsonArray deviceArray;
+
+            for (const auto& entry : m_entries) {
+                const Device& device = entry.second.device;
+                if (!entry.second.discovered)
+                    continue;
+
+                JsonObject deviceDetails;
+                deviceDetails["deviceID"] = std::to_string(device.deviceID);
+                deviceDetails["name"] = device.name;
+                deviceDetails["deviceType"] = device.deviceType;
+                deviceDetails["connected"] = device.connected;
+                deviceDetails["paired"] = device.paired;
+                if (device.hasRssi)
+                    deviceDetails["rssi"] = std::to_string(device.rssi);
+                deviceArray.Add(deviceDetails);
+            }
+            return deviceArray;
+        }
+
+        JsonArray BluetoothDeviceRegistry::getPairedDevices() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            JsonArray deviceArray;
+
+            for (const auto& entry : m_entries) {
+                const Device& device = entry.second.device;
+                if (!device.paired)
+                    continue;
+
+                JsonObject deviceDetails;
+                deviceDetails["deviceID"] = std::to_string(device.deviceID);
+                deviceDetails["name"] = device.name;
+                deviceDetails["deviceType"] = device.deviceType;
+                deviceDetails["connected"] = device.connected;
+                deviceArray.Add(deviceDetails);
+            }
+            return deviceArray;
+        }
+
+        BluetoothDeviceRegistry::Entry& BluetoothDeviceRegistry::findOrAdd(const Device& device, bool& added)
+        {
+            auto it = m_entries.find(device.deviceID);
+            added = (it == m_entries.end());
+            if (!added)
+                return it->second;
+
+            Entry& entry = m_entries[device.deviceID];
+            entry.device = device;
+            entry.discovered = false;
+            entry.rssi = device.rssi;
+            entry.reportedRssi = device.rssi;
+            entry.discovery = m_discovery;
+            entry.missedDiscoveries = 0;
+            return entry;
+        }
+
+        // Returns whether a reported property changed
+        bool BluetoothDeviceRegistry::merge(Entry& entry, const Device& device)
+        {
+            Device& known = entry.device;
+            bool changed = false;
+
+            if (!device.name.empty() && (device.name != known.name)) {
+                known.name = device.name;
+                changed = true;
+            }
+            if (device.deviceType != known.deviceType) {
+                known.deviceType = device.deviceType;
+                changed = true;
+            }
+            if (device.rawDeviceType != known.rawDeviceType) {
+                known.rawDeviceType = device.rawDeviceType;
+                changed = true;
+            }
+            if ((device.paired != known.paired) || (device.connected != known.connected) || (device.lastConnectedState != known.lastConnectedState)) {
+                known.paired = device.paired;
+                known.connected = device.connected;
+                known.lastConnectedState = device.lastConnectedState;
+                changed = true;
+            }
+
+            if (device.hasRssi) {
+                if (!known.hasRssi) {
+                    entry.rssi = device.rssi;
+                    entry.reportedRssi = device.rssi;
+                    known.hasRssi = true;
+                    changed = true;
+                } else {
+                    entry.rssi += rssiSmoothing * (device.rssi - entry.rssi);
+                    if (std::fabs(entry.rssi - entry.reportedRssi) >= rssiChangeThreshold) {
+                        entry.reportedRssi = entry.rssi;
+                        changed = true;
+                    }
+                }
+                known.rssi = static_cast<int>(std::lround(entry.reportedRssi));
+            }
+            return changed;
+        }
+
+        // Reports the entry, dropping it once it is neither discovered nor paired
+        void BluetoothDeviceRegistry::update(std::map<long long int, Entry>::iterator it, bool added, bool changed, Delta& delta)
+        {
+            const Entry& entry = it->second;
+
+            if (!entry.discovered && !entry.device.paired) {
+                if (!added) {
+                    JsonObject removed;
+                    removed["deviceID"] = std::to_string(it->first);
+                    removed["name"] = entry.device.name;
+                    delta.removed.Add(removed);
+                }
+                m_entries.erase(it);
+            }
+            else if (added)
+                delta.added.Add(toJson(entry));
+            else if (changed)
+                delta.changed.Add(toJson(entry));
+        }
+
+        JsonObject BluetoothDeviceRegistry::toJson(const Entry& entry)
+        {
+            const Device& device = entry.device;
+            JsonObject deviceDetails;
+
+            deviceDetails["deviceID"] = std::to_string(device.deviceID);
+            deviceDetails["name"] = device.name;
+            deviceDetails["deviceType"] = device.deviceType;
+            deviceDetails["rawDeviceType"] = device.rawDeviceType;
+            deviceDetails["lastConnectedState"] = device.lastConnectedState;
+            deviceDetails["discovered"] = entry.discovered;
+            deviceDetails["paired"] = device.paired;
+            deviceDetails["connected"] = device.connected;
+            if (device.hasRssi)
+                deviceDetails["rssi"] = std::to_string(device.rssi);
+            return deviceDetails;
+        }
+    } // namespace Plugin
+} // namespace WPEFramework
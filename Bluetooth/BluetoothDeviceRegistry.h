@@ -0,0 +1,103 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+
+#pragma once
+
+#include "Module.h"
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        // Discovered and paired devices, kept up to date from the Bluetooth Manager events so the
+        // getters do not have to ask Bluetooth Manager for its lists again.
+        //
+        // A discovered device not reported by several discovery rounds in a row is dropped. RSSI
+        // readings are smoothed, a change is only reported when the smoothed value moves by a few dB.
+        class BluetoothDeviceRegistry {
+        public:
+            struct Device {
+                Device() : deviceID(0), paired(false), connected(false), lastConnectedState(false), hasRssi(false), rssi(0) {}
+
+                long long int deviceID;
+                string name;
+                string deviceType;
+                string rawDeviceType;
+                bool paired;
+                bool connected;
+                bool lastConnectedState;
+                bool hasRssi;
+                int rssi;
+            };
+
+            // Devices which entered or left the registry, or whose properties changed
+            struct Delta {
+                JsonArray added;
+                JsonArray changed;
+                JsonArray removed;
+
+                bool isEmpty() const { return (added.Length() == 0) && (changed.Length() == 0) && (removed.Length() == 0); }
+            };
+
+            BluetoothDeviceRegistry();
+            BluetoothDeviceRegistry(const BluetoothDeviceRegistry&) = delete;
+            BluetoothDeviceRegistry& operator=(const BluetoothDeviceRegistry&) = delete;
+
+            bool isLoaded() const;
+            void load(const std::vector<Device>& discovered, const std::vector<Device>& paired);
+            void clear(Delta& delta);
+
+            void onDiscoveryStarted();
+            void onDiscoveryCompleted(Delta& delta);
+            void onFound(const Device& device, Delta& delta);
+            void onLost(const Device& device, Delta& delta);
+            // A paired device back in range, it is not discovered for all that
+            void onInRange(const Device& device, Delta& delta);
+            void onPairing(const Device& device, Delta& delta);
+            void onConnection(const Device& device, Delta& delta);
+
+            JsonArray getDiscoveredDevices() const;
+            JsonArray getPairedDevices() const;
+
+        private:
+            struct Entry {
+                Device device;
+                bool discovered;
+                double rssi;                // Smoothed
+                double reportedRssi;
+                unsigned discovery;         // Last discovery round the device was reported by
+                unsigned missedDiscoveries;
+            };
+
+            Entry& findOrAdd(const Device& device, bool& added);
+            bool merge(Entry& entry, const Device& device);
+            void update(std::map<long long int, Entry>::iterator it, bool added, bool changed, Delta& delta);
+            static JsonObject toJson(const Entry& entry);
+
+            mutable std::mutex m_mutex;
+            std::map<long long int, Entry> m_entries;
+            unsigned m_discovery;           // Incremented when a discovery round starts
+            bool m_loaded;
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
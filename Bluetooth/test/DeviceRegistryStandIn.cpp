@@ -0,0 +1,205 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+/*
+ * Feeds the Bluetooth device registry the event sequences Bluetooth Manager
+ * sends, without Bluetooth Manager: devices found and aged out of discovery
+ * rounds, RSSI readings, paired devices leaving and coming back in range.
+ * Checks the deltas sent with onDevicesChanged and the getter lists.
+ */
+
+#include "BluetoothDeviceRegistry.h"
+
+#include <stdio.h>
+
+using namespace WPEFramework;
+using namespace WPEFramework::Plugin;
+
+namespace {
+
+    typedef BluetoothDeviceRegistry Registry;
+
+    Registry::Device Discovered(long long int id, int rssi)
+    {
+        Registry::Device device;
+        device.deviceID = id;
+        device.name = "device " + std::to_string(id);
+        device.deviceType = "SMARTPHONE";
+        device.hasRssi = true;
+        device.rssi = rssi;
+        return device;
+    }
+
+    // As BTRMGR_EVENT_DEVICE_FOUND / OUT_OF_RANGE report them, without RSSI
+    Registry::Device Paired(long long int id)
+    {
+        Registry::Device device;
+        device.deviceID = id;
+        device.name = "device " + std::to_string(id);
+        device.deviceType = "HEADPHONES";
+        device.paired = true;
+        return device;
+    }
+
+    bool Listed(const JsonArray& devices, long long int id)
+    {
+        for (uint32_t index = 0; index < devices.Length(); index++) {
+            if (devices[index].Object()["deviceID"].String() == std::to_string(id))
+                return true;
+        }
+        return false;
+    }
+
+    bool Expect(const bool condition, const char* what)
+    {
+        printf("%-60s %s\n", what, (condition ? "ok" : "FAILED"));
+        return condition;
+    }
+
+    bool Added()
+    {
+        Registry registry;
+        Registry::Delta delta;
+        bool passed = true;
+
+        registry.onDiscoveryStarted();
+        registry.onFound(Discovered(1, -60), delta);
+        passed &= Expect((delta.added.Length() == 1) && (delta.changed.Length() == 0) && Listed(registry.getDiscoveredDevices(), 1),
+            "found device is added");
+
+        Registry::Delta again;
+        registry.onFound(Discovered(1, -60), again);
+        passed &= Expect(again.isEmpty(), "same device found again is not reported");
+        return passed;
+    }
+
+    bool AgedOut()
+    {
+        Registry registry;
+        bool passed = true;
+
+        registry.onDiscoveryStarted();
+        Registry::Delta first;
+        registry.onFound(Discovered(1, -60), first);
+        registry.onFound(Discovered(2, -60), first);
+        registry.onDiscoveryCompleted(first);
+
+        // Device 1 is only reported by the first round
+        Registry::Delta missed;
+        registry.onDiscoveryStarted();
+        registry.onFound(Discovered(2, -60), missed);
+        registry.onDiscoveryCompleted(missed);
+        passed &= Expect(missed.isEmpty() && Listed(registry.getDiscoveredDevices(), 1), "device missing from one round is kept");
+
+        Registry::Delta dropped;
+        registry.onDiscoveryStarted();
+        registry.onFound(Discovered(2, -60), dropped);
+        registry.onDiscoveryCompleted(dropped);
+        passed &= Expect((dropped.removed.Length() == 1) && (dropped.removed[0].Object()["deviceID"].String() == "1")
+            && !Listed(registry.getDiscoveredDevices(), 1) && Listed(registry.getDiscoveredDevices(), 2),
+            "device missing from two rounds in a row is removed");
+        return passed;
+    }
+
+    bool RssiSmoothing()
+    {
+        Registry registry;
+        bool passed = true;
+
+        Registry::Delta delta;
+        registry.onFound(Discovered(1, -60), delta);
+
+        // Smoothed with a weight of 0.5: -62 moves it to -61, -64 to -62.5
+        Registry::Delta small;
+        registry.onFound(Discovered(1, -62), small);
+        registry.onFound(Discovered(1, -64), small);
+        passed &= Expect(small.isEmpty(), "RSSI moving less than 5 dB is not reported");
+
+        // -75 moves it to -68.75, more than 5 dB from the -60 reported
+        Registry::Delta large;
+        registry.onFound(Discovered(1, -75), large);
+        passed &= Expect((large.changed.Length() == 1) && (large.changed[0].Object()["rssi"].String() == "-69"),
+            "RSSI moving 5 dB or more is reported smoothed");
+
+        // A single outlier does not make it
+        Registry::Delta outlier;
+        registry.onFound(Discovered(1, -78), outlier);
+        passed &= Expect(outlier.isEmpty(), "smoothed RSSI close to the reported one is not reported");
+        return passed;
+    }
+
+    bool PairedKept()
+    {
+        Registry registry;
+        bool passed = true;
+
+        registry.load({}, { Paired(7) });
+
+        // Found while discovering, then missing from two rounds
+        Registry::Device discovered = Discovered(7, -50);
+        discovered.deviceType = "HEADPHONES";
+        discovered.paired = true;
+        Registry::Delta found;
+        registry.onDiscoveryStarted();
+        registry.onFound(discovered, found);
+        registry.onDiscoveryCompleted(found);
+        passed &= Expect(Listed(registry.getDiscoveredDevices(), 7), "paired device found while discovering is discovered");
+
+        Registry::Delta aged;
+        for (int round = 0; round < 2; round++) {
+            registry.onDiscoveryStarted();
+            registry.onDiscoveryCompleted(aged);
+        }
+        passed &= Expect((aged.removed.Length() == 0) && (aged.changed.Length() == 1) && (aged.changed[0].Object()["discovered"].Boolean() == false)
+            && Listed(registry.getPairedDevices(), 7) && !Listed(registry.getDiscoveredDevices(), 7),
+            "paired device aged out of discovery is kept as paired");
+
+        // Out of range and back, as BTRMGR_EVENT_DEVICE_OUT_OF_RANGE / DEVICE_FOUND report it
+        Registry::Delta lost;
+        registry.onLost(Paired(7), lost);
+        passed &= Expect(lost.removed.Length() == 0 && Listed(registry.getPairedDevices(), 7), "paired device out of range is kept");
+
+        Registry::Delta inRange;
+        registry.onInRange(Paired(7), inRange);
+        passed &= Expect(inRange.isEmpty() && !Listed(registry.getDiscoveredDevices(), 7) && Listed(registry.getPairedDevices(), 7),
+            "paired device back in range is not discovered");
+
+        // Unpaired while not discovered, it leaves the registry
+        Registry::Delta unpaired;
+        Registry::Device device = Paired(7);
+        device.paired = false;
+        registry.onPairing(device, unpaired);
+        passed &= Expect((unpaired.removed.Length() == 1) && !Listed(registry.getPairedDevices(), 7), "unpaired device is removed");
+        return passed;
+    }
+
+} // namespace
+
+int main()
+{
+    bool passed = true;
+
+    passed &= Added();
+    passed &= AgedOut();
+    passed &= RssiSmoothing();
+    passed &= PairedKept();
+
+    printf("%s\n", (passed ? "PASSED" : "FAILED"));
+    return (passed ? 0 : 1);
+}
@@ -33,6 +33,8 @@
   * This service will be enabled/disabled using an TR181 parameter.
   */
 #include <iomanip>
+#include <unistd.h>
+#include <stdio.h>
 
 #include "ContinueWatching.h"
 
@@ -50,6 +52,7 @@
 
 #define CW_TR181_PARAMETER                      "Device.DeviceInfo.X_RDKCENTRAL-COM_RFC.Feature.OTT_Token.Enable"
 #define CW_ENV_PARAMETER                        "ENABLE_OTT_TOKEN"
+#define CW_TR181_CHECK_INTERVAL_MS              10000
 
 #define CONTINUEWATCHING_MAJOR_VERSION 1
 #define CONTINUEWATCHING_MINOR_VERSION 0
@@ -68,11 +71,14 @@ namespace WPEFramework {
 
 		ContinueWatching::ContinueWatching()
 		: AbstractPlugin()
+		, m_flushPending(false)
+		, m_flushStop(false)
 		, m_apiVersionNumber((uint32_t)-1)
 		{
 			LOGINFO();
 
 			ContinueWatching::_instance = this;
+			m_flushThread = std::thread(&ContinueWatching::flushThread, this);
 			//Register all the APIs
 			registerMethod("getApplicationToken", &ContinueWatching::getApplicationToken, this);
 			registerMethod("setApplicationToken", &ContinueWatching::setApplicationToken, this);
@@ -83,6 +89,20 @@ namespace WPEFramework {
 		ContinueWatching::~ContinueWatching()
 		{
 			LOGINFO();
+
+			// Pending changes are written before the flush thread exits
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_flushStop = true;
+			}
+			m_flushCondition.notify_all();
+			if (m_flushThread.joinable())
+				m_flushThread.join();
+
+			for (auto& impl : m_impls)
+				delete impl.second;
+			m_impls.clear();
+
 			ContinueWatching::_instance = nullptr;
 		}
 
@@ -181,6 +201,27 @@ namespace WPEFramework {
 			returnResponse(result);
 		}
 
+		/**
+		 * @brief This function is used to get the token store of an application. Stores are created
+		 * on first use and kept for the plugin lifetime. Must be called with m_mutex held.
+		 *
+		 * @param[in] strApplicationName Application Name String.
+		 *
+		 * @return ContinueWatchingImpl* or NULL if the application is not supported.
+		 */
+		ContinueWatchingImpl* ContinueWatching::getImpl(std::string strApplicationName)
+		{
+			std::map<std::string, ContinueWatchingImpl*>::iterator it = m_impls.find(strApplicationName);
+			if (it != m_impls.end())
+				return it->second;
+
+			ContinueWatchingImplFactory continueWatchingImplFactory;
+			ContinueWatchingImpl *continueWatchingImpl = continueWatchingImplFactory.createContinueWatchingImpl(strApplicationName);
+			if (continueWatchingImpl)
+				m_impls[strApplicationName] = continueWatchingImpl;
+			return continueWatchingImpl;
+		}
+
 		/**
 		 * @brief This function is used to get the application token.
 		 *
@@ -192,9 +233,7 @@ namespace WPEFramework {
 		{
 			try
 			{
-				ContinueWatchingImplFactory continueWatchingImplFactory;
-				ContinueWatchingImpl *continueWatchingImpl = NULL;
-				continueWatchingImpl = continueWatchingImplFactory.createContinueWatchingImpl(strApplicationName);
+				ContinueWatchingImpl *continueWatchingImpl = getImpl(strApplicationName);
 				if (!continueWatchingImpl)
 				{
 					LOGERR("Application name not matched. Return empty string \n");
@@ -202,7 +241,6 @@ namespace WPEFramework {
 				}
 
 				std::string tokenData = continueWatchingImpl->getApplicationToken();
-				continueWatchingImpl = NULL;
 				LOGINFO(" tokenData %s \n",tokenData.c_str());
 				return tokenData;
 			}
@@ -227,15 +265,13 @@ namespace WPEFramework {
 				if (token.size() < 1)
 					return false;
 
-				ContinueWatchingImplFactory continueWatchingImplFactory;
-				ContinueWatchingImpl *continueWatchingImpl = NULL;
-				continueWatchingImpl = continueWatchingImplFactory.createContinueWatchingImpl(strApplicationName);
+				ContinueWatchingImpl *continueWatchingImpl = getImpl(strApplicationName);
 				if (!continueWatchingImpl)
 					return false;
 
 				bool result = continueWatchingImpl->setApplicationToken(token);
-				delete continueWatchingImpl;
-				continueWatchingImpl = NULL;
+				if (result)
+					scheduleFlush();
 				return result;
 			}
 			catch (...) {
@@ -255,15 +291,13 @@ namespace WPEFramework {
 		{
 			try
 			{
-				ContinueWatchingImplFactory continueWatchingImplFactory;
-				ContinueWatchingImpl *continueWatchingImpl = NULL;
-				continueWatchingImpl = continueWatchingImplFactory.createContinueWatchingImpl(strApplicationName);
+				ContinueWatchingImpl *continueWatchingImpl = getImpl(strApplicationName);
 				if (!continueWatchingImpl)
 					return false;
 
 				bool result = continueWatchingImpl->deleteApplicationToken();
-				delete continueWatchingImpl;
-				continueWatchingImpl = NULL;
+				if (result)
+					scheduleFlush();
 				return result;
 			}
 			catch (...) {
@@ -271,13 +305,164 @@ namespace WPEFramework {
 			}
 		}
 
+		/**
+		 * @brief This function requests the token stores to be written to CW_LOCAL_FILE.
+		 * Must be called with m_mutex held.
+		 */
+		void ContinueWatching::scheduleFlush()
+		{
+			m_flushPending = true;
+			m_flushCondition.notify_all();
+		}
+
+		/**
+		 * @brief Background writer. Changes are written CW_FLUSH_DELAY_MS after the first one,
+		 * so a burst of updates results in a single file write.
+		 */
+		void ContinueWatching::flushThread()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			while (true)
+			{
+				m_flushCondition.wait(lock, [this]() { return m_flushPending || m_flushStop; });
+
+				if (!m_flushStop)
+					m_flushCondition.wait_for(lock, std::chrono::milliseconds(CW_FLUSH_DELAY_MS), [this]() { return m_flushStop; });
+
+				bool stop = m_flushStop;
+				m_flushPending = false;
+
+				lock.unlock();
+				flushTokens();
+				lock.lock();
+
+				if (stop)
+					break;
+			}
+		}
+
+		/**
+		 * @brief This function writes the changed tokens to CW_LOCAL_FILE. Entries of other applications
+		 * are kept. The file is replaced atomically, a crash leaves either the old or the new file.
+		 */
+		void ContinueWatching::flushTokens()
+		{
+			std::map<std::string, std::pair<bool, std::string>> changes;
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				for (auto& impl : m_impls)
+				{
+					std::string protectedData;
+					bool stored = false;
+					if (impl.second->takeDirty(protectedData, stored))
+						changes[impl.first] = std::make_pair(stored, protectedData);
+				}
+			}
+
+			if (changes.empty())
+				return;
+
+			cJSON *root = NULL;
+			FILE *file = fopen(CW_LOCAL_FILE, "r");
+			if (file) {
+				fseek(file, 0, SEEK_END);
+				long numbytes = ftell(file);
+				char *jsonDoc = (char*)malloc(sizeof(char)*(numbytes + 1));
+				if (jsonDoc) {
+					fseek(file, 0, SEEK_SET);
+					size_t read = fread(jsonDoc, 1, numbytes, file);
+					jsonDoc[read] = 0;
+					root = cJSON_Parse(jsonDoc);
+					free(jsonDoc);
+				}
+				fclose(file);
+				file = NULL;
+			}
+
+			if (!root)
+				root = cJSON_CreateObject();
+
+			cJSON *tokens = cJSON_GetObjectItem(root, "tokens");
+			if (!tokens) {
+				tokens = cJSON_CreateArray();
+				cJSON_AddItemToObject(root, "tokens", tokens);
+			}
+
+			for (auto& change : changes)
+			{
+				bool found = false;
+				int tokensCount = cJSON_GetArraySize(tokens);
+				for (int i = 0; i < tokensCount; i++) {
+					cJSON *token = cJSON_GetArrayItem(tokens, i);
+					cJSON *item = cJSON_GetObjectItem(token, "applicationName");
+					if (item && item->valuestring && strcmp(item->valuestring, change.first.c_str()) == 0) {
+						found = true;
+						if (change.second.first)
+							cJSON_ReplaceItemInObject(token, "encryptedData", cJSON_CreateString(change.second.second.c_str()));
+						else
+							cJSON_DeleteItemFromArray(tokens, i);
+						break;
+					}
+				}
+
+				if (!found && change.second.first) {
+					cJSON *jsonItem = cJSON_CreateObject();
+					cJSON_AddItemToObject(jsonItem, "applicationName", cJSON_CreateString(change.first.c_str()));
+					cJSON_AddItemToObject(jsonItem, "encryptedData", cJSON_CreateString(change.second.second.c_str()));
+					cJSON_AddItemToArray(tokens, jsonItem);
+				}
+			}
+
+			char *jsonOut = cJSON_Print(root);
+			cJSON_Delete(root);
+
+			bool written = false;
+			if (jsonOut) {
+				file = fopen(CW_LOCAL_FILE_TMP, "w");
+				if (file) {
+					written = (fputs(jsonOut, file) >= 0) && (fflush(file) == 0) && (fsync(fileno(file)) == 0);
+					written = (fclose(file) == 0) && written;
+					file = NULL;
+				}
+				free(jsonOut);
+				jsonOut = NULL;
+			}
+
+			if (written && rename(CW_LOCAL_FILE_TMP, CW_LOCAL_FILE) == 0)
+				return;
+
+			LOGERR("Failed to write %s, retrying\n", CW_LOCAL_FILE);
+			unlink(CW_LOCAL_FILE_TMP);
+
+			// The changes are still not on file, hand them back for the next flush
+			std::lock_guard<std::mutex> lock(m_mutex);
+			for (auto& change : changes)
+			{
+				auto impl = m_impls.find(change.first);
+				if (impl != m_impls.end())
+					impl->second->markDirty();
+			}
+			if (!m_flushStop)
+				scheduleFlush();
+		}
+
 		/**
 		 * @brief Class ContinueWatchingImpl Constructor.
 		 *
 		 * @return None.
 		 */
 		ContinueWatchingImpl::ContinueWatchingImpl()
+		: mLoaded(false)
+		, mStored(false)
+		, mDirty(false)
+		, mFeatureEnabled(false)
 		{
+		#if !defined(DISABLE_SECAPI)
+			mSecProcessor = NULL;
+			mSecKey = NULL;
+		#endif
 		}
 
 		/**
@@ -288,7 +473,70 @@ namespace WPEFramework {
 
 		ContinueWatchingImpl::~ContinueWatchingImpl()
 		{
+		#if !defined(DISABLE_SECAPI)
+			releaseSecHandles();
+		#endif
+		}
+
+		#if !defined(DISABLE_SECAPI)
+		/**
+		 * @brief This function sets up the SecAPI processor and key handles, once.
+		 *
+		 * @return True if the handles are available.
+		 */
+		bool ContinueWatchingImpl::acquireSecHandles()
+		{
+			Sec_Result result = SEC_RESULT_SUCCESS;
+
+			if (mSecKey)
+				return true;
+
+			try
+			{
+				if (!mSecProcessor) {
+					result = SecProcessor_GetInstance_Directories(&mSecProcessor, "/opt/drm", "/opt/drm/servicemgr");
+					if(result != SEC_RESULT_SUCCESS) {
+						mSecProcessor = NULL;
+						throw "Failure to get SecAPI Processor Instance!";
+					}
+				}
+
+				if(!SecKey_IsProvisioned(mSecProcessor, mSecObjectId)) {
+					result = SecKey_Generate(mSecProcessor, mSecObjectId, SEC_KEYTYPE_AES_128, SEC_STORAGELOC_FILE);
+					if(result != SEC_RESULT_SUCCESS)
+						throw "Failure to generate new key!";
+				}
+
+				result = SecKey_GetInstance(mSecProcessor, mSecObjectId, &mSecKey);
+				if(result != SEC_RESULT_SUCCESS) {
+					mSecKey = NULL;
+					throw "Failure to get SecAPI key handle!";
+				}
+			}
+			catch (const char* msg) {
+				LOGWARN("%s %s result = %d\n", __FUNCTION__, msg, result);
+				return false;
+			}
+
+			return true;
+		}
+
+		/**
+		 * @brief This function releases the SecAPI key and processor handles.
+		 */
+		void ContinueWatchingImpl::releaseSecHandles()
+		{
+			if(mSecKey) {
+				SecKey_Release(mSecKey);
+				mSecKey = NULL;
+			}
+
+			if(mSecProcessor) {
+				SecProcessor_Release(mSecProcessor);
+				mSecProcessor = NULL;
+			}
 		}
+		#endif
 
 		/**
 		 * @brief Class ContinueWatchingImplFactory Constructor.
@@ -322,9 +570,6 @@ namespace WPEFramework {
 		bool ContinueWatchingImpl::encryptData(uint8_t* clearData, int clearDataLength, uint8_t* protectedData, int protectedDataLength, int &bytesWritten)
 		{
 		#if !defined(DISABLE_SECAPI)
-			Sec_ProcessorHandle *sec_proc = NULL;
-			Sec_KeyHandle *sec_key = NULL;
-			Sec_StorageLoc loc = SEC_STORAGELOC_FILE;
 			Sec_Result result = SEC_RESULT_SUCCESS;
 			Sec_CipherHandle *sec_cipher = NULL;
 			SEC_BYTE iv[SEC_CIPHER_IV_MAX_LEN] = { 0 };
@@ -339,21 +584,10 @@ namespace WPEFramework {
 
 			try
 			{
-				result = SecProcessor_GetInstance_Directories(&sec_proc, "/opt/drm", "/opt/drm/servicemgr");
-				if(result != SEC_RESULT_SUCCESS)
-					throw "Failure to get SecAPI Processor Instance!";
-
-				if(!SecKey_IsProvisioned(sec_proc, mSecObjectId)) {
-					result = SecKey_Generate(sec_proc, mSecObjectId, SEC_KEYTYPE_AES_128,loc);
-					if(result != SEC_RESULT_SUCCESS)
-						throw "Failure to generate new key!";
-				}
+				if(!acquireSecHandles())
+					throw "Failure to get SecAPI handles!";
 
-				result = SecKey_GetInstance(sec_proc, mSecObjectId, &sec_key);
-				if(result != SEC_RESULT_SUCCESS)
-					throw "Failure to get SecAPI key handle!";
-
-				result = SecCipher_GetInstance(sec_proc, algorithm, mode, sec_key, iv, &sec_cipher);
+				result = SecCipher_GetInstance(mSecProcessor, algorithm, mode, mSecKey, iv, &sec_cipher);
 				if(result != SEC_RESULT_SUCCESS)
 					throw "Failure to get SecAPI cipher handler!";
 
@@ -370,16 +604,6 @@ namespace WPEFramework {
 				SecCipher_Release(sec_cipher);
 				sec_cipher = NULL;
 			}
-
-			if(sec_key) {
-				SecKey_Release(sec_key);
-				sec_key = NULL;
-			}
-
-			if(sec_proc) {
-				SecProcessor_Release(sec_proc);
-				sec_proc = NULL;
-			}
 			return retVal;
 		#else
 			LOGERR("SecAPI is not enabled on this platform.\n");
@@ -401,9 +625,6 @@ namespace WPEFramework {
 		bool ContinueWatchingImpl::decryptData(uint8_t* protectedData, int protectedDataLength, uint8_t* clearData, int clearDataLength, int &bytesWritten)
 		{
 			#if !defined(DISABLE_SECAPI)
-			Sec_ProcessorHandle *sec_proc = NULL;
-			Sec_KeyHandle *sec_key = NULL;
-			Sec_StorageLoc loc = SEC_STORAGELOC_FILE;
 			Sec_Result result = SEC_RESULT_SUCCESS;
 			Sec_CipherHandle *sec_cipher = NULL;
 			SEC_BYTE iv[SEC_CIPHER_IV_MAX_LEN] = { 0 };
@@ -418,24 +639,11 @@ namespace WPEFramework {
 
 			try
 			{
-				result = SecProcessor_GetInstance_Directories(&sec_proc, "/opt/drm", "/opt/drm/servicemgr");
-				if(result != SEC_RESULT_SUCCESS){
-					throw "Failure to get SecAPI Processor Instance!";
-				}
-
-				if(!SecKey_IsProvisioned(sec_proc, mSecObjectId)) {
-					result = SecKey_Generate(sec_proc, mSecObjectId, SEC_KEYTYPE_AES_128, loc);
-					if(result != SEC_RESULT_SUCCESS){
-						throw "Failure to generate new key!";
-					}
+				if(!acquireSecHandles()){
+					throw "Failure to get SecAPI handles!";
 				}
 
-				result = SecKey_GetInstance(sec_proc, mSecObjectId, &sec_key);
-				if(result != SEC_RESULT_SUCCESS){
-					throw "Failure to get SecAPI key handler!";
-				}
-
-				result = SecCipher_GetInstance(sec_proc, algorithm, mode, sec_key, iv, &sec_cipher);
+				result = SecCipher_GetInstance(mSecProcessor, algorithm, mode, mSecKey, iv, &sec_cipher);
 				if(result != SEC_RESULT_SUCCESS){
 					throw "Failure to get SecAPI cipher handler!";
 				}
@@ -455,16 +663,6 @@ namespace WPEFramework {
 				sec_cipher = NULL;
 			}
 
-			if(sec_key) {
-				SecKey_Release(sec_key);
-				sec_key = NULL;
-			}
-
-			if(sec_proc) {
-				SecProcessor_Release(sec_proc);
-				sec_proc = NULL;
-			}
-
 			return retVal;
 		#else
 			LOGWARN("%s SecAPI is not enabled on this platform.\n", __FUNCTION__);
@@ -472,101 +670,6 @@ namespace WPEFramework {
 		#endif
 		}
 
-		/**
-		 * @brief This function is used to write the protectedData into file.
-		 *
-		 * @param[in] protectedData Variable of string.
-		 *
-		 * @return True if it able to write data into file.
-		 */
-		bool ContinueWatchingImpl::writeToJson(std::string protectedData)
-		{
-			char *jsonDoc = NULL;
-			char *jsonOut = NULL;
-			cJSON *root = NULL;
-			bool createNewJsonDoc = true;
-
-			FILE *file = fopen(CW_LOCAL_FILE, "r");
-			if (file) {
-				fseek(file, 0, SEEK_END);
-				long numbytes = ftell(file);
-				jsonDoc = (char*)malloc(sizeof(char)*(numbytes + 1));
-				if(jsonDoc == NULL) {
-					return false;
-				}
-
-				fseek(file, 0, SEEK_SET);
-				fread(jsonDoc, numbytes, 1, file);
-				fclose(file);
-				file = NULL;
-				jsonDoc[numbytes] = 0;
-
-				root = cJSON_Parse(jsonDoc);
-				cJSON *tokens = cJSON_GetObjectItem(root, "tokens");
-				if (tokens) {
-					int i;
-					bool tokenUpdated = false;
-					int tokensCount = cJSON_GetArraySize(tokens);
-					createNewJsonDoc = false;
-					for (i = 0; i < tokensCount; i++) {
-						cJSON *token = cJSON_GetArrayItem(tokens, i);
-						cJSON *item = cJSON_GetObjectItem(token, "applicationName");
-						if (item) {
-							//updating token data
-							if (strcmp(item->valuestring, mStrApplicationName.c_str()) == 0) {
-								tokenUpdated = true;
-								cJSON_ReplaceItemInObject(token, "encryptedData", cJSON_CreateString(protectedData.c_str()));
-				 				break;
-							}
-						}
-					}
-
-					//Adding new entry to list
-					if(!tokenUpdated) {
-						cJSON *jsonItem = cJSON_CreateObject();
-
-						cJSON_AddItemToObject(jsonItem, "applicationName", cJSON_CreateString(mStrApplicationName.c_str()));
-						cJSON_AddItemToObject(jsonItem, "encryptedData", cJSON_CreateString(protectedData.c_str()));
-						cJSON_AddItemToArray(tokens, jsonItem);
-					}
-				}
-				free(jsonDoc);
-				jsonDoc = NULL;
-			}
-
-			if (createNewJsonDoc) {
-				cJSON *tokenArray;
-				cJSON *jsonItem;
-
-				root  = cJSON_CreateObject();
-				tokenArray=  cJSON_CreateArray();
-				cJSON_AddItemToObject(root, "tokens", tokenArray);
-				jsonItem = cJSON_CreateObject();
-				cJSON_AddItemToObject(jsonItem, "applicationName", cJSON_CreateString(mStrApplicationName.c_str()));
-				cJSON_AddItemToObject(jsonItem, "encryptedData", cJSON_CreateString(protectedData.c_str()));
-				cJSON_AddItemToArray(tokenArray, jsonItem);
-			}
-
-			jsonOut = cJSON_Print(root);
-			cJSON_Delete(root);
-
-			file = fopen(CW_LOCAL_FILE, "w");
-			if (!file) {
-				free(jsonOut);
-				jsonOut = NULL;
-				return false;
-			}
-
-			fprintf(file, "%s", jsonOut);
-
-			fclose (file);
-			file = NULL;
-			free(jsonOut);
-			jsonOut = NULL;
-
-			return true;
-		}
-
 		/**
 		 * @brief This function is used to read the protectedData from file.
 		 *
@@ -620,82 +723,109 @@ namespace WPEFramework {
 		}
 
 		/**
-		 * @brief This function is used to delete the token from file.
+		 * @brief This function is used to load the token from file into memory, once.
 		 *
-		 * @return True.
+		 * @return True if the token (possibly none) is in memory.
 		 */
-		bool ContinueWatchingImpl::deleteToken()
+		bool ContinueWatchingImpl::loadToken()
 		{
-			char *jsonDoc = NULL;
-			char *jsonOut = NULL;
-			cJSON *root = NULL;
-			bool retVal = false;
+			if (mLoaded)
+				return true;
+
+			std::string protectedData = readFromJson();
+			if (protectedData.empty()) {
+				mToken.clear();
+				mStored = false;
+				mLoaded = true;
+				return true;
+			}
 
-			if(!tr181FeatureEnabled()) {
-				LOGWARN("Feature DISABLED...\n");
+			std::string token = decodeToken(protectedData);
+			if (token.empty())
 				return false;
-			}
 
-			FILE *file = fopen(CW_LOCAL_FILE, "r");
-			if (!file)
-				return retVal;
+			mToken = token;
+			mProtectedData = protectedData;
+			mStored = true;
+			mLoaded = true;
+			return true;
+		}
 
-			fseek(file, 0, SEEK_END);
-			long numbytes = ftell(file);
-			jsonDoc = (char*)malloc(sizeof(char)*(numbytes + 1));
-			if(jsonDoc==NULL) {
+		/**
+		 * @brief This function encrypts the token and keeps it in memory until the next flush.
+		 *
+		 * @return True if the token could be encrypted.
+		 */
+		bool ContinueWatchingImpl::storeToken(const std::string& token)
+		{
+			std::string protectedData;
+
+			if (!encodeToken(token, protectedData))
 				return false;
-			}
-			fseek(file, 0, SEEK_SET);
-			fread(jsonDoc, numbytes, 1, file);
-			fclose(file);
-			file = NULL;
-			jsonDoc[numbytes] = 0;
 
-			root = cJSON_Parse(jsonDoc);
-			cJSON *tokens = cJSON_GetObjectItem(root, "tokens");
-			if (tokens) {
-				int i;
-				int tokensCount = cJSON_GetArraySize(tokens);
-				for (i = 0; i < tokensCount; i++) {
-					cJSON *token = cJSON_GetArrayItem(tokens, i);
-					cJSON *item = cJSON_GetObjectItem(token, "applicationName");
-					if (item) {
-						if (strcmp(item->valuestring, mStrApplicationName.c_str()) == 0) {
-							retVal = true;
-							cJSON_DeleteItemFromArray(tokens, i);
-							break;
-						}
-					}
-				}
-			}
-			free(jsonDoc);
-			jsonDoc = NULL;
+			mToken = token;
+			mProtectedData = protectedData;
+			mStored = true;
+			mLoaded = true;
+			mDirty = true;
+			return true;
+		}
 
-			if (!retVal) {
-				cJSON_Delete(root);
-				return retVal;
+		/**
+		 * @brief This function is used to delete the token. It is removed from file on the next flush.
+		 *
+		 * @return True if there was a token.
+		 */
+		bool ContinueWatchingImpl::deleteToken()
+		{
+			if(!tr181FeatureEnabled()) {
+				LOGWARN("Feature DISABLED...\n");
+				return false;
 			}
 
-			jsonOut = cJSON_Print(root);
-			cJSON_Delete(root);
+			// A token that fails to decrypt can still be deleted
+			if (!mLoaded && !loadToken())
+				mStored = !readFromJson().empty();
 
-			file = fopen(CW_LOCAL_FILE, "w");
-			if (!file) {
-				free(jsonOut);
-				jsonOut = NULL;
-				retVal = false;
-				return retVal;
-			}
+			if (!mStored)
+				return false;
+
+			mToken.clear();
+			mProtectedData.clear();
+			mStored = false;
+			mLoaded = true;
+			mDirty = true;
+			return true;
+		}
+
+		/**
+		 * @brief This function hands the pending change over to the writer.
+		 *
+		 * @param[out] protectedData Encrypted token to write.
+		 * @param[out] stored False if the token has to be removed from file.
+		 *
+		 * @return True if there was a change to write.
+		 */
+		bool ContinueWatchingImpl::takeDirty(std::string& protectedData, bool& stored)
+		{
+			if (!mDirty)
+				return false;
 
-			fprintf(file, "%s", jsonOut);
-			fclose (file);
-			file = NULL;
-			free(jsonOut);
-			jsonOut = NULL;
+			protectedData = mProtectedData;
+			stored = mStored;
+			mDirty = false;
 			return true;
 		}
 
+		/**
+		 * @brief This function marks the token as still to be written, after a failed flush.
+		 * The token in memory is written, whether or not it changed again meanwhile.
+		 */
+		void ContinueWatchingImpl::markDirty()
+		{
+			mDirty = true;
+		}
+
 		/**
 		 * @brief This function is used generate sha256 hash for given string.
 		 *
@@ -750,6 +880,13 @@ namespace WPEFramework {
 		bool ContinueWatchingImpl::tr181FeatureEnabled()
 		{
 			bool retVal = false;
+			std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+			// RFC lookups are expensive, the result is reused for a while
+			if (mFeatureCheckTime != std::chrono::steady_clock::time_point() &&
+				(now - mFeatureCheckTime) < std::chrono::milliseconds(CW_TR181_CHECK_INTERVAL_MS)) {
+				return mFeatureEnabled;
+			}
 
 			// Get RFC value for Continue Watching
 			if(checkTR181(CW_TR181_PARAMETER)) {
@@ -769,6 +906,9 @@ namespace WPEFramework {
 				retVal = true;
 				LOGINFO("%s: found environment setting %s, setting enabled to %d\n", __FUNCTION__, CW_ENV_PARAMETER, retVal);
 			}
+
+			mFeatureEnabled = retVal;
+			mFeatureCheckTime = now;
 			return retVal;
 		}
 
@@ -800,10 +940,41 @@ namespace WPEFramework {
 		 *
 		 * @return string.
 		 */
-
 		std::string NetflixContinueWatchingImpl::getApplicationToken()
 		{
-			string encencryptData = readFromJson();
+			if(!tr181FeatureEnabled()) {
+				LOGWARN("%s Feature DISABLED\n", __FUNCTION__);
+				return "";
+			}
+
+			if (!loadToken())
+				return "";
+
+			return mToken;
+		}
+
+		/**
+		 * @brief This function is used to set the application token.
+		 *
+		 * @param[in] token Variable of token value string.
+		 *
+		 * @return true.
+		 */
+		bool NetflixContinueWatchingImpl::setApplicationToken(string token)
+		{
+			return storeToken(token);
+		}
+
+		/**
+		 * @brief This function decodes, decrypts and verifies a token read from file.
+		 *
+		 * @param[in] protectedData Base64 encrypted token as stored in file.
+		 *
+		 * @return token, empty on failure.
+		 */
+		std::string ContinueWatchingImpl::decodeToken(const std::string& protectedData)
+		{
+			string encencryptData = protectedData;
 			int paddingLength = 0;
 			string decodedencryptedtokenbase64;
 
@@ -827,6 +998,8 @@ namespace WPEFramework {
 			bool result;
 
 			result = decryptData(workspace, num_chars, output, sizeof(output), bytesWritten);
+			free(workspace);
+			workspace = NULL;
 			if (!result){
 				LOGERR("decryptData failed..\n");
 				return "";
@@ -864,17 +1037,20 @@ namespace WPEFramework {
 				listdecydec << decworkspace[i];
 			}
 			dectokenbase64 = listdecydec.str();
+			free(decworkspace);
+			decworkspace = NULL;
 			return dectokenbase64;
 		}
 
 		/**
-		 * @brief This function is used to set the application token.
+		 * @brief This function encrypts and encodes a token the way it is stored in file.
 		 *
 		 * @param[in] token Variable of token value string.
+		 * @param[out] protectedData Base64 encrypted token.
 		 *
-		 * @return true.
+		 * @return True on success.
 		 */
-		bool NetflixContinueWatchingImpl::setApplicationToken(string token)
+		bool ContinueWatchingImpl::encodeToken(const std::string& token, std::string& protectedData)
 		{
 			bool result;
 			string tokenbase64;
@@ -894,6 +1070,8 @@ namespace WPEFramework {
 				list1 << workspace[i];
 			}
 			tokenbase64 = list1.str();
+			free(workspace);
+			workspace = NULL;
 
 			//add hash of sha256
 			string hash = sha256(tokenbase64);
@@ -928,8 +1106,11 @@ namespace WPEFramework {
 				listwritetofile << jsonworkspace[i];
 			}
 			jsontokenbase64 = listwritetofile.str();
-			result = writeToJson(jsontokenbase64);
-			return result;
+			free(jsonworkspace);
+			jsonworkspace = NULL;
+
+			protectedData = jsontokenbase64;
+			return true;
 		}
 
 		/**
@@ -40,6 +40,10 @@
 
 #include <string.h>
 #include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <map>
 #include "Module.h"
 #include "utils.h"
 #if !defined(DISABLE_SECAPI)
@@ -50,6 +54,8 @@
 #include "AbstractPlugin.h"
 
 #define CW_LOCAL_FILE  "/opt/continuewatching.json"
+#define CW_LOCAL_FILE_TMP  "/opt/continuewatching.json.tmp"
+#define CW_FLUSH_DELAY_MS  2000
 #define NETFLIX_CONTINUEWATCHING_APP_NAME  "netflix"
 
 namespace WPEFramework {
@@ -72,6 +78,8 @@ namespace WPEFramework {
 		// As the registration/unregistration of notifications is realized by the class PluginHost::JSONRPC,
 		// this class exposes a public method called, Notify(), using this methods, all subscribed clients
 		// will receive a JSONRPC message as a notification, in case this method is called.
+		class ContinueWatchingImpl;
+
 	        class ContinueWatching : public AbstractPlugin {
         	private:
 			// We do not allow this plugin to be copied !!
@@ -83,8 +91,18 @@ namespace WPEFramework {
 			std::string getAppToken(std::string strApplicationName);
 			bool setAppToken(std::string strApplicationName, std::string token);
 			bool deleteAppToken(std::string strApplicationName);
+			ContinueWatchingImpl* getImpl(std::string strApplicationName);
+			void scheduleFlush();
+			void flushThread();
+			void flushTokens();
 	       private:
 			std::mutex m_mutex;
+			// Token stores live for the plugin lifetime, guarded by m_mutex
+			std::map<std::string, ContinueWatchingImpl*> m_impls;
+			std::thread m_flushThread;
+			std::condition_variable m_flushCondition;
+			bool m_flushPending;
+			bool m_flushStop;
         	public:
 			ContinueWatching();
 			virtual ~ContinueWatching();
@@ -111,18 +129,39 @@ namespace WPEFramework {
 			bool encryptData(uint8_t* clearData, int clearDataLength, uint8_t* protectedData, int protectedDataLength, int &bytesWritten);
 			bool decryptData(uint8_t* protectedData, int protectedDataLength, uint8_t* clearData, int clearDataLength, int &bytesWritten);
 			std::string sha256(const std::string str);
-			bool writeToJson(std::string protectedData);
 			std::string readFromJson();
 			bool deleteToken();
+			const std::string& applicationName() const { return mStrApplicationName; }
+			bool takeDirty(std::string& protectedData, bool& stored);
+			void markDirty();
 
 		protected:
 		    	bool checkTR181(const std::string& feature);
 	    		bool tr181FeatureEnabled();
+			bool loadToken();
+			bool storeToken(const std::string& token);
+			std::string decodeToken(const std::string& protectedData);
+			bool encodeToken(const std::string& token, std::string& protectedData);
 
 	    		std::string mStrApplicationName;
 			#if !defined(DISABLE_SECAPI)
     			SEC_OBJECTID mSecObjectId;
+			bool acquireSecHandles();
+			void releaseSecHandles();
+			// Processor and key handles are set up once and reused for every cipher operation
+			Sec_ProcessorHandle *mSecProcessor;
+			Sec_KeyHandle *mSecKey;
 			#endif
+
+			// Decrypted token, loaded from CW_LOCAL_FILE on first use
+			bool mLoaded;
+			bool mStored;
+			bool mDirty;
+			std::string mToken;
+			std::string mProtectedData;
+
+			bool mFeatureEnabled;
+			std::chrono::steady_clock::time_point mFeatureCheckTime;
 		};
 
 		/**
@@ -0,0 +1,256 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "CECTransmitQueue.h"
+
+#include <string.h>
+
+#define CEC_TRANSMIT_QUEUE_REPLY_TIMEOUT_MS 2000
+
+CECTransmitQueue::CECTransmitQueue()
+	: m_running(false)
+	, m_replyTimeoutMs(CEC_TRANSMIT_QUEUE_REPLY_TIMEOUT_MS)
+{
+	resetStatistics();
+}
+
+CECTransmitQueue::~CECTransmitQueue()
+{
+	stop();
+}
+
+void CECTransmitQueue::start()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if ( m_running )
+		return;
+
+	m_running = true;
+	m_thread = std::thread(&CECTransmitQueue::run, this);
+}
+
+void CECTransmitQueue::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if ( !m_running )
+			return;
+
+		m_running = false;
+
+		/* Whatever is left is meant for a connection that is going away */
+		for (int i = 0; i < PRIORITY_COUNT; i++)
+			m_queues[i].clear();
+		m_pending.clear();
+		m_inFlight.clear();
+	}
+
+	m_condition.notify_all();
+
+	if ( m_thread.joinable() )
+		m_thread.join();
+}
+
+bool CECTransmitQueue::enqueue(Priority priority, int destination, int opcode, bool expectReply, Transmit transmit)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	uint32_t requestKey = key(destination, opcode);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if ( !m_running )
+			return false;
+
+		/* The same question is on the bus already, its answer will do */
+		if ( isInFlight(requestKey, now) )
+		{
+			m_statistics[priority].inFlightSkipped++;
+			return false;
+		}
+
+		std::map<uint32_t, int>::iterator pending = m_pending.find(requestKey);
+		if ( pending != m_pending.end() )
+		{
+			m_statistics[priority].coalesced++;
+
+			/* Asked again with a higher priority, move it up keeping its original enqueue time */
+			if ( priority < pending->second )
+			{
+				std::deque<Request> &from = m_queues[pending->second];
+				for (std::deque<Request>::iterator it = from.begin(); it != from.end(); ++it)
+				{
+					if ( key(it->destination, it->opcode) == requestKey )
+					{
+						m_queues[priority].push_back(*it);
+						from.erase(it);
+						break;
+					}
+				}
+				pending->second = priority;
+			}
+			return false;
+		}
+
+		Request request;
+		request.destination = destination;
+		request.opcode = opcode;
+		request.expectReply = expectReply;
+		request.transmit = transmit;
+		request.enqueueTime = now;
+
+		m_queues[priority].push_back(request);
+		m_pending[requestKey] = priority;
+		m_statistics[priority].enqueued++;
+	}
+
+	m_condition.notify_one();
+	return true;
+}
+
+void CECTransmitQueue::replied(int source, int opcode)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_inFlight.erase(key(source, opcode));
+}
+
+void CECTransmitQueue::clear(int destination)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (int i = 0; i < PRIORITY_COUNT; i++)
+	{
+		std::deque<Request>::iterator it = m_queues[i].begin();
+		while ( it != m_queues[i].end() )
+		{
+			if ( it->destination == destination )
+			{
+				m_pending.erase(key(it->destination, it->opcode));
+				it = m_queues[i].erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	std::map<uint32_t, std::chrono::steady_clock::time_point>::iterator it = m_inFlight.begin();
+	while ( it != m_inFlight.end() )
+	{
+		if ( (int)(it->first >> 8) == destination )
+			it = m_inFlight.erase(it);
+		else
+			++it;
+	}
+}
+
+size_t CECTransmitQueue::pending()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_pending.size();
+}
+
+void CECTransmitQueue::getStatistics(Statistics (&statistics)[PRIORITY_COUNT])
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	memcpy(statistics, m_statistics, sizeof(m_statistics));
+}
+
+void CECTransmitQueue::resetStatistics()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	memset(m_statistics, 0, sizeof(m_statistics));
+}
+
+bool CECTransmitQueue::isInFlight(uint32_t requestKey, std::chrono::steady_clock::time_point now)
+{
+	std::map<uint32_t, std::chrono::steady_clock::time_point>::iterator it = m_inFlight.find(requestKey);
+
+	if ( it == m_inFlight.end() )
+		return false;
+
+	/* No reply in time, the request may be sent again */
+	if ( now >= it->second )
+	{
+		m_inFlight.erase(it);
+		return false;
+	}
+
+	return true;
+}
+
+void CECTransmitQueue::run()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while ( m_running )
+	{
+		int priority = 0;
+		while ( priority < PRIORITY_COUNT && m_queues[priority].empty() )
+			priority++;
+
+		if ( priority == PRIORITY_COUNT )
+		{
+			m_condition.wait(lock);
+			continue;
+		}
+
+		Request request = m_queues[priority].front();
+		m_queues[priority].pop_front();
+
+		uint32_t requestKey = key(request.destination, request.opcode);
+		m_pending.erase(requestKey);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		std::chrono::duration<double,std::milli> wait = start - request.enqueueTime;
+		m_statistics[priority].totalWaitMs += wait.count();
+		if ( wait.count() > m_statistics[priority].maxWaitMs )
+			m_statistics[priority].maxWaitMs = wait.count();
+
+		/* Mark it in flight before sending, the reply can arrive before the transmit returns */
+		if ( request.expectReply )
+			m_inFlight[requestKey] = start + std::chrono::milliseconds(m_replyTimeoutMs);
+
+		lock.unlock();
+
+		bool sent = true;
+		try {
+			request.transmit();
+		}
+		catch(...)
+		{
+			sent = false;
+		}
+
+		lock.lock();
+
+		if ( sent )
+		{
+			m_statistics[priority].sent++;
+		}
+		else
+		{
+			m_statistics[priority].failed++;
+			m_inFlight.erase(requestKey);
+		}
+	}
+}
@@ -0,0 +1,120 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef _CEC_TRANSMIT_QUEUE_H_
+#define _CEC_TRANSMIT_QUEUE_H_
+
+#include <stdint.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+/*
+ * Single transmitter for the CEC bus. Frames are sent one at a time by a
+ * worker thread, highest priority first, so a user action never waits
+ * behind a burst of informational polls.
+ *
+ * Requests are identified by destination and opcode: a request that is
+ * already pending is coalesced (and promoted when asked with a higher
+ * priority), a request whose reply is still expected is not sent again
+ * until the reply arrives or the reply timeout expires.
+ *
+ * The queue has no knowledge of the CEC library, the frame is sent by
+ * the Transmit callback, which may block and may throw.
+ */
+class CECTransmitQueue {
+public:
+	enum Priority {
+		PRIORITY_USER = 0,	/* User initiated actions, e.g. SetStreamPath */
+		PRIORITY_ROUTING,	/* Routing and active source handling */
+		PRIORITY_INFO,		/* Device information polls */
+		PRIORITY_COUNT
+	};
+
+	typedef std::function<void()> Transmit;
+
+	struct Statistics {
+		uint32_t enqueued;
+		uint32_t sent;
+		uint32_t failed;
+		uint32_t coalesced;
+		uint32_t inFlightSkipped;
+		double totalWaitMs;
+		double maxWaitMs;
+	};
+
+	CECTransmitQueue();
+	~CECTransmitQueue();
+
+	void start();
+	void stop();
+
+	void setReplyTimeout(uint32_t timeoutMs) { m_replyTimeoutMs = timeoutMs; }
+
+	/* Returns false when the request was coalesced with a pending or in-flight one */
+	bool enqueue(Priority priority, int destination, int opcode, bool expectReply, Transmit transmit);
+
+	/* A reply to the request 'opcode' was received from 'source' */
+	void replied(int source, int opcode);
+
+	/* Drops pending and in-flight requests for a device that left the bus */
+	void clear(int destination);
+
+	size_t pending();
+	void getStatistics(Statistics (&statistics)[PRIORITY_COUNT]);
+	void resetStatistics();
+
+private:
+	CECTransmitQueue(const CECTransmitQueue&) = delete;
+	CECTransmitQueue& operator=(const CECTransmitQueue&) = delete;
+
+	struct Request {
+		int destination;
+		int opcode;
+		bool expectReply;
+		Transmit transmit;
+		std::chrono::steady_clock::time_point enqueueTime;
+	};
+
+	static uint32_t key(int destination, int opcode) { return ((destination & 0xFF) << 8) | (opcode & 0xFF); }
+
+	bool isInFlight(uint32_t requestKey, std::chrono::steady_clock::time_point now);
+	void run();
+
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::thread m_thread;
+	bool m_running;
+	uint32_t m_replyTimeoutMs;
+
+	std::deque<Request> m_queues[PRIORITY_COUNT];
+	/* Key of each pending request and the priority queue it sits in */
+	std::map<uint32_t, int> m_pending;
+	/* Key of each request waiting for its reply, and its deadline */
+	std::map<uint32_t, std::chrono::steady_clock::time_point> m_inFlight;
+
+	Statistics m_statistics[PRIORITY_COUNT];
+};
+
+#endif
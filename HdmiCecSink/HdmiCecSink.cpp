@@ -39,6 +39,8 @@
 
 #include "utils.h"
 
+#include <algorithm>
+
 #define HDMICECSINK_METHOD_SET_ENABLED "setEnabled"
 #define HDMICECSINK_METHOD_GET_ENABLED "getEnabled"
 #define HDMICECSINK_METHOD_OTP_SET_ENABLED "setOTPEnabled"
@@ -51,6 +53,8 @@
 #define HDMICECSINK_METHOD_SET_ACTIVE_PATH "setActivePath"
 #define HDMICECSINK_METHOD_GET_DEVICE_LIST "getDeviceList"
 #define HDMICECSINK_METHOD_GET_ACTIVE_SOURCE "getActiveSource"
+#define HDMICECSINK_METHOD_GET_DISCOVERY_STATISTICS "getDiscoveryStatistics"
+#define HDMICECSINK_METHOD_GET_TRANSMIT_QUEUE_STATISTICS "getTransmitQueueStatistics"
 
 
 
@@ -62,6 +66,18 @@
 #define HDMICECSINK_REQUEST_INTERVAL_TIME_MS 		200
 #define HDMICECSINK_NUMBER_TV_ADDR 					2
 #define HDMICECSINK_UPDATE_POWER_STATUS_INTERVA_MS    (60 * 1000)
+#define HDMICECSINK_PING_FAST_INTERVAL_MS 			1000
+#define HDMICECSINK_PING_FAST_CYCLES 				10
+#define HDMICECSINK_PING_BUDGET_MS 					250
+#define HDMICECSINK_PING_GAP_MS 					20
+#define HDMICECSINK_PING_MAX_BACKOFF 				4
+
+/* Logical addresses of a device type, in the order they are allocated */
+static const int logicalAddressSequences[][4] = {
+	{ 1, 2, 9, -1 },	/* Recording devices */
+	{ 3, 6, 7, 10 },	/* Tuners */
+	{ 4, 8, 11, -1 },	/* Playback devices */
+};
 
 
 
@@ -135,6 +151,7 @@ namespace WPEFramework
 
 			 HdmiCecSink::_instance->addDevice(header.from.toInt());	
 			 HdmiCecSink::_instance->updateActiveSource(header.from.toInt(), msg);
+			 HdmiCecSink::_instance->onRequestReplied(LogicalAddress::BROADCAST, RequestActiveSource().opCode());
       }
        void HdmiCecSinkProcessor::process (const InActiveSource &msg, const Header &header)
        {
@@ -186,6 +203,7 @@ namespace WPEFramework
 
 			HdmiCecSink::_instance->addDevice(header.from.toInt());
 			HdmiCecSink::_instance->deviceList[header.from.toInt()].update(msg.version);
+			HdmiCecSink::_instance->onRequestReplied(header.from.toInt(), GetCECVersion().opCode());
        }
        void HdmiCecSinkProcessor::process (const SetMenuLanguage &msg, const Header &header)
        {
@@ -247,6 +265,7 @@ namespace WPEFramework
 
 			 HdmiCecSink::_instance->addDevice(header.from.toInt());
 			 HdmiCecSink::_instance->deviceList[header.from.toInt()].update(msg.osdName);
+			 HdmiCecSink::_instance->onRequestReplied(header.from.toInt(), GiveOSDName().opCode());
        }
        void HdmiCecSinkProcessor::process (const RoutingChange &msg, const Header &header)
        {
@@ -279,6 +298,7 @@ namespace WPEFramework
 			 HdmiCecSink::_instance->addDevice(header.from.toInt()); 	
 			 HdmiCecSink::_instance->deviceList[header.from.toInt()].update(msg.physicalAddress);
 			 HdmiCecSink::_instance->deviceList[header.from.toInt()].update(msg.deviceType);
+			 HdmiCecSink::_instance->onRequestReplied(header.from.toInt(), GivePhysicalAddress().opCode());
        }
        void HdmiCecSinkProcessor::process (const DeviceVendorID &msg, const Header &header)
        {
@@ -287,6 +307,7 @@ namespace WPEFramework
 
 			 HdmiCecSink::_instance->addDevice(header.from.toInt());
 			 HdmiCecSink::_instance->deviceList[header.from.toInt()].update(msg.vendorId);
+			 HdmiCecSink::_instance->onRequestReplied(header.from.toInt(), GiveDeviceVendorID().opCode());
        }
        void HdmiCecSinkProcessor::process (const GiveDevicePowerStatus &msg, const Header &header)
        {
@@ -308,6 +329,7 @@ namespace WPEFramework
 
 			HdmiCecSink::_instance->addDevice(header.from.toInt());
 			HdmiCecSink::_instance->deviceList[header.from.toInt()].update(msg.status);
+			HdmiCecSink::_instance->onRequestReplied(header.from.toInt(), GiveDevicePowerStatus().opCode());
        }
        void HdmiCecSinkProcessor::process (const FeatureAbort &msg, const Header &header)
        {
@@ -375,6 +397,15 @@ namespace WPEFramework
 		   m_isHdmiInConnected = false;
 		   m_pollNextState = POLL_THREAD_STATE_NONE;
 		   m_pollThreadState = POLL_THREAD_STATE_NONE;
+		   m_pingCycles = 0;
+		   m_pingsSent = 0;
+		   m_pingsSkipped = 0;
+		   m_pingBusTimeMs = 0;
+		   m_devicesDiscovered = 0;
+		   m_discoveryLatencyLastMs = 0;
+		   m_discoveryLatencyMaxMs = 0;
+		   m_discoveryLatencyTotalMs = 0;
+		   resetDiscovery();
 
            InitializeIARM();
 
@@ -388,6 +419,8 @@ namespace WPEFramework
 		   registerMethod(HDMICECSINK_METHOD_SET_ACTIVE_PATH, &HdmiCecSink::setActivePathWrapper, this);
 		   registerMethod(HDMICECSINK_METHOD_GET_DEVICE_LIST, &HdmiCecSink::getDeviceListWrapper, this);
 		   registerMethod(HDMICECSINK_METHOD_GET_ACTIVE_SOURCE, &HdmiCecSink::getActiveSourceWrapper, this);
+		   registerMethod(HDMICECSINK_METHOD_GET_DISCOVERY_STATISTICS, &HdmiCecSink::getDiscoveryStatisticsWrapper, this);
+		   registerMethod(HDMICECSINK_METHOD_GET_TRANSMIT_QUEUE_STATISTICS, &HdmiCecSink::getTransmitQueueStatisticsWrapper, this);
 
            logicalAddressDeviceType = "None";
            logicalAddress = 0xFF;
@@ -550,7 +583,7 @@ namespace WPEFramework
        		{
        			/*while wakeup From Standby, Ask for Active Source*/
 				m_currentActiveSource = -1;
-       			_instance->smConnection->sendTo(LogicalAddress(LogicalAddress::BROADCAST),MessageEncoder().encode(RequestActiveSource()), 5000); 
+       			_instance->transmit(CECTransmitQueue::PRIORITY_ROUTING, LogicalAddress::BROADCAST, RequestActiveSource(), true);
        		}
        }
 
@@ -590,6 +623,9 @@ namespace WPEFramework
 
 			CheckHdmiInState();
 
+			/* Topology may have changed, forget what is known about absent addresses and rediscover quickly */
+			resetDiscovery();
+
 			if ( previousHdmiState != m_isHdmiInConnected )
 			{
 				if ( m_isHdmiInConnected == false )
@@ -597,6 +633,15 @@ namespace WPEFramework
 					m_pollNextState = POLL_THREAD_STATE_PING;
 				}
 			}
+			else if ( m_isHdmiInConnected == true && m_pollThreadState != POLL_THREAD_STATE_WAIT )
+			{
+				m_pollNextState = POLL_THREAD_STATE_PING;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_pollMutex);
+				m_pollCondition.notify_one();
+			}
             return;
        }
 
@@ -680,6 +725,56 @@ namespace WPEFramework
             returnResponse(true);
        }
 
+       uint32_t HdmiCecSink::getDiscoveryStatisticsWrapper(const JsonObject& parameters, JsonObject& response)
+       {
+            LOGINFO();
+
+			std::lock_guard<std::mutex> lock(m_discoveryMutex);
+
+			response["pingCycles"] = m_pingCycles;
+			response["pingsSent"] = m_pingsSent;
+			response["pingsSkipped"] = m_pingsSkipped;
+			response["averageCycleBusTimeMs"] = (m_pingCycles ? (uint32_t)(m_pingBusTimeMs / m_pingCycles) : 0);
+			response["devicesDiscovered"] = m_devicesDiscovered;
+			response["lastDiscoveryLatencyMs"] = (uint32_t)m_discoveryLatencyLastMs;
+			response["averageDiscoveryLatencyMs"] = (m_devicesDiscovered ? (uint32_t)(m_discoveryLatencyTotalMs / m_devicesDiscovered) : 0);
+			response["maxDiscoveryLatencyMs"] = (uint32_t)m_discoveryLatencyMaxMs;
+
+            returnResponse(true);
+       }
+
+
+       uint32_t HdmiCecSink::getTransmitQueueStatisticsWrapper(const JsonObject& parameters, JsonObject& response)
+       {
+            LOGINFO();
+
+			static const char *priorityNames[CECTransmitQueue::PRIORITY_COUNT] = { "user", "routing", "info" };
+			CECTransmitQueue::Statistics statistics[CECTransmitQueue::PRIORITY_COUNT];
+			JsonArray queues;
+
+			m_txQueue.getStatistics(statistics);
+
+			for (int i = 0; i < CECTransmitQueue::PRIORITY_COUNT; i++)
+			{
+				JsonObject queue;
+				uint32_t dequeued = statistics[i].sent + statistics[i].failed;
+
+				queue["priority"] = priorityNames[i];
+				queue["enqueued"] = statistics[i].enqueued;
+				queue["sent"] = statistics[i].sent;
+				queue["failed"] = statistics[i].failed;
+				queue["coalesced"] = statistics[i].coalesced;
+				queue["inFlightSkipped"] = statistics[i].inFlightSkipped;
+				queue["averageWaitMs"] = (dequeued ? (uint32_t)(statistics[i].totalWaitMs / dequeued) : 0);
+				queue["maxWaitMs"] = (uint32_t)statistics[i].maxWaitMs;
+				queues.Add(queue);
+			}
+
+			response["queues"] = queues;
+			response["pending"] = (uint32_t)m_txQueue.pending();
+
+            returnResponse(true);
+       }
 
        uint32_t HdmiCecSink::setOSDNameWrapper(const JsonObject& parameters, JsonObject& response)
        {
@@ -1064,6 +1159,10 @@ namespace WPEFramework
 		void HdmiCecSink::pingDevices(std::vector<int> &connected , std::vector<int> &disconnected)
         {
         	int i;
+			int n;
+			uint32_t pinged = 0;
+			uint32_t skipped = 0;
+			std::chrono::duration<double,std::milli> busTime(0);
 
 			if(!HdmiCecSink::_instance)
                 return;
@@ -1072,39 +1171,141 @@ namespace WPEFramework
 				LOGERR("Logical Address NOT Allocated");
 				return;
 			}
-			
-            for(i=0; i< LogicalAddress::UNREGISTERED; i++ ) {
-				if ( i != _instance->m_logicalAddressAllocated )
+
+			/* The ping state is also reset on hotplug, from the IARM thread. It is never locked across a ping */
+			int cursor;
+			{
+				std::lock_guard<std::mutex> lock(_instance->m_discoveryMutex);
+				cursor = _instance->m_pingCursor;
+				_instance->m_pingPending = false;
+			}
+
+			/* Start where the previous cycle ran out of budget, so every address gets its turn */
+            for(n=0; n< LogicalAddress::UNREGISTERED; n++ ) {
+				i = (cursor + n) % LogicalAddress::UNREGISTERED;
+
+				if ( i == _instance->m_logicalAddressAllocated )
+					continue;
+
 				{
-					//LOGWARN("PING for  0x%x \r\n",i);
-					try {
-						_instance->smConnection->ping(LogicalAddress(_instance->m_logicalAddressAllocated), LogicalAddress(i), Throw_e());
-					}
-					catch(CECNoAckException &e)
+					std::lock_guard<std::mutex> lock(_instance->m_discoveryMutex);
+
+					/* Present devices are pinged every cycle to detect removal, absent addresses only when due */
+					if ( !_instance->deviceList[i].m_isDevicePresent && _instance->m_pingSkip[i] > 0 )
 					{
-						if ( _instance->deviceList[i].m_isDevicePresent ) {
-							disconnected.push_back(i);
-						}
-						//LOGWARN("Ping caught %s \r\n",e.what());
-						usleep(50000);
+						_instance->m_pingSkip[i]--;
+						skipped++;
 						continue;
 					}
-					  catch(Exception &e)
-					  {
-						LOGINFO("Ping caught %s \r\n",e.what());
-					  }
-					  
-					  LOGINFO("PING got Device ACK 0x%x \r\n",i);
-					  /* If we get ACK, then the device is present in the network*/
-					  if ( !_instance->deviceList[i].m_isDevicePresent )
-					  {
-					  	connected.push_back(i);
-					  }
-					  usleep(50000);      
+
+					if ( busTime.count() >= HDMICECSINK_PING_BUDGET_MS )
+					{
+						_instance->m_pingCursor = i;
+						_instance->m_pingPending = true;
+						break;
+					}
+				}
+
+				std::chrono::steady_clock::time_point pingStart = std::chrono::steady_clock::now();
+				pinged++;
+
+				//LOGWARN("PING for  0x%x \r\n",i);
+				try {
+					_instance->smConnection->ping(LogicalAddress(_instance->m_logicalAddressAllocated), LogicalAddress(i), Throw_e());
+				}
+				catch(CECNoAckException &e)
+				{
+					if ( _instance->deviceList[i].m_isDevicePresent ) {
+						disconnected.push_back(i);
+					}
+					_instance->backoffAbsent(i);
+					//LOGWARN("Ping caught %s \r\n",e.what());
+					usleep(HDMICECSINK_PING_GAP_MS * 1000);
+					busTime += std::chrono::steady_clock::now() - pingStart;
+					continue;
 				}
+				  catch(Exception &e)
+				  {
+					LOGINFO("Ping caught %s \r\n",e.what());
+				  }
+
+				  LOGINFO("PING got Device ACK 0x%x \r\n",i);
+				  /* If we get ACK, then the device is present in the network*/
+				  if ( !_instance->deviceList[i].m_isDevicePresent )
+				  {
+				  	connected.push_back(i);
+				  }
+				  usleep(HDMICECSINK_PING_GAP_MS * 1000);
+				  busTime += std::chrono::steady_clock::now() - pingStart;
            	}
+
+			std::lock_guard<std::mutex> lock(_instance->m_discoveryMutex);
+			if ( !_instance->m_pingPending )
+			{
+				_instance->m_pingCursor = 0;
+			}
+
+			_instance->m_pingCycles++;
+			_instance->m_pingsSent += pinged;
+			_instance->m_pingsSkipped += skipped;
+			_instance->m_pingBusTimeMs += busTime.count();
+			LOGINFO("Ping cycle: %u pinged, %u skipped, %.0f ms bus time%s", pinged, skipped, busTime.count(), _instance->m_pingPending ? ", budget exceeded" : "");
         }
 
+		bool HdmiCecSink::isAddressExpected(const int logicalAddress) {
+			/* TVs, audio system and specific use can always show up */
+			if ( logicalAddress == LogicalAddress::TV || logicalAddress == 5 || logicalAddress == 14 )
+				return true;
+
+			/* A device type takes the next address of its sequence only if the previous one is in use */
+			for (unsigned int type = 0; type < sizeof(logicalAddressSequences) / sizeof(logicalAddressSequences[0]); type++)
+			{
+				for (int index = 0; index < 4 && logicalAddressSequences[type][index] != -1; index++)
+				{
+					if ( logicalAddressSequences[type][index] == logicalAddress )
+					{
+						return ( index == 0 || deviceList[logicalAddressSequences[type][index - 1]].m_isDevicePresent );
+					}
+				}
+			}
+
+			/* Reserved addresses */
+			return false;
+		}
+
+		void HdmiCecSink::backoffAbsent(const int logicalAddress) {
+			std::lock_guard<std::mutex> lock(m_discoveryMutex);
+			int backoff = m_pingBackoff[logicalAddress];
+
+			if ( isAddressExpected(logicalAddress) )
+			{
+				backoff = ( backoff == 0 ) ? 1 : std::min(backoff * 2, HDMICECSINK_PING_MAX_BACKOFF);
+			}
+			else
+			{
+				backoff = HDMICECSINK_PING_MAX_BACKOFF;
+			}
+
+			m_pingBackoff[logicalAddress] = backoff;
+			m_pingSkip[logicalAddress] = backoff;
+			m_lastAbsentTime[logicalAddress] = std::chrono::steady_clock::now();
+		}
+
+		void HdmiCecSink::resetDiscovery() {
+			std::lock_guard<std::mutex> lock(m_discoveryMutex);
+			std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+			for (int i = 0; i < LogicalAddress::UNREGISTERED; i++)
+			{
+				m_pingBackoff[i] = 0;
+				m_pingSkip[i] = 0;
+				m_lastAbsentTime[i] = now;
+			}
+			m_pingCursor = 0;
+			m_pingPending = false;
+			m_fastPingCycles = HDMICECSINK_PING_FAST_CYCLES;
+		}
+
 		int HdmiCecSink::requestType( const int logicalAddress ) {
 			int requestType = CECDeviceParams::REQUEST_NONE;
 			
@@ -1145,7 +1346,7 @@ namespace WPEFramework
 			if(!HdmiCecSink::_instance)
 				return;
 
-			_instance->smConnection->sendTo(LogicalAddress(LogicalAddress::BROADCAST), MessageEncoder().encode(SetStreamPath(PhysicalAddress(1,0,0,0))), 5000);	
+			_instance->transmit(CECTransmitQueue::PRIORITY_USER, LogicalAddress::BROADCAST, SetStreamPath(PhysicalAddress(1,0,0,0)), false);
 		}
 
 		void HdmiCecSink::addDevice(const int logicalAddress) {
@@ -1163,6 +1364,20 @@ namespace WPEFramework
 			 	HdmiCecSink::_instance->deviceList[logicalAddress].m_isDevicePresent = true;
 				HdmiCecSink::_instance->deviceList[logicalAddress].m_logicalAddress = LogicalAddress(logicalAddress);
 				HdmiCecSink::_instance->m_numberOfDevices++;
+
+				/* Latency is measured from the last time the address was known to be absent */
+				{
+					std::lock_guard<std::mutex> lock(_instance->m_discoveryMutex);
+					std::chrono::duration<double,std::milli> latency = std::chrono::steady_clock::now() - _instance->m_lastAbsentTime[logicalAddress];
+					_instance->m_devicesDiscovered++;
+					_instance->m_discoveryLatencyLastMs = latency.count();
+					_instance->m_discoveryLatencyTotalMs += latency.count();
+					if ( latency.count() > _instance->m_discoveryLatencyMaxMs )
+						_instance->m_discoveryLatencyMaxMs = latency.count();
+					LOGINFO("Device 0x%x discovered in %.0f ms", logicalAddress, latency.count());
+					_instance->m_pingBackoff[logicalAddress] = 0;
+					_instance->m_pingSkip[logicalAddress] = 0;
+				}
 				HdmiCecSink::_instance->m_pollNextState = POLL_THREAD_STATE_INFO;
 				sendNotify(eventString[HDMICECSINK_EVENT_DEVICE_ADDED], JsonObject())
 			 }
@@ -1181,10 +1396,19 @@ namespace WPEFramework
 			{
 				_instance->m_numberOfDevices--;
 				_instance->deviceList[logicalAddress].clear();
+				{
+					std::lock_guard<std::mutex> lock(_instance->m_discoveryMutex);
+					_instance->m_lastAbsentTime[logicalAddress] = std::chrono::steady_clock::now();
+				}
+				_instance->m_txQueue.clear(logicalAddress);
 				sendNotify(eventString[HDMICECSINK_EVENT_DEVICE_REMOVED], JsonObject());
 			}
 		}
 
+		void HdmiCecSink::onRequestReplied(const int logicalAddress, const int opcode) {
+			m_txQueue.replied(logicalAddress, opcode);
+		}
+
 		void HdmiCecSink::requestPowerStatus(const int logicalAddress) {
 			int i;
 			int requestType;
@@ -1195,7 +1419,7 @@ namespace WPEFramework
 				LOGERR("Logical Address NOT Allocated Or its not valid");
 				return;
 			}
-			_instance->smConnection->sendTo(LogicalAddress(logicalAddress), MessageEncoder().encode(GiveDevicePowerStatus()), 5000);	
+			_instance->transmit(CECTransmitQueue::PRIORITY_INFO, logicalAddress, GiveDevicePowerStatus(), true);
 		}
 
 		void HdmiCecSink::request(const int logicalAddress) {
@@ -1216,31 +1440,31 @@ namespace WPEFramework
 			{
 				case CECDeviceParams::REQUEST_PHISICAL_ADDRESS :
 				{
-					_instance->smConnection->sendTo(LogicalAddress(logicalAddress), MessageEncoder().encode(GivePhysicalAddress()), 5000);	
+					_instance->transmit(CECTransmitQueue::PRIORITY_INFO, logicalAddress, GivePhysicalAddress(), true);
 				}
 					break;
 
 				case CECDeviceParams::REQUEST_CEC_VERSION :
 				{
-					_instance->smConnection->sendTo(LogicalAddress(logicalAddress), MessageEncoder().encode(GetCECVersion()), 5000);	
+					_instance->transmit(CECTransmitQueue::PRIORITY_INFO, logicalAddress, GetCECVersion(), true);
 				}
 					break;
 
 				case CECDeviceParams::REQUEST_DEVICE_VENDOR_ID :
 				{
-					_instance->smConnection->sendTo(LogicalAddress(logicalAddress), MessageEncoder().encode(GiveDeviceVendorID()), 5000);	
+					_instance->transmit(CECTransmitQueue::PRIORITY_INFO, logicalAddress, GiveDeviceVendorID(), true);
 				}
 					break;
 
 				case CECDeviceParams::REQUEST_OSD_NAME :	
 				{
-					_instance->smConnection->sendTo(LogicalAddress(logicalAddress), MessageEncoder().encode(GiveOSDName()), 5000);	
+					_instance->transmit(CECTransmitQueue::PRIORITY_INFO, logicalAddress, GiveOSDName(), true);
 				}
 					break;
 
 				case CECDeviceParams::REQUEST_POWER_STATUS :	
 				{
-					_instance->smConnection->sendTo(LogicalAddress(logicalAddress), MessageEncoder().encode(GiveDevicePowerStatus()), 5000);	
+					_instance->transmit(CECTransmitQueue::PRIORITY_INFO, logicalAddress, GiveDevicePowerStatus(), true);
 				}
 					break;
 				default:
@@ -1435,12 +1659,12 @@ namespace WPEFramework
 						_instance->deviceList[_instance->m_logicalAddressAllocated].m_cecVersion = Version::V_1_4;
 						_instance->deviceList[_instance->m_logicalAddressAllocated].m_vendorID = appVendorId;
 						_instance->smConnection->addFrameListener(_instance->msgFrameListener);
-						_instance->smConnection->sendTo(LogicalAddress(LogicalAddress::BROADCAST), 
-								MessageEncoder().encode(ReportPhysicalAddress(physical_addr, _instance->deviceList[_instance->m_logicalAddressAllocated].m_deviceType)), 5000);	
+						_instance->transmit(CECTransmitQueue::PRIORITY_ROUTING, LogicalAddress::BROADCAST,
+								ReportPhysicalAddress(physical_addr, _instance->deviceList[_instance->m_logicalAddressAllocated].m_deviceType), false);
 
 						 if ( powerState == 0 )
 						 {
-							_instance->smConnection->sendTo(LogicalAddress(LogicalAddress::BROADCAST),MessageEncoder().encode(RequestActiveSource()), 5000); 
+							_instance->transmit(CECTransmitQueue::PRIORITY_ROUTING, LogicalAddress::BROADCAST, RequestActiveSource(), true);
 						 }
 
 						_instance->m_sleepTime = HDMICECSINK_PING_INTERVAL_MS;
@@ -1562,7 +1786,19 @@ namespace WPEFramework
 				case POLL_THREAD_STATE_IDLE :
 				{
 					LOGINFO("POLL_THREAD_STATE_IDLE");
-					_instance->m_sleepTime = HDMICECSINK_PING_INTERVAL_MS;
+					/* Ping again soon after a hotplug or when the last cycle ran out of budget */
+					std::unique_lock<std::mutex> lock(_instance->m_discoveryMutex);
+					if ( _instance->m_pingPending || _instance->m_fastPingCycles > 0 )
+					{
+						if ( _instance->m_fastPingCycles > 0 )
+							_instance->m_fastPingCycles--;
+						_instance->m_sleepTime = HDMICECSINK_PING_FAST_INTERVAL_MS;
+					}
+					else
+					{
+						_instance->m_sleepTime = HDMICECSINK_PING_INTERVAL_MS;
+					}
+					lock.unlock();
 					_instance->m_pollThreadState = POLL_THREAD_STATE_PING;
 				}
 				break;
@@ -1589,7 +1825,11 @@ namespace WPEFramework
 				}
 
 				if ( _instance->m_sleepTime ) {
-					usleep(_instance->m_sleepTime*1000);
+					/* Hotplug events cut the wait short */
+					std::unique_lock<std::mutex> lock(_instance->m_pollMutex);
+					_instance->m_pollCondition.wait_for(lock, std::chrono::milliseconds(_instance->m_sleepTime),
+						[]() { return ( _instance->m_pollNextState != POLL_THREAD_STATE_NONE ||
+							( _instance->m_pollThreadState == POLL_THREAD_STATE_WAIT && _instance->m_isHdmiInConnected ) ); });
 				}
 			}
         }
@@ -1668,6 +1908,7 @@ namespace WPEFramework
             smConnection->open();
             msgProcessor = new HdmiCecSinkProcessor(*smConnection);
             msgFrameListener = new HdmiCecSinkFrameListener(*msgProcessor);
+            m_txQueue.start();
             
             cecEnableStatus = true;
 
@@ -1696,6 +1937,9 @@ namespace WPEFramework
                 return;
             }
 
+            /* Nothing may be sent on the connection once it is closed */
+            m_txQueue.stop();
+
             if (smConnection != NULL)
             {
                 smConnection->close();
@@ -34,9 +34,12 @@
 #include "Module.h"
 #include "utils.h"
 #include "AbstractPlugin.h"
+#include "CECTransmitQueue.h"
 
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <chrono>
 
 
 namespace WPEFramework {
@@ -270,6 +273,7 @@ namespace WPEFramework {
 			void addDevice(const int logicalAddress);
 			void printDeviceList();
 			void setActivePath();
+			void onRequestReplied(const int logicalAddress, const int opcode);
 			int m_numberOfDevices; /* Number of connected devices othethan own device */
         private:
             // We do not allow this plugin to be copied !!
@@ -287,6 +291,8 @@ namespace WPEFramework {
 			uint32_t setActivePathWrapper(const JsonObject& parameters, JsonObject& response);
 			uint32_t getDeviceListWrapper(const JsonObject& parameters, JsonObject& response);
 			uint32_t getActiveSourceWrapper(const JsonObject& parameters, JsonObject& response);
+			uint32_t getDiscoveryStatisticsWrapper(const JsonObject& parameters, JsonObject& response);
+			uint32_t getTransmitQueueStatisticsWrapper(const JsonObject& parameters, JsonObject& response);
 			
             //End methods
             std::string logicalAddressDeviceType;
@@ -301,7 +307,26 @@ namespace WPEFramework {
 			uint32_t m_pollNextState;
 			uint32_t m_sleepTime;
             std::mutex m_pollMutex;
+			std::condition_variable m_pollCondition;
+			/* Adaptive discovery: per address back off (in ping cycles) and bus time budget per cycle */
+			int m_pingBackoff[16];
+			int m_pingSkip[16];
+			std::chrono::steady_clock::time_point m_lastAbsentTime[16];
+			int m_pingCursor;
+			bool m_pingPending;
+			int m_fastPingCycles;
+			std::mutex m_discoveryMutex;	/* Guards the ping state above and the statistics below */
+			uint32_t m_pingCycles;
+			uint32_t m_pingsSent;
+			uint32_t m_pingsSkipped;
+			double m_pingBusTimeMs;
+			uint32_t m_devicesDiscovered;
+			double m_discoveryLatencyLastMs;
+			double m_discoveryLatencyMaxMs;
+			double m_discoveryLatencyTotalMs;
             Connection *smConnection;
+			/* All frames initiated by the sink go through the transmit queue, replies to requests from other devices do not */
+			CECTransmitQueue m_txQueue;
 			std::vector<uint8_t> m_connectedDevices;
             HdmiCecSinkProcessor *msgProcessor;
             HdmiCecSinkFrameListener *msgFrameListener;
@@ -310,11 +335,25 @@ namespace WPEFramework {
 			void allocateLogicalAddress(int deviceType);
 			void allocateLAforTV();
 			void pingDevices(std::vector<int> &connected , std::vector<int> &disconnected);
+			bool isAddressExpected(const int logicalAddress);
+			void backoffAbsent(const int logicalAddress);
+			void resetDiscovery();
 			void CheckHdmiInState();
 			void request(const int logicalAddress);
 			int requestType(const int logicalAddress);
 			int requestStatus(const int logicalAddress);
 			void requestPowerStatus(const int logicalAddress);
+
+			template <typename T>
+			void transmit(CECTransmitQueue::Priority priority, const int logicalAddress, const T &message, bool expectReply)
+			{
+				CECFrame frame = MessageEncoder().encode(message);
+				m_txQueue.enqueue(priority, logicalAddress, message.opCode(), expectReply, [this, logicalAddress, frame]() {
+					if ( smConnection )
+						smConnection->sendTo(LogicalAddress(logicalAddress), frame, 5000);
+				});
+			}
+
 			static void threadRun();
 			void cecMonitoringThread();
             static void cecMgrEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
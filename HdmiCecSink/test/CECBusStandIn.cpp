@@ -0,0 +1,203 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+/*
+ * Software stand-in for a CEC bus, used to load test the HdmiCecSink
+ * transmit queue without hardware. Frames occupy the bus for their
+ * nominal CEC duration (4.5 ms start bit, 10 bits of 2.4 ms per block),
+ * simulated devices answer information requests after a processing delay
+ * and their replies compete for the same bus.
+ *
+ * An info poller floods the queue the way the poll thread does, with
+ * duplicate requests, while user actions are injected periodically. The
+ * latency of user actions is reported with and without prioritisation.
+ */
+
+#include "CECTransmitQueue.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define START_BIT_US 4500
+#define BLOCK_US (10 * 2400)
+
+/* Opcodes of the requests used by the sink */
+#define OPCODE_GIVE_PHYSICAL_ADDRESS 0x83
+#define OPCODE_GET_CEC_VERSION 0x9F
+#define OPCODE_GIVE_DEVICE_VENDOR_ID 0x8C
+#define OPCODE_GIVE_OSD_NAME 0x46
+#define OPCODE_GIVE_DEVICE_POWER_STATUS 0x8F
+#define OPCODE_SET_STREAM_PATH 0x86
+
+static const int infoOpcodes[] = { OPCODE_GIVE_PHYSICAL_ADDRESS, OPCODE_GET_CEC_VERSION, OPCODE_GIVE_DEVICE_VENDOR_ID, OPCODE_GIVE_OSD_NAME, OPCODE_GIVE_DEVICE_POWER_STATUS };
+static const int deviceAddresses[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+
+struct Options {
+	int devices = 4;
+	int seconds = 10;
+	int pollIntervalMs = 100;
+	int userIntervalMs = 250;
+	int replyDelayMs = 50;
+	bool fifo = false;
+};
+
+class Bus {
+public:
+	/* Occupies the bus for the duration of a frame of 'blocks' blocks, header included */
+	void transfer(int blocks)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::this_thread::sleep_for(std::chrono::microseconds(START_BIT_US + blocks * BLOCK_US));
+		m_frames++;
+	}
+
+	uint32_t frames() { return m_frames; }
+
+private:
+	std::mutex m_mutex;
+	std::atomic<uint32_t> m_frames { 0 };
+};
+
+static void usage(const char *name)
+{
+	printf("Usage: %s [options]\n"
+		"  -d <count>   simulated devices, 1..11 (default 4)\n"
+		"  -t <seconds> duration (default 10)\n"
+		"  -p <ms>      info poll interval (default 100)\n"
+		"  -u <ms>      user action interval (default 250)\n"
+		"  -r <ms>      device reply delay (default 50)\n"
+		"  -f           single priority (FIFO), for comparison\n", name);
+}
+
+static double percentile(const std::vector<double> &sorted, double p)
+{
+	if ( sorted.empty() )
+		return 0;
+	size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+	return sorted[std::min(index, sorted.size() - 1)];
+}
+
+int main(int argc, char *argv[])
+{
+	Options options;
+	int option;
+
+	while ((option = getopt(argc, argv, "d:t:p:u:r:fh")) != -1) {
+		switch (option) {
+		case 'd': options.devices = std::max(1, std::min(11, atoi(optarg))); break;
+		case 't': options.seconds = atoi(optarg); break;
+		case 'p': options.pollIntervalMs = atoi(optarg); break;
+		case 'u': options.userIntervalMs = atoi(optarg); break;
+		case 'r': options.replyDelayMs = atoi(optarg); break;
+		case 'f': options.fifo = true; break;
+		default: usage(argv[0]); return 1;
+		}
+	}
+
+	Bus bus;
+	CECTransmitQueue queue;
+	std::atomic<bool> running(true);
+	std::mutex repliesMutex;
+	std::vector<std::thread> replies;
+	std::mutex latencyMutex;
+	std::vector<double> userLatencies;
+
+	queue.start();
+
+	/* Devices answer a request with a 3 block frame after their processing delay */
+	auto request = [&](int destination, int opcode) {
+		return [&, destination, opcode]() {
+			bus.transfer(2);
+			std::lock_guard<std::mutex> lock(repliesMutex);
+			replies.push_back(std::thread([&, destination, opcode]() {
+				std::this_thread::sleep_for(std::chrono::milliseconds(options.replyDelayMs));
+				bus.transfer(3);
+				queue.replied(destination, opcode);
+			}));
+		};
+	};
+
+	std::thread poller([&]() {
+		std::mt19937 random(0xCEC);
+		while ( running ) {
+			/* The poll thread and its retries ask the same questions over and over */
+			for (int i = 0; i < options.devices; i++) {
+				int opcode = infoOpcodes[random() % (sizeof(infoOpcodes) / sizeof(infoOpcodes[0]))];
+				queue.enqueue(CECTransmitQueue::PRIORITY_INFO, deviceAddresses[i], opcode, true, request(deviceAddresses[i], opcode));
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(options.pollIntervalMs));
+		}
+	});
+
+	std::thread user([&]() {
+		CECTransmitQueue::Priority priority = options.fifo ? CECTransmitQueue::PRIORITY_INFO : CECTransmitQueue::PRIORITY_USER;
+		while ( running ) {
+			std::chrono::steady_clock::time_point enqueued = std::chrono::steady_clock::now();
+			queue.enqueue(priority, 15, OPCODE_SET_STREAM_PATH, false, [&, enqueued]() {
+				bus.transfer(4);
+				std::chrono::duration<double,std::milli> latency = std::chrono::steady_clock::now() - enqueued;
+				std::lock_guard<std::mutex> lock(latencyMutex);
+				userLatencies.push_back(latency.count());
+			});
+			std::this_thread::sleep_for(std::chrono::milliseconds(options.userIntervalMs));
+		}
+	});
+
+	std::this_thread::sleep_for(std::chrono::seconds(options.seconds));
+	running = false;
+	poller.join();
+	user.join();
+	queue.stop();
+
+	{
+		std::lock_guard<std::mutex> lock(repliesMutex);
+		for (std::thread &reply : replies)
+			reply.join();
+	}
+
+	static const char *priorityNames[CECTransmitQueue::PRIORITY_COUNT] = { "user", "routing", "info" };
+	CECTransmitQueue::Statistics statistics[CECTransmitQueue::PRIORITY_COUNT];
+	queue.getStatistics(statistics);
+
+	printf("mode            : %s, %d devices, %d s\n", options.fifo ? "fifo" : "prioritised", options.devices, options.seconds);
+	printf("bus frames      : %u\n", bus.frames());
+	for (int i = 0; i < CECTransmitQueue::PRIORITY_COUNT; i++) {
+		uint32_t dequeued = statistics[i].sent + statistics[i].failed;
+		printf("%-8s        : enqueued %u sent %u coalesced %u in flight %u, wait avg %.1f ms max %.1f ms\n", priorityNames[i],
+			statistics[i].enqueued, statistics[i].sent, statistics[i].coalesced, statistics[i].inFlightSkipped,
+			dequeued ? statistics[i].totalWaitMs / dequeued : 0.0, statistics[i].maxWaitMs);
+	}
+
+	std::sort(userLatencies.begin(), userLatencies.end());
+	printf("user action (ms): p50 %.1f  p90 %.1f  p99 %.1f  max %.1f  (%zu actions)\n",
+		percentile(userLatencies, 0.50), percentile(userLatencies, 0.90), percentile(userLatencies, 0.99),
+		userLatencies.empty() ? 0.0 : userLatencies.back(), userLatencies.size());
+
+	return 0;
+}
@@ -0,0 +1,919 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "IcmpEngine.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <linux/errqueue.h>
+#include <math.h>
+#include <net/if.h>
+#include <netdb.h>
+#include <netinet/icmp6.h>
+#include <netinet/in.h>
+#include <netinet/ip_icmp.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#define ICMP_ENGINE_HEADER_SIZE     8
+#define ICMP_ENGINE_RECEIVE_SIZE    1500
+#define ICMP_ENGINE_SOCKET_BUFFER   (256 * 1024)
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        IcmpEngine::IcmpEngine()
+            : m_epoll(-1)
+            , m_wakeup(-1)
+            , m_running(false)
+            , m_identifier((uint16_t)getpid())
+            , m_sequence(0)
+        {
+        }
+
+        IcmpEngine::~IcmpEngine()
+        {
+            stop();
+        }
+
+        bool IcmpEngine::openSocket(int family, Socket& socket)
+        {
+            int protocol = (family == AF_INET6) ? (int)IPPROTO_ICMPV6 : (int)IPPROTO_ICMP;
+
+            socket.raw = false;
+            socket.fd = ::socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, protocol);
+            if (socket.fd < 0)
+            {
+                socket.raw = true;
+                socket.fd = ::socket(family, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, protocol);
+            }
+
+            if (socket.fd < 0)
+                return false;
+
+            // Replies to concurrent sessions arrive in bursts
+            int size = ICMP_ENGINE_SOCKET_BUFFER;
+            setsockopt(socket.fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+            if (!socket.raw)
+            {
+                // ICMP errors for a datagram socket, time exceeded included, only come through the error queue
+                int on = 1;
+                if (family == AF_INET6)
+                    setsockopt(socket.fd, IPPROTO_IPV6, IPV6_RECVERR, &on, sizeof(on));
+                else
+                    setsockopt(socket.fd, IPPROTO_IP, IP_RECVERR, &on, sizeof(on));
+            }
+            else if (family == AF_INET6)
+            {
+                // Raw ICMPv6 sockets get every ICMPv6 message, neighbour discovery included
+                struct icmp6_filter filter;
+                ICMP6_FILTER_SETBLOCKALL(&filter);
+                ICMP6_FILTER_SETPASS(ICMP6_ECHO_REPLY, &filter);
+                ICMP6_FILTER_SETPASS(ICMP6_TIME_EXCEEDED, &filter);
+                ICMP6_FILTER_SETPASS(ICMP6_DST_UNREACH, &filter);
+                setsockopt(socket.fd, IPPROTO_ICMPV6, ICMP6_FILTER, &filter, sizeof(filter));
+            }
+
+            return true;
+        }
+
+        bool IcmpEngine::start()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (m_running)
+                return true;
+
+            m_epoll = epoll_create1(EPOLL_CLOEXEC);
+            m_wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (m_epoll < 0 || m_wakeup < 0)
+            {
+                if (m_epoll >= 0)
+                    close(m_epoll);
+                if (m_wakeup >= 0)
+                    close(m_wakeup);
+                m_epoll = m_wakeup = -1;
+                return false;
+            }
+
+            struct epoll_event event;
+            memset(&event, 0, sizeof(event));
+            event.events = EPOLLIN;     // EPOLLERR is always reported
+
+            event.data.fd = m_wakeup;
+            epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup, &event);
+
+            // A family without a socket only fails the pings to that family
+            if (openSocket(AF_INET, m_socket4))
+            {
+                event.data.fd = m_socket4.fd;
+                epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_socket4.fd, &event);
+            }
+            if (openSocket(AF_INET6, m_socket6))
+            {
+                event.data.fd = m_socket6.fd;
+                epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_socket6.fd, &event);
+            }
+
+            m_running = true;
+            m_thread = std::thread(&IcmpEngine::run, this);
+
+            return true;
+        }
+
+        void IcmpEngine::stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_running)
+                    return;
+                m_running = false;
+            }
+
+            uint64_t one = 1;
+            if (write(m_wakeup, &one, sizeof(one)) < 0)
+            {
+                // The thread still sees m_running at its next timeout
+            }
+            m_thread.join();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            for (std::list<Session*>::iterator it = m_sessions.begin(); it != m_sessions.end(); ++it)
+            {
+                (*it)->sendError = "ICMP engine stopped";
+                complete(**it);
+            }
+            m_sessions.clear();
+            m_probes.clear();
+            m_done.notify_all();
+
+            if (m_socket4.fd >= 0)
+                close(m_socket4.fd);
+            if (m_socket6.fd >= 0)
+                close(m_socket6.fd);
+            close(m_epoll);
+            close(m_wakeup);
+            m_socket4 = m_socket6 = Socket();
+            m_epoll = m_wakeup = -1;
+        }
+
+        bool IcmpEngine::resolve(Session& session)
+        {
+            struct addrinfo hints;
+            struct addrinfo* info = NULL;
+
+            memset(&hints, 0, sizeof(hints));
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_DGRAM;
+
+            if (getaddrinfo(session.request.endpoint.c_str(), NULL, &hints, &info) != 0 || info == NULL)
+            {
+                session.result.error = "Bad Address";
+                return false;
+            }
+
+            memset(&session.address, 0, sizeof(session.address));
+            memcpy(&session.address, info->ai_addr, info->ai_addrlen);
+            session.addressLength = info->ai_addrlen;
+            freeaddrinfo(info);
+
+            char address[INET6_ADDRSTRLEN] = {0};
+            session.interfaceIndex = 0;
+
+            if (session.address.ss_family == AF_INET6)
+            {
+                struct sockaddr_in6* in6 = (struct sockaddr_in6*)&session.address;
+                if (!session.request.interface.empty())
+                    session.interfaceIndex = if_nametoindex(session.request.interface.c_str());
+                if (IN6_IS_ADDR_LINKLOCAL(&in6->sin6_addr) && in6->sin6_scope_id == 0)
+                    in6->sin6_scope_id = session.interfaceIndex;
+                inet_ntop(AF_INET6, &in6->sin6_addr, address, sizeof(address));
+            }
+            else
+            {
+                inet_ntop(AF_INET, &((struct sockaddr_in*)&session.address)->sin_addr, address, sizeof(address));
+            }
+
+            session.result.address = address;
+            return true;
+        }
+
+        void IcmpEngine::initSession(Session& session)
+        {
+            session.addressLength = 0;
+            session.interfaceIndex = 0;
+            session.pending = 0;
+            session.done = false;
+            session.trace = false;
+            session.maxHops = 0;
+            session.reachedTtl = 0;
+            session.nextHop = 1;
+        }
+
+        // Called with m_mutex held, the sessions that cannot run are marked done
+        bool IcmpEngine::submit(std::vector<Session*>& sessions)
+        {
+            Clock::time_point now = Clock::now();
+            bool submitted = false;
+
+            for (size_t i = 0; i < sessions.size(); i++)
+            {
+                Session& session = *sessions[i];
+                if (session.done)
+                    continue;
+
+                if (!m_running)
+                {
+                    session.result.error = "ICMP engine is not running";
+                    session.done = true;
+                }
+                else if (socketFor(session.address.ss_family).fd < 0)
+                {
+                    session.result.error = "Could not open ICMP socket";
+                    session.done = true;
+                }
+                else
+                {
+                    session.nextSend = now;
+                    m_sessions.push_back(&session);
+                    submitted = true;
+                }
+            }
+
+            uint64_t one = 1;
+            if (submitted && write(m_wakeup, &one, sizeof(one)) < 0)
+            {
+                // Already signalled, the counter is saturated
+            }
+
+            return submitted;
+        }
+
+        IcmpEngine::Result IcmpEngine::ping(const Request& request)
+        {
+            return ping(std::vector<Request>(1, request))[0];
+        }
+
+        std::vector<IcmpEngine::Result> IcmpEngine::ping(const std::vector<Request>& requests)
+        {
+            std::vector<Session> sessions(requests.size());
+            std::vector<Session*> pointers;
+
+            for (size_t i = 0; i < requests.size(); i++)
+            {
+                Session& session = sessions[i];
+                initSession(session);
+                session.request = requests[i];
+                session.request.packets = std::max(1, std::min(session.request.packets, ICMP_ENGINE_MAX_PACKETS));
+                session.request.intervalMs = std::max(0, session.request.intervalMs);
+                session.request.timeoutMs = std::max(1, session.request.timeoutMs);
+                session.result.target = session.request.endpoint;
+                session.done = !resolve(session);
+                pointers.push_back(&session);
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            submit(pointers);
+
+            m_done.wait(lock, [&sessions]() {
+                for (size_t i = 0; i < sessions.size(); i++)
+                {
+                    if (!sessions[i].done)
+                        return false;
+                }
+                return true;
+            });
+
+            std::vector<Result> results;
+            for (size_t i = 0; i < sessions.size(); i++)
+                results.push_back(sessions[i].result);
+
+            return results;
+        }
+
+        IcmpEngine::TraceResult IcmpEngine::trace(const TraceRequest& request, const HopCallback& onHop)
+        {
+            Session session;
+            initSession(session);
+
+            int queries = std::max(1, std::min(request.queries, ICMP_ENGINE_TRACE_MAX_QUERIES));
+            session.trace = true;
+            session.maxHops = std::max(1, std::min(request.maxHops, ICMP_ENGINE_TRACE_MAX_HOPS));
+            session.request.endpoint = request.endpoint;
+            session.request.interface = request.interface;
+            session.request.packets = session.maxHops * queries;
+            session.request.intervalMs = ICMP_ENGINE_TRACE_ROUND_MS;
+            session.request.timeoutMs = std::max(1, request.timeoutMs);
+            session.result.target = request.endpoint;
+            session.done = !resolve(session);
+
+            std::vector<Session*> pointers(1, &session);
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            submit(pointers);
+
+            while (true)
+            {
+                m_done.wait(lock, [&session]() { return session.done || !session.readyHops.empty(); });
+
+                while (!session.readyHops.empty())
+                {
+                    Hop hop = session.readyHops.front();
+                    session.readyHops.pop_front();
+
+                    if (onHop)
+                    {
+                        lock.unlock();
+                        onHop(hop);
+                        lock.lock();
+                    }
+                }
+
+                if (session.done && session.readyHops.empty())
+                    break;
+            }
+
+            TraceResult result;
+            result.target = session.result.target;
+            result.address = session.result.address;
+            result.success = session.result.success;
+            result.error = session.result.error;
+            result.reached = session.reachedTtl > 0;
+            result.hops = session.hops;
+
+            return result;
+        }
+
+        void IcmpEngine::run()
+        {
+            struct epoll_event events[4];
+            int timeout = -1;
+
+            while (true)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (!m_running)
+                        break;
+                    timeout = service(Clock::now());
+                }
+
+                int count = epoll_wait(m_epoll, events, sizeof(events) / sizeof(events[0]), timeout);
+
+                for (int i = 0; i < count; i++)
+                {
+                    if (events[i].data.fd == m_wakeup)
+                    {
+                        uint64_t value;
+                        if (read(m_wakeup, &value, sizeof(value)) < 0)
+                        {
+                            // Nothing pending
+                        }
+                        continue;
+                    }
+
+                    int family = (events[i].data.fd == m_socket6.fd) ? AF_INET6 : AF_INET;
+                    if (events[i].events & EPOLLERR)
+                        receiveErrors(family);
+                    if (events[i].events & EPOLLIN)
+                        receive(family);
+                }
+            }
+        }
+
+        // Sends the probes that are due and expires the unanswered ones, returns the epoll timeout
+        int IcmpEngine::service(Clock::time_point now)
+        {
+            Clock::time_point deadline = Clock::time_point::max();
+
+            for (std::list<Session*>::iterator it = m_sessions.begin(); it != m_sessions.end(); )
+            {
+                Session& session = **it;
+
+                // A ping sends one probe per interval, a trace one probe for every TTL
+                if ((int)session.probes.size() < session.request.packets && now >= session.nextSend)
+                {
+                    int burst = session.trace ? session.maxHops : 1;
+                    for (int i = 0; i < burst && (int)session.probes.size() < session.request.packets; i++)
+                    {
+                        int ttl = session.trace ? (int)(session.probes.size() % session.maxHops) + 1 : ICMP_ENGINE_DEFAULT_TTL;
+                        sendProbe(session, ttl, now);
+                    }
+                    session.nextSend = now + std::chrono::milliseconds(session.request.intervalMs);
+                }
+
+                for (size_t i = 0; i < session.probes.size(); i++)
+                {
+                    Probe& probe = session.probes[i];
+                    if (probe.replied || probe.lost)
+                        continue;
+
+                    Clock::time_point expiry = probe.sent + std::chrono::milliseconds(session.request.timeoutMs);
+                    if (now >= expiry)
+                    {
+                        probe.lost = true;
+                        resolveProbe(session, probe);
+                    }
+                    else
+                    {
+                        deadline = std::min(deadline, expiry);
+                    }
+                }
+
+                if (session.trace)
+                    collectHops(session);
+
+                if ((int)session.probes.size() == session.request.packets && session.pending == 0)
+                {
+                    complete(session);
+                    it = m_sessions.erase(it);
+                    m_done.notify_all();
+                    continue;
+                }
+
+                if (!session.readyHops.empty())
+                    m_done.notify_all();
+
+                if ((int)session.probes.size() < session.request.packets)
+                    deadline = std::min(deadline, session.nextSend);
+
+                ++it;
+            }
+
+            if (deadline == Clock::time_point::max())
+                return -1;
+
+            // Round up so that the deadline has passed when epoll returns
+            return (int)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count() + 1;
+        }
+
+        void IcmpEngine::setTtl(int family, int ttl)
+        {
+            Socket& socket = socketFor(family);
+            if (socket.ttl == ttl)
+                return;
+
+            if (family == AF_INET6)
+                setsockopt(socket.fd, IPPROTO_IPV6, IPV6_UNICAST_HOPS, &ttl, sizeof(ttl));
+            else
+                setsockopt(socket.fd, IPPROTO_IP, IP_TTL, &ttl, sizeof(ttl));
+
+            socket.ttl = ttl;
+        }
+
+        void IcmpEngine::sendProbe(Session& session, int ttl, Clock::time_point now)
+        {
+            int family = session.address.ss_family;
+            unsigned char packet[ICMP_ENGINE_HEADER_SIZE + ICMP_ENGINE_PAYLOAD_SIZE];
+            Probe probe;
+
+            probe.sent = now;
+            probe.sequence = 0;
+            probe.ttl = ttl;
+            probe.replied = false;
+            probe.lost = false;
+            probe.rttMs = 0;
+            probe.fromEndpoint = false;
+
+            // Nothing to learn beyond the hop where the endpoint answered
+            if (session.trace && session.reachedTtl > 0 && ttl > session.reachedTtl)
+            {
+                probe.lost = true;
+                session.probes.push_back(probe);
+                return;
+            }
+
+            probe.sequence = nextSequence();
+
+            memset(packet, 0, sizeof(packet));
+            packet[0] = (family == AF_INET6) ? ICMP6_ECHO_REQUEST : ICMP_ECHO;
+            packet[4] = m_identifier >> 8;
+            packet[5] = m_identifier & 0xFF;
+            packet[6] = probe.sequence >> 8;
+            packet[7] = probe.sequence & 0xFF;
+            for (size_t i = ICMP_ENGINE_HEADER_SIZE; i < sizeof(packet); i++)
+                packet[i] = (unsigned char)i;
+
+            // The kernel computes the ICMPv6 checksum, which covers the IPv6 pseudo header
+            if (family == AF_INET)
+            {
+                uint16_t sum = checksum(packet, sizeof(packet));
+                memcpy(&packet[2], &sum, sizeof(sum));
+            }
+
+            struct iovec iov;
+            iov.iov_base = packet;
+            iov.iov_len = sizeof(packet);
+
+            struct msghdr message;
+            memset(&message, 0, sizeof(message));
+            message.msg_name = &session.address;
+            message.msg_namelen = session.addressLength;
+            message.msg_iov = &iov;
+            message.msg_iovlen = 1;
+
+            // Pin IPv6 probes to the requested interface, as ping6 -I does
+            char control[CMSG_SPACE(sizeof(struct in6_pktinfo))];
+            if (family == AF_INET6 && session.interfaceIndex != 0)
+            {
+                memset(control, 0, sizeof(control));
+                message.msg_control = control;
+                message.msg_controllen = sizeof(control);
+
+                struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+                cmsg->cmsg_level = IPPROTO_IPV6;
+                cmsg->cmsg_type = IPV6_PKTINFO;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(struct in6_pktinfo));
+
+                struct in6_pktinfo* info = (struct in6_pktinfo*)CMSG_DATA(cmsg);
+                info->ipi6_ifindex = session.interfaceIndex;
+            }
+
+            // Only the engine thread sends, the TTL of the shared socket is set per probe
+            setTtl(family, ttl);
+
+            if (sendmsg(socketFor(family).fd, &message, 0) < 0)
+            {
+                session.sendError = strerror(errno);
+                probe.lost = true;
+                session.probes.push_back(probe);
+                return;
+            }
+
+            session.probes.push_back(probe);
+            session.pending++;
+            m_probes[probe.sequence] = std::make_pair(&session, session.probes.size() - 1);
+        }
+
+        void IcmpEngine::receive(int family)
+        {
+            Socket& socket = socketFor(family);
+            unsigned char buffer[ICMP_ENGINE_RECEIVE_SIZE];
+
+            const unsigned char echoReply = (family == AF_INET6) ? ICMP6_ECHO_REPLY : ICMP_ECHOREPLY;
+            const unsigned char echoRequest = (family == AF_INET6) ? ICMP6_ECHO_REQUEST : ICMP_ECHO;
+            const unsigned char timeExceeded = (family == AF_INET6) ? ICMP6_TIME_EXCEEDED : ICMP_TIME_EXCEEDED;
+            const unsigned char unreachable = (family == AF_INET6) ? ICMP6_DST_UNREACH : ICMP_DEST_UNREACH;
+
+            while (true)
+            {
+                struct sockaddr_storage from;
+                socklen_t fromLength = sizeof(from);
+
+                ssize_t length = recvfrom(socket.fd, buffer, sizeof(buffer), 0, (struct sockaddr*)&from, &fromLength);
+                if (length < 0)
+                    break;
+
+                Clock::time_point received = Clock::now();
+                const unsigned char* icmp = buffer;
+
+                // Only raw IPv4 sockets deliver the IP header
+                if (family == AF_INET && socket.raw)
+                {
+                    size_t headerLength = (length > 0) ? (size_t)(buffer[0] & 0x0F) * 4 : 0;
+                    if (headerLength == 0 || (size_t)length < headerLength)
+                        continue;
+                    icmp += headerLength;
+                    length -= headerLength;
+                }
+
+                if (length < ICMP_ENGINE_HEADER_SIZE)
+                    continue;
+
+                MessageType type;
+                const unsigned char* echo = icmp;
+
+                if (icmp[0] == echoReply)
+                {
+                    type = MESSAGE_ECHO_REPLY;
+                }
+                else if (socket.raw && (icmp[0] == timeExceeded || icmp[0] == unreachable))
+                {
+                    // The error quotes the IP header and the start of our echo request
+                    const unsigned char* quoted = icmp + ICMP_ENGINE_HEADER_SIZE;
+                    size_t quotedLength = length - ICMP_ENGINE_HEADER_SIZE;
+                    size_t headerLength;
+
+                    if (family == AF_INET6)
+                    {
+                        headerLength = 40;
+                        if (quotedLength < headerLength + ICMP_ENGINE_HEADER_SIZE || quoted[6] != IPPROTO_ICMPV6)
+                            continue;
+                    }
+                    else
+                    {
+                        headerLength = (quotedLength > 0) ? (size_t)(quoted[0] & 0x0F) * 4 : 0;
+                        if (headerLength == 0 || quotedLength < headerLength + ICMP_ENGINE_HEADER_SIZE || quoted[9] != IPPROTO_ICMP)
+                            continue;
+                    }
+
+                    echo = quoted + headerLength;
+                    if (echo[0] != echoRequest)
+                        continue;
+
+                    type = (icmp[0] == timeExceeded) ? MESSAGE_TIME_EXCEEDED : MESSAGE_UNREACHABLE;
+                }
+                else
+                {
+                    continue;
+                }
+
+                // A raw socket sees the ICMP traffic of every process, a datagram socket only its own,
+                // but the kernel replaces the identifier with the socket's own one
+                uint16_t identifier = (uint16_t)((echo[4] << 8) | echo[5]);
+                if (socket.raw && identifier != m_identifier)
+                    continue;
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                handleMessage(family, type, from, (uint16_t)((echo[6] << 8) | echo[7]), received);
+            }
+        }
+
+        // ICMP errors of a datagram socket: the probe is returned with the error and the router that sent it
+        void IcmpEngine::receiveErrors(int family)
+        {
+            Socket& socket = socketFor(family);
+            unsigned char buffer[ICMP_ENGINE_RECEIVE_SIZE];
+            char control[512];
+
+            while (true)
+            {
+                struct sockaddr_storage destination;
+                struct iovec iov;
+                struct msghdr message;
+
+                iov.iov_base = buffer;
+                iov.iov_len = sizeof(buffer);
+                memset(&message, 0, sizeof(message));
+                message.msg_name = &destination;
+                message.msg_namelen = sizeof(destination);
+                message.msg_iov = &iov;
+                message.msg_iovlen = 1;
+                message.msg_control = control;
+                message.msg_controllen = sizeof(control);
+
+                ssize_t length = recvmsg(socket.fd, &message, MSG_ERRQUEUE);
+                if (length < 0)
+                    break;
+
+                Clock::time_point received = Clock::now();
+                if (length < ICMP_ENGINE_HEADER_SIZE)
+                    continue;
+
+                for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != NULL; cmsg = CMSG_NXTHDR(&message, cmsg))
+                {
+                    bool isError = (family == AF_INET6)
+                        ? (cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)
+                        : (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_RECVERR);
+                    if (!isError)
+                        continue;
+
+                    const struct sock_extended_err* error = (const struct sock_extended_err*)CMSG_DATA(cmsg);
+                    if (error->ee_origin != ((family == AF_INET6) ? SO_EE_ORIGIN_ICMP6 : SO_EE_ORIGIN_ICMP))
+                        continue;
+
+                    MessageType type;
+                    if (error->ee_type == ((family == AF_INET6) ? ICMP6_TIME_EXCEEDED : ICMP_TIME_EXCEEDED))
+                        type = MESSAGE_TIME_EXCEEDED;
+                    else if (error->ee_type == ((family == AF_INET6) ? ICMP6_DST_UNREACH : ICMP_DEST_UNREACH))
+                        type = MESSAGE_UNREACHABLE;
+                    else
+                        continue;
+
+                    struct sockaddr_storage offender;
+                    const struct sockaddr* source = SO_EE_OFFENDER(error);
+                    memset(&offender, 0, sizeof(offender));
+                    memcpy(&offender, source, (family == AF_INET6) ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
+
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    handleMessage(family, type, offender, (uint16_t)((buffer[6] << 8) | buffer[7]), received);
+                }
+            }
+        }
+
+        void IcmpEngine::handleMessage(int family, MessageType type, const struct sockaddr_storage& from, uint16_t sequence, Clock::time_point received)
+        {
+            std::map<uint16_t, std::pair<Session*, size_t> >::iterator entry = m_probes.find(sequence);
+            if (entry == m_probes.end())
+                return;
+
+            Session& session = *entry->second.first;
+            Probe& probe = session.probes[entry->second.second];
+
+            if (session.address.ss_family != family)
+                return;
+
+            bool fromEndpoint = (family == AF_INET6)
+                ? !memcmp(&((const struct sockaddr_in6*)&from)->sin6_addr, &((const struct sockaddr_in6*)&session.address)->sin6_addr, sizeof(struct in6_addr))
+                : ((const struct sockaddr_in*)&from)->sin_addr.s_addr == ((const struct sockaddr_in*)&session.address)->sin_addr.s_addr;
+
+            // A ping only counts echo replies from the endpoint, a trace also the errors of the routers on the way
+            if (type == MESSAGE_ECHO_REPLY ? !fromEndpoint : !session.trace)
+                return;
+
+            char address[INET6_ADDRSTRLEN] = {0};
+            if (family == AF_INET6)
+                inet_ntop(AF_INET6, &((const struct sockaddr_in6*)&from)->sin6_addr, address, sizeof(address));
+            else
+                inet_ntop(AF_INET, &((const struct sockaddr_in*)&from)->sin_addr, address, sizeof(address));
+
+            probe.replied = true;
+            probe.rttMs = std::chrono::duration<double, std::milli>(received - probe.sent).count();
+            probe.responder = address;
+            probe.fromEndpoint = fromEndpoint && type != MESSAGE_TIME_EXCEEDED;
+            resolveProbe(session, probe);
+
+            if (session.trace)
+            {
+                if (probe.fromEndpoint && (session.reachedTtl == 0 || probe.ttl < session.reachedTtl))
+                {
+                    session.reachedTtl = probe.ttl;
+
+                    // The probes beyond the endpoint will not tell anything more
+                    for (size_t i = 0; i < session.probes.size(); i++)
+                    {
+                        Probe& other = session.probes[i];
+                        if (other.ttl > session.reachedTtl && !other.replied && !other.lost)
+                        {
+                            other.lost = true;
+                            resolveProbe(session, other);
+                        }
+                    }
+                }
+
+                collectHops(session);
+            }
+
+            finishIfDone(session);
+        }
+
+        void IcmpEngine::resolveProbe(Session& session, Probe& probe)
+        {
+            session.pending--;
+            m_probes.erase(probe.sequence);
+        }
+
+        void IcmpEngine::finishIfDone(Session& session)
+        {
+            if ((int)session.probes.size() == session.request.packets && session.pending == 0)
+            {
+                complete(session);
+                m_sessions.remove(&session);
+                m_done.notify_all();
+            }
+            else if (!session.readyHops.empty())
+            {
+                m_done.notify_all();
+            }
+        }
+
+        bool IcmpEngine::hopComplete(const Session& session, int ttl)
+        {
+            int queries = session.request.packets / session.maxHops;
+            int resolved = 0;
+
+            for (size_t i = 0; i < session.probes.size(); i++)
+            {
+                const Probe& probe = session.probes[i];
+                if (probe.ttl == ttl && (probe.replied || probe.lost))
+                    resolved++;
+            }
+
+            return resolved == queries;
+        }
+
+        // Moves the hops whose probes are all resolved to readyHops, in TTL order
+        void IcmpEngine::collectHops(Session& session)
+        {
+            int last = (session.reachedTtl > 0) ? session.reachedTtl : session.maxHops;
+
+            while (session.nextHop <= last && hopComplete(session, session.nextHop))
+            {
+                Hop hop;
+                hop.ttl = session.nextHop;
+
+                for (size_t i = 0; i < session.probes.size(); i++)
+                {
+                    const Probe& probe = session.probes[i];
+                    if (probe.ttl != hop.ttl)
+                        continue;
+
+                    hop.rttMs.push_back(probe.replied ? probe.rttMs : -1);
+                    if (probe.replied && hop.address.empty())
+                        hop.address = probe.responder;
+                    if (probe.fromEndpoint)
+                        hop.reached = true;
+                }
+
+                session.hops.push_back(hop);
+                session.readyHops.push_back(hop);
+                session.nextHop++;
+            }
+        }
+
+        void IcmpEngine::complete(Session& session)
+        {
+            Result& result = session.result;
+            double sum = 0;
+            double squares = 0;
+
+            result.transmitted = 0;
+            result.received = 0;
+
+            for (size_t i = 0; i < session.probes.size(); i++)
+            {
+                const Probe& probe = session.probes[i];
+                if (probe.sequence != 0)
+                    result.transmitted++;
+                if (!probe.replied)
+                    continue;
+
+                result.minMs = (result.received == 0) ? probe.rttMs : std::min(result.minMs, probe.rttMs);
+                result.maxMs = (result.received == 0) ? probe.rttMs : std::max(result.maxMs, probe.rttMs);
+                sum += probe.rttMs;
+                squares += probe.rttMs * probe.rttMs;
+                result.received++;
+            }
+
+            if (session.trace)
+            {
+                collectHops(session);
+
+                // Unanswered hops are a normal trace outcome, failing to send is not
+                result.success = result.received > 0 || session.sendError.empty();
+                if (!result.success)
+                    result.error = session.sendError;
+
+                session.done = true;
+                return;
+            }
+
+            if (result.received > 0)
+            {
+                result.avgMs = sum / result.received;
+                result.stddevMs = sqrt(std::max(0.0, squares / result.received - result.avgMs * result.avgMs));
+            }
+
+            result.lossPercent = (result.transmitted > 0) ? 100.0 * (result.transmitted - result.received) / result.transmitted : 100.0;
+            result.success = result.received > 0;
+            if (!result.success)
+                result.error = session.sendError.empty() ? "No reply from endpoint" : session.sendError;
+
+            session.done = true;
+        }
+
+        uint16_t IcmpEngine::nextSequence()
+        {
+            // 0 marks a probe that was not sent, skip it and the numbers still waiting for a reply
+            do
+            {
+                m_sequence++;
+            } while (m_sequence == 0 || m_probes.count(m_sequence));
+
+            return m_sequence;
+        }
+
+        uint16_t IcmpEngine::checksum(const unsigned char* data, size_t length)
+        {
+            uint32_t sum = 0;
+
+            for (size_t i = 0; i + 1 < length; i += 2)
+            {
+                uint16_t word;
+                memcpy(&word, data + i, sizeof(word));
+                sum += word;
+            }
+            if (length & 1)
+                sum += data[length - 1];
+
+            while (sum >> 16)
+                sum = (sum & 0xFFFF) + (sum >> 16);
+
+            return (uint16_t)~sum;
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
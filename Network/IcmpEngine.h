@@ -0,0 +1,234 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stdint.h>
+#include <sys/socket.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define ICMP_ENGINE_DEFAULT_INTERVAL_MS     1000
+#define ICMP_ENGINE_DEFAULT_TIMEOUT_MS      5000
+#define ICMP_ENGINE_PAYLOAD_SIZE            56
+#define ICMP_ENGINE_MAX_PACKETS             100
+#define ICMP_ENGINE_DEFAULT_TTL             64
+
+#define ICMP_ENGINE_TRACE_MAX_HOPS          30
+#define ICMP_ENGINE_TRACE_MAX_QUERIES       10
+#define ICMP_ENGINE_TRACE_ROUND_MS          50      // Between the probe rounds, eases router ICMP rate limits
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        /*
+         * In-process ICMP / ICMPv6 echo engine, for ping and traceroute.
+         *
+         * One socket per address family is shared by all the sessions in progress, a single
+         * thread sends the probes on schedule and waits for the replies with epoll. Replies
+         * and ICMP errors are matched to their probe by sequence number, which is unique
+         * across sessions.
+         *
+         * Unprivileged datagram ICMP sockets are used when net.ipv4.ping_group_range allows
+         * them, raw sockets otherwise (the kernel default range excludes every group).
+         */
+        class IcmpEngine
+        {
+        public:
+            struct Request
+            {
+                Request() : packets(1), intervalMs(ICMP_ENGINE_DEFAULT_INTERVAL_MS), timeoutMs(ICMP_ENGINE_DEFAULT_TIMEOUT_MS) { }
+
+                std::string endpoint;       // IPv4 / IPv6 literal or host name
+                std::string interface;      // Outgoing interface for IPv6, optional
+                int packets;
+                int intervalMs;
+                int timeoutMs;              // Per probe
+            };
+
+            struct Result
+            {
+                Result() : success(false), transmitted(0), received(0), lossPercent(0), minMs(0), avgMs(0), maxMs(0), stddevMs(0) { }
+
+                std::string target;
+                std::string address;        // Address the endpoint resolved to
+                bool success;               // At least one reply
+                std::string error;
+                int transmitted;
+                int received;
+                double lossPercent;
+                double minMs;
+                double avgMs;
+                double maxMs;
+                double stddevMs;
+            };
+
+            // Every TTL is probed at once, 'queries' rounds of probes are sent
+            struct TraceRequest
+            {
+                TraceRequest() : maxHops(6), queries(3), timeoutMs(3000) { }
+
+                std::string endpoint;
+                std::string interface;
+                int maxHops;
+                int queries;
+                int timeoutMs;
+            };
+
+            struct Hop
+            {
+                Hop() : ttl(0), reached(false) { }
+
+                int ttl;
+                std::string address;        // First responder, empty when none answered
+                std::vector<double> rttMs;  // One per query, negative when unanswered
+                bool reached;               // Answered by the endpoint itself
+            };
+
+            struct TraceResult
+            {
+                TraceResult() : success(false), reached(false) { }
+
+                std::string target;
+                std::string address;
+                bool success;               // The trace ran, whether or not the endpoint was reached
+                std::string error;
+                bool reached;
+                std::vector<Hop> hops;      // Up to the endpoint, or to maxHops
+            };
+
+            // Called in the thread of trace(), in TTL order, as soon as every probe of the hop has been answered or has timed out
+            typedef std::function<void(const Hop& hop)> HopCallback;
+
+            IcmpEngine();
+            ~IcmpEngine();
+
+            bool start();
+            void stop();
+
+            // Blocking, the pings of one call run concurrently
+            Result ping(const Request& request);
+            std::vector<Result> ping(const std::vector<Request>& requests);
+
+            // Blocking, lasts as long as the slowest hop rather than the sum of the hops
+            TraceResult trace(const TraceRequest& request, const HopCallback& onHop = HopCallback());
+
+        private:
+            typedef std::chrono::steady_clock Clock;
+
+            enum MessageType
+            {
+                MESSAGE_ECHO_REPLY,
+                MESSAGE_TIME_EXCEEDED,
+                MESSAGE_UNREACHABLE
+            };
+
+            struct Probe
+            {
+                Clock::time_point sent;
+                uint16_t sequence;
+                int ttl;
+                bool replied;
+                bool lost;
+                double rttMs;
+                std::string responder;
+                bool fromEndpoint;
+            };
+
+            struct Session
+            {
+                Request request;            // For a trace, packets is maxHops * queries
+                Result result;
+                struct sockaddr_storage address;
+                socklen_t addressLength;
+                unsigned interfaceIndex;
+                std::vector<Probe> probes;
+                int pending;
+                Clock::time_point nextSend;
+                std::string sendError;
+                bool done;
+
+                // Traceroute only
+                bool trace;
+                int maxHops;
+                int reachedTtl;             // Lowest TTL answered by the endpoint, 0 until then
+                int nextHop;
+                std::vector<Hop> hops;
+                std::deque<Hop> readyHops;  // Completed, not passed to the callback yet
+            };
+
+            struct Socket
+            {
+                Socket() : fd(-1), raw(false), ttl(0) { }
+
+                int fd;
+                bool raw;
+                int ttl;                    // Last one set on the socket
+            };
+
+            IcmpEngine(const IcmpEngine&) = delete;
+            IcmpEngine& operator=(const IcmpEngine&) = delete;
+
+            static bool openSocket(int family, Socket& socket);
+            static bool resolve(Session& session);
+            static void initSession(Session& session);
+            static uint16_t checksum(const unsigned char* data, size_t length);
+            static bool hopComplete(const Session& session, int ttl);
+            static void collectHops(Session& session);
+            static void complete(Session& session);
+
+            bool submit(std::vector<Session*>& sessions);
+            void run();
+            int service(Clock::time_point now);
+            void sendProbe(Session& session, int ttl, Clock::time_point now);
+            void setTtl(int family, int ttl);
+            void receive(int family);
+            void receiveErrors(int family);
+            void handleMessage(int family, MessageType type, const struct sockaddr_storage& from, uint16_t sequence, Clock::time_point received);
+            void resolveProbe(Session& session, Probe& probe);
+            void finishIfDone(Session& session);
+            uint16_t nextSequence();
+            Socket& socketFor(int family) { return (family == AF_INET6) ? m_socket6 : m_socket4; }
+
+            std::mutex m_mutex;
+            std::condition_variable m_done;
+            std::list<Session*> m_sessions;
+            std::map<uint16_t, std::pair<Session*, size_t> > m_probes;   // sequence -> session, probe index
+
+            Socket m_socket4;
+            Socket m_socket6;
+            int m_epoll;
+            int m_wakeup;
+            std::thread m_thread;
+            bool m_running;
+            uint16_t m_identifier;
+            uint16_t m_sequence;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -24,15 +24,11 @@
 //Defines
 
 #define NETUTIL_DEVICE_PROPERTIES_FILE          "/etc/device.properties"
-#define COMMAND_RESULT_FILE "cmdresult"
 
 
 namespace WPEFramework {
     namespace Plugin {
 
-        unsigned int NetUtils::m_counter = 0;
-        std::mutex NetUtils::m_counterProtect;
-
         /*
          *
          */
@@ -76,88 +72,17 @@ namespace WPEFramework {
         }
 
         /*
-         * Returns >= 0 on success
-         * Blocking process so run in background thread
-         *
-         * If 'result' is not NULL then it will be set to the return status of the command
-         *
-         * If 'outputfile' is not NULL then it should contain a name for the outpur file. The output of the command will
-         *     be dumped to '/tmp/[outputfile]x' where x is a unique number.
-         *     The filepath will be returned in 'output' and the file should be deleted by the calling process after use.
+         * Reverse of getInterfaceDescription, e.g. "wlan0" for "WIFI"
+         * Anything which is not a known description is assumed to be an interface name already
          */
-        int NetUtils::execCmd(const char *command, std::string &output, bool *result, const char *outputfile)
+        std::string NetUtils::getInterfaceName(const std::string& description)
         {
-            std::string commandString;
-            std::string resultFile;
-            char buffer[MAX_OUTPUT_LENGTH];
-            FILE *pipe = NULL;
-            size_t length = 0;
-
-            output.clear();
-
-            commandString.assign(command);
-
-            // If we have an output file then pipe the output from the command to /tmp/outpufile
-            if (outputfile)
-            {
-                getTmpFilename(outputfile, output); //append a count to get a unique filename and return the filename in output
-                commandString += " > ";
-                commandString += output;
-            }
-
-            // If we have requested a result, store the result of the command in /tmp/cmdresult
-            if (result)
-            {
-                getTmpFilename(COMMAND_RESULT_FILE, resultFile); //append a count to get a unique filename
-                commandString += "; echo $? > ";
-                commandString += resultFile;
-            }
-
-            pipe = popen(commandString.c_str(), "r");
-            if (pipe == NULL)
-            {
-                LOGERR("%s: failed to open file '%s' for read mode with result: %s", __FUNCTION__,
-                        commandString.c_str(), strerror(errno));
-                return -1;
-            }
-
-            LOGWARN("%s: opened file '%s' for read mode", __FUNCTION__,
-                    commandString.c_str());
-
-            while (!feof(pipe) && fgets(buffer, MAX_OUTPUT_LENGTH, pipe) != NULL)
-            {
-                // If we are not dumping it to file, store the output
-                if (!outputfile)
-                {
-                    output += buffer;
-                }
-            }
-
-            // Strip trailing line feed from the output
-            if ((length = output.length()) > 0)
+            for (const auto& e : interface_descriptions)
             {
-                if (output[length-1] == '\n')
-                {
-                    output.erase(length-1);
-                }
+                if (e.second == description)
+                    return e.first;
             }
-
-            // If we have requested a result, query the contents of the result file
-            if (result)
-            {
-                std::string commandResult = "1";
-                if (!getFile(resultFile.c_str(), commandResult, true)) //delete file after reading
-                {
-                    LOGERR("%s: failed to get command result '%s'", __FUNCTION__,resultFile.c_str());
-                }
-                else
-                {
-                    *result =  (commandResult == "0");
-                    LOGINFO("%s: command result '%s'", __FUNCTION__,((*result)?"true":"false"));
-                }
-            }
-
-            return pclose(pipe);
+            return description;
         }
 
         /*
@@ -233,14 +158,6 @@ namespace WPEFramework {
             return false;
         }
 
-        void NetUtils::getTmpFilename(const char *in, std::string &out)
-        {
-            std::lock_guard<std::mutex> lock(m_counterProtect);
-            out = "/tmp/";
-            out += in;
-            out += std::to_string(m_counter++);
-        }
-
         bool NetUtils::isIPV6LinkLocal(const std::string& address)
         {
             struct sockaddr_in6 sa6;
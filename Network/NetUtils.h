@@ -30,7 +30,6 @@
 
 namespace WPEFramework {
     #define MAX_COMMAND_LENGTH      256
-    #define MAX_OUTPUT_LENGTH       128
 
     namespace Plugin {
         class Network;
@@ -45,24 +44,21 @@ namespace WPEFramework {
 
             void InitialiseNetUtils();
             const std::string& getInterfaceDescription(const std::string name);
+            std::string getInterfaceName(const std::string& description);
 
             static bool isIPV4(const std::string &address);
             static bool isIPV6(const std::string &address);
             static bool isIPV6LinkLocal(const std::string &address);
             static bool isIPV4LinkLocal(const std::string &address);
-            static int execCmd(const char *command, std::string &output, bool *result = NULL, const char *outputfile = NULL);
             static bool getFile(const char *filepath, std::string &contents, bool deleteFile = false);
 
             static bool envGetValue(const char *key, std::string &value);
 
-            static void getTmpFilename(const char *in, std::string &out);
             static bool isValidEndpointURL(const std::string& endpoint);
 
         private:
             static bool _isCharacterIllegal(const int& c);
 
-            static unsigned int     m_counter;
-            static std::mutex       m_counterProtect;
             std::map<std::string, std::string> interface_descriptions;
         };
     } // namespace Plugin
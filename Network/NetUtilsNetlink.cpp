@@ -18,11 +18,17 @@
 **/
 
 #include "NetUtilsNetlink.h"
+#include <arpa/inet.h>
 #include <fcntl.h>
 #include <linux/rtnetlink.h>
 #include <net/if.h>
+#include <poll.h>
 #include <string.h>
+#include <sys/eventfd.h>
 #include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
 
 namespace WPEFramework {
     namespace Plugin {
@@ -373,5 +379,714 @@ namespace WPEFramework {
             return index > 0;
         }
 
+        /*
+         * NetlinkSnapshot
+         */
+
+        const NetlinkInterface* NetlinkSnapshot::find(unsigned index) const
+        {
+            auto it = interfaces.find(index);
+            return (it != interfaces.end()) ? &it->second : NULL;
+        }
+
+        const NetlinkInterface* NetlinkSnapshot::find(const std::string &name) const
+        {
+            for (const auto &entry : interfaces)
+            {
+                if (entry.second.name == name)
+                {
+                    return &entry.second;
+                }
+            }
+            return NULL;
+        }
+
+        bool NetlinkSnapshot::getDefaultRoute(int family, NetlinkRoute &route) const
+        {
+            // defaultRoutes is kept sorted, IPv4 first then by metric
+            for (const NetlinkRoute &candidate : defaultRoutes)
+            {
+                if ((family == AF_UNSPEC) || (candidate.family == family))
+                {
+                    route = candidate;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::string NetlinkSnapshot::getDefaultInterface(int family) const
+        {
+            NetlinkRoute route;
+            const NetlinkInterface *interface = NULL;
+
+            if (getDefaultRoute(family, route) && ((interface = find(route.index)) != NULL))
+            {
+                return interface->name;
+            }
+            return "";
+        }
+
+        bool NetlinkAddress::assigned() const
+        {
+            return (flags & (IFA_F_TENTATIVE | IFA_F_DADFAILED)) == 0;
+        }
+
+        bool NetlinkSnapshot::getAddress(const std::string &interface, int family, NetlinkAddress &address) const
+        {
+            const NetlinkInterface *entry = find(interface);
+            if (entry == NULL)
+            {
+                return false;
+            }
+
+            for (const NetlinkAddress &candidate : entry->addresses)
+            {
+                if ((candidate.family != family) || (candidate.scope != RT_SCOPE_UNIVERSE) ||
+                    !candidate.assigned() || (candidate.flags & IFA_F_DEPRECATED))
+                {
+                    continue;
+                }
+                address = candidate;
+                return true;
+            }
+            return false;
+        }
+
+        /*
+         * NetlinkMonitor
+         */
+
+        NetlinkMonitor::NetlinkMonitor() :
+            m_fdNetlink(-1),
+            m_fdWakeup(-1),
+            m_sequence(0),
+            m_dumpInterrupted(false),
+            m_buffer(NETLINK_MONITOR_MESSAGE_SIZE)
+        {
+        }
+
+        NetlinkMonitor::~NetlinkMonitor()
+        {
+            stop();
+        }
+
+        bool NetlinkMonitor::start(const EventHandler &handler)
+        {
+            struct sockaddr_nl address;
+            int bufferSize = NETLINK_MONITOR_SOCKET_BUFFER;
+
+            if (m_fdNetlink != -1)
+            {
+                return true;
+            }
+
+            m_fdNetlink = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+            if (m_fdNetlink == -1)
+            {
+                LOGERR("Failed to create Netlink socket: %s", strerror(errno));
+                return false;
+            }
+
+            if (setsockopt(m_fdNetlink, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize)) < 0)
+            {
+                LOGWARN("Failed to set the Netlink receive buffer size: %s", strerror(errno));
+            }
+
+            // nl_pid 0 lets the kernel pick a port id, the Netlink helper uses the thread id for its own
+            memset(&address, 0, sizeof(address));
+            address.nl_family = AF_NETLINK;
+            address.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR | RTMGRP_IPV4_ROUTE | RTMGRP_IPV6_ROUTE;
+
+            if ((bind(m_fdNetlink, (struct sockaddr *)&address, sizeof(address)) < 0) ||
+                ((m_fdWakeup = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) == -1))
+            {
+                LOGERR("Failed to set up the Netlink monitor: %s", strerror(errno));
+                stop();
+                return false;
+            }
+
+            if (!_synchronise())
+            {
+                LOGERR("Failed to read the initial network state from Netlink");
+                stop();
+                return false;
+            }
+
+            m_handler = handler;
+            _publish();
+
+            m_thread = std::thread(&NetlinkMonitor::_run, this);
+            return true;
+        }
+
+        void NetlinkMonitor::stop()
+        {
+            if (m_thread.joinable())
+            {
+                uint64_t value = 1;
+                if (write(m_fdWakeup, &value, sizeof(value)) != sizeof(value))
+                {
+                    LOGWARN("Failed to wake up the Netlink monitor: %s", strerror(errno));
+                }
+                m_thread.join();
+            }
+
+            if (m_fdWakeup != -1)
+            {
+                close(m_fdWakeup);
+                m_fdWakeup = -1;
+            }
+            if (m_fdNetlink != -1)
+            {
+                close(m_fdNetlink);
+                m_fdNetlink = -1;
+            }
+
+            std::atomic_store(&m_snapshot, NetlinkSnapshotPtr());
+            m_handler = EventHandler();
+            m_state = NetlinkSnapshot();
+        }
+
+        void NetlinkMonitor::_run()
+        {
+            struct pollfd fds[2];
+
+            fds[0].fd = m_fdNetlink;
+            fds[0].events = POLLIN;
+            fds[1].fd = m_fdWakeup;
+            fds[1].events = POLLIN;
+
+            while (true)
+            {
+                if (poll(fds, 2, -1) < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    LOGERR("Netlink monitor poll failed: %s", strerror(errno));
+                    break;
+                }
+
+                if (fds[1].revents)
+                {
+                    break;
+                }
+                if (fds[0].revents)
+                {
+                    _receive();
+                }
+            }
+        }
+
+        /*
+         * Read every message queued on the socket, then publish a single snapshot for all of them
+         */
+        void NetlinkMonitor::_receive()
+        {
+            bool changed = false;
+
+            while (true)
+            {
+                bool done = false;
+                int length = recv(m_fdNetlink, &m_buffer[0], m_buffer.size(), MSG_DONTWAIT);
+
+                if (length < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    if (errno == ENOBUFS)
+                    {
+                        // Events were dropped, the state can only be trusted again after a full dump
+                        LOGWARN("Netlink monitor overrun, resynchronising");
+                        if (_synchronise())
+                        {
+                            changed = true;
+                            continue;
+                        }
+                        LOGERR("Failed to resynchronise the network state from Netlink");
+                    }
+                    else if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+                    {
+                        LOGERR("Failed to read from the Netlink socket: %s", strerror(errno));
+                    }
+                    break;
+                }
+
+                _process(&m_buffer[0], length, 0, done, changed);
+            }
+
+            if (changed)
+            {
+                _publish();
+            }
+        }
+
+        /*
+         * Rebuild the working state from dumps of the links, then the addresses, then the routes
+         */
+        bool NetlinkMonitor::_synchronise()
+        {
+            uint64_t generation = m_state.generation;
+
+            for (int attempt = 0; attempt < NETLINK_MONITOR_DUMP_RETRIES; attempt++)
+            {
+                m_state = NetlinkSnapshot();
+                m_state.generation = generation;
+                m_dumpInterrupted = false;
+
+                if (_dump(RTM_GETLINK) && _dump(RTM_GETADDR) && _dump(RTM_GETROUTE) && !m_dumpInterrupted)
+                {
+                    return true;
+                }
+                LOGWARN("Netlink dump failed or was interrupted (attempt %d)", attempt + 1);
+            }
+            return false;
+        }
+
+        bool NetlinkMonitor::_dump(int type)
+        {
+            struct {
+                struct nlmsghdr header;
+                union {
+                    struct ifinfomsg link;
+                    struct ifaddrmsg address;
+                    struct rtmsg route;
+                } body;
+            } request;
+            size_t bodyLength = (type == RTM_GETLINK) ? sizeof(struct ifinfomsg) :
+                                (type == RTM_GETADDR) ? sizeof(struct ifaddrmsg) : sizeof(struct rtmsg);
+            bool done = false;
+            bool changed = false;
+
+            memset(&request, 0, sizeof(request));
+            request.header.nlmsg_len = NLMSG_LENGTH(bodyLength);
+            request.header.nlmsg_type = type;
+            request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+            request.header.nlmsg_seq = ++m_sequence;
+
+            if (send(m_fdNetlink, &request, request.header.nlmsg_len, 0) < 0)
+            {
+                LOGERR("Failed to send Netlink dump request: %s", strerror(errno));
+                return false;
+            }
+
+            while (!done)
+            {
+                struct pollfd fd;
+                int length;
+
+                fd.fd = m_fdNetlink;
+                fd.events = POLLIN;
+                if (poll(&fd, 1, NETLINK_MESSAGE_TIMEOUT_MS) <= 0)
+                {
+                    LOGERR("No reply to Netlink dump request %d", type);
+                    return false;
+                }
+
+                length = recv(m_fdNetlink, &m_buffer[0], m_buffer.size(), MSG_DONTWAIT);
+                if (length < 0)
+                {
+                    if ((errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK))
+                    {
+                        continue;
+                    }
+                    LOGERR("Failed to read Netlink dump: %s", strerror(errno));
+                    return false;
+                }
+
+                // Events received meanwhile are applied as well, they are at least as recent as the dump
+                if (!_process(&m_buffer[0], length, request.header.nlmsg_seq, done, changed))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /*
+         * Apply the messages of a buffer to the working state.
+         * 'done' is set at the end of the dump 'sequence' (0 when not dumping).
+         */
+        bool NetlinkMonitor::_process(const char *buffer, int length, uint32_t sequence, bool &done, bool &changed)
+        {
+            for (const struct nlmsghdr *message = (const struct nlmsghdr *)buffer;
+                 NLMSG_OK(message, length);
+                 message = NLMSG_NEXT(message, length))
+            {
+                bool reply = (sequence != 0) && (message->nlmsg_seq == sequence);
+
+                if (reply && (message->nlmsg_flags & NLM_F_DUMP_INTR))
+                {
+                    m_dumpInterrupted = true;
+                }
+
+                switch (message->nlmsg_type)
+                {
+                    case NLMSG_DONE:
+                        if (reply)
+                        {
+                            done = true;
+                        }
+                        break;
+                    case NLMSG_ERROR:
+                        if (reply)
+                        {
+                            const struct nlmsgerr *error = (const struct nlmsgerr *)NLMSG_DATA(message);
+                            LOGERR("Netlink dump failed: %s", strerror(-error->error));
+                            return false;
+                        }
+                        break;
+                    case RTM_NEWLINK:
+                    case RTM_DELLINK:
+                        changed |= _onLink(message);
+                        break;
+                    case RTM_NEWADDR:
+                    case RTM_DELADDR:
+                        changed |= _onAddress(message);
+                        break;
+                    case RTM_NEWROUTE:
+                    case RTM_DELROUTE:
+                        changed |= _onRoute(message);
+                        break;
+                    default:
+                        break;
+                }
+            }
+            return true;
+        }
+
+        bool NetlinkMonitor::_onLink(const struct nlmsghdr *message)
+        {
+            const struct ifinfomsg *info = (const struct ifinfomsg *)NLMSG_DATA(message);
+            int attrLength = message->nlmsg_len - NLMSG_LENGTH(sizeof(struct ifinfomsg));
+            NetlinkInterface updated;
+
+            // Bridge port notifications share the link group, they do not describe the interface itself
+            if ((attrLength < 0) || (info->ifi_family == AF_BRIDGE))
+            {
+                return false;
+            }
+
+            if (message->nlmsg_type == RTM_DELLINK)
+            {
+                size_t routes = m_state.defaultRoutes.size();
+                m_state.defaultRoutes.erase(std::remove_if(m_state.defaultRoutes.begin(), m_state.defaultRoutes.end(),
+                    [info](const NetlinkRoute &route) { return route.index == (unsigned)info->ifi_index; }), m_state.defaultRoutes.end());
+                return (m_state.interfaces.erase(info->ifi_index) > 0) || (routes != m_state.defaultRoutes.size());
+            }
+
+            auto it = m_state.interfaces.find(info->ifi_index);
+            if (it != m_state.interfaces.end())
+            {
+                updated = it->second;
+            }
+            updated.index = info->ifi_index;
+            updated.type = info->ifi_type;
+            updated.flags = info->ifi_flags;
+
+            for (const struct rtattr *attribute = IFLA_RTA(info);
+                 RTA_OK(attribute, attrLength);
+                 attribute = RTA_NEXT(attribute, attrLength))
+            {
+                if (attribute->rta_type == IFLA_IFNAME)
+                {
+                    updated.name = (const char *)RTA_DATA(attribute);
+                }
+                else if (attribute->rta_type == IFLA_ADDRESS)
+                {
+                    const unsigned char *bytes = (const unsigned char *)RTA_DATA(attribute);
+                    char mac[4];
+                    updated.macAddress.clear();
+                    for (size_t i = 0; i < RTA_PAYLOAD(attribute); i++)
+                    {
+                        snprintf(mac, sizeof(mac), i ? ":%02x" : "%02x", bytes[i]);
+                        updated.macAddress += mac;
+                    }
+                }
+            }
+
+            if ((it != m_state.interfaces.end()) && (it->second.name == updated.name) &&
+                (it->second.macAddress == updated.macAddress) && (it->second.type == updated.type) &&
+                (it->second.flags == updated.flags))
+            {
+                // Wireless events and statistics updates come as new link messages too
+                return false;
+            }
+
+            m_state.interfaces[updated.index] = updated;
+            return true;
+        }
+
+        bool NetlinkMonitor::_onAddress(const struct nlmsghdr *message)
+        {
+            const struct ifaddrmsg *info = (const struct ifaddrmsg *)NLMSG_DATA(message);
+            int attrLength = message->nlmsg_len - NLMSG_LENGTH(sizeof(struct ifaddrmsg));
+            const void *local = NULL;
+            const void *remote = NULL;
+            char ipAddress[INET6_ADDRSTRLEN];
+            NetlinkAddress address;
+
+            if ((attrLength < 0) || ((info->ifa_family != AF_INET) && (info->ifa_family != AF_INET6)))
+            {
+                return false;
+            }
+
+            auto it = m_state.interfaces.find(info->ifa_index);
+            if (it == m_state.interfaces.end())
+            {
+                return false;
+            }
+
+            address.family = info->ifa_family;
+            address.prefixLength = info->ifa_prefixlen;
+            address.scope = info->ifa_scope;
+            address.flags = info->ifa_flags;
+
+            for (const struct rtattr *attribute = IFA_RTA(info);
+                 RTA_OK(attribute, attrLength);
+                 attribute = RTA_NEXT(attribute, attrLength))
+            {
+                if (attribute->rta_type == IFA_LOCAL)
+                {
+                    local = RTA_DATA(attribute);
+                }
+                else if (attribute->rta_type == IFA_ADDRESS)
+                {
+                    remote = RTA_DATA(attribute);
+                }
+                else if (attribute->rta_type == IFA_FLAGS)
+                {
+                    address.flags = *(const uint32_t *)RTA_DATA(attribute);
+                }
+            }
+
+            // On point to point links IFA_ADDRESS is the peer, IFA_LOCAL is ours
+            if (((local == NULL) && (remote == NULL)) ||
+                (inet_ntop(info->ifa_family, local ? local : remote, ipAddress, INET6_ADDRSTRLEN) == NULL))
+            {
+                return false;
+            }
+            address.address = ipAddress;
+
+            std::vector<NetlinkAddress> &addresses = it->second.addresses;
+            auto existing = std::find_if(addresses.begin(), addresses.end(),
+                [&address](const NetlinkAddress &entry) { return (entry.family == address.family) && (entry.address == address.address); });
+
+            if (message->nlmsg_type == RTM_DELADDR)
+            {
+                if (existing == addresses.end())
+                {
+                    return false;
+                }
+                addresses.erase(existing);
+            }
+            else if (existing == addresses.end())
+            {
+                addresses.push_back(address);
+            }
+            else if ((existing->prefixLength != address.prefixLength) || (existing->scope != address.scope) || (existing->flags != address.flags))
+            {
+                // e.g. an IPv6 address leaving the tentative state once duplicate address detection completes
+                *existing = address;
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        }
+
+        bool NetlinkMonitor::_onRoute(const struct nlmsghdr *message)
+        {
+            const struct rtmsg *info = (const struct rtmsg *)NLMSG_DATA(message);
+            int attrLength = message->nlmsg_len - NLMSG_LENGTH(sizeof(struct rtmsg));
+            unsigned table;
+            char ipAddress[INET6_ADDRSTRLEN];
+            NetlinkRoute route;
+
+            // Only the default routes of the main table matter, a default route has no destination
+            if ((attrLength < 0) || ((info->rtm_family != AF_INET) && (info->rtm_family != AF_INET6)) ||
+                (info->rtm_dst_len != 0) || (info->rtm_type != RTN_UNICAST))
+            {
+                return false;
+            }
+
+            table = info->rtm_table;
+            route.family = info->rtm_family;
+            route.index = 0;
+            route.metric = 0;
+
+            for (const struct rtattr *attribute = RTM_RTA(info);
+                 RTA_OK(attribute, attrLength);
+                 attribute = RTA_NEXT(attribute, attrLength))
+            {
+                if (attribute->rta_type == RTA_TABLE)
+                {
+                    table = *(const uint32_t *)RTA_DATA(attribute);
+                }
+                else if (attribute->rta_type == RTA_OIF)
+                {
+                    route.index = *(const uint32_t *)RTA_DATA(attribute);
+                }
+                else if (attribute->rta_type == RTA_PRIORITY)
+                {
+                    route.metric = *(const uint32_t *)RTA_DATA(attribute);
+                }
+                else if (attribute->rta_type == RTA_GATEWAY)
+                {
+                    if (inet_ntop(info->rtm_family, RTA_DATA(attribute), ipAddress, INET6_ADDRSTRLEN) != NULL)
+                    {
+                        route.gateway = ipAddress;
+                    }
+                }
+            }
+
+            if ((table != RT_TABLE_MAIN) || (route.index == 0))
+            {
+                return false;
+            }
+
+            std::vector<NetlinkRoute> &routes = m_state.defaultRoutes;
+            auto existing = std::find_if(routes.begin(), routes.end(), [&route](const NetlinkRoute &entry) {
+                return (entry.family == route.family) && (entry.index == route.index) &&
+                       (entry.metric == route.metric) && (entry.gateway == route.gateway);
+            });
+
+            if (message->nlmsg_type == RTM_DELROUTE)
+            {
+                if (existing == routes.end())
+                {
+                    return false;
+                }
+                routes.erase(existing);
+                return true;
+            }
+
+            if (existing != routes.end())
+            {
+                return false;
+            }
+
+            // Keep the order getDefaultRoute() relies on
+            auto position = std::find_if(routes.begin(), routes.end(), [&route](const NetlinkRoute &entry) {
+                return (route.family == AF_INET && entry.family == AF_INET6) ||
+                       (route.family == entry.family && route.metric < entry.metric);
+            });
+            routes.insert(position, route);
+            return true;
+        }
+
+        void NetlinkMonitor::_publish()
+        {
+            NetlinkSnapshotPtr before = std::atomic_load(&m_snapshot);
+            std::vector<NetlinkEvent> events;
+
+            m_state.generation++;
+            std::atomic_store(&m_snapshot, NetlinkSnapshotPtr(new NetlinkSnapshot(m_state)));
+
+            if (before && m_handler)
+            {
+                _compare(*before, m_state, events);
+                for (const NetlinkEvent &event : events)
+                {
+                    m_handler(event);
+                }
+            }
+        }
+
+        /*
+         * Changes of the enabled (IFF_UP) and connected (IFF_RUNNING) flags, of the addresses and of the
+         * default interface. Interfaces are matched by name, an interface which appears or disappears
+         * reports every flag and address it has.
+         */
+        void NetlinkMonitor::_compare(const NetlinkSnapshot &before, const NetlinkSnapshot &after, std::vector<NetlinkEvent> &events)
+        {
+            static const NetlinkInterface none = NetlinkInterface();
+            std::map<std::string, std::pair<const NetlinkInterface*, const NetlinkInterface*> > interfaces;
+
+            for (const auto &entry : before.interfaces)
+            {
+                interfaces[entry.second.name].first = &entry.second;
+            }
+            for (const auto &entry : after.interfaces)
+            {
+                interfaces[entry.second.name].second = &entry.second;
+            }
+
+            for (const auto &entry : interfaces)
+            {
+                const NetlinkInterface &previous = entry.second.first ? *entry.second.first : none;
+                const NetlinkInterface &current = entry.second.second ? *entry.second.second : none;
+                unsigned changed = previous.flags ^ current.flags;
+                NetlinkEvent event;
+
+                if (entry.first.empty())
+                {
+                    continue;
+                }
+                event.interface = entry.first;
+                event.linkType = entry.second.second ? current.type : previous.type;
+                event.family = AF_UNSPEC;
+
+                if (changed & IFF_UP)
+                {
+                    event.type = NetlinkEvent::INTERFACE_ENABLED_STATUS;
+                    event.status = (current.flags & IFF_UP) != 0;
+                    events.push_back(event);
+                }
+                if (changed & IFF_RUNNING)
+                {
+                    event.type = NetlinkEvent::INTERFACE_CONNECTION_STATUS;
+                    event.status = (current.flags & IFF_RUNNING) != 0;
+                    events.push_back(event);
+                }
+
+                // An address is only acquired once it is assigned, and lost when it is no longer
+                event.type = NetlinkEvent::INTERFACE_IPADDRESS;
+                for (const NetlinkAddress &address : previous.addresses)
+                {
+                    if (address.assigned() &&
+                        std::none_of(current.addresses.begin(), current.addresses.end(), [&address](const NetlinkAddress &other) {
+                            return (other.family == address.family) && (other.address == address.address) && other.assigned(); }))
+                    {
+                        event.status = false;
+                        event.family = address.family;
+                        event.address = address.address;
+                        events.push_back(event);
+                    }
+                }
+                for (const NetlinkAddress &address : current.addresses)
+                {
+                    if (address.assigned() &&
+                        std::none_of(previous.addresses.begin(), previous.addresses.end(), [&address](const NetlinkAddress &other) {
+                            return (other.family == address.family) && (other.address == address.address) && other.assigned(); }))
+                    {
+                        event.status = true;
+                        event.family = address.family;
+                        event.address = address.address;
+                        events.push_back(event);
+                    }
+                }
+            }
+
+            std::string oldInterface = before.getDefaultInterface();
+            std::string newInterface = after.getDefaultInterface();
+            if (oldInterface != newInterface)
+            {
+                NetlinkEvent event;
+                event.type = NetlinkEvent::DEFAULT_INTERFACE;
+                event.interface = newInterface;
+                event.linkType = 0;
+                event.oldInterface = oldInterface;
+                event.status = !newInterface.empty();
+                event.family = AF_UNSPEC;
+                events.push_back(event);
+            }
+        }
+
     } // namespace Plugin
 } // namespace WPEFramework
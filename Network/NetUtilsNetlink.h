@@ -19,15 +19,26 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+
+#include <functional>
+#include <map>
+#include <memory>
 #include <string>
 #include <thread>
 #include <mutex>
+#include <vector>
 #include "utils.h"
 
 namespace WPEFramework {
     namespace Plugin {
         #define NETLINK_MESSAGE_BUFFER_SIZE     8192
         #define NETLINK_MESSAGE_TIMEOUT_MS      500
+        #define NETLINK_MONITOR_MESSAGE_SIZE    32768           // Dumps are sent in messages up to 32K
+        #define NETLINK_MONITOR_SOCKET_BUFFER   (256 * 1024)    // Absorbs bursts of events, e.g. an interface going down
+        #define NETLINK_MONITOR_DUMP_RETRIES    3
 
         typedef std::vector<std::string> stringList;
         typedef std::vector<unsigned> indexList;
@@ -60,5 +71,132 @@ namespace WPEFramework {
                 bool _getRoutesInformation(indexList &defaultInterfaceIndex, stringList &gatewayAddress);
                 bool _parseRoute(void *msg, unsigned &index, std::string &destination, std::string &gateway);
         };
+
+        struct NetlinkAddress
+        {
+            int family;
+            std::string address;
+            unsigned prefixLength;
+            unsigned char scope;            // RT_SCOPE_*
+            unsigned flags;                 // IFA_F_*
+
+            // False while duplicate address detection runs on an IPv6 address, or once it failed
+            bool assigned() const;
+        };
+
+        struct NetlinkInterface
+        {
+            unsigned index;
+            std::string name;
+            std::string macAddress;
+            unsigned short type;            // ARPHRD_*
+            unsigned flags;                 // IFF_*
+            std::vector<NetlinkAddress> addresses;
+        };
+
+        struct NetlinkRoute
+        {
+            int family;
+            unsigned index;
+            std::string gateway;
+            unsigned metric;
+        };
+
+        /*
+         * The interfaces, their addresses and the default routes of the main table at one point in time.
+         * A snapshot is never modified once published, every change publishes a new one.
+         */
+        struct NetlinkSnapshot
+        {
+            NetlinkSnapshot() : generation(0) { }
+
+            const NetlinkInterface* find(unsigned index) const;
+            const NetlinkInterface* find(const std::string &name) const;
+
+            // Lowest metric first, AF_UNSPEC prefers an IPv4 route to an IPv6 one
+            bool getDefaultRoute(int family, NetlinkRoute &route) const;
+            std::string getDefaultInterface(int family = AF_UNSPEC) const;
+
+            // First global address of the family, tentative and deprecated IPv6 addresses are skipped
+            bool getAddress(const std::string &interface, int family, NetlinkAddress &address) const;
+
+            uint64_t generation;            // Incremented by every change
+            std::map<unsigned, NetlinkInterface> interfaces;
+            std::vector<NetlinkRoute> defaultRoutes;
+        };
+
+        typedef std::shared_ptr<const NetlinkSnapshot> NetlinkSnapshotPtr;
+
+        /*
+         * A change between two snapshots, in the terms of the Network plugin notifications
+         */
+        struct NetlinkEvent
+        {
+            enum Type
+            {
+                INTERFACE_ENABLED_STATUS,
+                INTERFACE_CONNECTION_STATUS,
+                INTERFACE_IPADDRESS,
+                DEFAULT_INTERFACE
+            };
+
+            Type type;
+            std::string interface;          // New interface for DEFAULT_INTERFACE
+            unsigned short linkType;        // ARPHRD_* of the interface
+            std::string oldInterface;       // DEFAULT_INTERFACE only
+            bool status;                    // Enabled, connected or acquired
+            int family;                     // INTERFACE_IPADDRESS only
+            std::string address;            // INTERFACE_IPADDRESS only
+        };
+
+        /*
+         * Keeps a snapshot of the network state up to date from the rtnetlink multicast groups
+         * (links, IPv4 / IPv6 addresses and routes), so it can be queried without asking netsrvmgr.
+         *
+         * A dedicated thread owns the netlink socket and the working copy of the state. When a batch of
+         * messages changes something, it publishes a new snapshot and reports the differences to the
+         * event handler, from the same thread. A receive buffer overrun resynchronises with full dumps.
+         */
+        class NetlinkMonitor
+        {
+            public:
+                typedef std::function<void(const NetlinkEvent &event)> EventHandler;
+
+                NetlinkMonitor();
+                ~NetlinkMonitor();
+
+                // Dumps the current state before returning, the first snapshot is complete
+                bool start(const EventHandler &handler);
+                void stop();
+
+                // Readers only take a reference, they never wait for the monitor thread. Null when not running.
+                NetlinkSnapshotPtr snapshot() const { return std::atomic_load(&m_snapshot); }
+
+            private:
+                NetlinkMonitor(const NetlinkMonitor&) = delete;
+                NetlinkMonitor& operator=(const NetlinkMonitor&) = delete;
+
+                void _run();
+                void _receive();
+                bool _synchronise();
+                bool _dump(int type);
+                bool _process(const char *buffer, int length, uint32_t sequence, bool &done, bool &changed);
+                bool _onLink(const struct nlmsghdr *message);
+                bool _onAddress(const struct nlmsghdr *message);
+                bool _onRoute(const struct nlmsghdr *message);
+                void _publish();
+
+                static void _compare(const NetlinkSnapshot &before, const NetlinkSnapshot &after, std::vector<NetlinkEvent> &events);
+
+                int                 m_fdNetlink;
+                int                 m_fdWakeup;
+                uint32_t            m_sequence;
+                bool                m_dumpInterrupted;
+                std::vector<char>   m_buffer;
+                NetlinkSnapshot     m_state;        // Working copy, only used by the monitor thread once started
+                NetlinkSnapshotPtr  m_snapshot;
+                EventHandler        m_handler;
+                std::thread         m_thread;
+        };
     } // namespace Plugin
 } // namespace WPEFramework
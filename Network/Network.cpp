@@ -18,7 +18,10 @@
 **/
 
 #include "Network.h"
+#include "IARMExecutor.h"
 #include <net/if.h>
+#include <net/if_arp.h>
+#include <algorithm>
 
 #define DEFAULT_PING_PACKETS 15
 
@@ -27,6 +30,7 @@
 #define INTERFACE_SIZE 10
 #define INTERFACE_LIST 50
 #define MAX_IP_ADDRESS_LEN 46
+#define MAX_LOST_ADDRESSES 64
 #define IARM_BUS_NETSRVMGR_API_getActiveInterface "getActiveInterface"
 #define IARM_BUS_NETSRVMGR_API_getNetworkInterfaces "getNetworkInterfaces"
 #define IARM_BUS_NETSRVMGR_API_getInterfaceList "getInterfaceList"
@@ -193,6 +197,12 @@ namespace WPEFramework
                 IARM_CHECK( IARM_Bus_RegisterEventHandler(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETWORK_MANAGER_EVENT_DEFAULT_INTERFACE, eventHandler) );
             }
 
+            if (!m_icmpEngine.start())
+                LOGERR("Could not start the ICMP engine, ping will fail");
+
+            if (!m_netlinkMonitor.start([this](const NetlinkEvent& event) { netlinkEventHandler(event); }))
+                LOGERR("Could not start the netlink monitor, queries will go to %s", IARM_BUS_NM_SRV_MGR_NAME);
+
             return string();
         }
 
@@ -207,6 +217,10 @@ namespace WPEFramework
                 IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETWORK_MANAGER_EVENT_INTERFACE_IPADDRESS) );
                 IARM_CHECK( IARM_Bus_UnRegisterEventHandler(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETWORK_MANAGER_EVENT_DEFAULT_INTERFACE) );
             }
+
+            m_netlinkMonitor.stop();
+            m_icmpEngine.stop();
+            Utils::IARMExecutor::instance().logStatistics();
         }
 
         string Network::Information() const
@@ -250,8 +264,42 @@ namespace WPEFramework
 
             if (m_apiVersionNumber >= 1)
             {
+                NetlinkSnapshotPtr snapshot = m_netlinkMonitor.snapshot();
+                if (snapshot)
+                {
+                    JsonArray networkInterfaces;
+                    bool found = false;
+
+                    for (const auto& entry : snapshot->interfaces)
+                    {
+                        const NetlinkInterface& link = entry.second;
+                        // Only the ethernet like interfaces, as listed by netsrvmgr
+                        if ((link.type != ARPHRD_ETHER) || (link.flags & IFF_LOOPBACK))
+                            continue;
+
+                        // netsrvmgr only lists the interfaces it manages, never docker, bridges or VLANs
+                        JsonObject interface;
+                        std::string iface = m_netUtils.getInterfaceDescription(link.name);
+                        if (iface == "")
+                            continue;
+                        interface["interface"] = iface;
+                        interface["macAddress"] = link.macAddress;
+                        interface["enabled"] = ((link.flags & IFF_UP) != 0);
+                        interface["connected"] = ((link.flags & IFF_RUNNING) != 0);
+
+                        networkInterfaces.Add(interface);
+                        found = true;
+                    }
+
+                    if (found)
+                    {
+                        response["interfaces"] = networkInterfaces;
+                        returnResponse(true);
+                    }
+                }
+
                 IARM_BUS_NetSrvMgr_InterfaceList_t list;
-                if (IARM_RESULT_SUCCESS == IARM_Bus_Call(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_getInterfaceList, (void*)&list, sizeof(list)))
+                if (IARM_RESULT_SUCCESS == Utils::IARMCallRead(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_getInterfaceList, (void*)&list, sizeof(list)))
                 {
                     JsonArray networkInterfaces;
 
@@ -323,7 +371,7 @@ namespace WPEFramework
                     strncpy(iarmData.enableInterface, interface.c_str(), INTERFACE_SIZE);
                     iarmData.persist = persist;
 
-                    if (IARM_RESULT_SUCCESS == IARM_Bus_Call (IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_setDefaultInterface, (void *)&iarmData, sizeof(iarmData)))
+                    if (IARM_RESULT_SUCCESS == Utils::IARMCall(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_setDefaultInterface, (void *)&iarmData, sizeof(iarmData)))
                     {
                         response["success"] = true;
                         returnResponse(true);
@@ -365,7 +413,24 @@ namespace WPEFramework
             else
                 param.ipv4request = false;
 
-            ret = IARM_Bus_Call(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_getSTBip, (void*)&param, sizeof(param));
+            NetlinkSnapshotPtr snapshot = m_netlinkMonitor.snapshot();
+            if (snapshot)
+            {
+                int family = param.ipv4request ? AF_INET : AF_INET6;
+                std::string interface = snapshot->getDefaultInterface(family);
+                NetlinkAddress address;
+
+                if (interface.empty())
+                    interface = snapshot->getDefaultInterface();
+                if (!interface.empty() && snapshot->getAddress(interface, family, address))
+                {
+                    response["ip"] = address.address;
+                    returnResponse(true);
+                }
+                // No address of that family yet, let netsrvmgr decide what to answer
+            }
+
+            ret = Utils::IARMCallRead(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_getSTBip, (void*)&param, sizeof(param));
 
             if (ret != IARM_RESULT_SUCCESS )
             {
@@ -387,9 +452,10 @@ namespace WPEFramework
 
                     getStringParameter("interface", interface);
 
+                    // netsrvmgr answers with the enabled state it persists, which is not the IFF_UP flag of the link
                     IARM_BUS_NetSrvMgr_Iface_EventData_t param = {0};
                     strncpy(param.enableInterface, interface.c_str(), INTERFACE_SIZE);
-                    if (IARM_RESULT_SUCCESS == IARM_Bus_Call (IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_isInterfaceEnabled, (void*)&param, sizeof(param)))
+                    if (IARM_RESULT_SUCCESS == Utils::IARMCallRead(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_isInterfaceEnabled, (void*)&param, sizeof(param)))
                     {
                         LOGINFO("%s :: Enabled = %d \n",__FUNCTION__,param.isInterfaceEnabled);
                         response["enabled"] = param.isInterfaceEnabled;
@@ -429,7 +495,7 @@ namespace WPEFramework
                     iarmData.isInterfaceEnabled = enabled;
                     iarmData.persist = persist;
 
-                    if (IARM_RESULT_SUCCESS == IARM_Bus_Call (IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_setInterfaceEnabled, (void *)&iarmData, sizeof(iarmData)))
+                    if (IARM_RESULT_SUCCESS == Utils::IARMCall(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_setInterfaceEnabled, (void *)&iarmData, sizeof(iarmData)))
                     {
                         response["success"] = true;
                         returnResponse(true);
@@ -650,8 +716,12 @@ namespace WPEFramework
                     strncpy(iarmData.secondarydns, secondarydns.c_str(), 16);
                     iarmData.isSupported = true;
 
-                    if (IARM_RESULT_SUCCESS == IARM_Bus_Call (IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_setIPSettings, (void *)&iarmData, sizeof(iarmData)))
+                    if (IARM_RESULT_SUCCESS == Utils::IARMCall(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_setIPSettings, (void *)&iarmData, sizeof(iarmData)))
                     {
+                        {
+                            std::lock_guard<std::mutex> lock(m_ipSettingsProtect);
+                            m_ipSettings.clear();
+                        }
                         response["supported"] = iarmData.isSupported;
                         returnResponse(true);
                     }
@@ -680,11 +750,25 @@ namespace WPEFramework
                     std::string interface = "";
                     getStringParameter("interface", interface);
 
+                    // netlink does not carry the DNS servers nor how the address was configured, so the reply
+                    // of netsrvmgr is kept until the addresses, routes or links change
+                    NetlinkSnapshotPtr snapshot = m_netlinkMonitor.snapshot();
+                    if (snapshot)
+                    {
+                        std::lock_guard<std::mutex> lock(m_ipSettingsProtect);
+                        auto it = m_ipSettings.find(interface);
+                        if ((it != m_ipSettings.end()) && (it->second.first == snapshot->generation))
+                        {
+                            response = it->second.second;
+                            returnResponse(true);
+                        }
+                    }
+
                     IARM_BUS_NetSrvMgr_Iface_Settings_t iarmData = { 0 };
                     strncpy(iarmData.interface, interface.c_str(), 16);
                     iarmData.isSupported = true;
 
-                    if (IARM_RESULT_SUCCESS == IARM_Bus_Call (IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_getIPSettings, (void *)&iarmData, sizeof(iarmData)))
+                    if (IARM_RESULT_SUCCESS == Utils::IARMCallRead(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_getIPSettings, (void *)&iarmData, sizeof(iarmData)))
                     {
                         response["interface"] = string(iarmData.interface);
                         response["ipversion"] = string(iarmData.ipversion);
@@ -694,6 +778,12 @@ namespace WPEFramework
                         response["gateway"] = string(iarmData.gateway);
                         response["primarydns"] = string(iarmData.primarydns);
                         response["secondarydns"] = string(iarmData.secondarydns);
+
+                        if (snapshot)
+                        {
+                            std::lock_guard<std::mutex> lock(m_ipSettingsProtect);
+                            m_ipSettings[interface] = std::make_pair(snapshot->generation, response);
+                        }
                         returnResponse(true);
                     }
                     else
@@ -714,8 +804,12 @@ namespace WPEFramework
          * Notifications
          */
 
-        void Network::onInterfaceEnabledStatusChanged(string interface, bool enabled)
+        void Network::onInterfaceEnabledStatusChanged(string interface, bool enabled, bool fromNetlink)
         {
+            // The link being up (netlink) and the interface being enabled (netsrvmgr) are different states
+            if (!_isNewState((fromNetlink ? "up:" : "enabled:") + interface, enabled ? "1" : "0"))
+                return;
+
             JsonObject params;
             params["interface"] = m_netUtils.getInterfaceDescription(interface);
             params["enabled"] = enabled;
@@ -724,6 +818,9 @@ namespace WPEFramework
 
         void Network::onInterfaceConnectionStatusChanged(string interface, bool connected)
         {
+            if (!_isNewState("connected:" + interface, connected ? "1" : "0"))
+                return;
+
             JsonObject params;
             params["interface"] = m_netUtils.getInterfaceDescription(interface);
             params["status"] = string (connected ? "CONNECTED" : "DISCONNECTED");
@@ -732,6 +829,9 @@ namespace WPEFramework
 
         void Network::onInterfaceIPAddressChanged(string interface, string ipv6Addr, string ipv4Addr, bool acquired)
         {
+            if (!_isNewState("ipaddress:" + interface + ":" + ipv6Addr + ipv4Addr, acquired ? "1" : "0"))
+                return;
+
             JsonObject params;
             params["interface"] = m_netUtils.getInterfaceDescription(interface);
             if (ipv6Addr != "")
@@ -744,16 +844,45 @@ namespace WPEFramework
             }
             params["status"] = string (acquired ? "ACQUIRED" : "LOST");
             sendNotify("onIPAddressStatusChanged", params);
+
+            // Addresses come and go (privacy addresses, DHCP leases), only the last ones lost are remembered
+            if (!acquired)
+                _keepLostState("ipaddress:" + interface + ":" + ipv6Addr + ipv4Addr);
         }
 
         void Network::onDefaultInterfaceChanged(string oldInterface, string newInterface)
         {
+            if (!_isNewState("default", newInterface))
+                return;
+
             JsonObject params;
             params["oldInterfaceName"] = m_netUtils.getInterfaceDescription(oldInterface);
             params["newInterfaceName"] = m_netUtils.getInterfaceDescription(newInterface);
             sendNotify("onDefaultInterfaceChanged", params);
         }
 
+        void Network::onTraceHop(const string& target, const IcmpEngine::Hop& hop)
+        {
+            JsonObject params;
+            JsonArray rtts;
+            params["target"] = target;
+            params["hop"] = hop.ttl;
+            params["address"] = hop.address;
+            for (size_t i = 0; i < hop.rttMs.size(); i++)
+            {
+                char rtt[32];
+                // Same representation as the ping trip times, "" for an unanswered probe
+                if (hop.rttMs[i] < 0)
+                    rtt[0] = '\0';
+                else
+                    snprintf(rtt, sizeof(rtt), "%.3f", hop.rttMs[i]);
+                rtts.Add(string(rtt));
+            }
+            params["tripTimes"] = rtts;
+            params["reached"] = hop.reached;
+            sendNotify("onTraceHop", params);
+        }
+
         void Network::eventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
         {
             if (Network::_instance)
@@ -784,7 +913,7 @@ namespace WPEFramework
                 if (m_netUtils.getInterfaceDescription(e->interface) == "")
                     break;
 #endif
-                onInterfaceEnabledStatusChanged(e->interface, e->status);
+                onInterfaceEnabledStatusChanged(e->interface, e->status, false);
                 break;
             }
             case IARM_BUS_NETWORK_MANAGER_EVENT_INTERFACE_CONNECTION_STATUS:
@@ -829,14 +958,66 @@ namespace WPEFramework
             }
         }
 
+        void Network::netlinkEventHandler(const NetlinkEvent& event)
+        {
+            if (event.type != NetlinkEvent::DEFAULT_INTERFACE)
+            {
+                // Same interfaces as getInterfaces reports
+                if (event.linkType != ARPHRD_ETHER)
+                    return;
+                if (m_netUtils.getInterfaceDescription(event.interface) == "")
+                    return;
+            }
+
+            switch (event.type)
+            {
+            case NetlinkEvent::INTERFACE_ENABLED_STATUS:
+                onInterfaceEnabledStatusChanged(event.interface, event.status, true);
+                break;
+            case NetlinkEvent::INTERFACE_CONNECTION_STATUS:
+                onInterfaceConnectionStatusChanged(event.interface, event.status);
+                break;
+            case NetlinkEvent::INTERFACE_IPADDRESS:
+                if (event.family == AF_INET6)
+                {
+#ifdef NET_NO_LINK_LOCAL_ANNOUNCE
+                    if (!m_netUtils.isIPV6LinkLocal(event.address))
+#endif
+                        onInterfaceIPAddressChanged(event.interface, event.address, "", event.status);
+                }
+                else
+                {
+#ifdef NET_NO_LINK_LOCAL_ANNOUNCE
+                    if (!m_netUtils.isIPV4LinkLocal(event.address))
+#endif
+                        onInterfaceIPAddressChanged(event.interface, "", event.address, event.status);
+                }
+                break;
+            case NetlinkEvent::DEFAULT_INTERFACE:
+                onDefaultInterfaceChanged(event.oldInterface, event.interface);
+                break;
+            }
+        }
+
         /*
          * Internal functions
          */
 
         bool Network::_getDefaultInterface(string& interface, string& gateway)
         {
+            NetlinkSnapshotPtr snapshot = m_netlinkMonitor.snapshot();
+            NetlinkRoute route;
+            const NetlinkInterface* link = NULL;
+
+            if (snapshot && snapshot->getDefaultRoute(AF_UNSPEC, route) && ((link = snapshot->find(route.index)) != NULL))
+            {
+                interface = link->name;
+                gateway = route.gateway;
+                return true;
+            }
+
             IARM_BUS_NetSrvMgr_DefaultRoute_t defaultRoute = {0};
-            if (IARM_RESULT_SUCCESS == IARM_Bus_Call(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_getDefaultInterface, (void*)&defaultRoute, sizeof(defaultRoute)))
+            if (IARM_RESULT_SUCCESS == Utils::IARMCallRead(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_getDefaultInterface, (void*)&defaultRoute, sizeof(defaultRoute)))
             {
                 LOGINFO ("Call to %s for %s returned interface = %s, gateway = %s\n", IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_getDefaultInterface, defaultRoute.interface, defaultRoute.gateway);
                 interface = defaultRoute.interface;
@@ -850,5 +1031,36 @@ namespace WPEFramework
             }
         }
 
+        /*
+         * Record the state last notified for a key, returns false when it is the same as the last one
+         */
+        bool Network::_isNewState(const string& key, const string& state)
+        {
+            std::lock_guard<std::mutex> lock(m_notifyProtect);
+            auto it = m_notifiedState.find(key);
+            if ((it != m_notifiedState.end()) && (it->second == state))
+                return false;
+            m_notifiedState[key] = state;
+            return true;
+        }
+
+        /*
+         * Keep the LOST state of an address, so that the same loss reported by the other source is not notified
+         * again, until MAX_LOST_ADDRESSES others were lost since. An ACQUIRED state overwrites it meanwhile.
+         */
+        void Network::_keepLostState(const string& key)
+        {
+            std::lock_guard<std::mutex> lock(m_notifyProtect);
+            m_lostAddresses.erase(std::remove(m_lostAddresses.begin(), m_lostAddresses.end(), key), m_lostAddresses.end());
+            m_lostAddresses.push_back(key);
+            while (m_lostAddresses.size() > MAX_LOST_ADDRESSES)
+            {
+                auto it = m_notifiedState.find(m_lostAddresses.front());
+                if ((it != m_notifiedState.end()) && (it->second == "0"))
+                    m_notifiedState.erase(it);
+                m_lostAddresses.pop_front();
+            }
+        }
+
     } // namespace Plugin
 } // namespace WPEFramework
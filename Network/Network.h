@@ -20,10 +20,15 @@
 #pragma once
 
 #include <cjson/cJSON.h>
+#include <deque>
+#include <map>
+#include <mutex>
 #include <string>
+#include <utility>
 
 #include "Module.h"
 #include "NetUtils.h"
+#include "IcmpEngine.h"
 #include "utils.h"
 #include "upnpdiscoverymanager.h"
 
@@ -74,19 +79,24 @@ namespace WPEFramework {
             uint32_t setIPSettings(const JsonObject& parameters, JsonObject& response);
             uint32_t getIPSettings(const JsonObject& parameters, JsonObject& response);
 
-            void onInterfaceEnabledStatusChanged(std::string interface, bool enabled);
+            void onInterfaceEnabledStatusChanged(std::string interface, bool enabled, bool fromNetlink);
             void onInterfaceConnectionStatusChanged(std::string interface, bool connected);
             void onInterfaceIPAddressChanged(std::string interface, std::string ipv6Addr, std::string ipv4Addr, bool acquired);
             void onDefaultInterfaceChanged(std::string oldInterface, std::string newInterface);
+            void onTraceHop(const std::string& target, const IcmpEngine::Hop& hop);
 
             static void eventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
             void iarmEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len);
+            void netlinkEventHandler(const NetlinkEvent& event);
 
             // Internal methods
             bool _getDefaultInterface(std::string& interface, std::string& gateway);
+            bool _isNewState(const std::string& key, const std::string& state);
+            void _keepLostState(const std::string& key);
 
             bool _doTrace(std::string &endpoint, int packets, JsonObject& response);
             bool _doTraceNamedEndpoint(std::string &endpointName, int packets, JsonObject& response);
+            static std::string _formatTraceHop(const IcmpEngine::Hop& hop);
 
             JsonObject _doPing(const std::string& guid, const std::string& endPoint, int packets);
             JsonObject _doPingNamedEndpoint(const std::string& guid, const std::string& endpointName, int packets);
@@ -113,6 +123,17 @@ namespace WPEFramework {
         private:
             uint32_t m_apiVersionNumber;
             NetUtils m_netUtils;
+            IcmpEngine m_icmpEngine;
+            NetlinkMonitor m_netlinkMonitor;
+
+            // Last state notified, netsrvmgr and netlink both report most changes
+            std::mutex m_notifyProtect;
+            std::map<std::string, std::string> m_notifiedState;
+            std::deque<std::string> m_lostAddresses;    // Keys of the last addresses notified LOST, oldest first
+
+            // getIPSettings replies, valid as long as the netlink snapshot generation they were read with
+            std::mutex m_ipSettingsProtect;
+            std::map<std::string, std::pair<uint64_t, JsonObject> > m_ipSettings;
         };
     } // namespace Plugin
 } // namespace WPEFramework
@@ -18,20 +18,12 @@
 **/
 
 #include "Network.h"
-#include <fcntl.h>
 #include <string.h>
 
-//e.g. traceroute -w 3 -m 6 -q 3 192.168.1.100 52
-#define CMD_TRACEROUTE "traceroute -w %d -m %d -q %d %s %d 2>&1"
-//e.g. traceroute6 -i eth0 -w 3 -m 6 -q 3 fe80::5a19:f8ff:fe37:7a3d 52
-#define CMD_TRACEROUTE6 "traceroute6 -i %s -w %d -m %d -q %d %s %d 2>&1"
-
-#define DEFAULT_PACKET_LENGTH   52
 #define DEFAULT_WAIT            3
 #define DEFAULT_MAX_HOPS        6
 #define DEFAULT_QUERIES         3
 
-
 namespace WPEFramework {
     namespace Plugin {
 
@@ -58,20 +50,21 @@ namespace WPEFramework {
 
         bool Network::_doTrace(std::string &endpoint, int packets, JsonObject &response)
         {
-            std::string output = "";
             std::string error = "";
             std::string interface = "";
             std::string gateway;
-            int wait = DEFAULT_WAIT;
-            int maxHops = DEFAULT_MAX_HOPS;
-            int packetLen = DEFAULT_PACKET_LENGTH;
-            char command[MAX_COMMAND_LENGTH];
-            bool result = false;
+            IcmpEngine::TraceResult result;
+            std::vector<string> hopLines;
 
             if (packets <= 0)
             {
                 packets = DEFAULT_QUERIES;
             }
+            else if (packets > ICMP_ENGINE_TRACE_MAX_QUERIES)
+            {
+                // The engine sends no more than that, the header must not claim otherwise
+                packets = ICMP_ENGINE_TRACE_MAX_QUERIES;
+            }
 
             if (endpoint.empty())
             {
@@ -89,66 +82,78 @@ namespace WPEFramework {
             }
             else
             {
-                if (NetUtils::isIPV6(endpoint))
-                {
-                    snprintf(command, MAX_COMMAND_LENGTH, CMD_TRACEROUTE6,
-                            interface.c_str(),
-                            wait,
-                            maxHops,
-                            packets,
-                            endpoint.c_str(),
-                            packetLen);
-                }
-                else
-                {
-                    snprintf(command, MAX_COMMAND_LENGTH, CMD_TRACEROUTE,
-                            wait,
-                            maxHops,
-                            packets,
-                            endpoint.c_str(),
-                            packetLen);
-                }
+                IcmpEngine::TraceRequest request;
+                request.endpoint = endpoint;
+                request.interface = interface;
+                request.maxHops = DEFAULT_MAX_HOPS;
+                request.queries = packets;
+                request.timeoutMs = DEFAULT_WAIT * 1000;
 
-                if (NetUtils::execCmd(command, output, &result) < 0)
-                {
-                    error = "Failed to execute traceroute command";
-                }
-                else if (!result) // check the command return status
+                // All the TTLs are probed at once, the hops are notified as soon as they are known
+                result = m_icmpEngine.trace(request, [this, &endpoint, &hopLines](const IcmpEngine::Hop& hop) {
+                    hopLines.push_back(_formatTraceHop(hop));
+                    onTraceHop(endpoint, hop);
+                });
+
+                if (!result.success)
                 {
-                    error = "Failed to execute traceroute";
+                    error = result.error.empty() ? "Failed to execute traceroute" : result.error;
                 }
             }
 
+            response["target"] = endpoint;
             if (error.empty())
             {
-                // We return the entire output of the trace command but since this contains newlines it is not valid as
-                // a json value so we will parse the output into an array of strings, one element for each line.
-                JsonArray list;
-                if (!output.empty())
+                // Same shape as the traceroute output used to be, one string per line
+                JsonArray lines;
+                char header[256];
+                snprintf(header, sizeof(header), "traceroute to %s (%s), %d hops max, %d queries per hop",
+                        endpoint.c_str(), result.address.c_str(), DEFAULT_MAX_HOPS, packets);
+                lines.Add(string(header));
+                for (size_t i = 0; i < hopLines.size(); i++)
                 {
-                    std::string::size_type last = 0;
-                    std::string::size_type next = output.find('\n');
-                    while (next != std::string::npos)
-                    {
-                        list.Add(output.substr(last, next - last));
-                        last = next + 1;
-                        next = output.find('\n', last);
-                    }
-                    list.Add(output.substr(last));
+                    lines.Add(hopLines[i]);
                 }
 
-                response["target"] = endpoint;
-                response["results"] = list;
+                response["results"] = lines;
                 response["error"] = "";
                 return true;
             }
             else
             {
-                response["target"] = endpoint;
                 response["results"] = "";
                 response["error"] = error;
                 return false;
             }
         }
+
+        string Network::_formatTraceHop(const IcmpEngine::Hop& hop)
+        {
+            // e.g. " 2  10.0.0.1  1.234 ms  *  1.502 ms", or " 3  *  *  *" when nothing answered
+            char text[64];
+
+            snprintf(text, sizeof(text), "%2d", hop.ttl);
+            string line = text;
+
+            if (!hop.address.empty())
+            {
+                line += "  " + hop.address;
+            }
+
+            for (size_t i = 0; i < hop.rttMs.size(); i++)
+            {
+                if (hop.rttMs[i] < 0)
+                {
+                    line += "  *";
+                }
+                else
+                {
+                    snprintf(text, sizeof(text), "  %.3f ms", hop.rttMs[i]);
+                    line += text;
+                }
+            }
+
+            return line;
+        }
     } // namespace Plugin
 } // namespace WPEFramework
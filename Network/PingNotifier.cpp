@@ -32,9 +32,6 @@ namespace WPEFramework
             JsonObject pingResult;
             std::string interface = "";
             std::string gateway;
-            bool result = false;
-            std::string outputFile;
-            FILE *fp = NULL;
 
             pingResult["target"] = endPoint;
 
@@ -66,120 +63,45 @@ namespace WPEFramework
                 return pingResult;
             }
 
-            char cmd [1000] = {0x0};
-            if (NetUtils::isIPV6(endPoint))
-            {
-                snprintf(cmd, sizeof(cmd), "ping6 -I %s -c %d -W 5 '%s' 2>&1",
-                        interface.c_str(), packets, endPoint.c_str());
-            }
-            else
-            {
-                snprintf(cmd, sizeof(cmd), "ping -c %d -W 5 '%s' 2>&1",
-                        packets, endPoint.c_str());
-            }
+            IcmpEngine::Request request;
+            request.endpoint = endPoint;
+            request.packets = packets;
+            // IPv6 probes leave through the default interface, as with ping6 -I
+            request.interface = interface;
 
-            LOGWARN("ping command: %s", cmd);
+            IcmpEngine::Result result = m_icmpEngine.ping(request);
 
-            // Run the command and dump the output to /tmp/pingoutput
-            if (NetUtils::execCmd(cmd, outputFile, &result, "pingoutput") < 0)
-            {
-                LOGERR("%s: SERVICEMANAGER_FILE_ERROR: Can't open pipe for command '%s' for read mode: %s"
-                        , __FUNCTION__, cmd, strerror(errno));
+            LOGINFO("ping %s (%s): %d transmitted, %d received, rtt min/avg/max/mdev = %.3f/%.3f/%.3f/%.3f ms",
+                    endPoint.c_str(), result.address.c_str(), result.transmitted, result.received,
+                    result.minMs, result.avgMs, result.maxMs, result.stddevMs);
 
-                pingResult["success"] = false;
-                pingResult["error"] = "Could not run command";
-            }
-            else if (!result) // check the command return status
+            if (!result.success)
             {
+                LOGERR("%s: ping of '%s' failed: %s", __FUNCTION__, endPoint.c_str(), result.error.c_str());
                 pingResult["success"] = false;
-                pingResult["error"] = "Could not ping endpoint";
-            }
-            else if ((fp = fopen(outputFile.c_str(), "r")) == NULL)
-            {
-                pingResult["success"] = false;
-                pingResult["error"] = "Could not read ping result";
+                pingResult["error"] = (result.error == "Bad Address") ? result.error : "Could not ping endpoint";
             }
             else
             {
+                // Same representation as the ping output used to have, numbers as strings
+                char value[32];
+
                 pingResult["success"] = true;
                 pingResult["error"] = "";
                 pingResult["guid"] = guid;
-
-                char linearray[1000]={0x0};
-                while(fgets(linearray, sizeof(linearray), fp) != NULL)
-                {
-                    std::string line(linearray);
-                    LOGINFO("ping result: %s", line.c_str());
-
-                    if( line.find( "packet" ) != std::string::npos ) {
-                        //Example: 10 packets transmitted, 10 packets received, 0% packet loss
-
-                        std::stringstream ss( line );
-                        int transCount;
-                        ss >> transCount;
-                        pingResult["packetsTransmitted"] = transCount;
-
-                        std::string token;
-                        getline( ss, token, ',' );
-                        getline( ss, token, ',' );
-                        std::stringstream ss2( token );
-                        int rxCount;
-                        ss2 >> rxCount;
-                        pingResult["packetsReceived"] = rxCount;
-
-                        getline( ss, token, ',' );
-                        std::string prefix = token.substr(0, token.find("%"));
-                        //double lossFloat = ::atof(prefix.c_str());
-                        //pingResult["packetLoss"] = lossFloat;
-                        pingResult["packetLoss"] = prefix.c_str();
-
-                    }else if( line.find( "min/avg/max" ) != std::string::npos ) {
-                        //Example: round-trip min/avg/max = 17.038/18.310/20.197 ms
-
-                        std::stringstream ss( line );
-                        std::string fullpath;
-                        getline( ss, fullpath, '=' );
-                        getline( ss, fullpath, '=' );
-
-                        std::string prefix;
-                        int index = fullpath.find("/");
-                        if (index >= 0)
-                        {
-                            prefix = fullpath.substr(0, fullpath.find("/"));
-                            pingResult["tripMin"] = prefix.c_str();
-                        }
-
-                        index = fullpath.find("/");
-                        if (index >= 0)
-                        {
-                            fullpath = fullpath.substr(index + 1, fullpath.length());
-                            prefix = fullpath.substr(0, fullpath.find("/"));
-                            pingResult["tripAvg"] = prefix.c_str();
-                        }
-
-                        index = fullpath.find("/");
-                        if (index >= 0)
-                        {
-                            fullpath = fullpath.substr(index + 1, fullpath.length());
-                            prefix = fullpath.substr(0, fullpath.find("/"));
-                            pingResult["tripMax"] = prefix.c_str();
-                        }
-
-                        index = fullpath.find("/");
-                        if (index >= 0)
-                        {
-                            fullpath = fullpath.substr(index + 1, fullpath.length());
-                            pingResult["tripStdDev"] = fullpath.c_str();
-                        }
-                    }else if( line.find( "bad" ) != std::string::npos ) {
-                        pingResult["success"] = false;
-                        pingResult["error"] = "Bad Address";
-                    }
-                }
-                fclose(fp);
-
-                // clear up
-                std::remove(outputFile.c_str());
+                pingResult["packetsTransmitted"] = result.transmitted;
+                pingResult["packetsReceived"] = result.received;
+
+                snprintf(value, sizeof(value), "%d", (int)result.lossPercent);
+                pingResult["packetLoss"] = value;
+                snprintf(value, sizeof(value), "%.3f", result.minMs);
+                pingResult["tripMin"] = value;
+                snprintf(value, sizeof(value), "%.3f", result.avgMs);
+                pingResult["tripAvg"] = value;
+                snprintf(value, sizeof(value), "%.3f", result.maxMs);
+                pingResult["tripMax"] = value;
+                snprintf(value, sizeof(value), "%.3f", result.stddevMs);
+                pingResult["tripStdDev"] = value;
             }
 
             return pingResult;
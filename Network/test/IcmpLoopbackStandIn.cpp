@@ -0,0 +1,171 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+/*
+ * Drives the Network plugin ICMP engine against the loopback interface,
+ * standing in for the ping endpoints of a real network. Several sessions
+ * to 127.0.0.1, ::1 and localhost run at once, optionally together with
+ * an address that never answers (TEST-NET-2 by default), and from several
+ * threads as concurrent JSON-RPC calls would.
+ *
+ * Every loopback session must get all its replies, the unanswered one
+ * must report 100% loss, and the whole run must take about as long as a
+ * single session rather than the sum of them.
+ *
+ * Loopback traces are run last, they must stop at the first hop, with
+ * that hop notified once.
+ */
+
+#include "IcmpEngine.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace WPEFramework::Plugin;
+
+struct Options {
+    int packets = 5;
+    int interval = 200;
+    int copies = 4;
+    int callers = 2;
+    std::string unreachable;
+};
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [options]\n"
+        "  -n <count>   packets per session (default 5)\n"
+        "  -i <ms>      interval between packets (default 200)\n"
+        "  -c <count>   sessions per loopback address and caller (default 4)\n"
+        "  -t <count>   calling threads (default 2)\n"
+        "  -u <address> also ping an address which never answers, e.g. 198.51.100.1\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    int option;
+
+    while ((option = getopt(argc, argv, "n:i:c:t:u:")) != -1) {
+        switch (option) {
+        case 'n': options.packets = std::max(1, atoi(optarg)); break;
+        case 'i': options.interval = std::max(0, atoi(optarg)); break;
+        case 'c': options.copies = std::max(1, atoi(optarg)); break;
+        case 't': options.callers = std::max(1, atoi(optarg)); break;
+        case 'u': options.unreachable = optarg; break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+
+    IcmpEngine engine;
+    if (!engine.start()) {
+        fprintf(stderr, "Could not start the ICMP engine\n");
+        return 1;
+    }
+
+    static const char *loopback[] = { "127.0.0.1", "::1", "localhost" };
+
+    std::vector<IcmpEngine::Request> requests;
+    for (int copy = 0; copy < options.copies; copy++) {
+        for (const char *endpoint : loopback) {
+            IcmpEngine::Request request;
+            request.endpoint = endpoint;
+            request.packets = options.packets;
+            request.intervalMs = options.interval;
+            request.timeoutMs = 1000;
+            requests.push_back(request);
+        }
+    }
+    if (!options.unreachable.empty()) {
+        IcmpEngine::Request request;
+        request.endpoint = options.unreachable;
+        request.packets = options.packets;
+        request.intervalMs = options.interval;
+        request.timeoutMs = 1000;
+        requests.push_back(request);
+    }
+
+    std::vector<std::vector<IcmpEngine::Result> > results(options.callers);
+    std::vector<std::thread> callers;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < options.callers; i++)
+        callers.push_back(std::thread([&engine, &requests, &results, i]() { results[i] = engine.ping(requests); }));
+    for (std::thread &caller : callers)
+        caller.join();
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    int failures = 0;
+
+    for (const char *endpoint : { "127.0.0.1", "::1" }) {
+        IcmpEngine::TraceRequest request;
+        request.endpoint = endpoint;
+        request.timeoutMs = 1000;
+
+        int notified = 0;
+        IcmpEngine::TraceResult trace = engine.trace(request, [&notified](const IcmpEngine::Hop &) { notified++; });
+
+        bool valid = trace.success && trace.reached && trace.hops.size() == 1 && notified == 1 &&
+            trace.hops[0].reached && trace.hops[0].rttMs.size() == (size_t)request.queries &&
+            *std::min_element(trace.hops[0].rttMs.begin(), trace.hops[0].rttMs.end()) >= 0;
+        if (!valid)
+            failures++;
+
+        printf("trace %-6s %zu hop(s), %d notified, %s%s\n", endpoint, trace.hops.size(), notified,
+            trace.reached ? "reached" : "not reached", valid ? "" : "  UNEXPECTED");
+    }
+
+    engine.stop();
+
+    int sessions = 0;
+
+    for (const std::vector<IcmpEngine::Result> &callerResults : results) {
+        for (const IcmpEngine::Result &result : callerResults) {
+            bool expectReplies = result.target != options.unreachable;
+            bool valid = expectReplies
+                ? (result.success && result.received == options.packets && result.lossPercent == 0)
+                : (!result.success && result.transmitted == options.packets && result.lossPercent == 100);
+            if (!valid)
+                failures++;
+            sessions++;
+
+            printf("%-12s %-16s %d/%d  loss %5.1f%%  rtt %.3f/%.3f/%.3f/%.3f ms%s%s%s\n",
+                result.target.c_str(), result.address.c_str(), result.received, result.transmitted, result.lossPercent,
+                result.minMs, result.avgMs, result.maxMs, result.stddevMs,
+                result.error.empty() ? "" : "  ", result.error.c_str(), valid ? "" : "  UNEXPECTED");
+        }
+    }
+
+    /* One session lasts (packets - 1) intervals plus the last reply, or the timeout when nothing answers */
+    double single = (options.packets - 1) * options.interval + (options.unreachable.empty() ? 0 : 1000);
+    bool concurrent = elapsed < single + 500;
+    if (!concurrent)
+        failures++;
+
+    printf("%d sessions in %.0f ms, a single session takes about %.0f ms%s\n", sessions, elapsed, single, concurrent ? "" : "  NOT CONCURRENT");
+
+    return failures ? 2 : 0;
+}
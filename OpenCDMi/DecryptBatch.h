@@ -0,0 +1,179 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DECRYPTBATCH_H
+#define __DECRYPTBATCH_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Layout of a batched decrypt request in the session DataExchange buffer.
+    //
+    // A batch is a single RequestConsume/Consumed round trip carrying many
+    // samples. It is recognized by the Magic at the start of the buffer while
+    // the regular (per sample) IV is left empty. The buffer contains:
+    //
+    //   Header | Sample[Header::Count] | subsample maps | sample data
+    //
+    // All offsets are relative to the start of the buffer. On return every
+    // Sample carries its own Status and clear Length, the clear data is
+    // written back in place of the encrypted data.
+    namespace DecryptBatch {
+
+        static constexpr uint8_t Magic[8] = { 'O', 'C', 'D', 'M', 'B', 'T', 'C', 'H' };
+        static constexpr uint16_t Version = 1;
+        static constexpr uint8_t MaxIVLength = 16;
+        static constexpr uint8_t MaxKeyIdLength = 16;
+
+        struct Header {
+            uint8_t Magic[8];
+            uint16_t Version;
+            uint16_t Count;
+            uint32_t Length;
+        };
+
+        struct Sample {
+            uint32_t Offset;
+            uint32_t Length;
+            uint32_t SubSampleOffset;
+            uint16_t SubSampleCount; // number of uint32_t entries, clear/encrypted pairs
+            uint8_t IVLength;
+            uint8_t KeyIdLength;
+            uint8_t IV[MaxIVLength];
+            uint8_t KeyId[MaxKeyIdLength];
+            int32_t Status;
+            uint8_t InitWithLast15;
+            uint8_t Reserved[3];
+        };
+
+        inline bool IsBatch(const uint8_t buffer[], const uint32_t length, const uint8_t ivLength)
+        {
+            return ((ivLength == 0) && (length >= sizeof(Header)) && (::memcmp(buffer, Magic, sizeof(Magic)) == 0));
+        }
+
+        // Validates a header copied out of the buffer against the buffer length.
+        inline bool IsValid(const Header& header, const uint32_t length)
+        {
+            return ((header.Version == Version) && (header.Length <= length) && (header.Count > 0)
+                && ((sizeof(Header) + (static_cast<uint64_t>(header.Count) * sizeof(Sample))) <= header.Length));
+        }
+
+        // Validates a descriptor copied out of the buffer against its (validated) header.
+        inline bool IsValid(const Header& header, const Sample& sample)
+        {
+            return ((static_cast<uint64_t>(sample.Offset) + sample.Length) <= header.Length)
+                && ((static_cast<uint64_t>(sample.SubSampleOffset) + (sample.SubSampleCount * sizeof(uint32_t))) <= header.Length)
+                && ((sample.SubSampleOffset % sizeof(uint32_t)) == 0)
+                && (sample.IVLength <= MaxIVLength)
+                && (sample.KeyIdLength <= MaxKeyIdLength);
+        }
+
+        // Validates a subsample map copied out of the buffer against its sample.
+        inline bool IsValid(const Sample& sample, const std::vector<uint32_t>& subSamples)
+        {
+            uint64_t total = 0;
+            for (const uint32_t entry : subSamples) {
+                total += entry;
+            }
+            return (total <= sample.Length);
+        }
+
+        // Decrypts all samples of the batch in the buffer, in place.
+        //
+        // The other side maps the same buffer and can still write to it, so the header, the
+        // descriptors and the subsample maps are copied out first. Only the copies are validated
+        // and used, the buffer is only read for the sample data and written for the clear data,
+        // the per sample Status and clear Length.
+        //
+        // decrypt(sample, subSamples, data, clearContentSize, clearContent) returns the CDMi
+        // status of one sample. Returns false, without decrypting anything, when the batch is
+        // malformed. Otherwise result holds the status of the first failing sample, if any.
+        template <typename DECRYPT>
+        bool Decrypt(uint8_t buffer[], const uint32_t length, const int32_t invalid, DECRYPT decrypt, int32_t& result)
+        {
+            Header header;
+            if (length < sizeof(Header)) {
+                return (false);
+            }
+            ::memcpy(&header, buffer, sizeof(Header));
+            if (IsValid(header, length) == false) {
+                return (false);
+            }
+
+            std::vector<Sample> samples(header.Count);
+            ::memcpy(samples.data(), buffer + sizeof(Header), header.Count * sizeof(Sample));
+
+            std::vector< std::vector<uint32_t> > subSamples(header.Count);
+            for (uint16_t index = 0; index < header.Count; index++) {
+                const Sample& sample(samples[index]);
+                if (IsValid(header, sample) == false) {
+                    return (false);
+                }
+                subSamples[index].resize(sample.SubSampleCount);
+                ::memcpy(subSamples[index].data(), buffer + sample.SubSampleOffset, sample.SubSampleCount * sizeof(uint32_t));
+                if (IsValid(sample, subSamples[index]) == false) {
+                    return (false);
+                }
+            }
+
+            result = 0;
+            Sample* slots = reinterpret_cast<Sample*>(buffer + sizeof(Header));
+
+            for (uint16_t index = 0; index < header.Count; index++) {
+                Sample& sample(samples[index]);
+                uint32_t clearContentSize = 0;
+                uint8_t* clearContent = nullptr;
+
+                int32_t cr = decrypt(static_cast<const Sample&>(sample),
+                    (sample.SubSampleCount != 0 ? subSamples[index].data() : nullptr),
+                    buffer + sample.Offset, clearContentSize, clearContent);
+
+                if ((cr == 0) && (clearContentSize != 0)) {
+                    if (clearContentSize > sample.Length) {
+                        cr = invalid;
+                    } else {
+                        if (clearContent != (buffer + sample.Offset)) {
+                            ::memmove(buffer + sample.Offset, clearContent, clearContentSize);
+                        }
+                        sample.Length = clearContentSize;
+                    }
+                }
+
+                sample.Status = cr;
+                ::memcpy(&slots[index], &sample, sizeof(Sample));
+
+                if ((result == 0) && (cr != 0)) {
+                    result = cr;
+                }
+            }
+
+            return (true);
+        }
+
+    } // namespace DecryptBatch
+
+} // namespace Plugin
+} // namespace WPEFramework
+
+#endif // __DECRYPTBATCH_H
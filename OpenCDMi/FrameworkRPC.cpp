@@ -23,6 +23,7 @@
 
 #include "Module.h"
 #include "CENCParser.h"
+#include "DecryptBatch.h"
 
 // Get in the definitions required for access to the sepcific
 // DRM engines.
@@ -271,42 +272,15 @@ namespace Plugin {
 
                         while (IsRunning() == true) {
 
-                            uint32_t clearContentSize = 0;
-                            uint8_t* clearContent = nullptr;
-
                             RequestConsume(Core::infinite);
 
                             if (IsRunning() == true) {
-                                uint8_t keyIdLength = 0;
-                                const uint8_t* keyIdData = KeyId(keyIdLength);
-
-                                int cr = _mediaKeys->Decrypt(
-                                    _sessionKey,
-                                    _sessionKeyLength,
-                                    nullptr, //subsamples
-                                    0, //number of subsamples
-                                    IVKey(),
-                                    IVKeyLength(),
-                                    Buffer(),
-                                    BytesWritten(),
-                                    &clearContentSize,
-                                    &clearContent,
-                                    keyIdLength,
-                                    keyIdData,
-                                    InitWithLast15());
-                                if ((cr == 0) && (clearContentSize != 0)) {
-                                    if (clearContentSize != BytesWritten()) {
-                                        TRACE_L1("Returned clear sample size (%d) differs from encrypted buffer size (%d)", clearContentSize, BytesWritten());
-                                        Size(clearContentSize);
-                                    }
-
-                                    // Adjust the buffer on our sied (this process) on what we will write back
-                                    SetBuffer(0, clearContentSize, clearContent);
+                                if (DecryptBatch::IsBatch(Buffer(), BytesWritten(), IVKeyLength()) == true) {
+                                    DecryptSamples();
+                                } else {
+                                    DecryptSample();
                                 }
 
-                                // Store the status we have for the other side.
-                                Status(static_cast<uint32_t>(cr));
-
                                 // Whatever the result, we are done with the buffer..
                                 Consumed();
                             }
@@ -315,6 +289,76 @@ namespace Plugin {
                         return (Core::infinite);
                     }
 
+                    void DecryptSample()
+                    {
+                        uint32_t clearContentSize = 0;
+                        uint8_t* clearContent = nullptr;
+                        uint8_t keyIdLength = 0;
+                        const uint8_t* keyIdData = KeyId(keyIdLength);
+
+                        int cr = _mediaKeys->Decrypt(
+                            _sessionKey,
+                            _sessionKeyLength,
+                            nullptr, //subsamples
+                            0, //number of subsamples
+                            IVKey(),
+                            IVKeyLength(),
+                            Buffer(),
+                            BytesWritten(),
+                            &clearContentSize,
+                            &clearContent,
+                            keyIdLength,
+                            keyIdData,
+                            InitWithLast15());
+                        if ((cr == 0) && (clearContentSize != 0)) {
+                            if (clearContentSize != BytesWritten()) {
+                                TRACE_L1("Returned clear sample size (%d) differs from encrypted buffer size (%d)", clearContentSize, BytesWritten());
+                                Size(clearContentSize);
+                            }
+
+                            // Adjust the buffer on our sied (this process) on what we will write back
+                            SetBuffer(0, clearContentSize, clearContent);
+                        }
+
+                        // Store the status we have for the other side.
+                        Status(static_cast<uint32_t>(cr));
+                    }
+
+                    // All samples described in the batch are decrypted in this one pass, the
+                    // other side is signalled only once, after the last one.
+                    void DecryptSamples()
+                    {
+                        int32_t result = 0;
+
+                        bool valid = DecryptBatch::Decrypt(Buffer(), BytesWritten(), static_cast<int32_t>(::OCDM::OCDM_INVALID_DECRYPT_BUFFER),
+                            [this](const DecryptBatch::Sample& sample, const uint32_t subSamples[], const uint8_t data[],
+                                uint32_t& clearContentSize, uint8_t*& clearContent) -> int32_t {
+                                return (_mediaKeys->Decrypt(
+                                    _sessionKey,
+                                    _sessionKeyLength,
+                                    subSamples,
+                                    sample.SubSampleCount,
+                                    sample.IV,
+                                    sample.IVLength,
+                                    data,
+                                    sample.Length,
+                                    &clearContentSize,
+                                    &clearContent,
+                                    sample.KeyIdLength,
+                                    (sample.KeyIdLength != 0 ? sample.KeyId : nullptr),
+                                    (sample.InitWithLast15 != 0)));
+                            },
+                            result);
+
+                        if (valid == false) {
+                            TRACE_L1("Invalid batch descriptor in buffer of %d bytes", BytesWritten());
+                            result = static_cast<int32_t>(::OCDM::OCDM_INVALID_DECRYPT_BUFFER);
+                        }
+
+                        // The overall status reflects the first failing sample, if any.
+                        Status(static_cast<uint32_t>(result));
+                    }
+
                 private:
                     CDMi::IMediaKeySession* _mediaKeys;
                     CDMi::IMediaKeySessionExt* _mediaKeysExt;
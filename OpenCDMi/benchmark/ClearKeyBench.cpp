@@ -0,0 +1,219 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Software "clear key" CDMi system used to benchmark the OCDM decrypt path
+// (AccessorOCDM, session DataExchange) on hosts without a real DRM.
+// Not meant to be deployed on devices.
+
+#include "Module.h"
+#include "ClearKeyCipher.h"
+
+#include <interfaces/IDRM.h>
+
+#include <atomic>
+
+namespace CDMi {
+
+class ClearKeyBenchSession : public IMediaKeySession {
+private:
+    ClearKeyBenchSession() = delete;
+    ClearKeyBenchSession(const ClearKeyBenchSession&) = delete;
+    ClearKeyBenchSession& operator=(const ClearKeyBenchSession&) = delete;
+
+public:
+    ClearKeyBenchSession(const uint8_t initData[], const uint32_t initDataLength)
+        : _sessionId()
+        , _initData(initData, initData + initDataLength)
+        , _callback(nullptr)
+        , _licensed(false)
+        , _license()
+        , _map()
+        , _clear()
+    {
+        static std::atomic<uint32_t> sequence(0);
+        _sessionId = "ClearKeyBench-" + std::to_string(++sequence);
+    }
+    virtual ~ClearKeyBenchSession()
+    {
+    }
+
+public:
+    virtual const char* GetSessionId() const override
+    {
+        return (_sessionId.c_str());
+    }
+    virtual const char* GetKeySystem() const override
+    {
+        return ("org.rdk.clearkeybench");
+    }
+    virtual void Run(const IMediaKeySessionCallback* callback) override
+    {
+        _callback = const_cast<IMediaKeySessionCallback*>(callback);
+
+        if (_callback != nullptr) {
+            // The init data is all the benchmark "license server" needs
+            _callback->OnKeyMessage(_initData.data(), static_cast<uint32_t>(_initData.size()), "");
+        }
+    }
+    virtual CDMi_RESULT Load() override
+    {
+        return (CDMi_S_FALSE);
+    }
+    virtual void Update(const uint8_t* response, uint32_t responseLength) override
+    {
+        if (responseLength < sizeof(ClearKeyCipher::License)) {
+            if (_callback != nullptr) {
+                _callback->OnError(0, CDMi_S_FALSE, "Invalid ClearKeyBench license");
+            }
+            return;
+        }
+
+        ::memcpy(&_license, response, sizeof(_license));
+        _licensed = true;
+
+        if ((_callback != nullptr) && (responseLength > sizeof(_license))) {
+            // Key id follows the license, report it usable
+            _callback->OnKeyStatusUpdate("KeyUsable", &response[sizeof(_license)],
+                static_cast<uint8_t>(responseLength - sizeof(_license)));
+            _callback->OnKeyStatusesUpdated();
+        }
+    }
+    virtual CDMi_RESULT Remove() override
+    {
+        _licensed = false;
+        return (CDMi_SUCCESS);
+    }
+    virtual CDMi_RESULT Close() override
+    {
+        return (CDMi_SUCCESS);
+    }
+    virtual std::string GetMetadata() const
+    {
+        return (std::string());
+    }
+    virtual void ResetOutputProtection()
+    {
+    }
+
+    virtual CDMi_RESULT Decrypt(
+        const uint8_t*, // sessionKey
+        uint32_t, // sessionKeyLength
+        const uint32_t* subSampleMapping,
+        uint32_t subSampleCount,
+        const uint8_t* iv,
+        uint32_t ivLength,
+        const uint8_t* data,
+        uint32_t dataLength,
+        uint32_t* clearContentLength,
+        uint8_t** clearContent,
+        const uint8_t, // keyIdLength
+        const uint8_t*, // keyId
+        bool) override // initWithLast15
+    {
+        if (_licensed == false) {
+            return (CDMi_S_FALSE);
+        }
+
+        // Without an explicit map the layout negotiated in the license applies
+        if (subSampleCount == 0) {
+            ClearKeyCipher::SubSamples(dataLength, _license.ClearBytes, _license.EncryptedBytes, _map);
+            subSampleMapping = _map.data();
+            subSampleCount = static_cast<uint32_t>(_map.size());
+        }
+
+        _clear.assign(data, data + dataLength);
+
+        if (ClearKeyCipher::Process(false, static_cast<ClearKeyCipher::Scheme>(_license.Scheme), _license.Key,
+                iv, static_cast<uint8_t>(ivLength), subSampleMapping, subSampleCount, _clear.data(), dataLength) == false) {
+            return (CDMi_S_FALSE);
+        }
+
+        *clearContentLength = dataLength;
+        *clearContent = _clear.data();
+
+        return (CDMi_SUCCESS);
+    }
+
+    virtual CDMi_RESULT ReleaseClearContent(const uint8_t*, uint32_t, const uint32_t, uint8_t*) override
+    {
+        return (CDMi_SUCCESS);
+    }
+
+private:
+    std::string _sessionId;
+    std::vector<uint8_t> _initData;
+    IMediaKeySessionCallback* _callback;
+    bool _licensed;
+    ClearKeyCipher::License _license;
+    std::vector<uint32_t> _map;
+    std::vector<uint8_t> _clear;
+};
+
+class ClearKeyBench : public IMediaKeys {
+private:
+    ClearKeyBench(const ClearKeyBench&) = delete;
+    ClearKeyBench& operator=(const ClearKeyBench&) = delete;
+
+public:
+    ClearKeyBench()
+    {
+    }
+    virtual ~ClearKeyBench()
+    {
+    }
+
+public:
+    virtual CDMi_RESULT CreateMediaKeySession(
+        const std::string&, // keySystem
+        int32_t, // licenseType
+        const char*, // initDataType
+        const uint8_t* initData,
+        uint32_t initDataLength,
+        const uint8_t*, // CDMData
+        uint32_t, // CDMDataLength
+        IMediaKeySession** session) override
+    {
+        *session = new ClearKeyBenchSession(initData, initDataLength);
+        return (CDMi_SUCCESS);
+    }
+
+    virtual CDMi_RESULT SetServerCertificate(const uint8_t*, uint32_t) override
+    {
+        return (CDMi_S_FALSE);
+    }
+
+    virtual CDMi_RESULT DestroyMediaKeySession(IMediaKeySession* session) override
+    {
+        delete session;
+        return (CDMi_SUCCESS);
+    }
+};
+
+static SystemFactoryType<ClearKeyBench> g_instance({ "video/mp4", "audio/mp4", "video/x-h264", "video/x-h265", "audio/mpeg" });
+
+} // namespace CDMi
+
+extern "C" {
+
+CDMi::ISystemFactory* GetSystemFactory()
+{
+    return (&CDMi::g_instance);
+}
+
+}
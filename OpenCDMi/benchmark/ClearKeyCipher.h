@@ -0,0 +1,123 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <openssl/evp.h>
+
+// Software Common Encryption used by the decrypt benchmark, shared by the
+// ClearKeyBench CDMi stand-in (decrypt) and the benchmark client (encrypt).
+namespace ClearKeyCipher {
+
+    enum Scheme : uint8_t {
+        CENC = 0, // AES-128-CTR, counter runs over the protected ranges of a sample
+        CBCS = 1  // AES-128-CBC, 1:9 pattern, IV restarts on every subsample
+    };
+
+    static constexpr uint8_t KeyLength = 16;
+    static constexpr uint8_t BlockLength = 16;
+    static constexpr uint8_t CryptBlocks = 1;
+    static constexpr uint8_t SkipBlocks = 9;
+
+    // License used by the benchmark, sent through the session Update:
+    // the content key and the subsample layout applied when the sample
+    // comes without a subsample map.
+    struct License {
+        uint8_t Key[KeyLength];
+        uint32_t ClearBytes;
+        uint32_t EncryptedBytes;
+        uint8_t Scheme;
+    };
+
+    // Expands a clear/encrypted layout into a subsample map (clear, encrypted pairs)
+    inline void SubSamples(const uint32_t length, const uint32_t clearBytes, const uint32_t encryptedBytes, std::vector<uint32_t>& map)
+    {
+        map.clear();
+        uint32_t offset = 0;
+        while (offset < length) {
+            uint32_t clear = std::min(clearBytes, length - offset);
+            uint32_t encrypted = (encryptedBytes == 0 ? 0 : std::min(encryptedBytes, length - offset - clear));
+            if ((clear == 0) && (encrypted == 0)) {
+                clear = length - offset;
+            }
+            map.push_back(clear);
+            map.push_back(encrypted);
+            offset += clear + encrypted;
+        }
+    }
+
+    // Processes data in place, encrypt or decrypt depending on the direction.
+    inline bool Process(const bool encrypt, const Scheme scheme, const uint8_t key[], const uint8_t iv[], const uint8_t ivLength,
+        const uint32_t* map, const uint32_t mapCount, uint8_t data[], const uint32_t length)
+    {
+        uint8_t fullIV[BlockLength];
+        ::memset(fullIV, 0, sizeof(fullIV));
+        ::memcpy(fullIV, iv, std::min<uint8_t>(ivLength, BlockLength));
+
+        EVP_CIPHER_CTX* context = EVP_CIPHER_CTX_new();
+        if (context == nullptr) {
+            return (false);
+        }
+
+        const EVP_CIPHER* cipher = (scheme == CENC ? EVP_aes_128_ctr() : EVP_aes_128_cbc());
+        bool result = (EVP_CipherInit_ex(context, cipher, nullptr, key, fullIV, encrypt ? 1 : 0) == 1);
+        EVP_CIPHER_CTX_set_padding(context, 0);
+
+        // No map means the whole sample is protected
+        uint32_t whole[2] = { 0, length };
+        if (mapCount == 0) {
+            map = whole;
+        }
+        const uint32_t entries = (mapCount == 0 ? 2 : mapCount);
+
+        uint32_t offset = 0;
+        for (uint32_t index = 0; (result == true) && (index + 1 < entries); index += 2) {
+            offset += map[index];
+            uint32_t protectedLength = std::min(map[index + 1], (offset <= length ? length - offset : 0));
+            uint8_t* range = &data[offset];
+            int written = 0;
+
+            if (scheme == CENC) {
+                result = (EVP_CipherUpdate(context, range, &written, range, protectedLength) == 1);
+            } else {
+                result = (EVP_CipherInit_ex(context, nullptr, nullptr, nullptr, fullIV, -1) == 1);
+
+                // Only full blocks are protected, trailing partial block stays clear
+                uint32_t blocks = protectedLength / BlockLength;
+                for (uint32_t block = 0; (result == true) && (block < blocks); block += (CryptBlocks + SkipBlocks)) {
+                    uint32_t count = std::min<uint32_t>(CryptBlocks, blocks - block);
+                    uint8_t* crypt = &range[block * BlockLength];
+                    result = (EVP_CipherUpdate(context, crypt, &written, crypt, count * BlockLength) == 1);
+                }
+            }
+
+            offset += map[index + 1];
+        }
+
+        EVP_CIPHER_CTX_free(context);
+        return (result);
+    }
+
+} // namespace ClearKeyCipher
@@ -0,0 +1,268 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Drives the batched decrypt path of the session DataExchange worker
+// (DecryptBatch::Decrypt) without a client library able to write batches.
+// Batches are laid out in a plain buffer standing in for the shared memory
+// and decrypted with the ClearKeyCipher, the way the ClearKeyBench system
+// does. Besides the regular batches it feeds malformed ones and a client
+// rewriting the descriptor table while the batch is being decrypted.
+
+#include "../DecryptBatch.h"
+#include "ClearKeyCipher.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace WPEFramework::Plugin;
+
+namespace {
+
+    const uint8_t Key[ClearKeyCipher::KeyLength] = { 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f };
+    const int32_t Invalid = 0x7fff;
+
+    struct Options {
+        uint32_t sampleSize = 16 * 1024;
+        uint16_t batchSize = 16;
+        uint32_t batches = 200;
+        uint32_t clearBytes = 16;
+        uint32_t encryptedBytes = 496;
+    };
+
+    struct Batch {
+        std::vector<uint8_t> buffer;
+        std::vector<std::vector<uint8_t>> clear;
+    };
+
+    // Header | Sample[count] | subsample maps | sample data, encrypted in place
+    void Build(const Options& options, std::mt19937& random, Batch& batch)
+    {
+        std::vector<uint32_t> map;
+        ClearKeyCipher::SubSamples(options.sampleSize, options.clearBytes, options.encryptedBytes, map);
+
+        const uint32_t tableEnd = sizeof(DecryptBatch::Header) + (options.batchSize * sizeof(DecryptBatch::Sample));
+        const uint32_t mapsEnd = tableEnd + (options.batchSize * map.size() * sizeof(uint32_t));
+        const uint32_t length = mapsEnd + (options.batchSize * options.sampleSize);
+
+        batch.buffer.assign(length, 0);
+        batch.clear.resize(options.batchSize);
+
+        DecryptBatch::Header header;
+        ::memcpy(header.Magic, DecryptBatch::Magic, sizeof(header.Magic));
+        header.Version = DecryptBatch::Version;
+        header.Count = options.batchSize;
+        header.Length = length;
+        ::memcpy(batch.buffer.data(), &header, sizeof(header));
+
+        DecryptBatch::Sample* samples = reinterpret_cast<DecryptBatch::Sample*>(batch.buffer.data() + sizeof(DecryptBatch::Header));
+        for (uint16_t index = 0; index < options.batchSize; index++) {
+            DecryptBatch::Sample& sample(samples[index]);
+            ::memset(&sample, 0, sizeof(sample));
+            sample.SubSampleOffset = tableEnd + (index * map.size() * sizeof(uint32_t));
+            sample.SubSampleCount = static_cast<uint16_t>(map.size());
+            sample.Offset = mapsEnd + (index * options.sampleSize);
+            sample.Length = options.sampleSize;
+            sample.IVLength = 8;
+            for (uint8_t& byte : sample.IV) {
+                byte = static_cast<uint8_t>(random());
+            }
+            ::memcpy(batch.buffer.data() + sample.SubSampleOffset, map.data(), map.size() * sizeof(uint32_t));
+
+            std::vector<uint8_t>& clear(batch.clear[index]);
+            clear.resize(options.sampleSize);
+            for (uint8_t& byte : clear) {
+                byte = static_cast<uint8_t>(random());
+            }
+            uint8_t* data = batch.buffer.data() + sample.Offset;
+            ::memcpy(data, clear.data(), clear.size());
+            ClearKeyCipher::Process(true, ClearKeyCipher::CENC, Key, sample.IV, sample.IVLength, map.data(), static_cast<uint32_t>(map.size()), data, sample.Length);
+        }
+    }
+
+    // Stands in for IMediaKeySession::Decrypt of the ClearKeyBench system
+    struct ClearKeyDecrypt {
+        std::vector<uint8_t>& scratch;
+
+        int32_t operator()(const DecryptBatch::Sample& sample, const uint32_t subSamples[], const uint8_t data[],
+            uint32_t& clearContentSize, uint8_t*& clearContent)
+        {
+            scratch.assign(data, data + sample.Length);
+            if (ClearKeyCipher::Process(false, ClearKeyCipher::CENC, Key, sample.IV, sample.IVLength, subSamples, sample.SubSampleCount, scratch.data(), sample.Length) == false) {
+                return (1);
+            }
+            clearContentSize = sample.Length;
+            clearContent = scratch.data();
+            return (0);
+        }
+    };
+
+    bool Verify(const Batch& batch)
+    {
+        const DecryptBatch::Sample* samples = reinterpret_cast<const DecryptBatch::Sample*>(batch.buffer.data() + sizeof(DecryptBatch::Header));
+        for (uint16_t index = 0; index < batch.clear.size(); index++) {
+            const DecryptBatch::Sample& sample(samples[index]);
+            if ((sample.Status != 0) || (sample.Length != batch.clear[index].size())
+                || (::memcmp(batch.buffer.data() + sample.Offset, batch.clear[index].data(), sample.Length) != 0)) {
+                return (false);
+            }
+        }
+        return (true);
+    }
+
+    bool Expect(const bool condition, const char* what)
+    {
+        printf("%-60s %s\n", what, (condition ? "ok" : "FAILED"));
+        return (condition);
+    }
+
+    bool Malformed(const Options& options, std::mt19937& random)
+    {
+        std::vector<uint8_t> scratch;
+        int32_t result = 0;
+        bool passed = true;
+        Batch batch;
+
+        Build(options, random, batch);
+        DecryptBatch::Header* header = reinterpret_cast<DecryptBatch::Header*>(batch.buffer.data());
+        header->Length = static_cast<uint32_t>(batch.buffer.size()) + 1;
+        passed &= Expect(DecryptBatch::Decrypt(batch.buffer.data(), static_cast<uint32_t>(batch.buffer.size()), Invalid, ClearKeyDecrypt{ scratch }, result) == false,
+            "batch longer than the buffer is refused");
+
+        Build(options, random, batch);
+        DecryptBatch::Sample* samples = reinterpret_cast<DecryptBatch::Sample*>(batch.buffer.data() + sizeof(DecryptBatch::Header));
+        samples[options.batchSize - 1].Offset = static_cast<uint32_t>(batch.buffer.size()) - 1;
+        passed &= Expect(DecryptBatch::Decrypt(batch.buffer.data(), static_cast<uint32_t>(batch.buffer.size()), Invalid, ClearKeyDecrypt{ scratch }, result) == false,
+            "sample beyond the batch is refused");
+
+        Build(options, random, batch);
+        samples = reinterpret_cast<DecryptBatch::Sample*>(batch.buffer.data() + sizeof(DecryptBatch::Header));
+        reinterpret_cast<uint32_t*>(batch.buffer.data() + samples[0].SubSampleOffset)[1] = 0xFFFFFF00;
+        passed &= Expect(DecryptBatch::Decrypt(batch.buffer.data(), static_cast<uint32_t>(batch.buffer.size()), Invalid, ClearKeyDecrypt{ scratch }, result) == false,
+            "subsamples larger than their sample are refused");
+
+        return (passed);
+    }
+
+    // The other side rewrites the descriptors and maps of the samples still to come, after the
+    // batch was validated. The worker must keep using what it validated.
+    bool Rewritten(const Options& options, std::mt19937& random)
+    {
+        std::vector<uint8_t> scratch;
+        int32_t result = 0;
+        Batch batch;
+
+        Build(options, random, batch);
+        uint8_t* buffer = batch.buffer.data();
+        const uint32_t length = static_cast<uint32_t>(batch.buffer.size());
+        bool inside = true;
+        uint16_t calls = 0;
+
+        ClearKeyDecrypt clearKey{ scratch };
+        bool valid = DecryptBatch::Decrypt(buffer, length, Invalid,
+            [&](const DecryptBatch::Sample& sample, const uint32_t subSamples[], const uint8_t data[],
+                uint32_t& clearContentSize, uint8_t*& clearContent) -> int32_t {
+                inside = inside && (data >= buffer) && ((data + sample.Length) <= (buffer + length));
+                if (calls++ == 0) {
+                    DecryptBatch::Sample* samples = reinterpret_cast<DecryptBatch::Sample*>(buffer + sizeof(DecryptBatch::Header));
+                    for (uint16_t index = 1; index < options.batchSize; index++) {
+                        uint32_t* map = reinterpret_cast<uint32_t*>(buffer + samples[index].SubSampleOffset);
+                        map[1] = 0xFFFFFF00;
+                        samples[index].Offset = 0xFFFFFF00;
+                        samples[index].Length = 0xFFFFFF00;
+                        samples[index].SubSampleCount = 0xFFFF;
+                    }
+                }
+                return (clearKey(sample, subSamples, data, clearContentSize, clearContent));
+            },
+            result);
+
+        return (Expect(valid && (result == 0) && inside && (calls == options.batchSize) && Verify(batch),
+            "descriptors rewritten during the batch are not used"));
+    }
+
+    void Usage(const char* name)
+    {
+        printf("Usage: %s [options]\n"
+               "  -s <bytes>       sample size (default 16384)\n"
+               "  -b <count>       samples per batch (default 16)\n"
+               "  -n <count>       number of measured batches (default 200)\n"
+               "  -c <bytes>       clear bytes per subsample (default 16)\n"
+               "  -e <bytes>       encrypted bytes per subsample (default 496)\n", name);
+    }
+
+    bool ParseOptions(int argc, char* argv[], Options& options)
+    {
+        int option;
+        while ((option = getopt(argc, argv, "s:b:n:c:e:h")) != -1) {
+            switch (option) {
+            case 's': options.sampleSize = strtoul(optarg, nullptr, 0); break;
+            case 'b': options.batchSize = static_cast<uint16_t>(strtoul(optarg, nullptr, 0)); break;
+            case 'n': options.batches = strtoul(optarg, nullptr, 0); break;
+            case 'c': options.clearBytes = strtoul(optarg, nullptr, 0); break;
+            case 'e': options.encryptedBytes = strtoul(optarg, nullptr, 0); break;
+            default: return (false);
+            }
+        }
+        return ((options.sampleSize > 0) && (options.batchSize > 0) && (options.batches > 0));
+    }
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (ParseOptions(argc, argv, options) == false) {
+        Usage(argv[0]);
+        return (1);
+    }
+
+    std::mt19937 random(1);
+    std::vector<uint8_t> scratch;
+    bool passed = true;
+    double seconds = 0;
+
+    for (uint32_t run = 0; run < options.batches; run++) {
+        Batch batch;
+        int32_t result = 0;
+        Build(options, random, batch);
+
+        auto start = std::chrono::steady_clock::now();
+        bool valid = DecryptBatch::Decrypt(batch.buffer.data(), static_cast<uint32_t>(batch.buffer.size()), Invalid, ClearKeyDecrypt{ scratch }, result);
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if ((valid == false) || (result != 0) || (Verify(batch) == false)) {
+            passed = false;
+        }
+    }
+    passed &= Expect(passed, "batches decrypted and verified");
+
+    passed &= Malformed(options, random);
+    passed &= Rewritten(options, random);
+
+    const double bytes = static_cast<double>(options.batches) * options.batchSize * options.sampleSize;
+    printf("%u batches of %u x %u bytes: %.1f us per batch, %.1f MB/s\n", options.batches, options.batchSize, options.sampleSize,
+        (seconds * 1e6) / options.batches, (bytes / (1024 * 1024)) / seconds);
+
+    return (passed ? 0 : 1);
+}
@@ -0,0 +1,220 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures decrypt latency and throughput through the OCDM plugin
+// (AccessorOCDM -> session DataExchange -> CDMi) using the ClearKeyBench
+// stand-in system. Samples are encrypted locally with the same key, so
+// every decrypted sample can be verified against the original.
+
+#include "Module.h"
+#include "ClearKeyCipher.h"
+
+#include <ocdm/open_cdm.h>
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    // kid 000102030405060708090a0b0c0d0e0f
+    const uint8_t KeyId[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+    const char InitData[] = "{\"kids\":[\"AAECAwQFBgcICQoLDA0ODw\"]}";
+
+    struct Options {
+        std::string keySystem = "org.rdk.clearkeybench";
+        uint32_t sampleSize = 64 * 1024;
+        uint32_t samples = 1000;
+        uint32_t warmup = 20;
+        uint32_t clearBytes = 0;
+        uint32_t encryptedBytes = 0;
+        ClearKeyCipher::Scheme scheme = ClearKeyCipher::CENC;
+        bool verify = false;
+    };
+
+    void Usage(const char* name)
+    {
+        printf("Usage: %s [options]\n"
+               "  -k <keysystem>   key system (default org.rdk.clearkeybench)\n"
+               "  -s <bytes>       sample size (default 65536)\n"
+               "  -n <count>       number of measured samples (default 1000)\n"
+               "  -w <count>       warm up samples, not measured (default 20)\n"
+               "  -c <bytes>       clear bytes per subsample (default 0)\n"
+               "  -e <bytes>       encrypted bytes per subsample (default 0, whole sample)\n"
+               "  -m <cenc|cbcs>   encryption scheme (default cenc)\n"
+               "  -v               verify decrypted samples\n", name);
+    }
+
+    bool ParseOptions(int argc, char* argv[], Options& options)
+    {
+        int option;
+        while ((option = getopt(argc, argv, "k:s:n:w:c:e:m:vh")) != -1) {
+            switch (option) {
+            case 'k': options.keySystem = optarg; break;
+            case 's': options.sampleSize = strtoul(optarg, nullptr, 0); break;
+            case 'n': options.samples = strtoul(optarg, nullptr, 0); break;
+            case 'w': options.warmup = strtoul(optarg, nullptr, 0); break;
+            case 'c': options.clearBytes = strtoul(optarg, nullptr, 0); break;
+            case 'e': options.encryptedBytes = strtoul(optarg, nullptr, 0); break;
+            case 'm': options.scheme = (std::string(optarg) == "cbcs" ? ClearKeyCipher::CBCS : ClearKeyCipher::CENC); break;
+            case 'v': options.verify = true; break;
+            default: return (false);
+            }
+        }
+        return ((options.sampleSize > 0) && (options.samples > 0));
+    }
+
+    double Percentile(const std::vector<double>& sorted, const double percentile)
+    {
+        size_t index = static_cast<size_t>(percentile * (sorted.size() - 1) + 0.5);
+        return (sorted[std::min(index, sorted.size() - 1)]);
+    }
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (ParseOptions(argc, argv, options) == false) {
+        Usage(argv[0]);
+        return (1);
+    }
+
+    OpenCDMSystem* system = opencdm_create_system(options.keySystem.c_str());
+    if (system == nullptr) {
+        fprintf(stderr, "Key system %s is not available\n", options.keySystem.c_str());
+        return (1);
+    }
+
+    OpenCDMSessionCallbacks callbacks;
+    ::memset(&callbacks, 0, sizeof(callbacks));
+
+    OpenCDMSession* session = nullptr;
+    OpenCDMError error = opencdm_construct_session(system, Temporary, "keyids",
+        reinterpret_cast<const uint8_t*>(InitData), sizeof(InitData) - 1, nullptr, 0, &callbacks, nullptr, &session);
+    if ((error != ERROR_NONE) || (session == nullptr)) {
+        fprintf(stderr, "Failed to construct session (%d)\n", error);
+        opencdm_destruct_system(system);
+        return (1);
+    }
+
+    // Synthetic license: random content key and the subsample layout
+    std::mt19937 random(0x0CD1);
+    ClearKeyCipher::License license;
+    for (uint8_t& byte : license.Key) {
+        byte = static_cast<uint8_t>(random());
+    }
+    license.ClearBytes = options.clearBytes;
+    license.EncryptedBytes = options.encryptedBytes;
+    license.Scheme = options.scheme;
+
+    std::vector<uint8_t> response(reinterpret_cast<const uint8_t*>(&license), reinterpret_cast<const uint8_t*>(&license) + sizeof(license));
+    response.insert(response.end(), KeyId, KeyId + sizeof(KeyId));
+    opencdm_session_update(session, response.data(), static_cast<uint16_t>(response.size()));
+
+    // Key status is reported asynchronously
+    uint32_t waited = 0;
+    while ((opencdm_session_status(session, KeyId, sizeof(KeyId)) != Usable) && (waited < 2000)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        waited += 10;
+    }
+    if (opencdm_session_status(session, KeyId, sizeof(KeyId)) != Usable) {
+        fprintf(stderr, "Key did not become usable\n");
+        opencdm_destruct_session(session);
+        opencdm_destruct_system(system);
+        return (1);
+    }
+
+    std::vector<uint32_t> map;
+    ClearKeyCipher::SubSamples(options.sampleSize, options.clearBytes, options.encryptedBytes, map);
+
+    std::vector<uint8_t> clear(options.sampleSize);
+    for (uint8_t& byte : clear) {
+        byte = static_cast<uint8_t>(random());
+    }
+
+    uint8_t iv[8];
+    std::vector<uint8_t> sample;
+    std::vector<double> latencies;
+    latencies.reserve(options.samples);
+    uint32_t failures = 0;
+    uint32_t mismatches = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t index = 0; index < (options.warmup + options.samples); index++) {
+        if (index == options.warmup) {
+            start = std::chrono::steady_clock::now();
+        }
+
+        for (uint8_t& byte : iv) {
+            byte = static_cast<uint8_t>(random());
+        }
+        sample = clear;
+        ClearKeyCipher::Process(true, options.scheme, license.Key, iv, sizeof(iv), map.data(), static_cast<uint32_t>(map.size()), sample.data(), options.sampleSize);
+
+        auto before = std::chrono::steady_clock::now();
+        error = opencdm_session_decrypt(session, sample.data(), options.sampleSize, iv, sizeof(iv), KeyId, sizeof(KeyId), 0);
+        auto after = std::chrono::steady_clock::now();
+
+        if (error != ERROR_NONE) {
+            failures++;
+        } else if ((options.verify == true) && (sample != clear)) {
+            mismatches++;
+        }
+
+        if (index >= options.warmup) {
+            latencies.push_back(std::chrono::duration<double, std::micro>(after - before).count());
+        }
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    opencdm_destruct_session(session);
+    opencdm_destruct_system(system);
+
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0;
+    for (double latency : latencies) {
+        total += latency;
+    }
+
+    // Throughput counts only the time spent in decrypt, the local encryption is excluded
+    double megabytes = (static_cast<double>(options.sampleSize) * options.samples) / (1024.0 * 1024.0);
+
+    printf("key system      : %s\n", options.keySystem.c_str());
+    printf("scheme          : %s\n", options.scheme == ClearKeyCipher::CBCS ? "cbcs" : "cenc");
+    printf("sample size     : %u bytes, %zu subsamples\n", options.sampleSize, map.size() / 2);
+    printf("samples         : %u (+%u warm up), %u failed, %u mismatched\n", options.samples, options.warmup, failures, mismatches);
+    printf("latency (us)    : min %.1f  p50 %.1f  p90 %.1f  p99 %.1f  max %.1f  avg %.1f\n",
+        latencies.front(), Percentile(latencies, 0.50), Percentile(latencies, 0.90), Percentile(latencies, 0.99),
+        latencies.back(), total / latencies.size());
+    printf("throughput      : %.2f MB/s (%.2f MB/s wall clock)\n", megabytes / (total / 1000000.0), megabytes / elapsed);
+
+    WPEFramework::Core::Singleton::Dispose();
+
+    return (((failures == 0) && (mismatches == 0)) ? 0 : 2);
+}
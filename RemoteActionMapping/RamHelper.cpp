@@ -46,6 +46,133 @@ namespace WPEFramework {
 
     namespace Plugin {
 
+        RemoteActionMappingHelper::RemoteActionMappingHelper()
+            : m_rf4ceId(CTRLM_MAIN_NETWORK_ID_INVALID)
+        {
+        }
+
+        //
+        // RIB mirror - the IR-RF Database entries last read from or written to controlMgr.
+        // Reads of a mirrored entry are served locally, and writes of unchanged data are skipped.
+        // An entry is dropped when the remote writes it, when a bus call for it fails, and all
+        // entries of a controller are dropped when it is (re)validated or (re)configured.
+        //
+
+        bool RemoteActionMappingHelper::isMirroredAttribute(int attributeID)
+        {
+            return (attributeID == CTRLM_RCU_RIB_ATTR_ID_IR_RF_DATABASE);
+        }
+
+        uint32_t RemoteActionMappingHelper::ribMirrorKey(int networkID, int deviceID, int attributeID, int index)
+        {
+            return ((uint32_t)(unsigned char)networkID << 24) | ((uint32_t)(unsigned char)deviceID << 16) |
+                   ((uint32_t)(unsigned char)attributeID << 8) | (uint32_t)(unsigned char)index;
+        }
+
+        void RemoteActionMappingHelper::invalidateRIBEntry(int networkID, int deviceID, int attributeID, int index)
+        {
+            if (!isMirroredAttribute(attributeID))
+                return;
+
+            std::lock_guard<std::mutex> guard(m_ribMutex);
+            m_ribMirror.erase(ribMirrorKey(networkID, deviceID, attributeID, index));
+        }
+
+        void RemoteActionMappingHelper::invalidateController(int deviceID)
+        {
+            std::lock_guard<std::mutex> guard(m_ribMutex);
+            for (rib_mirror_t::iterator it = m_ribMirror.begin(); it != m_ribMirror.end(); )
+            {
+                if (((it->first >> 16) & 0xFF) == (uint32_t)(unsigned char)deviceID)
+                    it = m_ribMirror.erase(it);
+                else
+                    ++it;
+            }
+        }
+
+        void RemoteActionMappingHelper::invalidateAll()
+        {
+            std::lock_guard<std::mutex> guard(m_ribMutex);
+            m_ribMirror.clear();
+            m_rf4ceId = CTRLM_MAIN_NETWORK_ID_INVALID;
+        }
+
+        IARM_Result_t RemoteActionMappingHelper::ribRequestGet(ctrlm_rcu_iarm_call_rib_request_t& ribRequest)
+        {
+            if (!isMirroredAttribute(ribRequest.attribute_id))
+                return IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_GET, (void *)&ribRequest, sizeof(ribRequest));
+
+            uint32_t key = ribMirrorKey(ribRequest.network_id, ribRequest.controller_id, ribRequest.attribute_id, ribRequest.attribute_index);
+
+            // The lock is held across the bus call, so that the mirror cannot be overwritten with stale data by a racing request
+            std::unique_lock<std::mutex> guard(m_ribMutex);
+
+            rib_mirror_t::const_iterator it = m_ribMirror.find(key);
+            if (it != m_ribMirror.end())
+            {
+                memset((void*)ribRequest.data, 0, sizeof(ribRequest.data));
+                memcpy((void*)ribRequest.data, it->second.data(), it->second.size());
+                ribRequest.length = (unsigned char)it->second.size();
+                ribRequest.result = CTRLM_IARM_CALL_RESULT_SUCCESS;
+                return IARM_RESULT_SUCCESS;
+            }
+
+            IARM_Result_t res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_GET, (void *)&ribRequest, sizeof(ribRequest));
+            if ((res == IARM_RESULT_SUCCESS) && (ribRequest.result == CTRLM_IARM_CALL_RESULT_SUCCESS) &&
+                (ribRequest.length <= sizeof(ribRequest.data)))
+            {
+                const unsigned char* data = (const unsigned char*)ribRequest.data;
+                m_ribMirror[key].assign(data, data + ribRequest.length);
+            }
+            else if (res != IARM_RESULT_SUCCESS)
+            {
+                // controlMgr may have restarted, neither the network nor the mirrored entries can be trusted anymore
+                guard.unlock();
+                invalidateAll();
+            }
+
+            return res;
+        }
+
+        IARM_Result_t RemoteActionMappingHelper::ribRequestSet(ctrlm_rcu_iarm_call_rib_request_t& ribRequest)
+        {
+            if (!isMirroredAttribute(ribRequest.attribute_id))
+                return IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_SET, (void *)&ribRequest, sizeof(ribRequest));
+
+            uint32_t key = ribMirrorKey(ribRequest.network_id, ribRequest.controller_id, ribRequest.attribute_id, ribRequest.attribute_index);
+            const unsigned char* data = (const unsigned char*)ribRequest.data;
+            size_t length = (ribRequest.length <= sizeof(ribRequest.data)) ? ribRequest.length : sizeof(ribRequest.data);
+
+            std::unique_lock<std::mutex> guard(m_ribMutex);
+
+            rib_mirror_t::const_iterator it = m_ribMirror.find(key);
+            if ((it != m_ribMirror.end()) && (it->second.size() == length) && (memcmp(it->second.data(), data, length) == 0))
+            {
+                LOGINFO("RIB entry unchanged, skipping write - controller_id: %u, attribute_id: 0x%02X, attribute_index: 0x%02X.",
+                        ribRequest.controller_id, (unsigned char)ribRequest.attribute_id, ribRequest.attribute_index);
+                ribRequest.result = CTRLM_IARM_CALL_RESULT_SUCCESS;
+                return IARM_RESULT_SUCCESS;
+            }
+
+            IARM_Result_t res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_SET, (void *)&ribRequest, sizeof(ribRequest));
+            if ((res == IARM_RESULT_SUCCESS) && (ribRequest.result == CTRLM_IARM_CALL_RESULT_SUCCESS))
+            {
+                m_ribMirror[key].assign(data, data + length);
+            }
+            else
+            {
+                // The entry is in an unknown state now, and all of them are when controlMgr did not answer
+                m_ribMirror.erase(key);
+                if (res != IARM_RESULT_SUCCESS)
+                {
+                    guard.unlock();
+                    invalidateAll();
+                }
+            }
+
+            return res;
+        }
+
         //
         // IARM-level RemoteActionMappingHelper Methods
         //
@@ -56,6 +183,12 @@ namespace WPEFramework {
             ctrlm_network_id_t              rf4ceId = CTRLM_MAIN_NETWORK_ID_INVALID;
             IARM_Result_t                   res;
 
+            {
+                std::lock_guard<std::mutex> guard(m_ribMutex);
+                if (m_rf4ceId != CTRLM_MAIN_NETWORK_ID_INVALID)
+                    return m_rf4ceId;
+            }
+
             memset((void*)&status, 0, sizeof(status));
             status.api_revision = CTRLM_MAIN_IARM_BUS_API_REVISION;
             res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_MAIN_IARM_CALL_STATUS_GET, (void*)&status, sizeof(status));
@@ -83,6 +216,12 @@ namespace WPEFramework {
                 }
             }
 
+            if (rf4ceId != CTRLM_MAIN_NETWORK_ID_INVALID)
+            {
+                std::lock_guard<std::mutex> guard(m_ribMutex);
+                m_rf4ceId = rf4ceId;
+            }
+
             return rf4ceId;
         }
 
@@ -647,7 +786,7 @@ namespace WPEFramework {
                     (unsigned char)ribRequest.data[16], (unsigned char)ribRequest.data[17], (unsigned char)ribRequest.data[18], (unsigned char)ribRequest.data[19]);
 
             // Do the direct write to the IR-RF DB RIB entry.
-            res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_SET, (void *)&ribRequest, sizeof(ribRequest));
+            res = ribRequestSet(ribRequest);
             if (res == IARM_RESULT_SUCCESS)
             {
                 LOGWARN("Set RIB IR-RF DB Request: controller_id: %u, network_id: 0x%02X, "
@@ -718,7 +857,7 @@ namespace WPEFramework {
             ribRequest.length           = CTRLM_RCU_MAX_RIB_ATTRIBUTE_SIZE;
 
             // Read the RIB IRRFDB entry for the specified rfKey
-            res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_GET, (void *)&ribRequest, sizeof(ribRequest));
+            res = ribRequestGet(ribRequest);
             if (res == IARM_RESULT_SUCCESS)
             {
                 LOGWARN("Get RIB IR-RF DB Request: controller_id: %u, network_id: 0x%02X, "
@@ -861,7 +1000,7 @@ namespace WPEFramework {
             ribRequest.data[0]          = flags;
 
             // Direct write to the RIB IRRFDB entry for this RF key.
-            res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_SET, (void *)&ribRequest, sizeof(ribRequest));
+            res = ribRequestSet(ribRequest);
             if (res == IARM_RESULT_SUCCESS)
             {
                 LOGWARN("Wrote RIB IR-RF Database: controller_id: %u, network_id: 0x%02X, "
@@ -1144,7 +1283,7 @@ namespace WPEFramework {
             memcpy(bytePtr, data, dataSize);
 
             // Do the direct write to the IR-RF DB RIB entry.
-            res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_SET, (void *)&ribRequest, sizeof(ribRequest));
+            res = ribRequestSet(ribRequest);
             if (res == IARM_RESULT_SUCCESS)
             {
                 LOGWARN("Set RIB IR-RF DB Request: controller_id: %u, network_id: 0x%02X, "
@@ -1213,7 +1352,7 @@ namespace WPEFramework {
             ribRequest.data[0]          = flags;
 
             // Direct write to the RIB IRRFDB entry for this RF key.
-            res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_SET, (void *)&ribRequest, sizeof(ribRequest));
+            res = ribRequestSet(ribRequest);
             if (res == IARM_RESULT_SUCCESS)
             {
                 LOGWARN("Wrote RIB IR-RF Database: controller_id: %u, network_id: 0x%02X, "
@@ -1269,7 +1408,7 @@ namespace WPEFramework {
             ribRequest.length           = 1;
 
             // Read the RIB IRRF Status to get the current Flags setting
-            res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_GET, (void *)&ribRequest, sizeof(ribRequest));
+            res = ribRequestGet(ribRequest);
             if (res == IARM_RESULT_SUCCESS)
             {
                 LOGWARN("Current RIB IR-RF Status: controller_id: %u, network_id: 0x%02X, "
@@ -1290,7 +1429,7 @@ namespace WPEFramework {
                             ribRequest.length = 1;
                         }
 
-                        res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_SET, (void *)&ribRequest, sizeof(ribRequest));
+                        res = ribRequestSet(ribRequest);
                         if (res == IARM_RESULT_SUCCESS)
                         {
                             if (ribRequest.result == CTRLM_IARM_CALL_RESULT_SUCCESS)
@@ -1368,7 +1507,7 @@ namespace WPEFramework {
             ribRequest.length           = CTRLM_RCU_RIB_ATTR_LEN_TARGET_IRDB_STATUS;
 
             // Read the entire RIB Target IRDB Status attribute, to get the current Flags and  TV and AVR strings.
-            res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_GET, (void *)&ribRequest, sizeof(ribRequest));
+            res = ribRequestGet(ribRequest);
             if (res == IARM_RESULT_SUCCESS)
             {
                 LOGWARN("Current RIB Target IRDB Status: controller_id: %u, network_id: 0x%02X, "
@@ -1417,7 +1556,7 @@ namespace WPEFramework {
                     ribRequest.data[0] = flags;
                     // Write the Target IRDB Status attribute back to the RIB.
                     ribRequest.length = CTRLM_RCU_RIB_ATTR_LEN_TARGET_IRDB_STATUS;
-                    res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_SET, (void *)&ribRequest, sizeof(ribRequest));
+                    res = ribRequestSet(ribRequest);
                     if (res == IARM_RESULT_SUCCESS)
                     {
                         if (ribRequest.result == CTRLM_IARM_CALL_RESULT_SUCCESS)
@@ -1504,7 +1643,7 @@ namespace WPEFramework {
             ribRequest.length           = 1;
 
             // Read the RIB IRRF Status to get the current Flags setting
-            res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_GET, (void *)&ribRequest, sizeof(ribRequest));
+            res = ribRequestGet(ribRequest);
             if (res == IARM_RESULT_SUCCESS)
             {
                 LOGWARN("Current RIB IR-RF Status: controller_id: %u, network_id: 0x%02X, "
@@ -1525,7 +1664,7 @@ namespace WPEFramework {
                             ribRequest.length = 1;
                         }
 
-                        res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_SET, (void *)&ribRequest, sizeof(ribRequest));
+                        res = ribRequestSet(ribRequest);
                         if (res == IARM_RESULT_SUCCESS)
                         {
                             if (ribRequest.result == CTRLM_IARM_CALL_RESULT_SUCCESS)
@@ -1595,7 +1734,7 @@ namespace WPEFramework {
             ribRequest.length           = CTRLM_RCU_RIB_ATTR_LEN_CONTROLLER_IRDB_STATUS;
 
             // Read the entire RIB Controller IRDB Status attribute, to get the current TV and AVR Load Status bytes.
-            res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_GET, (void *)&ribRequest, sizeof(ribRequest));
+            res = ribRequestGet(ribRequest);
             if (res == IARM_RESULT_SUCCESS)
             {
                 LOGWARN("Current RIB Controller IRDB Status: controller_id: %u, network_id: 0x%02X, "
@@ -1682,7 +1821,7 @@ namespace WPEFramework {
             ribRequest.length           = 1;
 
             // Read the RIB IRRF Status to get the current Flags setting
-            res = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_CALL_RIB_REQUEST_GET, (void *)&ribRequest, sizeof(ribRequest));
+            res = ribRequestGet(ribRequest);
             if (res == IARM_RESULT_SUCCESS)
             {
                 LOGWARN("Current RIB IR-RF Status: controller_id: %u, network_id: 0x%02X, "
@@ -25,6 +25,8 @@
 #include "ctrlm_ipc.h"
 #include "ctrlm_ipc_rcu.h"
 
+#include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -277,6 +279,8 @@ namespace WPEFramework {
         class RemoteActionMappingHelper
         {
         public:
+            RemoteActionMappingHelper();
+
             int getLastUsedDeviceID(std::string& remoteType, bool& bFiveDigitCodeSet, bool& bFiveDigitCodeSupported);
             bool getControllerByID(int deviceID, std::string& remoteType, bool& pbFiveDigitCodeSet, bool& pbFiveDigitCodeSupported);
             bool setKeyActionMap(int deviceID, int keymapType, keyActionMap& actionMap, const KeyGroupSrcInfo& srcInfo);
@@ -296,11 +300,30 @@ namespace WPEFramework {
             bool setDevicePower(int deviceID, int keymapType, keyActionMap& actionMap);
             bool clearDevicePower(int deviceID, int keymapType, int rfKeyCode);
 
+            // RIB mirror invalidation, driven by controlMgr events. invalidateAll() is also called
+            // when a RIB bus call fails, controlMgr may have restarted with other contents.
+            void invalidateRIBEntry(int networkID, int deviceID, int attributeID, int index);
+            void invalidateController(int deviceID);
+            void invalidateAll();
+
         private:
+            // Local copy of the IR-RF Database RIB entries, keyed by network, controller, attribute and index
+            typedef std::map<uint32_t, byte_vector_t> rib_mirror_t;
+
+            static bool isMirroredAttribute(int attributeID);
+            static uint32_t ribMirrorKey(int networkID, int deviceID, int attributeID, int index);
+
+            IARM_Result_t ribRequestGet(ctrlm_rcu_iarm_call_rib_request_t& ribRequest);
+            IARM_Result_t ribRequestSet(ctrlm_rcu_iarm_call_rib_request_t& ribRequest);
+
             ctrlm_network_id_t getRf4ceNetworkID(void);
             bool getRf4ceBindRemotes(rf4ceBindRemotes_t* bindRemotes);
             bool setRIBDevicePower(int deviceID, int keymapType, int rfKeyCode, byte_vector_t& irData);
             bool clearRIBDevicePower(int deviceID, int keymapType, int rfKeyCode);
+
+            std::mutex          m_ribMutex;
+            rib_mirror_t        m_ribMirror;
+            ctrlm_network_id_t  m_rf4ceId;
         };
 
     } // namespace Plugin
@@ -145,6 +145,8 @@ namespace WPEFramework {
             {
                 IARM_Result_t res;
                 IARM_CHECK( IARM_Bus_RegisterEventHandler(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_EVENT_RIB_ACCESS_CONTROLLER, ramEventHandler) );
+                IARM_CHECK( IARM_Bus_RegisterEventHandler(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_EVENT_VALIDATION_END, ramEventHandler) );
+                IARM_CHECK( IARM_Bus_RegisterEventHandler(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_EVENT_CONFIGURATION_COMPLETE, ramEventHandler) );
             }
         }
 
@@ -156,6 +158,8 @@ namespace WPEFramework {
             {
                 IARM_Result_t res;
                 IARM_CHECK( IARM_Bus_RemoveEventHandler(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_EVENT_RIB_ACCESS_CONTROLLER, ramEventHandler) );
+                IARM_CHECK( IARM_Bus_RemoveEventHandler(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_EVENT_VALIDATION_END, ramEventHandler) );
+                IARM_CHECK( IARM_Bus_RemoveEventHandler(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_RCU_IARM_EVENT_CONFIGURATION_COMPLETE, ramEventHandler) );
             }
         }
 
@@ -188,6 +192,12 @@ namespace WPEFramework {
                             LOGINFO("RIB Access Event: network_id: %u, controller_id: %d, identifier: 0x%02X, index: 0x%02X, access_type: %s.",
                                     networkId, remoteId, attrId, index, ((accessType > 1) ? "INVALID" : ((accessType == 0) ? "READ" : "WRITE")));
 
+                            // The remote changed an entry behind our back - drop our copy of it
+                            if (accessType == CTRLM_ACCESS_TYPE_WRITE)
+                            {
+                                m_helper.invalidateRIBEntry(networkId, remoteId, attrId, index);
+                            }
+
                             std::lock_guard<std::mutex> guard(m_stateMutex);
 
                             if (m_ramsOperatingMode == RAMS_OP_MODE_IRRF_DATABASE)
@@ -379,6 +389,33 @@ namespace WPEFramework {
                         LOGERR("ERROR - event data is NULL!");
                     }
                 }
+                else if (eventId == CTRLM_RCU_IARM_EVENT_VALIDATION_END)
+                {
+                    if (data != NULL)
+                    {
+                        ctrlm_rcu_iarm_event_validation_end_t *valEnd = (ctrlm_rcu_iarm_event_validation_end_t*)data;
+                        LOGINFO("VALIDATION_END - controller_id: %d, result: %d.", (int)valEnd->controller_id, (int)valEnd->result);
+                        // A newly (re)bound remote has its own IR-RF Database contents
+                        m_helper.invalidateController((int)valEnd->controller_id);
+                    }
+                    else
+                    {
+                        LOGERR("ERROR - event data is NULL!");
+                    }
+                }
+                else if (eventId == CTRLM_RCU_IARM_EVENT_CONFIGURATION_COMPLETE)
+                {
+                    if (data != NULL)
+                    {
+                        ctrlm_rcu_iarm_event_configuration_complete_t *cfgComplete = (ctrlm_rcu_iarm_event_configuration_complete_t*)data;
+                        LOGINFO("CONFIGURATION_COMPLETE - controller_id: %d, result: %d.", (int)cfgComplete->controller_id, (int)cfgComplete->result);
+                        m_helper.invalidateController((int)cfgComplete->controller_id);
+                    }
+                    else
+                    {
+                        LOGERR("ERROR - event data is NULL!");
+                    }
+                }
                 else
                 {
                     LOGERR("UNKNOWN controlMgr Event: eventId: %d", (int)eventId);
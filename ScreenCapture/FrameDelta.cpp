@@ -0,0 +1,196 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "FrameDelta.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#define FRAME_DELTA_MULTIPLIER 0x9E3779B1u
+
+namespace
+{
+    const uint32_t seeds[4] = { 0x243F6A88u, 0x85A308D3u, 0x13198A2Eu, 0x03707344u };
+
+    /* Bytes of a tile row, the last tile of a row may be narrower */
+    inline size_t segmentBytes(int width, int tx)
+    {
+        return (size_t)std::min(FRAME_DELTA_TILE_SIZE, width - tx * FRAME_DELTA_TILE_SIZE) * 4;
+    }
+
+    inline void initHashes(FrameDelta::TileHash *hashes, int count)
+    {
+        for(int i = 0; i < count; i++)
+            memcpy(hashes[i].lane, seeds, sizeof(seeds));
+    }
+
+    inline void scalarStep(uint32_t *s, const unsigned char *block)
+    {
+        uint32_t words[4];
+        memcpy(words, block, sizeof(words));
+
+        for(int i = 0; i < 4; i++)
+        {
+            uint32_t v = (s[i] ^ words[i]) * FRAME_DELTA_MULTIPLIER;
+            s[i] = v ^ (v >> 15);
+        }
+    }
+
+    void scalarSegment(uint32_t *s, const unsigned char *p, size_t length)
+    {
+        size_t i = 0;
+
+        for(; i + 16 <= length; i += 16)
+            scalarStep(s, p + i);
+
+        if(i < length)
+        {
+            unsigned char tail[16] = { 0 };
+            memcpy(tail, p + i, length - i);
+            scalarStep(s, tail);
+        }
+    }
+
+#if defined(__SSE2__)
+    /* SSE2 has no 32 bit low multiply, do the even and odd lanes separately */
+    inline __m128i mullo32(__m128i a, __m128i b)
+    {
+        __m128i even = _mm_mul_epu32(a, b);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+
+    void vectorSegment(uint32_t *lanes, const unsigned char *p, size_t length)
+    {
+        const __m128i k = _mm_set1_epi32((int)FRAME_DELTA_MULTIPLIER);
+        __m128i s = _mm_loadu_si128((const __m128i*)lanes);
+        size_t i = 0;
+
+        for(; i + 16 <= length; i += 16)
+        {
+            s = mullo32(_mm_xor_si128(s, _mm_loadu_si128((const __m128i*)(p + i))), k);
+            s = _mm_xor_si128(s, _mm_srli_epi32(s, 15));
+        }
+
+        _mm_storeu_si128((__m128i*)lanes, s);
+
+        if(i < length)
+            scalarSegment(lanes, p + i, length - i);
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    void vectorSegment(uint32_t *lanes, const unsigned char *p, size_t length)
+    {
+        const uint32x4_t k = vdupq_n_u32(FRAME_DELTA_MULTIPLIER);
+        uint32x4_t s = vld1q_u32(lanes);
+        size_t i = 0;
+
+        for(; i + 16 <= length; i += 16)
+        {
+            s = vmulq_u32(veorq_u32(s, vreinterpretq_u32_u8(vld1q_u8(p + i))), k);
+            s = veorq_u32(s, vshrq_n_u32(s, 15));
+        }
+
+        vst1q_u32(lanes, s);
+
+        if(i < length)
+            scalarSegment(lanes, p + i, length - i);
+    }
+#else
+    void vectorSegment(uint32_t *lanes, const unsigned char *p, size_t length)
+    {
+        scalarSegment(lanes, p, length);
+    }
+#endif
+
+    /* Rows are walked top to bottom so the frame is read sequentially, each row feeds the tiles it crosses */
+    template<void (*Segment)(uint32_t*, const unsigned char*, size_t)>
+    void hash(const unsigned char *rgba, int width, int height, int stride, std::vector<FrameDelta::TileHash> &hashes)
+    {
+        const int tileColumns = FrameDelta::columns(width);
+
+        hashes.resize((size_t)tileColumns * FrameDelta::rows(height));
+        initHashes(hashes.empty() ? NULL : &hashes[0], (int)hashes.size());
+
+        for(int y = 0; y < height; y++)
+        {
+            const unsigned char *row = rgba + (size_t)y * stride;
+            FrameDelta::TileHash *tileRow = &hashes[(size_t)(y / FRAME_DELTA_TILE_SIZE) * tileColumns];
+
+            for(int tx = 0; tx < tileColumns; tx++)
+                Segment(tileRow[tx].lane, row + (size_t)tx * FRAME_DELTA_TILE_SIZE * 4, segmentBytes(width, tx));
+        }
+    }
+}
+
+void FrameDelta::hashTiles(const unsigned char *rgba, int width, int height, int stride, std::vector<TileHash> &hashes)
+{
+    hash<vectorSegment>(rgba, width, height, stride, hashes);
+}
+
+void FrameDelta::hashTilesScalar(const unsigned char *rgba, int width, int height, int stride, std::vector<TileHash> &hashes)
+{
+    hash<scalarSegment>(rgba, width, height, stride, hashes);
+}
+
+void FrameDelta::changedTiles(const std::vector<TileHash> &previous, const std::vector<TileHash> &current, std::vector<int> &changed)
+{
+    changed.clear();
+
+    for(size_t i = 0; i < current.size(); i++)
+    {
+        if(i >= previous.size() || previous[i] != current[i])
+            changed.push_back((int)i);
+    }
+}
+
+void FrameDelta::packTiles(const unsigned char *rgba, int width, int height, int stride, const std::vector<int> &tiles,
+    int atlasColumns, std::vector<unsigned char> &atlas, int &atlasWidth, int &atlasHeight)
+{
+    const int tileColumns = columns(width);
+    const size_t tileRowBytes = (size_t)FRAME_DELTA_TILE_SIZE * 4;
+
+    atlasColumns = std::max(1, std::min(atlasColumns, (int)tiles.size()));
+    atlasWidth = atlasColumns * FRAME_DELTA_TILE_SIZE;
+    atlasHeight = (int)((tiles.size() + atlasColumns - 1) / atlasColumns) * FRAME_DELTA_TILE_SIZE;
+
+    const size_t atlasStride = (size_t)atlasWidth * 4;
+    atlas.assign(atlasStride * atlasHeight, 0);
+
+    for(size_t i = 0; i < tiles.size(); i++)
+    {
+        int tx = tiles[i] % tileColumns;
+        int ty = tiles[i] / tileColumns;
+        int x0 = tx * FRAME_DELTA_TILE_SIZE;
+        int y0 = ty * FRAME_DELTA_TILE_SIZE;
+        int rows = std::min(FRAME_DELTA_TILE_SIZE, height - y0);
+        size_t bytes = segmentBytes(width, tx);
+
+        unsigned char *out = &atlas[((i / atlasColumns) * FRAME_DELTA_TILE_SIZE) * atlasStride + (i % atlasColumns) * tileRowBytes];
+
+        for(int y = 0; y < rows; y++)
+            memcpy(out + y * atlasStride, rgba + (size_t)(y0 + y) * stride + (size_t)x0 * 4, bytes);
+    }
+}
@@ -0,0 +1,70 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+
+#define FRAME_DELTA_TILE_SIZE 64
+
+/*
+ * Change detection between RGBA frames on a grid of square tiles.
+ *
+ * A tile hash is four independent 32 bit lanes, every lane runs over its
+ * words of the tile as s = xorshift((s ^ word) * K). Each step is a
+ * bijection of the state, so a change confined to a single 16 byte block
+ * of a tile always changes its hash. The lanes map onto SSE2 / NEON
+ * registers, the scalar version computes the same values.
+ */
+class FrameDelta
+{
+public:
+    struct TileHash
+    {
+        uint32_t lane[4];
+
+        bool operator==(const TileHash &other) const
+        {
+            return lane[0] == other.lane[0] && lane[1] == other.lane[1] && lane[2] == other.lane[2] && lane[3] == other.lane[3];
+        }
+        bool operator!=(const TileHash &other) const { return !(*this == other); }
+    };
+
+    static int columns(int width) { return (width + FRAME_DELTA_TILE_SIZE - 1) / FRAME_DELTA_TILE_SIZE; }
+    static int rows(int height) { return (height + FRAME_DELTA_TILE_SIZE - 1) / FRAME_DELTA_TILE_SIZE; }
+
+    /* One hash per tile, row major */
+    static void hashTiles(const unsigned char *rgba, int width, int height, int stride, std::vector<TileHash> &hashes);
+    static void hashTilesScalar(const unsigned char *rgba, int width, int height, int stride, std::vector<TileHash> &hashes);
+
+    /* Indices of the tiles that differ, both hash sets must come from frames of the same size */
+    static void changedTiles(const std::vector<TileHash> &previous, const std::vector<TileHash> &current, std::vector<int> &changed);
+
+    /*
+     * Copies the given tiles into an atlas of 'atlasColumns' tiles per row, in order.
+     * Tiles cut by the right or bottom edge of the frame are padded with transparent black.
+     */
+    static void packTiles(const unsigned char *rgba, int width, int height, int stride, const std::vector<int> &tiles,
+        int atlasColumns, std::vector<unsigned char> &atlas, int &atlasWidth, int &atlasHeight);
+
+private:
+    FrameDelta() = delete;
+};
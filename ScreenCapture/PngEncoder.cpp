@@ -0,0 +1,411 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "PngEncoder.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#define PNG_BYTES_PER_PIXEL 4
+
+namespace
+{
+    struct Stripe
+    {
+        Stripe() : adler(0), length(0), done(false), ok(false) { }
+
+        std::vector<unsigned char> data;    /* Raw deflate, sync flushed (finished for the last stripe) */
+        uLong adler;                        /* Of the filtered rows */
+        uLong length;                       /* Filtered bytes */
+        bool done;
+        bool ok;
+    };
+
+    void putUint32(unsigned char *p, uint32_t value)
+    {
+        p[0] = (unsigned char)(value >> 24);
+        p[1] = (unsigned char)(value >> 16);
+        p[2] = (unsigned char)(value >> 8);
+        p[3] = (unsigned char)(value);
+    }
+
+    bool writeChunk(const PngEncoder::Writer &writer, const char *type, const unsigned char *prefix, size_t prefixLength,
+        const unsigned char *data, size_t length, const unsigned char *suffix, size_t suffixLength)
+    {
+        unsigned char header[8];
+        unsigned char crc[4];
+        uLong sum = crc32(0, (const Bytef*)type, 4);
+
+        putUint32(header, (uint32_t)(prefixLength + length + suffixLength));
+        memcpy(header + 4, type, 4);
+
+        if(prefixLength)
+            sum = crc32(sum, prefix, prefixLength);
+        if(length)
+            sum = crc32(sum, data, length);
+        if(suffixLength)
+            sum = crc32(sum, suffix, suffixLength);
+        putUint32(crc, (uint32_t)sum);
+
+        return writer(header, sizeof(header))
+            && (!prefixLength || writer(prefix, prefixLength))
+            && (!length || writer(data, length))
+            && (!suffixLength || writer(suffix, suffixLength))
+            && writer(crc, sizeof(crc));
+    }
+
+    inline unsigned char paeth(int a, int b, int c)
+    {
+        int p = a + b - c;
+        int pa = abs(p - a);
+        int pb = abs(p - b);
+        int pc = abs(p - c);
+
+        if(pa <= pb && pa <= pc)
+            return (unsigned char)a;
+        if(pb <= pc)
+            return (unsigned char)b;
+        return (unsigned char)c;
+    }
+
+    /* Writes the filter type byte followed by the filtered row, 'prev' is NULL for the first row of the image */
+    void filterRow(PngEncoder::Filter filter, const unsigned char *row, const unsigned char *prev, size_t rowBytes, unsigned char *out)
+    {
+        const int bpp = PNG_BYTES_PER_PIXEL;
+        size_t i;
+
+        /* Above the first row is a row of zeros: up is none, average and paeth only look left */
+        if(!prev)
+        {
+            if(filter == PngEncoder::FILTER_UP)
+                filter = PngEncoder::FILTER_NONE;
+            else if(filter == PngEncoder::FILTER_PAETH)
+                filter = PngEncoder::FILTER_SUB;
+        }
+
+        out[0] = (unsigned char)filter;
+        out++;
+
+        switch(filter)
+        {
+            case PngEncoder::FILTER_NONE:
+                memcpy(out, row, rowBytes);
+                break;
+            case PngEncoder::FILTER_SUB:
+                memcpy(out, row, bpp);
+                for(i = bpp; i < rowBytes; i++)
+                    out[i] = row[i] - row[i - bpp];
+                break;
+            case PngEncoder::FILTER_UP:
+                for(i = 0; i < rowBytes; i++)
+                    out[i] = row[i] - prev[i];
+                break;
+            case PngEncoder::FILTER_AVERAGE:
+                if(prev)
+                {
+                    for(i = 0; i < bpp; i++)
+                        out[i] = row[i] - (prev[i] >> 1);
+                    for(; i < rowBytes; i++)
+                        out[i] = row[i] - ((row[i - bpp] + prev[i]) >> 1);
+                }
+                else
+                {
+                    memcpy(out, row, bpp);
+                    for(i = bpp; i < rowBytes; i++)
+                        out[i] = row[i] - (row[i - bpp] >> 1);
+                }
+                break;
+            case PngEncoder::FILTER_PAETH:
+                for(i = 0; i < bpp; i++)
+                    out[i] = row[i] - prev[i];
+                for(; i < rowBytes; i++)
+                    out[i] = row[i] - paeth(row[i - bpp], prev[i], prev[i - bpp]);
+                break;
+            default:
+                break;
+        }
+    }
+
+    size_t rowCost(const unsigned char *filtered, size_t rowBytes)
+    {
+        size_t sum = 0;
+        for(size_t i = 0; i < rowBytes; i++)
+            sum += (size_t)abs((signed char)filtered[i]);
+        return sum;
+    }
+
+    bool compressStripe(const unsigned char *rgba, int width, int stride, int first, int rows, bool last,
+        const PngEncoder::Options &options, Stripe &stripe)
+    {
+        const size_t rowBytes = (size_t)width * PNG_BYTES_PER_PIXEL;
+        std::vector<unsigned char> filtered(rowBytes + 1);
+        std::vector<unsigned char> candidate;
+        z_stream z;
+
+        memset(&z, 0, sizeof(z));
+
+        /* Raw deflate, the zlib header and trailer are written once for the whole image */
+        if(deflateInit2(&z, options.level, Z_DEFLATED, -15, 8,
+            options.filter == PngEncoder::FILTER_NONE ? Z_DEFAULT_STRATEGY : Z_FILTERED) != Z_OK)
+            return false;
+
+        stripe.length = (uLong)rows * (rowBytes + 1);
+        stripe.adler = adler32(0, NULL, 0);
+        stripe.data.resize(deflateBound(&z, stripe.length) + 16);
+
+        z.next_out = &stripe.data[0];
+        z.avail_out = (uInt)stripe.data.size();
+
+        if(options.filter == PngEncoder::FILTER_ADAPTIVE)
+            candidate.resize(rowBytes + 1);
+
+        bool ok = true;
+
+        for(int y = first; y < first + rows && ok; y++)
+        {
+            const unsigned char *row = rgba + (size_t)y * stride;
+            const unsigned char *prev = y ? row - stride : NULL;
+
+            if(options.filter == PngEncoder::FILTER_ADAPTIVE)
+            {
+                size_t best = (size_t)-1;
+                for(int f = PngEncoder::FILTER_NONE; f <= PngEncoder::FILTER_PAETH; f++)
+                {
+                    filterRow((PngEncoder::Filter)f, row, prev, rowBytes, &candidate[0]);
+                    size_t cost = rowCost(&candidate[1], rowBytes);
+                    if(cost < best)
+                    {
+                        best = cost;
+                        filtered.swap(candidate);
+                    }
+                }
+            }
+            else
+            {
+                filterRow(options.filter, row, prev, rowBytes, &filtered[0]);
+            }
+
+            stripe.adler = adler32(stripe.adler, &filtered[0], (uInt)filtered.size());
+
+            int flush = Z_NO_FLUSH;
+            if(y == first + rows - 1)
+                flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+
+            z.next_in = &filtered[0];
+            z.avail_in = (uInt)filtered.size();
+
+            do
+            {
+                if(z.avail_out == 0)
+                {
+                    size_t used = stripe.data.size();
+                    stripe.data.resize(used * 2);
+                    z.next_out = &stripe.data[used];
+                    z.avail_out = (uInt)(stripe.data.size() - used);
+                }
+
+                int ret = deflate(&z, flush);
+                if(ret == Z_STREAM_ERROR)
+                {
+                    ok = false;
+                    break;
+                }
+            } while(z.avail_in > 0 || z.avail_out == 0);
+        }
+
+        stripe.data.resize(stripe.data.size() - z.avail_out);
+        deflateEnd(&z);
+
+        return ok;
+    }
+}
+
+bool PngEncoder::parseFilter(const std::string &name, Filter &filter)
+{
+    static const char *names[] = { "none", "sub", "up", "average", "paeth", "adaptive" };
+
+    for(size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        if(name == names[i])
+        {
+            filter = (Filter)i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void PngEncoder::swapRedBlue(unsigned char *data, size_t pixels)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    /* x86 is little endian, a pixel is 0xAARRGGBB: swap bytes 0 and 2 of every 32 bit word */
+    const __m128i keep = _mm_set1_epi32(0xFF00FF00);
+    const __m128i low = _mm_set1_epi32(0x000000FF);
+    for(; i + 4 <= pixels; i += 4)
+    {
+        __m128i *p = (__m128i*)(data + i * PNG_BYTES_PER_PIXEL);
+        __m128i v = _mm_loadu_si128(p);
+        __m128i r = _mm_and_si128(_mm_srli_epi32(v, 16), low);
+        __m128i b = _mm_slli_epi32(_mm_and_si128(v, low), 16);
+        _mm_storeu_si128(p, _mm_or_si128(_mm_and_si128(v, keep), _mm_or_si128(r, b)));
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for(; i + 16 <= pixels; i += 16)
+    {
+        unsigned char *p = data + i * PNG_BYTES_PER_PIXEL;
+        uint8x16x4_t v = vld4q_u8(p);
+        uint8x16_t t = v.val[0];
+        v.val[0] = v.val[2];
+        v.val[2] = t;
+        vst4q_u8(p, v);
+    }
+#endif
+
+    for(; i < pixels; i++)
+    {
+        unsigned char *p = data + i * PNG_BYTES_PER_PIXEL;
+        std::swap(p[0], p[2]);
+    }
+}
+
+bool PngEncoder::encode(const unsigned char *rgba, int width, int height, int stride, const Options &options, const Writer &writer)
+{
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+    if(!rgba || width <= 0 || height <= 0 || stride < width * PNG_BYTES_PER_PIXEL)
+        return false;
+
+    if(options.level < 0 || options.level > 9 || options.filter < FILTER_NONE || options.filter > FILTER_ADAPTIVE)
+        return false;
+
+    unsigned char ihdr[13];
+    putUint32(ihdr, (uint32_t)width);
+    putUint32(ihdr + 4, (uint32_t)height);
+    ihdr[8] = 8;        /* bit depth */
+    ihdr[9] = 6;        /* colour type RGBA */
+    ihdr[10] = 0;       /* deflate */
+    ihdr[11] = 0;       /* adaptive filtering */
+    ihdr[12] = 0;       /* no interlace */
+
+    if(!writer(signature, sizeof(signature)) || !writeChunk(writer, "IHDR", NULL, 0, ihdr, sizeof(ihdr), NULL, 0))
+        return false;
+
+    const int stripeCount = (height + PNG_ENCODER_STRIPE_ROWS - 1) / PNG_ENCODER_STRIPE_ROWS;
+
+    int threadCount = options.threads;
+    if(threadCount <= 0)
+        threadCount = (int)std::thread::hardware_concurrency();
+    threadCount = std::max(1, std::min(std::min(threadCount, PNG_ENCODER_MAX_THREADS), stripeCount));
+
+    std::vector<Stripe> stripes(stripeCount);
+    std::atomic<int> next(0);
+    std::atomic<bool> abort(false);
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    auto worker = [&]() {
+        int index;
+        while(!abort && (index = next++) < stripeCount)
+        {
+            int first = index * PNG_ENCODER_STRIPE_ROWS;
+            int rows = std::min(PNG_ENCODER_STRIPE_ROWS, height - first);
+            bool ok = compressStripe(rgba, width, stride, first, rows, index == stripeCount - 1, options, stripes[index]);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            stripes[index].ok = ok;
+            stripes[index].done = true;
+            condition.notify_all();
+        }
+    };
+
+    /* The calling thread writes the stripes out in order while the workers compress the next ones */
+    std::vector<std::thread> threads;
+    for(int i = 0; i < threadCount; i++)
+        threads.push_back(std::thread(worker));
+
+    /* zlib header: deflate with a 32K window, no dictionary, level hint */
+    unsigned char zlibHeader[2] = { 0x78, (unsigned char)(options.level >= 7 ? 0xDA : (options.level >= 2 ? 0x9C : 0x01)) };
+    uLong adler = adler32(0, NULL, 0);
+    bool ok = true;
+
+    for(int index = 0; index < stripeCount && ok; index++)
+    {
+        Stripe &stripe = stripes[index];
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&stripe]() { return stripe.done; });
+        }
+
+        if(!stripe.ok)
+        {
+            ok = false;
+            break;
+        }
+
+        adler = adler32_combine(adler, stripe.adler, (z_off_t)stripe.length);
+
+        unsigned char trailer[4];
+        bool last = (index == stripeCount - 1);
+        if(last)
+            putUint32(trailer, (uint32_t)adler);
+
+        ok = writeChunk(writer, "IDAT", zlibHeader, index == 0 ? sizeof(zlibHeader) : 0,
+            stripe.data.empty() ? NULL : &stripe.data[0], stripe.data.size(), trailer, last ? sizeof(trailer) : 0);
+
+        std::vector<unsigned char>().swap(stripe.data);
+    }
+
+    if(!ok)
+        abort = true;
+
+    for(size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+
+    return ok && writeChunk(writer, "IEND", NULL, 0, NULL, 0, NULL, 0);
+}
+
+bool PngEncoder::encode(const unsigned char *rgba, int width, int height, int stride, const Options &options, std::vector<unsigned char> &png)
+{
+    png.clear();
+    png.reserve((size_t)width * height);
+
+    return encode(rgba, width, height, stride, options, [&png](const unsigned char *data, size_t length) {
+        png.insert(png.end(), data, data + length);
+        return true;
+    });
+}
@@ -0,0 +1,76 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stddef.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#define PNG_ENCODER_DEFAULT_LEVEL 1
+#define PNG_ENCODER_STRIPE_ROWS 64
+#define PNG_ENCODER_MAX_THREADS 4
+
+/*
+ * RGBA8 PNG encoder that deflates stripes of rows in parallel.
+ *
+ * Every stripe is filtered and compressed as an independent raw deflate
+ * stream, ended with a sync flush so that the streams can be concatenated.
+ * The stripes are stitched into a single zlib stream (header, stripes and
+ * the adler32 of the whole image combined from the per stripe checksums),
+ * written as one IDAT chunk per stripe in image order.
+ */
+class PngEncoder
+{
+public:
+    enum Filter
+    {
+        FILTER_NONE = 0,
+        FILTER_SUB,
+        FILTER_UP,
+        FILTER_AVERAGE,
+        FILTER_PAETH,
+        FILTER_ADAPTIVE     /* Per row, the filter with the smallest sum of absolute differences */
+    };
+
+    struct Options
+    {
+        Options() : level(PNG_ENCODER_DEFAULT_LEVEL), filter(FILTER_UP), threads(0) { }
+
+        int level;          /* zlib compression level, 0..9 */
+        Filter filter;
+        int threads;        /* 0 for one per core, up to PNG_ENCODER_MAX_THREADS */
+    };
+
+    /* Receives the PNG in order, returning false aborts the encoding */
+    typedef std::function<bool(const unsigned char *data, size_t length)> Writer;
+
+    static bool parseFilter(const std::string &name, Filter &filter);
+
+    /* In place BGRA -> RGBA conversion */
+    static void swapRedBlue(unsigned char *data, size_t pixels);
+
+    static bool encode(const unsigned char *rgba, int width, int height, int stride, const Options &options, const Writer &writer);
+    static bool encode(const unsigned char *rgba, int width, int height, int stride, const Options &options, std::vector<unsigned char> &png);
+
+private:
+    PngEncoder() = delete;
+};
@@ -26,8 +26,10 @@
 #include <nxclient.h>
 #endif
 
-#include <png.h>
-#include <curl/curl.h>
+#include <math.h>
+
+#include <condition_variable>
+#include <thread>
 
 // Methods
 #define METHOD_UPLOAD "uploadScreenCapture"
@@ -35,6 +37,14 @@
 // Events
 #define EVT_UPLOAD_COMPLETE "uploadComplete"
 
+// Captures waiting in the dispatcher, further requests are refused
+#define SCREENCAPTURE_MAX_PENDING_JOBS 4
+// Encoded png bytes buffered ahead of curl when streaming
+#define SCREENCAPTURE_STREAM_BUFFER_SIZE (512 * 1024)
+// Delta mode: a full frame every so many captures, clients remembered
+#define SCREENCAPTURE_DELTA_KEYFRAME_INTERVAL 30
+#define SCREENCAPTURE_DELTA_MAX_CLIENTS 8
+
 namespace WPEFramework
 {
     namespace Plugin
@@ -50,6 +60,11 @@ namespace WPEFramework
             ScreenCapture::_instance = this;
 
             screenShotDispatcher = new WPEFramework::Core::TimerType<ScreenShotJob>(64 * 1024, "ScreenCaptureDispatcher");
+            m_pendingJobs = 0;
+
+            curl_global_init(CURL_GLOBAL_ALL);
+            m_curl = NULL;
+            m_deltaUse = 0;
 
             #ifdef PLATFORM_BROADCOM
             inNexus = false;
@@ -64,6 +79,10 @@ namespace WPEFramework
             ScreenCapture::_instance = nullptr;
 
             delete screenShotDispatcher;
+
+            if(m_curl)
+                curl_easy_cleanup(m_curl);
+            curl_global_cleanup();
         }
 
         uint32_t ScreenCapture::uploadScreenCapture(const JsonObject& parameters, JsonObject& response)
@@ -84,7 +103,58 @@ namespace WPEFramework
             if(parameters.HasLabel("callGUID"))
               callGUID = parameters["callGUID"].String();
 
-            screenShotDispatcher->Schedule( Core::Time::Now().Add(0), ScreenShotJob( this, parameters["url"].String(), callGUID ) );
+            ScreenShotOptions options;
+
+            if(parameters.HasLabel("compressionLevel"))
+            {
+                options.png.level = parameters["compressionLevel"].Number();
+
+                if(options.png.level < 0 || options.png.level > 9)
+                {
+                    response["message"] = "compressionLevel must be between 0 and 9";
+
+                    returnResponse(false);
+                }
+            }
+
+            if(parameters.HasLabel("filter") && !PngEncoder::parseFilter(parameters["filter"].String(), options.png.filter))
+            {
+                response["message"] = "filter must be one of none, sub, up, average, paeth, adaptive";
+
+                returnResponse(false);
+            }
+
+            if(parameters.HasLabel("streaming"))
+                options.streaming = parameters["streaming"].Boolean();
+
+            if(parameters.HasLabel("mode"))
+            {
+                std::string mode = parameters["mode"].String();
+
+                if(mode == "delta")
+                    options.delta = true;
+                else if(mode != "full")
+                {
+                    response["message"] = "mode must be full or delta";
+
+                    returnResponse(false);
+                }
+            }
+
+            if(parameters.HasLabel("keyframe"))
+                options.keyframe = parameters["keyframe"].Boolean();
+
+            // Reserve the slot in one step, two concurrent requests must not both take the last one
+            if(m_pendingJobs.fetch_add(1) >= SCREENCAPTURE_MAX_PENDING_JOBS)
+            {
+                m_pendingJobs--;
+                LOGWARN("%d captures pending, refusing the request", SCREENCAPTURE_MAX_PENDING_JOBS);
+                response["message"] = "Too many captures pending";
+
+                returnResponse(false);
+            }
+
+            screenShotDispatcher->Schedule( Core::Time::Now().Add(0), ScreenShotJob( this, parameters["url"].String(), callGUID, options ) );
 
             returnResponse(true);
         }
@@ -97,87 +167,127 @@ namespace WPEFramework
                 return 0;
             }
 
-            m_screenCapture->doUploadScreenCapture(url, callGUID);
+            m_screenCapture->doUploadScreenCapture(url, callGUID, options, enqueueTime);
+            m_screenCapture->m_pendingJobs--;
 
             return 0;
         }
 
-        bool ScreenCapture::doUploadScreenCapture(std::string url, std::string callGUID)
+        static double msSince(std::chrono::steady_clock::time_point start)
         {
-            std::vector<unsigned char> png_data;
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        bool ScreenCapture::doUploadScreenCapture(std::string url, std::string callGUID, const ScreenShotOptions &options, std::chrono::steady_clock::time_point enqueueTime)
+        {
+            std::vector<unsigned char> rgba;
+            int width = 0;
+            int height = 0;
             bool got_screenshot = false;
+            ScreenShotStats stats;
+
+            stats.queueMs = msSince(enqueueTime);
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 
             #ifdef PLATFORM_BROADCOM
-            got_screenshot = getScreenshotNexus(png_data);
+            got_screenshot = getScreenshotNexus(rgba, width, height);
             #endif
 
             #ifdef PLATFORM_INTEL
-            got_screenshot = getScreenshotIntel(png_data);
+            got_screenshot = getScreenshotIntel(rgba, width, height);
             #endif
 
-            if(got_screenshot)
+            stats.captureMs = msSince(start);
+
+            if(!got_screenshot)
             {
-                std::string error_str;
+                LOGERR("Error: could not get the screenshot");
 
-                LOGWARN("uploading %d of png data to '%s'", png_data.size(), url.c_str() );
+                notifyUploadComplete(false, "Failed to get screen data", callGUID, stats);
 
-                if(uploadDataToUrl(png_data, url.c_str(), error_str))
-                {
-                    JsonObject params;
-                    params["status"] = true;
-                    params["message"] = "Success";
-                    params["call_guid"] = callGUID;
+                return false;
+            }
 
-                    sendNotify(EVT_UPLOAD_COMPLETE, params);
+            std::string error_str;
+            bool uploaded = false;
 
-                    return true;
-                }
-                else
-                {
-                    JsonObject params;
-                    params["status"] = false;
-                    params["message"] = std::string("Upload Failed: ") + error_str;
-                    params["call_guid"] = callGUID;
+            if(options.delta)
+            {
+                uploaded = uploadDeltaToUrl(callGUID, &rgba[0], width, height, options, url.c_str(), error_str, stats);
+            }
+            else if(options.streaming)
+            {
+                uploaded = encodeAndUploadToUrl(&rgba[0], width, height, options.png, url.c_str(), error_str, stats);
+            }
+            else
+            {
+                std::vector<unsigned char> png_data;
 
-                    sendNotify(EVT_UPLOAD_COMPLETE, params);
+                start = std::chrono::steady_clock::now();
+                if(!saveToPng(&rgba[0], width, height, options.png, png_data))
+                {
+                    notifyUploadComplete(false, "Failed to encode screen data", callGUID, stats);
 
                     return false;
                 }
+                stats.encodeMs = msSince(start);
+
+                LOGWARN("uploading %d of png data to '%s'", png_data.size(), url.c_str() );
+
+                uploaded = uploadDataToUrl(png_data, url.c_str(), error_str, stats);
             }
-            else
-            {
-                LOGERR("Error: could not get the screenshot");
 
-                JsonObject params;
-                params["status"] = false;
-                params["message"] = "Failed to get screen data";
-                params["call_guid"] = callGUID;
+            LOGINFO("capture queued %.1f ms, captured in %.1f ms, encoded in %.1f ms, uploaded in %.1f ms, %zu bytes",
+                stats.queueMs, stats.captureMs, stats.encodeMs, stats.uploadMs, stats.size);
 
-                sendNotify(EVT_UPLOAD_COMPLETE, params);
+            if(uploaded)
+                notifyUploadComplete(true, "Success", callGUID, stats);
+            else
+                notifyUploadComplete(false, std::string("Upload Failed: ") + error_str, callGUID, stats);
 
-                return false;
+            return uploaded;
+        }
+
+        void ScreenCapture::notifyUploadComplete(bool status, const std::string &message, const std::string &callGUID, const ScreenShotStats &stats)
+        {
+            JsonObject params;
+            params["status"] = status;
+            params["message"] = message;
+            params["call_guid"] = callGUID;
+            params["queue_ms"] = (int)(stats.queueMs + 0.5);
+            params["capture_ms"] = (int)(stats.captureMs + 0.5);
+            params["encode_ms"] = (int)(stats.encodeMs + 0.5);
+            params["upload_ms"] = (int)(stats.uploadMs + 0.5);
+            params["size"] = (uint32_t)stats.size;
+
+            if(stats.tiles >= 0)
+            {
+                params["sequence"] = stats.sequence;
+                params["keyframe"] = stats.keyframe;
+                params["tiles"] = stats.tiles;
             }
+
+            sendNotify(EVT_UPLOAD_COMPLETE, params);
         }
 
 #ifdef PLATFORM_INTEL
-        bool ScreenCapture::getScreenshotIntel(std::vector<unsigned char> &png_out_data)
+        bool ScreenCapture::getScreenshotIntel(std::vector<unsigned char> &rgba, int &width, int &height)
         {
-            int i;
-            char *filename = "/proc/gdl/dump/wbp";    //both video and guide graphics, potentially at lower 720x480
+            const char *filename = "/proc/gdl/dump/wbp";    //both video and guide graphics, potentially at lower 720x480
 //             char *filename = "/proc/gdl/dump/upp_d"; //graphics only, normally at higher 1280x720
 //             char *filename = "/proc/gdl/dump/upp_a"; //video only, normally at higher 1280x720
 
             FILE* fp = fopen(filename, "rb");
 
-            unsigned char info[56];
-            fread(info, sizeof(unsigned char), 56, fp); // read the 54-byte header
-
             if(!fp)
             {
                 LOGERR("Error: could not open image file '%s'", filename);
                 return false;
             }
 
+            unsigned char info[56];
+            fread(info, sizeof(unsigned char), 56, fp); // read the 54-byte header
+
             // extract image height and width from header
             int w = abs(*(int*)&info[18]);
             int h = abs(*(int*)&info[22]);
@@ -189,29 +299,22 @@ namespace WPEFramework
             if(size < 1)
             {
                 LOGERR("Error: png data size < 1");
+                fclose(fp);
                 return false;
             }
 
-            std::vector<unsigned char> data_v(size);
-            std::vector<unsigned char> new_data_v(size);
+            rgba.resize(size);
 
-            unsigned char* data = &data_v[0];
-            unsigned char* new_data = &new_data_v[0];
+            unsigned char* data = &rgba[0];
 
             fread(data, sizeof(unsigned char), size, fp); // read the rest of the data at once
             fclose(fp);
 
-            for(i = 0; i < size; i += 4)
-            {
-                //r and b need swapped?
-                new_data[i+0] = data[i+2];
-                new_data[i+1] = data[i+1];
-                new_data[i+2] = data[i+0];
-                new_data[i+3] = data[i+3];
-            }
+            //BGRA -> RGBA
+            PngEncoder::swapRedBlue(data, w * h);
 
-            //convert to png
-            saveToPng(new_data, w, h, png_out_data);
+            width = w;
+            height = h;
 
             return true;
         }
@@ -243,7 +346,7 @@ namespace WPEFramework
             return true;
         }
 
-        bool ScreenCapture::getScreenshotNexus(std::vector<unsigned char> &png_out_data)
+        bool ScreenCapture::getScreenshotNexus(std::vector<unsigned char> &rgba, int &width, int &height)
         {
             if(!joinNexus())
             {
@@ -275,8 +378,8 @@ namespace WPEFramework
             //defSurfSettings.pixelFormat = NEXUS_PixelFormat_eA8_R8_G8_B8;
             defSurfSettings.pixelFormat = NEXUS_PixelFormat_eA8_B8_G8_R8;
             int bytesPerPixel = 4;
-            std::vector<unsigned char> data_v(1280 * 720 * 4);
-            unsigned char *bytes = &data_v[0];
+            rgba.resize(1280 * 720 * 4);
+            unsigned char *bytes = &rgba[0];
 //             unsigned char bytes[1280 * 720 * 4];
 
 
@@ -324,58 +427,50 @@ namespace WPEFramework
                 return false;
             }
 
-            if(!saveToPng(bytes, defSurfSettings.width, defSurfSettings.height, png_out_data))
-            {
-                LOGERR("could not convert Nexus screenshot to png");
-                return false;
-            }
-            else
-                return true;
+            width = defSurfSettings.width;
+            height = defSurfSettings.height;
+
+            return true;
         }
 #endif
 
-        static void PngWriteCallback(png_structp  png_ptr, png_bytep data, png_size_t length)
+        static size_t DiscardResponseCallback(char *, size_t size, size_t nmemb, void *)
         {
-            std::vector<unsigned char> *p = (std::vector<unsigned char>*)png_get_io_ptr(png_ptr);
-            p->insert(p->end(), data, data + length);
+            return size * nmemb;
         }
 
-        bool ScreenCapture::uploadDataToUrl(std::vector<unsigned char> &data, const char *url, std::string &error_str)
+        CURL* ScreenCapture::getCurlHandle()
         {
-            CURL *curl;
-            CURLcode res;
-            bool call_succeeded = true;
+            if(!m_curl)
+                m_curl = curl_easy_init();
+            else
+                curl_easy_reset(m_curl); // options only, live connections and the DNS cache are kept
 
-            if(!url || !strlen(url))
+            if(!m_curl)
             {
-                LOGERR("no url given");
-                return false;
+                LOGERR("could not init curl\n");
+                return NULL;
             }
 
-            LOGWARN("uploading png data of size %u to '%s'", data.size(), url);
-
-            //init curl
-            curl_global_init(CURL_GLOBAL_ALL);
-            curl = curl_easy_init();
+            curl_easy_setopt(m_curl, CURLOPT_NOSIGNAL, 1L);
+            curl_easy_setopt(m_curl, CURLOPT_TCP_KEEPALIVE, 1L);
+            curl_easy_setopt(m_curl, CURLOPT_WRITEFUNCTION, DiscardResponseCallback);
 
-            if(!curl)
-            {
-                LOGERR("could not init curl\n");
-                return false;
-            }
+            return m_curl;
+        }
 
-            //create header
-            struct curl_slist *chunk = NULL;
-            chunk = curl_slist_append(chunk, "Content-Type: image/png");
+        bool ScreenCapture::performUpload(CURL *curl, const char *url, struct curl_slist *headers, std::string &error_str, ScreenShotStats &stats)
+        {
+            CURLcode res;
+            bool call_succeeded = true;
 
-            //set url and data
             curl_easy_setopt(curl, CURLOPT_URL, url);
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, chunk);
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, data.size());
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, &data[0]);
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
 
             //perform blocking upload call
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
             res = curl_easy_perform(curl);
+            stats.uploadMs = msSince(start);
 
             //output success / failure log
             if(CURLE_OK == res)
@@ -400,97 +495,340 @@ namespace WPEFramework
                 call_succeeded = false;
             }
 
-            //clean up curl object
-            curl_easy_cleanup(curl);
+            // The handle keeps a pointer to the list, do not leave it dangling
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, NULL);
+
+            return call_succeeded;
+        }
+
+        bool ScreenCapture::uploadDataToUrl(std::vector<unsigned char> &data, const char *url, std::string &error_str, ScreenShotStats &stats)
+        {
+            if(!url || !strlen(url))
+            {
+                LOGERR("no url given");
+                return false;
+            }
+
+            LOGWARN("uploading png data of size %u to '%s'", data.size(), url);
+
+            CURL *curl = getCurlHandle();
+            if(!curl)
+                return false;
+
+            //create header, without waiting for a 100-continue
+            struct curl_slist *chunk = NULL;
+            chunk = curl_slist_append(chunk, "Content-Type: image/png");
+            chunk = curl_slist_append(chunk, "Expect:");
+
+            //set data
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, data.size());
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, &data[0]);
+
+            stats.size = data.size();
+
+            bool call_succeeded = performUpload(curl, url, chunk, error_str, stats);
+
+            curl_slist_free_all(chunk);
+
+            return call_succeeded;
+        }
+
+        // Encoded png handed over from the encoder thread to the curl read callback
+        struct PngStream
+        {
+            PngStream() : offset(0), total(0), finished(false), failed(false), cancelled(false) { }
+
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::vector<unsigned char> buffer;
+            size_t offset;
+            size_t total;
+            bool finished;
+            bool failed;
+            bool cancelled;
+        };
+
+        static size_t PngStreamReadCallback(char *ptr, size_t size, size_t nmemb, void *userdata)
+        {
+            PngStream *stream = (PngStream*)userdata;
+            std::unique_lock<std::mutex> lock(stream->mutex);
+
+            stream->condition.wait(lock, [stream]() { return stream->offset < stream->buffer.size() || stream->finished; });
+
+            size_t available = stream->buffer.size() - stream->offset;
+            if(available == 0)
+                return stream->failed ? CURL_READFUNC_ABORT : 0;
+
+            size_t length = std::min(available, size * nmemb);
+            memcpy(ptr, &stream->buffer[stream->offset], length);
+            stream->offset += length;
+
+            if(stream->offset == stream->buffer.size())
+            {
+                stream->buffer.clear();
+                stream->offset = 0;
+            }
+
+            stream->condition.notify_all();
+
+            return length;
+        }
+
+        bool ScreenCapture::encodeAndUploadToUrl(unsigned char *rgba, int w, int h, const PngEncoder::Options &options, const char *url, std::string &error_str, ScreenShotStats &stats)
+        {
+            if(!url || !strlen(url))
+            {
+                LOGERR("no url given");
+                return false;
+            }
+
+            CURL *curl = getCurlHandle();
+            if(!curl)
+                return false;
+
+            PngStream stream;
+
+            // Stripes are sent as soon as they are compressed, the size is not known up front
+            std::thread encoder([&]() {
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+                bool encoded = PngEncoder::encode(rgba, w, h, 4 * w, options, [&stream](const unsigned char *data, size_t length) {
+                    std::unique_lock<std::mutex> lock(stream.mutex);
+
+                    stream.condition.wait(lock, [&stream]() {
+                        return stream.cancelled || stream.buffer.size() - stream.offset < SCREENCAPTURE_STREAM_BUFFER_SIZE;
+                    });
+
+                    if(stream.cancelled)
+                        return false;
+
+                    stream.buffer.insert(stream.buffer.end(), data, data + length);
+                    stream.total += length;
+                    stream.condition.notify_all();
+
+                    return true;
+                });
+
+                stats.encodeMs = msSince(start);
+
+                std::lock_guard<std::mutex> lock(stream.mutex);
+                stream.failed = !encoded && !stream.cancelled;
+                stream.finished = true;
+                stream.condition.notify_all();
+            });
+
+            struct curl_slist *chunk = NULL;
+            chunk = curl_slist_append(chunk, "Content-Type: image/png");
+            chunk = curl_slist_append(chunk, "Transfer-Encoding: chunked");
+            chunk = curl_slist_append(chunk, "Expect:");
+
+            curl_easy_setopt(curl, CURLOPT_POST, 1L);
+            curl_easy_setopt(curl, CURLOPT_READFUNCTION, PngStreamReadCallback);
+            curl_easy_setopt(curl, CURLOPT_READDATA, &stream);
+
+            LOGWARN("streaming png data to '%s'", url);
+
+            bool call_succeeded = performUpload(curl, url, chunk, error_str, stats);
+
+            // curl may have given up before the end of the png, release the encoder
+            {
+                std::lock_guard<std::mutex> lock(stream.mutex);
+                stream.cancelled = true;
+                stream.condition.notify_all();
+            }
+            encoder.join();
+
             curl_slist_free_all(chunk);
 
+            stats.size = stream.total;
+
+            if(stream.failed)
+            {
+                LOGERR("Error: failed to encode the png (w:%d h:%d level:%d filter:%d)", w, h, options.level, options.filter);
+                if(call_succeeded)
+                    error_str = "png encoding failed";
+                call_succeeded = false;
+            }
+
             return call_succeeded;
         }
 
-        bool ScreenCapture::saveToPng(unsigned char *data, int width, int height, std::vector<unsigned char> &png_out_data)
+        ScreenShotDeltaState& ScreenCapture::getDeltaState(const std::string &callGUID)
         {
-            int bitdepth = 8;
-            int colortype = PNG_COLOR_TYPE_RGBA;
-            int pitch = 4 * width;
-            int transform = PNG_TRANSFORM_IDENTITY;
+            std::map<std::string, ScreenShotDeltaState>::iterator it = m_deltaStates.find(callGUID);
 
-            int i = 0;
-            int r = 0;
-            png_structp png_ptr = NULL;
-            png_infop info_ptr = NULL;
-            png_bytep* row_pointers = NULL;
+            if(it == m_deltaStates.end())
+            {
+                // Forget the client that has not captured for the longest time
+                if(m_deltaStates.size() >= SCREENCAPTURE_DELTA_MAX_CLIENTS)
+                {
+                    std::map<std::string, ScreenShotDeltaState>::iterator oldest = m_deltaStates.begin();
+                    for(std::map<std::string, ScreenShotDeltaState>::iterator i = m_deltaStates.begin(); i != m_deltaStates.end(); ++i)
+                    {
+                        if(i->second.lastUse < oldest->second.lastUse)
+                            oldest = i;
+                    }
+                    LOGINFO("forgetting delta state of '%s'", oldest->first.c_str());
+                    m_deltaStates.erase(oldest);
+                }
 
-            if (NULL == data)
+                it = m_deltaStates.insert(std::make_pair(callGUID, ScreenShotDeltaState())).first;
+            }
+
+            it->second.lastUse = ++m_deltaUse;
+
+            return it->second;
+        }
+
+        bool ScreenCapture::uploadDeltaToUrl(const std::string &callGUID, unsigned char *rgba, int w, int h, const ScreenShotOptions &options, const char *url, std::string &error_str, ScreenShotStats &stats)
+        {
+            if(!url || !strlen(url))
             {
-                LOGERR("Error: failed to save the png because the given data is NULL.");
-                r = -1;
-                goto error;
+                LOGERR("no url given");
+                return false;
+            }
+
+            ScreenShotDeltaState &state = getDeltaState(callGUID);
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+            std::vector<FrameDelta::TileHash> hashes;
+            FrameDelta::hashTiles(rgba, w, h, 4 * w, hashes);
+
+            bool keyframe = options.keyframe || state.hashes.empty() || state.width != w || state.height != h
+                || state.sinceKeyframe + 1 >= SCREENCAPTURE_DELTA_KEYFRAME_INTERVAL;
+
+            std::vector<int> tiles;
+            if(!keyframe)
+            {
+                FrameDelta::changedTiles(state.hashes, hashes, tiles);
+
+                // Most of the screen changed, the full frame costs about the same and resynchronises the server
+                if(tiles.size() * 2 > hashes.size())
+                    keyframe = true;
+            }
+
+            int atlasColumns = 0;
+            std::vector<unsigned char> png_data;
+            bool encoded = true;
+
+            if(keyframe)
+            {
+                tiles.clear();
+                encoded = saveToPng(rgba, w, h, options.png, png_data);
             }
+            else if(!tiles.empty())
+            {
+                std::vector<unsigned char> atlas;
+                int atlasWidth = 0;
+                int atlasHeight = 0;
+
+                atlasColumns = (int)ceil(sqrt((double)tiles.size()));
+                FrameDelta::packTiles(rgba, w, h, 4 * w, tiles, atlasColumns, atlas, atlasWidth, atlasHeight);
+                encoded = saveToPng(&atlas[0], atlasWidth, atlasHeight, options.png, png_data);
+            }
+
+            stats.encodeMs = msSince(start);
+            stats.size = png_data.size();
+            stats.keyframe = keyframe;
+            stats.tiles = keyframe ? (int)hashes.size() : (int)tiles.size();
+            stats.sequence = state.sequence + 1;
 
-            if (0 == pitch)
+            if(!encoded)
             {
-                LOGERR("Error: failed to save the png because the given pitch is 0.");
-                r = -3;
-                goto error;
+                error_str = "png encoding failed";
+                return false;
             }
 
-            png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-            if (NULL == png_ptr)
+            JsonObject manifest;
+            manifest["call_guid"] = callGUID;
+            manifest["sequence"] = stats.sequence;
+            manifest["keyframe"] = keyframe;
+            manifest["width"] = w;
+            manifest["height"] = h;
+            manifest["tile_size"] = FRAME_DELTA_TILE_SIZE;
+
+            if(!keyframe)
             {
-                LOGERR("Error: failed to create the png write struct.");
-                r = -5;
-                goto error;
+                JsonArray changed;
+                for(size_t i = 0; i < tiles.size(); i++)
+                    changed.Add(JsonValue(tiles[i]));
+
+                manifest["base"] = state.sequence;
+                manifest["columns"] = FrameDelta::columns(w);
+                manifest["atlas_columns"] = atlasColumns;
+                manifest["tiles"] = changed;
             }
 
-            info_ptr = png_create_info_struct(png_ptr);
-            if (NULL == info_ptr)
+            std::string manifest_str;
+            manifest.ToString(manifest_str);
+
+            LOGWARN("uploading %s %u of '%s', %d tiles, %u bytes of png to '%s'", keyframe ? "keyframe" : "delta", stats.sequence,
+                callGUID.c_str(), stats.tiles, (unsigned)png_data.size(), url);
+
+            CURL *curl = getCurlHandle();
+            if(!curl)
+                return false;
+
+            // multipart/form-data: the manifest, and the frame or the atlas of changed tiles unless nothing changed
+            curl_mime *mime = curl_mime_init(curl);
+            curl_mimepart *part = curl_mime_addpart(mime);
+            curl_mime_name(part, "manifest");
+            curl_mime_type(part, "application/json");
+            curl_mime_data(part, manifest_str.c_str(), manifest_str.size());
+
+            if(!png_data.empty())
             {
-                LOGERR("Error: failed to create the png info struct.");
-                r = -6;
-                goto error;
+                part = curl_mime_addpart(mime);
+                curl_mime_name(part, keyframe ? "frame" : "tiles");
+                curl_mime_filename(part, keyframe ? "frame.png" : "tiles.png");
+                curl_mime_type(part, "image/png");
+                curl_mime_data(part, (const char*)&png_data[0], png_data.size());
             }
 
-            png_set_IHDR(png_ptr,
-                            info_ptr,
-                            width,
-                            height,
-                            bitdepth,                 /* e.g. 8 */
-                            colortype,                /* PNG_COLOR_TYPE_{GRAY, PALETTE, RGB, RGB_ALPHA, GRAY_ALPHA, RGBA, GA} */
-                            PNG_INTERLACE_NONE,       /* PNG_INTERLACE_{NONE, ADAM7 } */
-                            PNG_COMPRESSION_TYPE_BASE,
-                            PNG_FILTER_TYPE_BASE);
+            curl_easy_setopt(curl, CURLOPT_MIMEPOST, mime);
 
-            row_pointers = (png_bytep*)malloc(sizeof(png_bytep) * height);
+            struct curl_slist *chunk = NULL;
+            chunk = curl_slist_append(chunk, "Expect:");
 
-            for (i = 0; i < height; ++i)
-                row_pointers[i] = data + i * pitch;
+            bool call_succeeded = performUpload(curl, url, chunk, error_str, stats);
 
-            png_set_write_fn(png_ptr, &png_out_data, PngWriteCallback, NULL);
-            png_set_rows(png_ptr, info_ptr, row_pointers);
-            png_write_png(png_ptr, info_ptr, transform, NULL);
+            curl_easy_setopt(curl, CURLOPT_MIMEPOST, NULL);
+            curl_mime_free(mime);
+            curl_slist_free_all(chunk);
 
-            error:
+            state.sequence = stats.sequence;
 
-            if (NULL != png_ptr)
+            if(call_succeeded)
             {
+                state.hashes.swap(hashes);
+                state.width = w;
+                state.height = h;
+                state.sinceKeyframe = keyframe ? 0 : state.sinceKeyframe + 1;
+            }
+            else
+            {
+                // The server may not have this frame, the next capture resynchronises it
+                state.hashes.clear();
+            }
 
-                if (NULL == info_ptr)
-                {
-                    LOGERR("Error: info ptr is null. not supposed to happen here.\n");
-                }
+            return call_succeeded;
+        }
 
-                png_destroy_write_struct(&png_ptr, &info_ptr);
-                png_ptr = NULL;
-                info_ptr = NULL;
+        bool ScreenCapture::saveToPng(unsigned char *data, int width, int height, const PngEncoder::Options &options, std::vector<unsigned char> &png_out_data)
+        {
+            if (NULL == data)
+            {
+                LOGERR("Error: failed to save the png because the given data is NULL.");
+                return false;
             }
 
-            if (NULL != row_pointers)
+            if (!PngEncoder::encode(data, width, height, 4 * width, options, png_out_data))
             {
-                free(row_pointers);
-                row_pointers = NULL;
+                LOGERR("Error: failed to encode the png (w:%d h:%d level:%d filter:%d)", width, height, options.level, options.filter);
+                return false;
             }
 
-            return (r==0);
+            return true;
         }
 
     } // namespace Plugin
@@ -19,10 +19,17 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <map>
 #include <mutex>
 #include <vector>
 
+#include <curl/curl.h>
+
 #include "tptimer.h"
+#include "PngEncoder.h"
+#include "FrameDelta.h"
 
 #include "Module.h"
 #include "utils.h"
@@ -34,6 +41,16 @@ namespace WPEFramework {
 
         class ScreenCapture;
 
+        struct ScreenShotOptions
+        {
+            ScreenShotOptions() : streaming(false), delta(false), keyframe(false) { }
+
+            PngEncoder::Options png;
+            bool streaming;
+            bool delta;         // Upload the tiles changed since the previous capture for the same callGUID
+            bool keyframe;      // Force a full frame in delta mode
+        };
+
         class ScreenShotJob
         {
         private:
@@ -41,8 +58,10 @@ namespace WPEFramework {
             ScreenShotJob& operator=(const ScreenShotJob& RHS) = delete;
 
         public:
-            ScreenShotJob(WPEFramework::Plugin::ScreenCapture* tpt, std::string _url, std::string _callGUID) : m_screenCapture(tpt), url(_url), callGUID(_callGUID) { }
-            ScreenShotJob(const ScreenShotJob& copy) : m_screenCapture(copy.m_screenCapture), url(copy.url), callGUID(copy.callGUID) { }
+            ScreenShotJob(WPEFramework::Plugin::ScreenCapture* tpt, std::string _url, std::string _callGUID, const ScreenShotOptions& _options)
+                : m_screenCapture(tpt), url(_url), callGUID(_callGUID), options(_options), enqueueTime(std::chrono::steady_clock::now()) { }
+            ScreenShotJob(const ScreenShotJob& copy)
+                : m_screenCapture(copy.m_screenCapture), url(copy.url), callGUID(copy.callGUID), options(copy.options), enqueueTime(copy.enqueueTime) { }
             ~ScreenShotJob() {}
 
             inline bool operator==(const ScreenShotJob& RHS) const
@@ -59,6 +78,37 @@ namespace WPEFramework {
             WPEFramework::Plugin::ScreenCapture* m_screenCapture;
             std::string url;
             std::string callGUID;
+            ScreenShotOptions options;
+            std::chrono::steady_clock::time_point enqueueTime;
+        };
+
+        struct ScreenShotStats
+        {
+            ScreenShotStats() : queueMs(0), captureMs(0), encodeMs(0), uploadMs(0), size(0), tiles(-1), keyframe(false), sequence(0) { }
+
+            double queueMs;
+            double captureMs;
+            double encodeMs;
+            double uploadMs;
+            size_t size;
+
+            // Delta mode only
+            int tiles;
+            bool keyframe;
+            uint32_t sequence;
+        };
+
+        // What the server was last sent for a callGUID in delta mode
+        struct ScreenShotDeltaState
+        {
+            ScreenShotDeltaState() : width(0), height(0), sequence(0), sinceKeyframe(0), lastUse(0) { }
+
+            std::vector<FrameDelta::TileHash> hashes;   // Empty when the next capture must be a keyframe
+            int width;
+            int height;
+            uint32_t sequence;
+            uint32_t sinceKeyframe;
+            uint64_t lastUse;
         };
 
         // This is a server for a JSONRPC communication channel.
@@ -85,17 +135,23 @@ namespace WPEFramework {
             //End methods
 
             #ifdef PLATFORM_BROADCOM
-            bool getScreenshotNexus(std::vector<unsigned char> &png_data);
+            bool getScreenshotNexus(std::vector<unsigned char> &rgba, int &width, int &height);
             bool joinNexus();
             #endif
 
             #ifdef PLATFORM_INTEL
-            bool getScreenshotIntel(std::vector<unsigned char> &png_data);
+            bool getScreenshotIntel(std::vector<unsigned char> &rgba, int &width, int &height);
             #endif
 
-            bool saveToPng(unsigned char *bytes, int w, int h, std::vector<unsigned char> &png_out_data);
-            bool uploadDataToUrl(std::vector<unsigned char> &data, const char *url, std::string &error_str);
-            bool doUploadScreenCapture(std::string url, std::string callGUID);
+            bool saveToPng(unsigned char *bytes, int w, int h, const PngEncoder::Options &options, std::vector<unsigned char> &png_out_data);
+            bool uploadDataToUrl(std::vector<unsigned char> &data, const char *url, std::string &error_str, ScreenShotStats &stats);
+            bool encodeAndUploadToUrl(unsigned char *rgba, int w, int h, const PngEncoder::Options &options, const char *url, std::string &error_str, ScreenShotStats &stats);
+            bool uploadDeltaToUrl(const std::string &callGUID, unsigned char *rgba, int w, int h, const ScreenShotOptions &options, const char *url, std::string &error_str, ScreenShotStats &stats);
+            ScreenShotDeltaState& getDeltaState(const std::string &callGUID);
+            bool performUpload(CURL *curl, const char *url, struct curl_slist *headers, std::string &error_str, ScreenShotStats &stats);
+            CURL* getCurlHandle();
+            bool doUploadScreenCapture(std::string url, std::string callGUID, const ScreenShotOptions &options, std::chrono::steady_clock::time_point enqueueTime);
+            void notifyUploadComplete(bool status, const std::string &message, const std::string &callGUID, const ScreenShotStats &stats);
 
         public:
             ScreenCapture();
@@ -107,6 +163,14 @@ namespace WPEFramework {
             std::mutex m_callMutex;
 
             WPEFramework::Core::TimerType<ScreenShotJob> *screenShotDispatcher;
+            std::atomic<int> m_pendingJobs;
+
+            // Only used by the dispatcher thread, kept across uploads for its connection and DNS caches
+            CURL *m_curl;
+
+            // Dispatcher thread only, per callGUID
+            std::map<std::string, ScreenShotDeltaState> m_deltaStates;
+            uint64_t m_deltaUse;
 
             #ifdef PLATFORM_BROADCOM
             bool inNexus;
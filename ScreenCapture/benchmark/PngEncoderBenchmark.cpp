@@ -0,0 +1,275 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+/*
+ * Measures the screenshot conversion path: BGRA -> RGBA swizzle and PNG
+ * encoding with the striped encoder, compared with a single threaded
+ * libpng encode at its default settings. Every PNG produced is decoded
+ * again with libpng and compared with the source frame.
+ *
+ * The delta mode tile hashing is timed as well, and checked against the
+ * scalar version and for detecting single pixel changes.
+ *
+ * The frame is a synthetic UI (flat panels, gradients, text like noise)
+ * unless a raw BGRA dump is given with -i.
+ */
+
+#include "PngEncoder.h"
+#include "FrameDelta.h"
+
+#include <png.h>
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+struct Options {
+    int width = 1920;
+    int height = 1080;
+    int runs = 10;
+    int threads = 0;
+    std::string input;
+};
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [options]\n"
+        "  -w <pixels>  frame width (default 1920)\n"
+        "  -h <pixels>  frame height (default 1080)\n"
+        "  -n <count>   runs per configuration (default 10)\n"
+        "  -t <count>   encoder threads (default 0, one per core)\n"
+        "  -i <file>    raw BGRA frame of w x h instead of the synthetic one\n", name);
+}
+
+static void syntheticFrame(std::vector<unsigned char> &bgra, int width, int height)
+{
+    std::mt19937 random(0x5C4E);
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            unsigned char *p = &bgra[((size_t)y * width + x) * 4];
+            /* Background gradient */
+            p[0] = (unsigned char)(40 + y * 60 / height);
+            p[1] = (unsigned char)(20 + x * 40 / width);
+            p[2] = 30;
+            p[3] = 255;
+        }
+    }
+
+    /* Tiles of a menu, flat colours with "text" rows of noise */
+    for (int tile = 0; tile < 12; tile++) {
+        int x0 = 80 + (tile % 6) * (width - 160) / 6;
+        int y0 = height / 4 + (tile / 6) * height / 3;
+        int w = (width - 160) / 6 - 20;
+        int h = height / 3 - 40;
+        for (int y = y0; y < std::min(height, y0 + h); y++) {
+            for (int x = x0; x < std::min(width, x0 + w); x++) {
+                unsigned char *p = &bgra[((size_t)y * width + x) * 4];
+                bool text = (y - y0) > h - 60 && (y - y0) < h - 20 && (random() % 3) == 0;
+                p[0] = text ? 240 : (unsigned char)(90 + tile * 10);
+                p[1] = text ? 240 : 60;
+                p[2] = text ? 240 : (unsigned char)(160 - tile * 5);
+            }
+        }
+    }
+}
+
+static bool decode(const std::vector<unsigned char> &png, std::vector<unsigned char> &rgba, int &width, int &height)
+{
+    png_image image;
+    memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+
+    if (!png_image_begin_read_from_memory(&image, png.data(), png.size()))
+        return false;
+
+    image.format = PNG_FORMAT_RGBA;
+    width = image.width;
+    height = image.height;
+    rgba.resize(PNG_IMAGE_SIZE(image));
+
+    return png_image_finish_read(&image, NULL, rgba.data(), 0, NULL) != 0;
+}
+
+static void libpngWrite(png_structp png_ptr, png_bytep data, png_size_t length)
+{
+    std::vector<unsigned char> *p = (std::vector<unsigned char>*)png_get_io_ptr(png_ptr);
+    p->insert(p->end(), data, data + length);
+}
+
+/* What ScreenCapture::saveToPng did before the striped encoder */
+static bool libpngEncode(const unsigned char *rgba, int width, int height, std::vector<unsigned char> &out)
+{
+    png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop info_ptr = png_create_info_struct(png_ptr);
+    std::vector<png_bytep> rows(height);
+
+    for (int i = 0; i < height; i++)
+        rows[i] = (png_bytep)rgba + (size_t)i * width * 4;
+
+    out.clear();
+    png_set_IHDR(png_ptr, info_ptr, width, height, 8, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+    png_set_write_fn(png_ptr, &out, libpngWrite, NULL);
+    png_set_rows(png_ptr, info_ptr, rows.data());
+    png_write_png(png_ptr, info_ptr, PNG_TRANSFORM_IDENTITY, NULL);
+    png_destroy_write_struct(&png_ptr, &info_ptr);
+
+    return true;
+}
+
+static double median(std::vector<double> &values)
+{
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    int option;
+
+    while ((option = getopt(argc, argv, "w:h:n:t:i:")) != -1) {
+        switch (option) {
+        case 'w': options.width = atoi(optarg); break;
+        case 'h': options.height = atoi(optarg); break;
+        case 'n': options.runs = std::max(1, atoi(optarg)); break;
+        case 't': options.threads = atoi(optarg); break;
+        case 'i': options.input = optarg; break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+
+    if (options.width <= 0 || options.height <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    size_t size = (size_t)options.width * options.height * 4;
+    std::vector<unsigned char> frame(size);
+
+    if (!options.input.empty()) {
+        FILE *fp = fopen(options.input.c_str(), "rb");
+        if (!fp || fread(frame.data(), 1, size, fp) != size) {
+            fprintf(stderr, "Could not read %zu bytes from %s\n", size, options.input.c_str());
+            if (fp)
+                fclose(fp);
+            return 1;
+        }
+        fclose(fp);
+    } else {
+        syntheticFrame(frame, options.width, options.height);
+    }
+
+    /* Reference RGBA for the verification */
+    std::vector<unsigned char> reference(frame);
+    for (size_t i = 0; i < size; i += 4)
+        std::swap(reference[i], reference[i + 2]);
+
+    std::vector<double> swizzle;
+    std::vector<unsigned char> rgba;
+    for (int run = 0; run < options.runs; run++) {
+        rgba = frame;
+        auto start = std::chrono::steady_clock::now();
+        PngEncoder::swapRedBlue(rgba.data(), size / 4);
+        swizzle.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    printf("frame           : %dx%d, %d runs\n", options.width, options.height, options.runs);
+    printf("swizzle         : %.2f ms%s\n", median(swizzle), rgba == reference ? "" : "  MISMATCH");
+
+    int failures = (rgba == reference) ? 0 : 1;
+
+    std::vector<FrameDelta::TileHash> hashes;
+    std::vector<FrameDelta::TileHash> scalarHashes;
+    std::vector<double> hashing;
+    for (int run = 0; run < options.runs; run++) {
+        auto start = std::chrono::steady_clock::now();
+        FrameDelta::hashTiles(reference.data(), options.width, options.height, options.width * 4, hashes);
+        hashing.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    FrameDelta::hashTilesScalar(reference.data(), options.width, options.height, options.width * 4, scalarHashes);
+
+    /* One pixel changed per tile row, each must show up as exactly that tile */
+    std::vector<unsigned char> changed(reference);
+    std::vector<int> expected;
+    std::vector<int> tiles;
+    std::mt19937 random(0xDE17A);
+    for (int ty = 0; ty < FrameDelta::rows(options.height); ty++) {
+        int x = random() % options.width;
+        int y = std::min(options.height - 1, ty * FRAME_DELTA_TILE_SIZE + (int)(random() % FRAME_DELTA_TILE_SIZE));
+        changed[((size_t)y * options.width + x) * 4 + random() % 4] ^= 1 << (random() % 8);
+        expected.push_back((y / FRAME_DELTA_TILE_SIZE) * FrameDelta::columns(options.width) + x / FRAME_DELTA_TILE_SIZE);
+    }
+    std::vector<FrameDelta::TileHash> changedHashes;
+    FrameDelta::hashTiles(changed.data(), options.width, options.height, options.width * 4, changedHashes);
+    FrameDelta::changedTiles(hashes, changedHashes, tiles);
+
+    bool hashValid = (hashes == scalarHashes) && (tiles == expected);
+    if (!hashValid)
+        failures++;
+
+    printf("tile hash       : %.2f ms, %zu tiles, %zu changed%s\n", median(hashing), hashes.size(), tiles.size(), hashValid ? "" : "  INVALID");
+    std::vector<unsigned char> png;
+    std::vector<unsigned char> decoded;
+    std::vector<double> times;
+
+    for (int run = 0; run < options.runs; run++) {
+        auto start = std::chrono::steady_clock::now();
+        libpngEncode(reference.data(), options.width, options.height, png);
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    printf("%-16s: %8.2f ms %9zu bytes\n", "libpng default", median(times), png.size());
+
+    static const char *filters[] = { "none", "sub", "up", "average", "paeth", "adaptive" };
+    static const int levels[] = { 1, 3, 6 };
+
+    for (const char *name : filters) {
+        for (int level : levels) {
+            PngEncoder::Options encoderOptions;
+            PngEncoder::parseFilter(name, encoderOptions.filter);
+            encoderOptions.level = level;
+            encoderOptions.threads = options.threads;
+
+            times.clear();
+            for (int run = 0; run < options.runs; run++) {
+                auto start = std::chrono::steady_clock::now();
+                if (!PngEncoder::encode(reference.data(), options.width, options.height, options.width * 4, encoderOptions, png))
+                    failures++;
+                times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            }
+
+            int width = 0;
+            int height = 0;
+            bool valid = decode(png, decoded, width, height) && width == options.width && height == options.height && decoded == reference;
+            if (!valid)
+                failures++;
+
+            printf("%-8s level %d : %8.2f ms %9zu bytes%s\n", name, level, median(times), png.size(), valid ? "" : "  INVALID");
+        }
+    }
+
+    return failures ? 2 : 0;
+}
@@ -32,6 +32,7 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <unordered_map>
 
 #include "StateObserver.h"
 #include "libIARM.h"
@@ -60,10 +61,73 @@ namespace WPEFramework {
 
 		std::vector<string> registeredPropertyNames;
 
+		enum SystemProperty {
+			PROPERTY_CHANNEL_MAP,
+			PROPERTY_CARD_DISCONNECTED,
+			PROPERTY_TUNE_READY,
+			PROPERTY_EXIT_OK,
+			PROPERTY_CMAC,
+			PROPERTY_MOTO_ENTITLEMENT,
+			PROPERTY_DAC_INIT_TIMESTAMP,
+			PROPERTY_CARD_SERIAL_NO,
+			PROPERTY_STB_SERIAL_NO,
+			PROPERTY_ECM_MAC,
+			PROPERTY_MOTO_HRV_RX,
+			PROPERTY_CARD_CISCO_STATUS,
+			PROPERTY_VIDEO_PRESENTING,
+			PROPERTY_HDMI_OUT,
+			PROPERTY_HDCP_ENABLED,
+			PROPERTY_HDMI_EDID_READ,
+			PROPERTY_FIRMWARE_DWNLD,
+			PROPERTY_TIME_SOURCE,
+			PROPERTY_TIME_ZONE,
+			PROPERTY_CA_SYSTEM,
+			PROPERTY_ESTB_IP,
+			PROPERTY_ECM_IP,
+			PROPERTY_LAN_IP,
+			PROPERTY_DOCSIS,
+			PROPERTY_DSG_CA_TUNNEL,
+			PROPERTY_CABLE_CARD,
+			PROPERTY_VOD_AD,
+			PROPERTY_IP_MODE
+		};
+
+		static const std::unordered_map<string, SystemProperty> systemProperties = {
+			{ SYSTEM_CHANNEL_MAP, PROPERTY_CHANNEL_MAP },
+			{ SYSTEM_CARD_DISCONNECTED, PROPERTY_CARD_DISCONNECTED },
+			{ SYSTEM_TUNE_READY, PROPERTY_TUNE_READY },
+			{ SYSTEM_EXIT_OK, PROPERTY_EXIT_OK },
+			{ SYSTEM_CMAC, PROPERTY_CMAC },
+			{ SYSTEM_MOTO_ENTITLEMENT, PROPERTY_MOTO_ENTITLEMENT },
+			{ SYSTEM_DAC_INIT_TIMESTAMP, PROPERTY_DAC_INIT_TIMESTAMP },
+			{ SYSTEM_CARD_SERIAL_NO, PROPERTY_CARD_SERIAL_NO },
+			{ SYSTEM_STB_SERIAL_NO, PROPERTY_STB_SERIAL_NO },
+			{ SYSTEM_ECM_MAC, PROPERTY_ECM_MAC },
+			{ SYSTEM_MOTO_HRV_RX, PROPERTY_MOTO_HRV_RX },
+			{ SYSTEM_CARD_CISCO_STATUS, PROPERTY_CARD_CISCO_STATUS },
+			{ SYSTEM_VIDEO_PRESENTING, PROPERTY_VIDEO_PRESENTING },
+			{ SYSTEM_HDMI_OUT, PROPERTY_HDMI_OUT },
+			{ SYSTEM_HDCP_ENABLED, PROPERTY_HDCP_ENABLED },
+			{ SYSTEM_HDMI_EDID_READ, PROPERTY_HDMI_EDID_READ },
+			{ SYSTEM_FIRMWARE_DWNLD, PROPERTY_FIRMWARE_DWNLD },
+			{ SYSTEM_TIME_SOURCE, PROPERTY_TIME_SOURCE },
+			{ SYSTEM_TIME_ZONE, PROPERTY_TIME_ZONE },
+			{ SYSTEM_CA_SYSTEM, PROPERTY_CA_SYSTEM },
+			{ SYSTEM_ESTB_IP, PROPERTY_ESTB_IP },
+			{ SYSTEM_ECM_IP, PROPERTY_ECM_IP },
+			{ SYSTEM_LAN_IP, PROPERTY_LAN_IP },
+			{ SYSTEM_DOCSIS, PROPERTY_DOCSIS },
+			{ SYSTEM_DSG_CA_TUNNEL, PROPERTY_DSG_CA_TUNNEL },
+			{ SYSTEM_CABLE_CARD, PROPERTY_CABLE_CARD },
+			{ SYSTEM_VOD_AD, PROPERTY_VOD_AD },
+			{ SYSTEM_IP_MODE, PROPERTY_IP_MODE }
+		};
+
 
 		StateObserver::StateObserver()
 		: AbstractPlugin()
 		, m_apiVersionNumber((uint32_t)-1)
+		, m_systemStatesValid(false)
 		{
 			LOGINFO();
 
@@ -89,6 +153,10 @@ namespace WPEFramework {
 		{
 			LOGINFO();
 			InitializeIARM();
+			{
+				std::lock_guard<std::mutex> lock(m_systemStatesMutex);
+				refreshSystemStates();
+			}
 
 			// On success return empty, to indicate there is no error text.
 			return (string());
@@ -98,6 +166,7 @@ namespace WPEFramework {
 		{
 			LOGINFO();
 			DeinitializeIARM();
+			invalidateSystemStates();
 		}
 
 		void StateObserver::InitializeIARM()
@@ -297,288 +366,327 @@ namespace WPEFramework {
 				checkForStandalone = false;
 			}
 			IARM_Bus_SYSMgr_GetSystemStates_Param_t param;
-			IARM_Bus_Call(IARM_BUS_SYSMGR_NAME, IARM_BUS_SYSMGR_API_GetSystemStates, &param, sizeof(param));
+			{
+				std::lock_guard<std::mutex> lock(m_systemStatesMutex);
+				if (!m_systemStatesValid)
+				{
+					refreshSystemStates();
+				}
+				param = m_systemStates;
+			}
 			JsonArray response_arr;
 			for( std::vector<string>::iterator it = pname.begin(); it!= pname.end(); ++it )
 			{
 				string err_str="none";
 				JsonObject devProp;
-				if(*it == SYSTEM_CHANNEL_MAP)
+				std::unordered_map<string, SystemProperty>::const_iterator property = systemProperties.find(*it);
+
+				if (property == systemProperties.end())
 				{
-					int channelMapState = param.channel_map.state;
-					int channelMapError = param.channel_map.error;
-					if (stbStandAloneMode)
-					{
-						LOGINFO("stand alone mode true\n");
-						channelMapState = 2;
-						channelMapError = 0;
-					}
-					devProp["propertyName"]=SYSTEM_CHANNEL_MAP;
-					devProp["value"]=channelMapState;
-					if(channelMapError == 1)
-					{
-						err_str="RDK-03005";
-					}
-					devProp["error"]=err_str;
+					LOGINFO("Invalid property Name\n");
+					string res="Invalid property Name";
+					devProp["propertyName"] = *it;
+					devProp["error"]=res;
 					response_arr.Add(devProp);
+					continue;
 				}
 
-				else if(*it == SYSTEM_CARD_DISCONNECTED)
+				switch (property->second)
 				{
-					int systemCardState = param.disconnect_mgr_state.state;
-					int systemCardError = param.disconnect_mgr_state.error;
-					if (stbStandAloneMode)
+					case PROPERTY_CHANNEL_MAP:
 					{
-						systemCardState = 0;
-						systemCardError = 0;
+						int channelMapState = param.channel_map.state;
+						int channelMapError = param.channel_map.error;
+						if (stbStandAloneMode)
+						{
+							LOGINFO("stand alone mode true\n");
+							channelMapState = 2;
+							channelMapError = 0;
+						}
+						devProp["propertyName"]=SYSTEM_CHANNEL_MAP;
+						devProp["value"]=channelMapState;
+						if(channelMapError == 1)
+						{
+							err_str="RDK-03005";
+						}
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
 					}
-					devProp["propertyName"]=SYSTEM_CARD_DISCONNECTED;
-					devProp["value"]=systemCardState;
-					if(systemCardError==1)
+					case PROPERTY_CARD_DISCONNECTED:
 					{
-						err_str = "RDK-03007";
+						int systemCardState = param.disconnect_mgr_state.state;
+						int systemCardError = param.disconnect_mgr_state.error;
+						if (stbStandAloneMode)
+						{
+							systemCardState = 0;
+							systemCardError = 0;
+						}
+						devProp["propertyName"]=SYSTEM_CARD_DISCONNECTED;
+						devProp["value"]=systemCardState;
+						if(systemCardError==1)
+						{
+							err_str = "RDK-03007";
+						}
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
 					}
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it  == SYSTEM_TUNE_READY)
-				{
-					int tuneReadyState = param.TuneReadyStatus.state;
-					if (stbStandAloneMode)
+					case PROPERTY_TUNE_READY:
 					{
-						tuneReadyState = 1;
+						int tuneReadyState = param.TuneReadyStatus.state;
+						if (stbStandAloneMode)
+						{
+							tuneReadyState = 1;
+						}
+						devProp["propertyName"]=SYSTEM_TUNE_READY;
+						devProp["value"]=tuneReadyState;
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
 					}
-					devProp["propertyName"]=SYSTEM_TUNE_READY;
-					devProp["value"]=tuneReadyState;
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it  == SYSTEM_EXIT_OK)
-				{
-					devProp["propertyName"]=SYSTEM_EXIT_OK;
-					devProp["value"]=param.exit_ok_key_sequence.state;
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it ==SYSTEM_CMAC )
-				{
-					devProp["propertyName"]=SYSTEM_CMAC ;
-					devProp["value"]=param.cmac.state;
-					if(param.cmac.error == 1)
+					case PROPERTY_EXIT_OK:
 					{
-						err_str  = "RDK-03002";
+						devProp["propertyName"]=SYSTEM_EXIT_OK;
+						devProp["value"]=param.exit_ok_key_sequence.state;
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
 					}
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it ==SYSTEM_MOTO_ENTITLEMENT )
-				{
-					devProp["propertyName"]=SYSTEM_MOTO_ENTITLEMENT;
-					devProp["value"]=param.card_moto_entitlements.state;
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_DAC_INIT_TIMESTAMP)
-				{
-					devProp["propertyName"]=SYSTEM_DAC_INIT_TIMESTAMP;
-					string dac_init_str(param.dac_init_timestamp.payload);
-					devProp["value"]=dac_init_str;
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_CARD_SERIAL_NO )
-				{
-					string card_serial_str(param.card_serial_no.payload);
-					devProp["propertyName"]=SYSTEM_CARD_SERIAL_NO;
-					devProp["value"]=card_serial_str;
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_STB_SERIAL_NO )
-				{
-					string stb_string(param.stb_serial_no.payload);
-					devProp["propertyName"]=SYSTEM_STB_SERIAL_NO;
-					devProp["value"]=stb_string;
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it ==SYSTEM_ECM_MAC )
-				{
-					string ecm_mac_str(param.ecm_mac.payload);
-					devProp["propertyName"]=SYSTEM_ECM_MAC;
-					devProp["value"]=ecm_mac_str;
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_MOTO_HRV_RX)
-				{
-					devProp["propertyName"]=SYSTEM_MOTO_HRV_RX;
-					devProp["value"]=param.card_moto_hrv_rx.state;
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_CARD_CISCO_STATUS )
-				{
-					LOGINFO("property SYSTEM_CARD_CISCO_STATUS \n");
-					devProp["propertyName"]=SYSTEM_CARD_CISCO_STATUS;
-					devProp["value"]=param.card_cisco_status.state;
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_VIDEO_PRESENTING)
-				{
-					devProp["propertyName"]=SYSTEM_VIDEO_PRESENTING;
-					devProp["value"]=param.video_presenting.state;
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_HDMI_OUT )
-				{
-					devProp["propertyName"]=SYSTEM_HDMI_OUT;
-					devProp["value"]=param.hdmi_out.state;
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_HDCP_ENABLED )
-				{
-					devProp["propertyName"]=SYSTEM_HDCP_ENABLED;
-					devProp["value"]=param.hdcp_enabled.state;
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_HDMI_EDID_READ )
-				{
-					devProp["propertyName"]=SYSTEM_HDMI_EDID_READ;
-					devProp["value"]=param.hdmi_edid_read.state;
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_FIRMWARE_DWNLD )
-				{
-					devProp["propertyName"]=SYSTEM_FIRMWARE_DWNLD;
-					devProp["value"]=param.firmware_download.state;
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_TIME_SOURCE)
-				{
-					LOGWARN("%s PropertyName: %s Time source state: %d, time source error: %d",
-						__FUNCTION__,
-						SYSTEM_TIME_SOURCE.c_str(),
-						param.time_source.state,
-						param.time_source.error);
-
-					devProp["propertyName"]=SYSTEM_TIME_SOURCE;
-					devProp["value"]=param.time_source.state;
-					if(param.time_source.error == 1)
+					case PROPERTY_CMAC:
 					{
-						err_str  = "RDK-03006";
+						devProp["propertyName"]=SYSTEM_CMAC ;
+						devProp["value"]=param.cmac.state;
+						if(param.cmac.error == 1)
+						{
+							err_str  = "RDK-03002";
+						}
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
 					}
-					devProp["error"]=err_str;
-
-					std::string json;
-					devProp.ToString(json);
-					LOGWARN("%s devProp=%s", __FUNCTION__, json.c_str());
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_TIME_ZONE)
-				{
-					devProp["propertyName"]=SYSTEM_TIME_ZONE;
-					devProp["value"]=param.time_zone_available.state;
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_CA_SYSTEM)
-				{
-					devProp["propertyName"]=SYSTEM_CA_SYSTEM;
-					devProp["value"]=param.ca_system.state;
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_ESTB_IP)
-				{
-					devProp["propertyName"]=SYSTEM_ESTB_IP;
-					devProp["value"]=param.estb_ip.state;
-					if(param.estb_ip.error == 1)
+					case PROPERTY_MOTO_ENTITLEMENT:
 					{
-						err_str  = "RDK-03009";
+						devProp["propertyName"]=SYSTEM_MOTO_ENTITLEMENT;
+						devProp["value"]=param.card_moto_entitlements.state;
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
 					}
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_ECM_IP)
-				{
-					devProp["propertyName"]=SYSTEM_ECM_IP;
-					devProp["value"]=param.ecm_ip.state;
-					if(param.ecm_ip.error == 1)
+					case PROPERTY_DAC_INIT_TIMESTAMP:
 					{
-						err_str  = "RDK-03004";
+						devProp["propertyName"]=SYSTEM_DAC_INIT_TIMESTAMP;
+						string dac_init_str(param.dac_init_timestamp.payload);
+						devProp["value"]=dac_init_str;
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
 					}
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_LAN_IP)
-				{
-					devProp["propertyName"]=SYSTEM_LAN_IP;
-					devProp["value"]=param.lan_ip.state;
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_DOCSIS)
-				{
-					devProp["propertyName"]=SYSTEM_DOCSIS;
-					devProp["value"]=param.docsis.state;
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_DSG_CA_TUNNEL)
-				{
-					devProp["propertyName"]=SYSTEM_DSG_CA_TUNNEL;
-					devProp["value"]=param.dsg_ca_tunnel.state;
-					if(param.dsg_ca_tunnel.error == 1)
+					case PROPERTY_CARD_SERIAL_NO:
 					{
-						err_str  = "RDK-03003";
+						string card_serial_str(param.card_serial_no.payload);
+						devProp["propertyName"]=SYSTEM_CARD_SERIAL_NO;
+						devProp["value"]=card_serial_str;
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
 					}
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_CABLE_CARD )
-				{
-					devProp["propertyName"]=SYSTEM_CABLE_CARD;
-					devProp["value"]=param.cable_card.state;
-					if(param.cable_card.error == 1)
+					case PROPERTY_STB_SERIAL_NO:
 					{
-						err_str  = "RDK-03001";
+						string stb_string(param.stb_serial_no.payload);
+						devProp["propertyName"]=SYSTEM_STB_SERIAL_NO;
+						devProp["value"]=stb_string;
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
 					}
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_VOD_AD)
-				{
-					devProp["propertyName"]=SYSTEM_VOD_AD;
-					devProp["value"]=param.vod_ad.state;
-					devProp["error"]=err_str;
-					response_arr.Add(devProp);
-				}
-				else if(*it == SYSTEM_IP_MODE)
-				{
-					int ipState=param.ip_mode.state;
-					int ipError=param.ip_mode.error;
-					devProp["propertyName"]=SYSTEM_IP_MODE;
-					devProp["value"]=ipState;
-					devProp["error"]=ipError;
-					response_arr.Add(devProp);
-				}
+					case PROPERTY_ECM_MAC:
+					{
+						string ecm_mac_str(param.ecm_mac.payload);
+						devProp["propertyName"]=SYSTEM_ECM_MAC;
+						devProp["value"]=ecm_mac_str;
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
+					}
+					case PROPERTY_MOTO_HRV_RX:
+					{
+						devProp["propertyName"]=SYSTEM_MOTO_HRV_RX;
+						devProp["value"]=param.card_moto_hrv_rx.state;
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
+					}
+					case PROPERTY_CARD_CISCO_STATUS:
+					{
+						LOGINFO("property SYSTEM_CARD_CISCO_STATUS \n");
+						devProp["propertyName"]=SYSTEM_CARD_CISCO_STATUS;
+						devProp["value"]=param.card_cisco_status.state;
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
+					}
+					case PROPERTY_VIDEO_PRESENTING:
+					{
+						devProp["propertyName"]=SYSTEM_VIDEO_PRESENTING;
+						devProp["value"]=param.video_presenting.state;
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
+					}
+					case PROPERTY_HDMI_OUT:
+					{
+						devProp["propertyName"]=SYSTEM_HDMI_OUT;
+						devProp["value"]=param.hdmi_out.state;
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
+					}
+					case PROPERTY_HDCP_ENABLED:
+					{
+						devProp["propertyName"]=SYSTEM_HDCP_ENABLED;
+						devProp["value"]=param.hdcp_enabled.state;
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
+					}
+					case PROPERTY_HDMI_EDID_READ:
+					{
+						devProp["propertyName"]=SYSTEM_HDMI_EDID_READ;
+						devProp["value"]=param.hdmi_edid_read.state;
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
+					}
+					case PROPERTY_FIRMWARE_DWNLD:
+					{
+						devProp["propertyName"]=SYSTEM_FIRMWARE_DWNLD;
+						devProp["value"]=param.firmware_download.state;
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
+					}
+					case PROPERTY_TIME_SOURCE:
+					{
+						LOGWARN("%s PropertyName: %s Time source state: %d, time source error: %d",
+							__FUNCTION__,
+							SYSTEM_TIME_SOURCE.c_str(),
+							param.time_source.state,
+							param.time_source.error);
+
+						devProp["propertyName"]=SYSTEM_TIME_SOURCE;
+						devProp["value"]=param.time_source.state;
+						if(param.time_source.error == 1)
+						{
+							err_str  = "RDK-03006";
+						}
+						devProp["error"]=err_str;
 
-				else
-				{
-					LOGINFO("Invalid property Name\n");
-					string res="Invalid property Name";
- 					devProp["propertyName"] = *it;
-					devProp["error"]=res;
-					response_arr.Add(devProp);
+						std::string json;
+						devProp.ToString(json);
+						LOGWARN("%s devProp=%s", __FUNCTION__, json.c_str());
+						response_arr.Add(devProp);
+						break;
+					}
+					case PROPERTY_TIME_ZONE:
+					{
+						devProp["propertyName"]=SYSTEM_TIME_ZONE;
+						devProp["value"]=param.time_zone_available.state;
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
+					}
+					case PROPERTY_CA_SYSTEM:
+					{
+						devProp["propertyName"]=SYSTEM_CA_SYSTEM;
+						devProp["value"]=param.ca_system.state;
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
+					}
+					case PROPERTY_ESTB_IP:
+					{
+						devProp["propertyName"]=SYSTEM_ESTB_IP;
+						devProp["value"]=param.estb_ip.state;
+						if(param.estb_ip.error == 1)
+						{
+							err_str  = "RDK-03009";
+						}
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
+					}
+					case PROPERTY_ECM_IP:
+					{
+						devProp["propertyName"]=SYSTEM_ECM_IP;
+						devProp["value"]=param.ecm_ip.state;
+						if(param.ecm_ip.error == 1)
+						{
+							err_str  = "RDK-03004";
+						}
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
+					}
+					case PROPERTY_LAN_IP:
+					{
+						devProp["propertyName"]=SYSTEM_LAN_IP;
+						devProp["value"]=param.lan_ip.state;
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
+					}
+					case PROPERTY_DOCSIS:
+					{
+						devProp["propertyName"]=SYSTEM_DOCSIS;
+						devProp["value"]=param.docsis.state;
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
+					}
+					case PROPERTY_DSG_CA_TUNNEL:
+					{
+						devProp["propertyName"]=SYSTEM_DSG_CA_TUNNEL;
+						devProp["value"]=param.dsg_ca_tunnel.state;
+						if(param.dsg_ca_tunnel.error == 1)
+						{
+							err_str  = "RDK-03003";
+						}
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
+					}
+					case PROPERTY_CABLE_CARD:
+					{
+						devProp["propertyName"]=SYSTEM_CABLE_CARD;
+						devProp["value"]=param.cable_card.state;
+						if(param.cable_card.error == 1)
+						{
+							err_str  = "RDK-03001";
+						}
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
+					}
+					case PROPERTY_VOD_AD:
+					{
+						devProp["propertyName"]=SYSTEM_VOD_AD;
+						devProp["value"]=param.vod_ad.state;
+						devProp["error"]=err_str;
+						response_arr.Add(devProp);
+						break;
+					}
+					case PROPERTY_IP_MODE:
+					{
+						int ipState=param.ip_mode.state;
+						int ipError=param.ip_mode.error;
+						devProp["propertyName"]=SYSTEM_IP_MODE;
+						devProp["value"]=ipState;
+						devProp["error"]=ipError;
+						response_arr.Add(devProp);
+						break;
+					}
 				}
-
 			}
 
 			response["properties"]=response_arr;
@@ -589,6 +697,32 @@ namespace WPEFramework {
 			#endif
 		}
 
+		/**
+		 * @brief This function fetches all the system states from SysMgr into the snapshot.
+		 * Must be called with m_systemStatesMutex held.
+		 *
+		 * @return true if the snapshot is valid.
+		 */
+		bool StateObserver::refreshSystemStates()
+		{
+			IARM_Result_t res = IARM_Bus_Call(IARM_BUS_SYSMGR_NAME, IARM_BUS_SYSMGR_API_GetSystemStates, &m_systemStates, sizeof(m_systemStates));
+			m_systemStatesValid = (res == IARM_RESULT_SUCCESS);
+			if (!m_systemStatesValid)
+			{
+				LOGWARN("IARM_BUS_SYSMGR_API_GetSystemStates failed %d", res);
+			}
+			return m_systemStatesValid;
+		}
+
+		/**
+		 * @brief This function drops the snapshot, the next getValues fetches the system states again.
+		 */
+		void StateObserver::invalidateSystemStates()
+		{
+			std::lock_guard<std::mutex> lock(m_systemStatesMutex);
+			m_systemStatesValid = false;
+		}
+
 
 		 /**
 		 * @brief This function registers Listeners to properties.It adds the properties to a registered properties list.
@@ -715,7 +849,6 @@ namespace WPEFramework {
 		 */
 		void StateObserver::onReportStateObserverEvents(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
 		{
-			IARM_Bus_SYSMgr_GetSystemStates_Param_t systemStates;
 			JsonObject params;
 			int state=0;
 			int error=0;
@@ -725,9 +858,12 @@ namespace WPEFramework {
 			{
 				LOGWARN(" No need handle other events..");
 			}
-			else
+			else if (StateObserver::_instance)
 			{
 				LOGINFO(" Property changed event received ");
+				/* Keep the getValues snapshot up to date */
+				std::unique_lock<std::mutex> lock(StateObserver::_instance->m_systemStatesMutex);
+				IARM_Bus_SYSMgr_GetSystemStates_Param_t &systemStates = StateObserver::_instance->m_systemStates;
 				IARM_Bus_SYSMgr_EventData_t *sysEventData = (IARM_Bus_SYSMgr_EventData_t*)data;
 				IARM_Bus_SYSMgr_SystemState_t stateId = sysEventData->data.systemStates.stateId;
 				state = sysEventData->data.systemStates.state;
@@ -800,8 +936,8 @@ namespace WPEFramework {
 						{
 						systemStates.dac_init_timestamp.state = state;
 						systemStates.dac_init_timestamp.error = error;
-						strncpy(systemStates.dac_init_timestamp.payload,payload,strlen(payload));
-						systemStates.dac_init_timestamp.payload[strlen(payload)]='\0';
+						strncpy(systemStates.dac_init_timestamp.payload,payload,sizeof(systemStates.dac_init_timestamp.payload) - 1);
+						systemStates.dac_init_timestamp.payload[sizeof(systemStates.dac_init_timestamp.payload) - 1]='\0';
 						if(StateObserver::_instance)
 							StateObserver::_instance->setProp(params,SYSTEM_DAC_INIT_TIMESTAMP,state,error);
 						string payload_str(payload);
@@ -812,8 +948,8 @@ namespace WPEFramework {
 					case IARM_BUS_SYSMGR_SYSSTATE_CABLE_CARD_SERIAL_NO:
 						{
 						systemStates.card_serial_no.error =error;
-						strncpy(systemStates.card_serial_no.payload,payload,strlen(payload));
-						systemStates.card_serial_no.payload[strlen(payload)]='\0';
+						strncpy(systemStates.card_serial_no.payload,payload,sizeof(systemStates.card_serial_no.payload) - 1);
+						systemStates.card_serial_no.payload[sizeof(systemStates.card_serial_no.payload) - 1]='\0';
 						params["propertyName"]=SYSTEM_CARD_SERIAL_NO;
 						params["error"]=error;
 						string payload_str(payload);
@@ -824,8 +960,8 @@ namespace WPEFramework {
 					 case IARM_BUS_SYSMGR_SYSSTATE_STB_SERIAL_NO:
 						{
 						systemStates.stb_serial_no.error =error;
-						strncpy(systemStates.stb_serial_no.payload,payload,strlen(payload));
-						systemStates.stb_serial_no.payload[strlen(payload)]='\0';
+						strncpy(systemStates.stb_serial_no.payload,payload,sizeof(systemStates.stb_serial_no.payload) - 1);
+						systemStates.stb_serial_no.payload[sizeof(systemStates.stb_serial_no.payload) - 1]='\0';
 						params["propertyName"]=SYSTEM_STB_SERIAL_NO;
 						params["error"]=error;
 						string payload_str(payload);
@@ -960,8 +1096,8 @@ namespace WPEFramework {
 					case IARM_BUS_SYSMGR_SYSSTATE_ECM_MAC:
 						{
 						systemStates.ecm_mac.error =error;
-						strncpy(systemStates.ecm_mac.payload,payload,strlen(payload));
-						systemStates.ecm_mac.payload[strlen(payload)]='\0';
+						strncpy(systemStates.ecm_mac.payload,payload,sizeof(systemStates.ecm_mac.payload) - 1);
+						systemStates.ecm_mac.payload[sizeof(systemStates.ecm_mac.payload) - 1]='\0';
 						params["propertyName"]=SYSTEM_ECM_MAC;
 						params["error"]=error;
 						string payload_str(payload);
@@ -973,8 +1109,8 @@ namespace WPEFramework {
 						{
 						systemStates.ip_mode.state=state;
 						systemStates.ip_mode.error =error;
-						strncpy(systemStates.ip_mode.payload,payload,strlen(payload));
-						systemStates.ip_mode.payload[strlen(payload)]='\0';
+						strncpy(systemStates.ip_mode.payload,payload,sizeof(systemStates.ip_mode.payload) - 1);
+						systemStates.ip_mode.payload[sizeof(systemStates.ip_mode.payload) - 1]='\0';
 						if(StateObserver::_instance)
 							StateObserver::_instance->setProp(params,SYSTEM_IP_MODE,state,error);
 						string payload_str(payload);
@@ -982,8 +1118,10 @@ namespace WPEFramework {
 						break;
 						}
 					default:
+						/* Not served by getValues, nothing to keep */
 						break;
 				}
+				lock.unlock();
 
 				//notify the params
 				if(StateObserver::_instance)
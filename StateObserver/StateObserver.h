@@ -31,9 +31,11 @@
 #ifndef STATEOBSERVER_H
 #define STATEOBSERVER_H
 #include <cjson/cJSON.h>
+#include <mutex>
 
 #include "Module.h"
 #include "libIBus.h"
+#include "sysMgr.h"
 #include "utils.h"
 #include "utils.h"
 #include "AbstractPlugin.h"
@@ -121,6 +123,8 @@ namespace WPEFramework {
             uint32_t getRegisteredPropertyNames(const JsonObject &parameters, JsonObject &response);
 			uint32_t getNameWrapper(const JsonObject& parameters, JsonObject& response);
 			void getVal(std::vector<string> pname,JsonObject& response);
+			bool refreshSystemStates();
+			void invalidateSystemStates();
 			void InitializeIARM();
 			void DeinitializeIARM();
 			//End methods
@@ -146,6 +150,10 @@ namespace WPEFramework {
 			static StateObserver* _instance;
 		private:
 			uint32_t m_apiVersionNumber;
+			// Snapshot of the SysMgr system states, kept up to date by the state change events
+			IARM_Bus_SYSMgr_GetSystemStates_Param_t m_systemStates;
+			bool m_systemStatesValid;
+			std::mutex m_systemStatesMutex;
 		};
 
 	} // namespace Plugin
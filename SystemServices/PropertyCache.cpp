@@ -0,0 +1,166 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "PropertyCache.h"
+#include "utils.h"
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        static const char* sourceName(PropertyCache::Source source)
+        {
+            switch (source) {
+                case PropertyCache::SOURCE_FILE:    return "file";
+                case PropertyCache::SOURCE_SCRIPT:  return "script";
+                case PropertyCache::SOURCE_IARM:    return "IARM";
+                case PropertyCache::SOURCE_RFC:     return "RFC";
+            }
+            return "unknown";
+        }
+
+        PropertyCache::PropertyCache()
+        {
+        }
+
+        PropertyCache::~PropertyCache()
+        {
+            stop();
+        }
+
+        void PropertyCache::define(const std::string& name, Source source, Invalidation invalidation, int ttlMs, bool prewarm, const Resolver& resolver)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            Property& property = m_properties[name];
+            property.source = source;
+            property.invalidation = invalidation;
+            property.ttl = std::chrono::milliseconds(ttlMs);
+            property.prewarm = prewarm;
+            property.resolver = resolver;
+            property.valid = false;
+            property.resolving = false;
+            property.generation = 0;
+        }
+
+        bool PropertyCache::get(const std::string& name, std::string& value)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            auto it = m_properties.find(name);
+            if (it == m_properties.end()) {
+                LOGERR("Unknown property '%s'", name.c_str());
+                return false;
+            }
+            Property& property = it->second;
+
+            while (property.resolving)
+                m_resolved.wait(lock);
+
+            if (property.valid && (INVALIDATE_AFTER_TTL != property.invalidation || std::chrono::steady_clock::now() < property.expiry)) {
+                value = property.value;
+                return true;
+            }
+
+            property.resolving = true;
+            unsigned int generation = property.generation;
+            Resolver resolver = property.resolver;
+            lock.unlock();
+
+            auto start = std::chrono::steady_clock::now();
+            std::string resolved;
+            bool success = resolver(resolved);
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+            LOGINFO("Property '%s' %s from %s in %lld ms", name.c_str(), success ? "resolved" : "not resolved",
+                    sourceName(property.source), (long long)elapsed);
+
+            lock.lock();
+            property.resolving = false;
+            if (success && generation == property.generation) {
+                property.value = resolved;
+                property.valid = true;
+                property.expiry = std::chrono::steady_clock::now() + property.ttl;
+            }
+            m_resolved.notify_all();
+
+            if (success)
+                value = resolved;
+            return success;
+        }
+
+        void PropertyCache::invalidate(const std::string& name)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            auto it = m_properties.find(name);
+            if (it != m_properties.end()) {
+                it->second.valid = false;
+                it->second.generation++;
+            }
+        }
+
+        void PropertyCache::prewarm()
+        {
+            std::vector<std::string> names;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (auto& property : m_properties) {
+                    if (property.second.prewarm)
+                        names.push_back(property.first);
+                }
+            }
+
+            stop();
+            m_prewarmThread = std::thread([this, names]() {
+                auto start = std::chrono::steady_clock::now();
+                std::vector<std::thread> workers;
+                for (auto& name : names) {
+                    workers.push_back(std::thread([this, name]() {
+                        std::string value;
+                        get(name, value);
+                    }));
+                }
+                for (auto& worker : workers)
+                    worker.join();
+                LOGINFO("%d properties prewarmed in %lld ms", (int)names.size(),
+                        (long long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+            });
+        }
+
+        void PropertyCache::stop()
+        {
+            if (m_prewarmThread.joinable())
+                m_prewarmThread.join();
+        }
+
+        PropertyCache::Resolver PropertyCache::script(const std::vector<std::string>& argv, int timeoutMs)
+        {
+            return [argv, timeoutMs](std::string& value) {
+                Utils::ProcessRunner::Result result = Utils::ProcessRunner::run(argv, timeoutMs);
+                if (!result.succeeded())
+                    return false;
+
+                const char* whitespace = " \n\r\t";
+                size_t begin = result.output.find_first_not_of(whitespace);
+                size_t end = result.output.find_last_not_of(whitespace);
+                value = (std::string::npos == begin) ? "" : result.output.substr(begin, end - begin + 1);
+                return true;
+            };
+        }
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,89 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ProcessRunner.h"
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        // Device identity and version properties which are costly to get (a script to run, an IARM
+        // call to make) but change at most a few times while the device is up.
+        //
+        // A property is resolved on its first access and kept until its invalidation trigger fires:
+        // never, an event the plugin passes on through invalidate(), or the end of its time to live.
+        // Accesses made while a property is being resolved wait for that resolution. A failed
+        // resolution is not kept, the next access tries again.
+        class PropertyCache {
+        public:
+            enum Source { SOURCE_FILE, SOURCE_SCRIPT, SOURCE_IARM, SOURCE_RFC };
+            enum Invalidation { INVALIDATE_NEVER, INVALIDATE_ON_EVENT, INVALIDATE_AFTER_TTL };
+
+            // Returns false when the value could not be resolved
+            typedef std::function<bool(std::string& value)> Resolver;
+
+            PropertyCache();
+            ~PropertyCache();
+            PropertyCache(const PropertyCache&) = delete;
+            PropertyCache& operator=(const PropertyCache&) = delete;
+
+            // ttlMs only matters with INVALIDATE_AFTER_TTL, prewarm marks the properties prewarm() resolves
+            void define(const std::string& name, Source source, Invalidation invalidation, int ttlMs, bool prewarm, const Resolver& resolver);
+            bool get(const std::string& name, std::string& value);
+            void invalidate(const std::string& name);
+
+            // Resolves the prewarmed properties in parallel, on a background thread
+            void prewarm();
+            void stop();
+
+            // Trimmed output of a program, when it exited with 0
+            static Resolver script(const std::vector<std::string>& argv, int timeoutMs = PROCESS_RUNNER_DEFAULT_TIMEOUT_MS);
+
+        private:
+            struct Property {
+                Source source;
+                Invalidation invalidation;
+                std::chrono::milliseconds ttl;
+                bool prewarm;
+                Resolver resolver;
+
+                bool valid;
+                bool resolving;
+                unsigned int generation;    // Bumped by invalidate(), a resolution started before is dropped
+                std::string value;
+                std::chrono::steady_clock::time_point expiry;
+            };
+
+            std::mutex m_mutex;
+            std::condition_variable m_resolved;
+            std::map<std::string, Property> m_properties;
+            std::thread m_prewarmThread;
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -40,6 +40,7 @@
 #include "SystemServices.h"
 #include "StateObserverHelper.h"
 #include "utils.h"
+#include "ProcessRunner.h"
 
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
 #include "libIARM.h"
@@ -62,6 +63,16 @@ using namespace std;
 #define SYSSRV_MAJOR_VERSION 1
 #define SYSSRV_MINOR_VERSION 0
 
+#define SYSSRV_PROPERTY_PDRI_VERSION       "pdriVersion"
+#define SYSSRV_PROPERTY_PARTNER_ID         "partnerId"
+#define SYSSRV_PROPERTY_ACCOUNT_ID         "accountId"
+#define SYSSRV_PROPERTY_MODEL              "model"
+#define SYSSRV_PROPERTY_SERIAL_NUMBER      "serialNumber"
+#define SYSSRV_PROPERTY_DOWNLOAD_PERCENT   "downloadPercent"
+
+#define SYSSRV_ACCOUNT_CACHE_TTL_MS         (60 * 1000)         // Partner and account ids, set on activation
+#define SYSSRV_DOWNLOAD_PERCENT_TTL_MS      1000                // Shared by the clients polling the progress
+
 /**
  * @struct firmwareUpdate
  * @brief This structure contains information of firmware update.
@@ -230,6 +241,27 @@ namespace WPEFramework {
                 IARM_EventId_t eventId, void *data, size_t len);
 #endif /* defined(USE_IARMBUS) || defined(USE_IARM_BUS) */
 
+#ifdef ENABLE_DEVICE_MANUFACTURER_INFO
+        /**
+         * @brief reads a serialized item from the manufacturer library
+         *
+         * @return Returns true if the IARM call succeeded.
+         */
+        static bool readManufacturerData(mfrSerializedType_t type, string& value)
+        {
+            IARM_Bus_MFRLib_GetSerializedData_Param_t param;
+            param.bufLen = 0;
+            param.type = type;
+            IARM_Result_t result = IARM_Bus_Call(IARM_BUS_MFRLIB_NAME, IARM_BUS_MFRLIB_API_GetSerializedData, &param, sizeof(param));
+            param.buffer[param.bufLen] = '\0';
+
+            LOGWARN("SystemService getDeviceInfo param type %d result %s", param.type, param.buffer);
+
+            value = param.buffer;
+            return (result == IARM_RESULT_SUCCESS);
+        }
+#endif /* ENABLE_DEVICE_MANUFACTURER_INFO */
+
         SERVICE_REGISTRATION(SystemServices, SYSSRV_MAJOR_VERSION,
                 SYSSRV_MINOR_VERSION);
 
@@ -245,6 +277,8 @@ namespace WPEFramework {
         {
             SystemServices::_instance = this;
 
+            defineProperties();
+
             //Initialise timer with interval and callback function.
             m_operatingModeTimer.setInterval(updateDuration, MODE_TIMER_UPDATE_INTERVAL);
 
@@ -357,6 +391,7 @@ namespace WPEFramework {
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
             InitializeIARM();
 #endif /* defined(USE_IARMBUS) || defined(USE_IARM_BUS) */
+            m_properties.prewarm();
             /* On Success; return empty to indicate no error text. */
             return (string());
         }
@@ -367,6 +402,60 @@ namespace WPEFramework {
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
             DeinitializeIARM();
 #endif /* defined(USE_IARMBUS) || defined(USE_IARM_BUS) */
+            m_properties.stop();
+        }
+
+        /***
+         * @brief : Declares where the cached device properties come from and when they go stale.
+         */
+        void SystemServices::defineProperties()
+        {
+            m_properties.define(SYSSRV_PROPERTY_PDRI_VERSION, PropertyCache::SOURCE_SCRIPT,
+                    PropertyCache::INVALIDATE_ON_EVENT, 0, true,
+                    PropertyCache::script({"/usr/bin/mfr_util", "--PDRIVersion"}));
+            m_properties.define(SYSSRV_PROPERTY_PARTNER_ID, PropertyCache::SOURCE_SCRIPT,
+                    PropertyCache::INVALIDATE_AFTER_TTL, SYSSRV_ACCOUNT_CACHE_TTL_MS, true,
+                    PropertyCache::script({"/bin/sh", "-c", ". /lib/rdk/getPartnerId.sh; getPartnerId"}));
+            m_properties.define(SYSSRV_PROPERTY_ACCOUNT_ID, PropertyCache::SOURCE_SCRIPT,
+                    PropertyCache::INVALIDATE_AFTER_TTL, SYSSRV_ACCOUNT_CACHE_TTL_MS, true,
+                    PropertyCache::script({"/bin/sh", "-c", ". /lib/rdk/getAccountId.sh; getAccountId"}));
+            m_properties.define(SYSSRV_PROPERTY_MODEL, PropertyCache::SOURCE_SCRIPT,
+                    PropertyCache::INVALIDATE_NEVER, 0, true,
+                    [](string& value) {
+                        value = getModel();
+                        return ("ERROR" != value);
+                    });
+            m_properties.define(SYSSRV_PROPERTY_SERIAL_NUMBER, PropertyCache::SOURCE_SCRIPT,
+                    PropertyCache::INVALIDATE_NEVER, 0, true,
+                    [](string& value) {
+                        std::vector<string> lines;
+                        if (!Utils::fileExists("/lib/rdk/getStateDetails.sh")) {
+                            return false;
+                        }
+                        Utils::ProcessRunner::run({"/lib/rdk/getStateDetails.sh", "STB_SER_NO"});
+                        if (!getFileContent(TMP_SERIAL_NUMBER_FILE, lines) || lines.empty()) {
+                            return false;
+                        }
+                        value = lines.front();
+                        return true;
+                    });
+            m_properties.define(SYSSRV_PROPERTY_DOWNLOAD_PERCENT, PropertyCache::SOURCE_FILE,
+                    PropertyCache::INVALIDATE_AFTER_TTL, SYSSRV_DOWNLOAD_PERCENT_TTL_MS, false,
+                    [](string& value) {
+                        if (!Utils::fileExists(CURL_PROGRESS_FILE)) {
+                            return false;
+                        }
+                        value = getCurlProgressPercent(CURL_PROGRESS_FILE);
+                        return true;
+                    });
+#ifdef ENABLE_DEVICE_MANUFACTURER_INFO
+            m_properties.define(MODEL_NAME, PropertyCache::SOURCE_IARM,
+                    PropertyCache::INVALIDATE_NEVER, 0, false,
+                    [](string& value) { return readManufacturerData(mfrSERIALIZED_TYPE_SKYMODELNAME, value); });
+            m_properties.define(HARDWARE_ID, PropertyCache::SOURCE_IARM,
+                    PropertyCache::INVALIDATE_NEVER, 0, false,
+                    [](string& value) { return readManufacturerData(mfrSERIALIZED_TYPE_HWID, value); });
+#endif
         }
 
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
@@ -426,11 +515,10 @@ namespace WPEFramework {
             string otherReason = "";
             bool result = false;
 
-            //TODO: Replace system command
-            nfxResult = system("pgrep nrdPluginApp");
+            nfxResult = Utils::ProcessRunner::run({"pgrep", "nrdPluginApp"}).exitCode;
             if (E_OK == nfxResult) {
                 LOGINFO("SystemService shutting down Netflix...\n");
-                nfxResult = system("pkill nrdPluginApp");
+                nfxResult = Utils::ProcessRunner::run({"pkill", "nrdPluginApp"}).exitCode;
                 if (E_OK == nfxResult) {
                     //give Netflix process some time to terminate gracefully.
                     sleep(10);
@@ -522,8 +610,7 @@ namespace WPEFramework {
                  mocaFile.open(MOCA_FILE, ios::out);
                      if (mocaFile) {
                          mocaFile.close();
-                         /* TODO: replace system() */
-                         eRetval = system("/etc/init.d/moca_init start");
+                         eRetval = Utils::ProcessRunner::run({"/etc/init.d/moca_init", "start"}, 0).exitCode;
                      } else {
                          LOGERR("moca file open failed\n");
                          populateResponseWithError(SysSrv_FileAccessFailed, response);
@@ -531,8 +618,7 @@ namespace WPEFramework {
                  } else {
                      std::remove(MOCA_FILE);
                      if (!Utils::fileExists(MOCA_FILE)) {
-                         /* TODO: replace system() */
-                         eRetval = system("/etc/init.d/moca_init start");
+                         eRetval = Utils::ProcessRunner::run({"/etc/init.d/moca_init", "start"}, 0).exitCode;
                      } else {
                          LOGERR("moca file remove failed\n");
                          populateResponseWithError(SysSrv_FileAccessFailed, response);
@@ -617,22 +703,10 @@ namespace WPEFramework {
         {
             LOGWARN("SystemService getDeviceInfo query %s", parameter.c_str());
 
-            IARM_Bus_MFRLib_GetSerializedData_Param_t param;
-            param.bufLen = 0;
-            param.type = mfrSERIALIZED_TYPE_MANUFACTURER;
-            if (!parameter.compare(MODEL_NAME)) {
-                param.type = mfrSERIALIZED_TYPE_SKYMODELNAME;
-            } else if (!parameter.compare(HARDWARE_ID)) {
-                param.type = mfrSERIALIZED_TYPE_HWID;
-            }
-            IARM_Result_t result = IARM_Bus_Call(IARM_BUS_MFRLIB_NAME, IARM_BUS_MFRLIB_API_GetSerializedData, &param, sizeof(param));
-            param.buffer[param.bufLen] = '\0';
-
-            LOGWARN("SystemService getDeviceInfo param type %d result %s", param.type, param.buffer);
-
+            string value;
             bool status = false;
-            if (result == IARM_RESULT_SUCCESS) {
-                response[parameter.c_str()] = string(param.buffer);
+            if (m_properties.get(parameter, value)) {
+                response[parameter.c_str()] = value;
                 status = true;
             } else {
                 populateResponseWithError(SysSrv_ManufacturerDataReadFailed, response);
@@ -778,16 +852,13 @@ namespace WPEFramework {
                             result = false;
                         }
 
-                        string command = "";
+                        bool fileStat = false;
                         if (MODE_WAREHOUSE == m_currentMode) {
-                            command = "touch ";
+                            fileStat = !!std::ofstream(WAREHOUSE_MODE_FILE, ios::app);
                         } else {
-                            command = "rm -f ";
+                            fileStat = (0 == std::remove(WAREHOUSE_MODE_FILE) || ENOENT == errno);
                         }
-                        command += WAREHOUSE_MODE_FILE;
-                        /* TODO: replace with system alternate. */
-                        int sysStat = system(command.c_str());
-                        LOGINFO("system returned %d\n", sysStat);
+                        LOGINFO("updating %s %s\n", WAREHOUSE_MODE_FILE, fileStat ? "succeeded" : "failed");
                         //set values in temp file so they can be restored in receiver restarts / crashes
                         m_temp_settings.setValue("mode", m_currentMode);
                         m_temp_settings.setValue("mode_duration", m_remainingDuration);
@@ -914,7 +985,6 @@ namespace WPEFramework {
 
             string ipAddress = collectDeviceInfo("estb_ip");
             removeCharsFromString(ipAddress, "\n\r");
-            model = getModel();
 
             eStbMac = collectDeviceInfo("estb_mac");
             removeCharsFromString(eStbMac, "\n\r");
@@ -938,14 +1008,12 @@ namespace WPEFramework {
                 fullCommand.replace(start_pos, match.length(), "https://");
             }
             LOGWARN("fullCommand : '%s'\n", fullCommand.c_str());
-            pdriVersion = Utils::cRunScript("/usr/bin/mfr_util --PDRIVersion");
-            pdriVersion = trim(pdriVersion);
-
-            partnerId = Utils::cRunScript("sh -c \". /lib/rdk/getPartnerId.sh; getPartnerId\"");
-            partnerId = trim(partnerId);
-
-            accountId = Utils::cRunScript("sh -c \". /lib/rdk/getAccountId.sh; getAccountId\"");
-            accountId = trim(accountId);
+            if (_instance) {
+                _instance->m_properties.get(SYSSRV_PROPERTY_MODEL, model);
+                _instance->m_properties.get(SYSSRV_PROPERTY_PDRI_VERSION, pdriVersion);
+                _instance->m_properties.get(SYSSRV_PROPERTY_PARTNER_ID, partnerId);
+                _instance->m_properties.get(SYSSRV_PROPERTY_ACCOUNT_ID, accountId);
+            }
 
             string timeZone = getTimeZoneDSTHelper();
             string utcDateTime = currentDateTimeUtc("%a %B %e %I:%M:%S %Z %Y");
@@ -1172,7 +1240,9 @@ namespace WPEFramework {
             std::string estbMac = collectDeviceInfo("estb_mac");
             removeCharsFromString(estbMac, "\n\r");
             rConf["eStbMac"] = estbMac;
-            rConf["model"] = getModel();
+            string model;
+            m_properties.get(SYSSRV_PROPERTY_MODEL, model);
+            rConf["model"] = model;
             rConf["firmwareVersion"] = stbVersion;
             response["xconfParams"] = rConf;
             returnResponse(true);
@@ -1249,26 +1319,19 @@ namespace WPEFramework {
         bool SystemServices::getSerialNumberSnmp(JsonObject& response)
         {
             bool retAPIStatus = false;
-	    if (!Utils::fileExists("/lib/rdk/getStateDetails.sh")) {
+	    string serialNumber;
+	    if (m_properties.get(SYSSRV_PROPERTY_SERIAL_NUMBER, serialNumber)) {
+		response["serialNumber"] = serialNumber;
+		retAPIStatus = true;
+	    } else if (!Utils::fileExists("/lib/rdk/getStateDetails.sh")) {
 		LOGERR("/lib/rdk/getStateDetails.sh not found.");
 		populateResponseWithError(SysSrv_FileNotPresent, response);
+	    } else if (!Utils::fileExists(TMP_SERIAL_NUMBER_FILE)) {
+		LOGERR("%s file not found.", TMP_SERIAL_NUMBER_FILE);
+		populateResponseWithError(SysSrv_FileNotPresent, response);
 	    } else {
-		/* TODO: remove system() once alternate available. */
-		system("/lib/rdk/getStateDetails.sh STB_SER_NO");
-		std::vector<string> lines;
-		if (true == Utils::fileExists(TMP_SERIAL_NUMBER_FILE)) {
-		    if (getFileContent(TMP_SERIAL_NUMBER_FILE, lines)) {
-			string serialNumber = lines.front();
-			response["serialNumber"] = serialNumber;
-			retAPIStatus = true;
-		    } else {
-			LOGERR("Unexpected contents in %s file.", TMP_SERIAL_NUMBER_FILE);
-			populateResponseWithError(SysSrv_FileContentUnsupported, response);
-		    }
-		} else {
-		    LOGERR("%s file not found.", TMP_SERIAL_NUMBER_FILE);
-		    populateResponseWithError(SysSrv_FileNotPresent, response);
-		}
+		LOGERR("Unexpected contents in %s file.", TMP_SERIAL_NUMBER_FILE);
+		populateResponseWithError(SysSrv_FileContentUnsupported, response);
 	    }
 	    return retAPIStatus;
 	}
@@ -1302,23 +1365,12 @@ namespace WPEFramework {
         {
             bool retStatus = false;
             int m_downloadPercent = -1;
-            if (Utils::fileExists("/opt/curl_progress")) {
-                /* TODO: replace with new implementation. */
-                FILE* fp = popen(CAT_DWNLDPROGRESSFILE_AND_GET_INFO, "r");
-                if (NULL != fp) {
-                    char output[8];
-                    if (NULL != fgets (output, 8, fp)) {
-                        output[strcspn(output, "\n")] = 0;
-                        if (*output) {
-                            m_downloadPercent = strtol(output, NULL, 10);
-                        }
-                        LOGWARN("FirmwareDownloadPercent = [%d]\n", m_downloadPercent);
-                    } else {
-                        LOGERR("Cannot read output from command\n");
-                    }
-                    pclose(fp);
+            string percent;
+            if (m_properties.get(SYSSRV_PROPERTY_DOWNLOAD_PERCENT, percent)) {
+                if (!percent.empty()) {
+                    m_downloadPercent = strtol(percent.c_str(), NULL, 10);
                 } else {
-                    LOGERR("Cannot run command\n");
+                    LOGERR("Cannot read progress from %s\n", CURL_PROGRESS_FILE);
                 }
 
                 LOGWARN("FirmwareDownloadPercent = [%d]", m_downloadPercent);
@@ -1479,6 +1531,10 @@ namespace WPEFramework {
             const FirmwareUpdateState firmwareUpdateState = (FirmwareUpdateState)newState;
             params["firmwareUpdateStateChange"] = (int)firmwareUpdateState;
             LOGINFO("New firmwareUpdateState = %d\n", (int)firmwareUpdateState);
+            if (FirmwareUpdateStateValidationComplete == firmwareUpdateState) {
+                /* A new image may come with a new PDRI. */
+                m_properties.invalidate(SYSSRV_PROPERTY_PDRI_VERSION);
+            }
             sendNotify(EVT_ONFIRMWAREUPDATESTATECHANGED, params);
         }
 
@@ -1494,14 +1550,12 @@ namespace WPEFramework {
             JsonObject params;
             string macTypeList[] = {"ecm_mac", "estb_mac", "moca_mac",
                 "eth_mac", "wifi_mac", "bluetooth_mac", "rf4ce_mac"};
-            string tempBuffer, cmdBuffer;
+            string tempBuffer;
 
             for (i = 0; i < sizeof(macTypeList)/sizeof(macTypeList[0]); i++) {
-                cmdBuffer.clear();
-                cmdBuffer = "/lib/rdk/getDeviceDetails.sh read " + macTypeList[i];
-                LOGWARN("cmd = %s\n", cmdBuffer.c_str());
+                LOGWARN("cmd = /lib/rdk/getDeviceDetails.sh read %s\n", macTypeList[i].c_str());
                 tempBuffer.clear();
-                tempBuffer = Utils::cRunScript(cmdBuffer.c_str());
+                tempBuffer = Utils::ProcessRunner::run({"/lib/rdk/getDeviceDetails.sh", "read", macTypeList[i]}).output;
                 removeCharsFromString(tempBuffer, "\n\r");
                 LOGWARN("resp = %s\n", tempBuffer.c_str());
                 params[macTypeList[i].c_str()] = (tempBuffer.empty()? "00:00:00:00:00:00" : tempBuffer.c_str());
@@ -1587,8 +1641,7 @@ namespace WPEFramework {
 					LOGERR("Empty timeZone received.");
 				} else {
 					if (!dirExists(dir)) {
-						std::string command = "mkdir -p " + dir + " \0";
-						Utils::cRunScript(command.c_str());
+						Utils::ProcessRunner::run({"mkdir", "-p", dir});
 					} else {
 						//Do nothing//
 					}
@@ -1883,19 +1936,10 @@ namespace WPEFramework {
         {
             bool retAPIStatus = false;
 
-                /* FIXME: popen in use */
-                FILE *pipe = NULL;
-                char cmd[128] = {'\0'};
-
-                snprintf(cmd, 127, "rm -f %s", STANDBY_REASON_FILE);
-                pipe = popen(cmd, "r");
-                if (pipe) {
-                    retAPIStatus = ((pclose(pipe) != -1)? true: false);
-                    if (false == retAPIStatus) {
-                        populateResponseWithError(SysSrv_Unexpected, response);
-                    }
-                } else {
-                    populateResponseWithError(SysSrv_Unexpected, response);
+            retAPIStatus = (0 == std::remove(STANDBY_REASON_FILE) || ENOENT == errno);
+            if (false == retAPIStatus) {
+                LOGERR("Cannot remove %s: %s\n", STANDBY_REASON_FILE, strerror(errno));
+                populateResponseWithError(SysSrv_Unexpected, response);
             }
 
             returnResponse(retAPIStatus);
@@ -2080,8 +2124,6 @@ namespace WPEFramework {
                 JsonObject& response)
         {
             const std::regex re("(\\w|-|\\.)+");
-            const std::string baseCommand = "tr181Set -g ";
-            const std::string redirection = " 2>&1";
             bool retAPIStatus = false;
             JsonObject hash;
             JsonArray jsonRFCList;
@@ -2090,7 +2132,7 @@ namespace WPEFramework {
 		    returnResponse(retAPIStatus);
 	    }
             jsonRFCList = parameters["rfcList"].Array();
-            std::string cmdParams, cmdResponse;
+            std::string cmdResponse;
 
             if (!jsonRFCList.Length()) {
                 populateResponseWithError(SysSrv_UnSupportedFormat, response);
@@ -2105,10 +2147,9 @@ namespace WPEFramework {
                         hash[jsonRFCList[i].String().c_str()] = "Invalid charset found";
                         continue;
                     } else {
-                        cmdResponse = "";
-                        cmdParams = baseCommand + jsonRFCList[i].String() + redirection + "\0";
-                        LOGINFO("executing %s\n", cmdParams.c_str());
-                        cmdResponse = Utils::cRunScript(cmdParams.c_str());
+                        LOGINFO("executing tr181Set -g %s\n", jsonRFCList[i].String().c_str());
+                        Utils::ProcessRunner::Result result = Utils::ProcessRunner::run({"tr181Set", "-g", jsonRFCList[i].String()});
+                        cmdResponse = result.output + result.error;
                         if (!cmdResponse.empty()) {
                             removeCharsFromString(cmdResponse, "\n\r");
                             hash[jsonRFCList[i].String().c_str()] = cmdResponse;
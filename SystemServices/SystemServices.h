@@ -41,6 +41,7 @@
 #include "sysMgr.h"
 #include "cSettings.h"
 #include "cTimer.h"
+#include "PropertyCache.h"
 
 /* System Services Triggered Events. */
 #define EVT_ONSYSTEMSAMPLEEVENT           "onSampleEvent"
@@ -85,6 +86,7 @@ namespace WPEFramework {
                 typedef Core::JSON::Boolean JBool;
                 string m_stbVersionString;
                 cSettings m_cacheService;
+                PropertyCache m_properties;
                 static cSettings m_temp_settings;
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
                 static IARM_Bus_SYSMgr_GetSystemStates_Param_t paramGetSysState;
@@ -109,6 +111,7 @@ namespace WPEFramework {
                 static void startModeTimer(int duration);
                 static void stopModeTimer();
                 static void updateDuration();
+                void defineProperties();
 #ifdef ENABLE_DEVICE_MANUFACTURER_INFO
                 bool getManufacturerData(const string& parameter, JsonObject& response);
 #endif
@@ -0,0 +1,335 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TTSCache.h"
+#include "logger.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <iterator>
+
+#define TTS_CACHE_FILE_SUFFIX ".ttsc"
+#define TTS_CACHE_MAX_CONTENT_TYPE 128
+
+namespace TTS {
+
+// "type/subtype", possibly with parameters. Also tells files written before the
+// content type was stored apart, their audio starts where the content type is expected
+static bool isContentType(const std::string &contentType) {
+    if(contentType.empty() || contentType.size() > TTS_CACHE_MAX_CONTENT_TYPE || contentType.find('/') == std::string::npos)
+        return false;
+    return std::all_of(contentType.begin(), contentType.end(), [](char c) { return isprint((unsigned char)c) != 0; });
+}
+
+TTSCache::TTSCache() :
+    m_memoryLimit(0),
+    m_memoryUsed(0),
+    m_diskLimit(0),
+    m_diskUsed(0),
+    m_maxEntrySize(0),
+    m_hits(0),
+    m_misses(0) {
+}
+
+TTSCache::~TTSCache() {
+    TTSLOG_INFO("Cache hits=%u, misses=%u", m_hits, m_misses);
+}
+
+void TTSCache::configure(size_t memoryLimit, size_t diskLimit, const std::string &directory, size_t maxEntrySize) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_memoryLimit = memoryLimit;
+    m_diskLimit = diskLimit;
+    m_maxEntrySize = maxEntrySize;
+    m_directory = directory;
+    if(!m_directory.empty() && m_directory.back() != '/')
+        m_directory.append("/");
+
+    evictMemory();
+
+    m_diskLru.clear();
+    m_diskIndex.clear();
+    m_diskUsed = 0;
+    if(!m_directory.empty() && m_diskLimit > 0)
+        loadDiskIndex();
+
+    TTSLOG_WARNING("Cache memoryLimit=%zu, diskLimit=%zu, directory=\"%s\", maxEntrySize=%zu",
+            m_memoryLimit, m_diskLimit, m_directory.c_str(), m_maxEntrySize);
+}
+
+bool TTSCache::isEnabled() {
+    return m_maxEntrySize > 0 && (m_memoryLimit > 0 || (!m_directory.empty() && m_diskLimit > 0));
+}
+
+std::string TTSCache::key(const std::string &text, const std::string &voice, const std::string &language, uint8_t rate) {
+    // Utterances differing only in surrounding / repeated white spaces
+    // produce the same audio, collapse them before building the key
+    std::string normalized;
+    normalized.reserve(text.size());
+    bool space = false;
+    for(char c : text) {
+        if(isspace((unsigned char)c)) {
+            space = !normalized.empty();
+        } else {
+            if(space)
+                normalized.push_back(' ');
+            normalized.push_back(c);
+            space = false;
+        }
+    }
+
+    std::string key;
+    key.reserve(voice.size() + language.size() + normalized.size() + 8);
+    key.append(voice).push_back('\x1f');
+    key.append(language).push_back('\x1f');
+    key.append(std::to_string(rate)).push_back('\x1f');
+    key.append(normalized);
+    return key;
+}
+
+bool TTSCache::contains(const std::string &key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_index.find(key) != m_index.end() ||
+        (!m_directory.empty() && m_diskIndex.find(fileFor(key)) != m_diskIndex.end());
+}
+
+bool TTSCache::lookup(const std::string &key, AudioData &data, std::string &contentType) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_index.find(key);
+    if(it != m_index.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        data = it->second->data;
+        contentType = it->second->contentType;
+        m_hits++;
+        return true;
+    }
+
+    if(readFromDisk(key, data, contentType)) {
+        insertInMemory(key, data, contentType);
+        m_hits++;
+        return true;
+    }
+
+    m_misses++;
+    return false;
+}
+
+void TTSCache::insert(const std::string &key, const AudioData &data, const std::string &contentType) {
+    if(data.empty() || data.size() > m_maxEntrySize || !isContentType(contentType))
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    insertInMemory(key, data, contentType);
+    writeToDisk(key, data, contentType);
+}
+
+void TTSCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_lru.clear();
+    m_index.clear();
+    m_memoryUsed = 0;
+
+    for(auto &entry : m_diskLru)
+        unlink((m_directory + entry.file).c_str());
+    m_diskLru.clear();
+    m_diskIndex.clear();
+    m_diskUsed = 0;
+}
+
+void TTSCache::insertInMemory(const std::string &key, const AudioData &data, const std::string &contentType) {
+    if(m_memoryLimit == 0 || data.size() > m_memoryLimit)
+        return;
+
+    auto it = m_index.find(key);
+    if(it != m_index.end()) {
+        m_memoryUsed -= it->second->data.size();
+        m_lru.erase(it->second);
+        m_index.erase(it);
+    }
+
+    m_lru.push_front(Entry{key, contentType, data});
+    m_index[key] = m_lru.begin();
+    m_memoryUsed += data.size();
+
+    evictMemory();
+}
+
+void TTSCache::evictMemory() {
+    while(m_memoryUsed > m_memoryLimit && !m_lru.empty()) {
+        Entry &victim = m_lru.back();
+        TTSLOG_VERBOSE("Evicting %zu bytes from memory cache", victim.data.size());
+        m_memoryUsed -= victim.data.size();
+        m_index.erase(victim.key);
+        m_lru.pop_back();
+    }
+}
+
+std::string TTSCache::fileFor(const std::string &key) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016zx" TTS_CACHE_FILE_SUFFIX, std::hash<std::string>()(key));
+    return name;
+}
+
+void TTSCache::loadDiskIndex() {
+    DIR *dir = opendir(m_directory.c_str());
+    if(!dir) {
+        if(mkdir(m_directory.c_str(), 0755) != 0) {
+            TTSLOG_ERROR("Failed to create cache directory \"%s\", disabling disk cache", m_directory.c_str());
+            m_directory.clear();
+        }
+        return;
+    }
+
+    struct FileInfo {
+        std::string file;
+        size_t size;
+        time_t mtime;
+    };
+    std::vector<FileInfo> files;
+
+    struct dirent *entry;
+    while((entry = readdir(dir)) != NULL) {
+        std::string file = entry->d_name;
+        size_t suffix = file.rfind(TTS_CACHE_FILE_SUFFIX);
+        if(suffix == std::string::npos || suffix + strlen(TTS_CACHE_FILE_SUFFIX) != file.size())
+            continue;
+
+        struct stat st;
+        if(stat((m_directory + file).c_str(), &st) == 0)
+            files.push_back(FileInfo{file, (size_t)st.st_size, st.st_mtime});
+    }
+    closedir(dir);
+
+    // Most recently used first
+    std::sort(files.begin(), files.end(), [](const FileInfo &a, const FileInfo &b) { return a.mtime > b.mtime; });
+    for(auto &f : files) {
+        m_diskLru.push_back(DiskEntry{f.file, f.size});
+        m_diskIndex[f.file] = std::prev(m_diskLru.end());
+        m_diskUsed += f.size;
+    }
+    evictDisk();
+
+    TTSLOG_INFO("Loaded %zu cached utterances (%zu bytes) from \"%s\"", m_diskLru.size(), m_diskUsed, m_directory.c_str());
+}
+
+bool TTSCache::readFromDisk(const std::string &key, AudioData &data, std::string &contentType) {
+    if(m_directory.empty())
+        return false;
+
+    std::string file = fileFor(key);
+    auto it = m_diskIndex.find(file);
+    if(it == m_diskIndex.end())
+        return false;
+
+    bool status = false;
+    FILE *fp = fopen((m_directory + file).c_str(), "rb");
+    if(fp) {
+        // File layout : <key>\n<content type>\n<encoded audio>
+        std::vector<char> storedKey(key.size() + 1);
+        if(fread(storedKey.data(), 1, storedKey.size(), fp) == storedKey.size() &&
+                std::equal(key.begin(), key.end(), storedKey.begin()) && storedKey.back() == '\n') {
+            char type[TTS_CACHE_MAX_CONTENT_TYPE + 2];
+            if(fgets(type, sizeof(type), fp) && strchr(type, '\n')) {
+                contentType.assign(type, strchr(type, '\n'));
+                size_t header = storedKey.size() + contentType.size() + 1;
+                if(isContentType(contentType) && it->second->size > header) {
+                    size_t size = it->second->size - header;
+                    data.resize(size);
+                    status = (fread(data.data(), 1, size, fp) == size);
+                }
+            }
+        }
+        fclose(fp);
+    }
+
+    if(status) {
+        // Entries are ordered by mtime when the index is rebuilt on startup
+        utime((m_directory + file).c_str(), NULL);
+        m_diskLru.splice(m_diskLru.begin(), m_diskLru, it->second);
+    } else {
+        // Hash collision, a corrupted or an older file, it will be replaced on the next insert
+        TTSLOG_VERBOSE("Cache file \"%s\" doesn't match the requested utterance", file.c_str());
+        data.clear();
+    }
+    return status;
+}
+
+void TTSCache::writeToDisk(const std::string &key, const AudioData &data, const std::string &contentType) {
+    if(m_directory.empty() || m_diskLimit == 0)
+        return;
+
+    std::string file = fileFor(key);
+    std::string path = m_directory + file;
+    std::string tmpPath = path + ".tmp";
+
+    FILE *fp = fopen(tmpPath.c_str(), "wb");
+    if(!fp) {
+        TTSLOG_ERROR("Failed to open \"%s\" for writing", tmpPath.c_str());
+        return;
+    }
+
+    bool status = (fwrite(key.data(), 1, key.size(), fp) == key.size()) &&
+        (fputc('\n', fp) != EOF) &&
+        (fwrite(contentType.data(), 1, contentType.size(), fp) == contentType.size()) &&
+        (fputc('\n', fp) != EOF) &&
+        (fwrite(data.data(), 1, data.size(), fp) == data.size());
+    status &= (fclose(fp) == 0);
+
+    // Rename is atomic, readers never see a partially written entry
+    if(!status || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        TTSLOG_ERROR("Failed to write cache file \"%s\"", path.c_str());
+        unlink(tmpPath.c_str());
+        return;
+    }
+
+    size_t size = key.size() + 1 + contentType.size() + 1 + data.size();
+    auto it = m_diskIndex.find(file);
+    if(it != m_diskIndex.end()) {
+        m_diskUsed -= it->second->size;
+        m_diskLru.erase(it->second);
+    }
+    m_diskLru.push_front(DiskEntry{file, size});
+    m_diskIndex[file] = m_diskLru.begin();
+    m_diskUsed += size;
+
+    evictDisk();
+}
+
+void TTSCache::evictDisk() {
+    while(m_diskUsed > m_diskLimit && !m_diskLru.empty()) {
+        DiskEntry &victim = m_diskLru.back();
+        TTSLOG_VERBOSE("Evicting \"%s\" from disk cache", victim.file.c_str());
+        unlink((m_directory + victim.file).c_str());
+        m_diskUsed -= victim.size;
+        m_diskIndex.erase(victim.file);
+        m_diskLru.pop_back();
+    }
+}
+
+} // namespace TTS
@@ -0,0 +1,96 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _TTS_CACHE_H_
+#define _TTS_CACHE_H_
+
+#include <stdint.h>
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TTS {
+
+typedef std::vector<uint8_t> AudioData;
+
+// Bounded LRU cache of synthesized (encoded) utterances, with the content type they were served with.
+// Entries live in memory and, when a cache directory is configured,
+// are also persisted to disk so that they survive plugin restarts.
+class TTSCache {
+public:
+    TTSCache();
+    ~TTSCache();
+
+    // memoryLimit / diskLimit are in bytes, empty directory disables the disk tier
+    void configure(size_t memoryLimit, size_t diskLimit, const std::string &directory, size_t maxEntrySize);
+    bool isEnabled();
+    size_t maxEntrySize() { return m_maxEntrySize; }
+
+    static std::string key(const std::string &text, const std::string &voice, const std::string &language, uint8_t rate);
+
+    bool contains(const std::string &key);
+    bool lookup(const std::string &key, AudioData &data, std::string &contentType);
+    void insert(const std::string &key, const AudioData &data, const std::string &contentType);
+    void clear();
+
+private:
+    struct Entry {
+        std::string key;
+        std::string contentType;
+        AudioData data;
+    };
+
+    struct DiskEntry {
+        std::string file;
+        size_t size;
+    };
+
+    void insertInMemory(const std::string &key, const AudioData &data, const std::string &contentType);
+    void evictMemory();
+
+    std::string fileFor(const std::string &key);
+    void loadDiskIndex();
+    bool readFromDisk(const std::string &key, AudioData &data, std::string &contentType);
+    void writeToDisk(const std::string &key, const AudioData &data, const std::string &contentType);
+    void evictDisk();
+
+    std::mutex m_mutex;
+
+    size_t m_memoryLimit;
+    size_t m_memoryUsed;
+    std::list<Entry> m_lru;
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+
+    std::string m_directory;
+    size_t m_diskLimit;
+    size_t m_diskUsed;
+    std::list<DiskEntry> m_diskLru;
+    std::unordered_map<std::string, std::list<DiskEntry>::iterator> m_diskIndex;
+
+    size_t m_maxEntrySize;
+    uint32_t m_hits;
+    uint32_t m_misses;
+};
+
+} // namespace TTS
+
+#endif
@@ -22,10 +22,20 @@
 
 #include <curl/curl.h>
 #include <unistd.h>
+#include <algorithm>
+#include <cctype>
 #include <regex>
 
 #define INT_FROM_ENV(env, default_value) ((getenv(env) ? atoi(getenv(env)) : 0) > 0 ? atoi(getenv(env)) : default_value)
 
+#define DEFAULT_CACHE_MEMORY_LIMIT_KB 1024
+#define DEFAULT_CACHE_DISK_LIMIT_KB 4096
+#define DEFAULT_CACHE_MAX_ENTRY_KB 128
+#define MAX_PREFETCH_DEPTH 2
+#define MAX_PREFETCH_SIZE (512 * 1024)
+#define PREFETCH_TIMEOUT_S 10
+#define DEFAULT_CONTENT_TYPE "audio/mpeg"
+
 namespace TTS {
 
 std::map<std::string, std::string> TTSConfiguration::m_others;
@@ -127,8 +137,20 @@ TTSSpeaker::TTSSpeaker(TTSConfiguration &config) :
     m_currentSpeech(NULL),
     m_isSpeaking(false),
     m_isPaused(false),
+    m_captureFetched(false),
+    m_prefetchDepth(0),
+    m_runPrefetch(true),
+    m_prefetchRequested(false),
+    m_prefetchThread(NULL),
+    m_measureGap(false),
+    m_gapCount(0),
+    m_gapTotalMs(0),
+    m_gapMaxMs(0),
     m_pipeline(NULL),
     m_source(NULL),
+    m_httpSource(NULL),
+    m_appSource(NULL),
+    m_sourcePeer(NULL),
     m_audioSink(NULL),
     main_loop(NULL),
     main_context(NULL),
@@ -140,7 +162,7 @@ TTSSpeaker::TTSSpeaker(TTSConfiguration &config) :
     m_flushed(false),
     m_isEOS(false),
     m_ensurePipeline(false),
-    m_gstThread(new std::thread(GStreamerThreadFunc, this)),
+    m_gstThread(NULL),
     m_busWatch(0),
     m_duration(0),
     m_pipelineConstructionFailures(0),
@@ -148,6 +170,18 @@ TTSSpeaker::TTSSpeaker(TTSConfiguration &config) :
         setenv("GST_DEBUG", "2", 0);
         if (!gst_is_initialized())
             gst_init(NULL,NULL);
+        configureCache();
+
+        auto it = TTSConfiguration::m_others.find("PrefetchDepth");
+        if(it != TTSConfiguration::m_others.end())
+            m_prefetchDepth = std::max(0, std::min(atoi(it->second.c_str()), MAX_PREFETCH_DEPTH));
+        if(m_prefetchDepth > 0) {
+            TTSLOG_WARNING("Pipelined playback enabled, prefetch depth=%u", m_prefetchDepth);
+            m_prefetchThread = new std::thread(PrefetchThreadFunc, this);
+        }
+
+        // Started once every member it uses is set up
+        m_gstThread = new std::thread(GStreamerThreadFunc, this);
         this->main_loop_thread = g_thread_new("BusWatch", (void* (*)(void*)) event_loop, this);
 }
 
@@ -158,16 +192,214 @@ TTSSpeaker::~TTSSpeaker() {
     m_busThread = false;
     m_condition.notify_one();
 
+    // Stopped first, a transfer in progress is aborted rather than waited for
+    {
+        std::lock_guard<std::mutex> lock(m_prefetchMutex);
+        m_runPrefetch = false;
+        m_prefetchCondition.notify_one();
+    }
+
     if(m_gstThread) {
         m_gstThread->join();
+        delete m_gstThread;
         m_gstThread = NULL;
     }
 
+    if(m_prefetchThread) {
+        m_prefetchThread->join();
+        delete m_prefetchThread;
+        m_prefetchThread = NULL;
+    }
+
     if(g_main_loop_is_running(this->main_loop))
         g_main_loop_quit(this->main_loop);
     g_thread_join(this->main_loop_thread);
 }
 
+void TTSSpeaker::configureCache() {
+    auto value = [](const char *key, size_t defaultValue) -> size_t {
+        auto it = TTSConfiguration::m_others.find(key);
+        return (it != TTSConfiguration::m_others.end()) ? std::stoul(it->second) : defaultValue;
+    };
+
+    std::string directory;
+    auto it = TTSConfiguration::m_others.find("CacheDirectory");
+    if(it != TTSConfiguration::m_others.end())
+        directory = it->second;
+
+    try {
+        m_cache.configure(
+                value("CacheMemoryLimitKB", DEFAULT_CACHE_MEMORY_LIMIT_KB) * 1024,
+                value("CacheDiskLimitKB", DEFAULT_CACHE_DISK_LIMIT_KB) * 1024,
+                directory,
+                value("CacheMaxEntryKB", DEFAULT_CACHE_MAX_ENTRY_KB) * 1024);
+    } catch(...) {
+        TTSLOG_ERROR("Invalid cache configuration, disabling utterance cache");
+        m_cache.configure(0, 0, "", 0);
+    }
+}
+
+void TTSSpeaker::requestPrefetch() {
+    if(!m_prefetchThread)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_prefetchMutex);
+    m_prefetchRequested = true;
+    m_prefetchCondition.notify_one();
+}
+
+void TTSSpeaker::clearPrefetched() {
+    std::lock_guard<std::mutex> lock(m_prefetchMutex);
+    m_prefetched.clear();
+}
+
+bool TTSSpeaker::takePrefetched(uint32_t id, AudioData &data, std::string &contentType) {
+    std::lock_guard<std::mutex> lock(m_prefetchMutex);
+
+    auto it = m_prefetched.find(id);
+    if(it == m_prefetched.end())
+        return false;
+
+    data = std::move(it->second.data);
+    contentType = it->second.contentType;
+    m_prefetched.erase(it);
+    return true;
+}
+
+static size_t PrefetchWriteCallback(char *ptr, size_t size, size_t nmemb, void *userdata) {
+    AudioData *data = (AudioData*)userdata;
+    size_t length = size * nmemb;
+
+    // Returning a short count aborts the transfer
+    if(data->size() + length > MAX_PREFETCH_SIZE)
+        return 0;
+
+    data->insert(data->end(), (uint8_t*)ptr, (uint8_t*)ptr + length);
+    return length;
+}
+
+static int PrefetchProgressCallback(void *userdata, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+    // Non zero aborts the transfer
+    return ((std::atomic<bool>*)userdata)->load() ? 0 : 1;
+}
+
+bool TTSSpeaker::fetchAudio(const std::string &url, AudioData &data, std::string &contentType) {
+    CURL *curl = curl_easy_init();
+    if(!curl)
+        return false;
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)PREFETCH_TIMEOUT_S);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, PrefetchWriteCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &data);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, PrefetchProgressCallback);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &m_runPrefetch);
+
+    CURLcode res = curl_easy_perform(curl);
+    char *type = NULL;
+    if(res == CURLE_OK && curl_easy_getinfo(curl, CURLINFO_CONTENT_TYPE, &type) == CURLE_OK && type)
+        contentType = type;
+    else
+        contentType = DEFAULT_CONTENT_TYPE;
+    curl_easy_cleanup(curl);
+
+    if(res != CURLE_OK) {
+        TTSLOG_WARNING("Prefetch failed, %s", curl_easy_strerror(res));
+        data.clear();
+        return false;
+    }
+    return !data.empty();
+}
+
+void TTSSpeaker::PrefetchThreadFunc(void *ctx) {
+    TTSSpeaker *speaker = (TTSSpeaker*) ctx;
+
+    TTSLOG_INFO("Starting PrefetchThread");
+
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(speaker->m_prefetchMutex);
+            speaker->m_prefetchCondition.wait(lock, [speaker] () {
+                    return speaker->m_prefetchRequested || !speaker->m_runPrefetch;
+                });
+            if(!speaker->m_runPrefetch)
+                break;
+            speaker->m_prefetchRequested = false;
+        }
+
+        // Pick the utterances waiting next in the queue, which are yet to be fetched. Their
+        // configuration is copied while queued, the client is not used once the lock is dropped
+        std::vector<std::pair<SpeechData, TTSConfiguration>> pending;
+        {
+            std::lock_guard<std::mutex> queueLock(speaker->m_queueMutex);
+            std::lock_guard<std::mutex> lock(speaker->m_prefetchMutex);
+            for(auto it = speaker->m_queue.begin(); it != speaker->m_queue.end() && pending.size() < speaker->m_prefetchDepth; ++it) {
+                if(speaker->m_prefetched.find(it->id) == speaker->m_prefetched.end()) {
+                    pending.push_back(std::make_pair(*it, *it->client->configuration()));
+                    pending.back().first.client = NULL;
+                }
+            }
+        }
+
+        for(auto &entry : pending) {
+            if(!speaker->m_runPrefetch)
+                break;
+
+            SpeechData &data = entry.first;
+            TTSConfiguration &config = entry.second;
+            std::string key;
+            if(speaker->m_cache.isEnabled()) {
+                key = TTSCache::key(data.text, config.voice(), config.language(), config.rate());
+                if(speaker->m_cache.contains(key))
+                    continue;
+            }
+
+            AudioData audio;
+            std::string contentType;
+            auto start = std::chrono::steady_clock::now();
+            if(speaker->fetchAudio(speaker->constructURL(config, data), audio, contentType)) {
+                TTSLOG_INFO("Prefetched speech=%u (%zu bytes) in %lld ms", data.id, audio.size(),
+                        (long long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+
+                // Cached from here, not from the speak path, where writing it would delay the playback
+                if(!key.empty())
+                    speaker->m_cache.insert(key, audio, contentType);
+
+                // Drop the result if the utterance was flushed / already taken meanwhile
+                std::lock_guard<std::mutex> queueLock(speaker->m_queueMutex);
+                std::lock_guard<std::mutex> lock(speaker->m_prefetchMutex);
+                for(auto &queued : speaker->m_queue) {
+                    if(queued.id == data.id) {
+                        speaker->m_prefetched[data.id] = PrefetchedAudio{contentType, std::move(audio)};
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    TTSLOG_INFO("Stopping PrefetchThread");
+}
+
+void TTSSpeaker::updateGapMetrics() {
+    // Set from the GStreamer thread and the queue, consumed from the bus callback
+    if(!m_measureGap.exchange(false))
+        return;
+
+    uint64_t gap = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_lastSpeechEnd).count();
+    m_gapCount++;
+    m_gapTotalMs += gap;
+    if(gap > m_gapMaxMs)
+        m_gapMaxMs = gap;
+
+    TTSLOG_INFO("Inter utterance gap %llu ms (count=%u, avg=%llu ms, max=%llu ms)",
+            (unsigned long long)gap, m_gapCount, (unsigned long long)(m_gapTotalMs / m_gapCount), (unsigned long long)m_gapMaxMs);
+}
+
 void TTSSpeaker::ensurePipeline(bool flag) {
     std::unique_lock<std::mutex> mlock(m_queueMutex);
     TTSLOG_WARNING("%s", __FUNCTION__);
@@ -286,14 +518,23 @@ void TTSSpeaker::setSpeakingState(bool state, TTSSpeakerClient *client) {
 }
 
 void TTSSpeaker::queueData(SpeechData data) {
-    std::lock_guard<std::mutex> lock(m_queueMutex);
-    m_queue.push_back(data);
-    m_condition.notify_one();
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_queue.push_back(data);
+        m_condition.notify_one();
+    }
+
+    // Fetch ahead only when something is being spoken, otherwise
+    // the GStreamer thread will start on this one right away
+    if(m_isSpeaking)
+        requestPrefetch();
 }
 
 void TTSSpeaker::flushQueue() {
     std::lock_guard<std::mutex> lock(m_queueMutex);
     m_queue.clear();
+    m_measureGap = false;
+    clearPrefetched();
 }
 
 SpeechData TTSSpeaker::dequeueData() {
@@ -361,7 +602,20 @@ void TTSSpeaker::createPipeline() {
         return;
     }
 
-    m_source = gst_element_factory_make("souphttpsrc", NULL);
+    // Utterances are fetched through souphttpsrc, cached ones are fed through appsrc.
+    // Both are owned by the speaker, only one of them is in the pipeline at a time
+    m_httpSource = GST_ELEMENT(gst_object_ref_sink(gst_element_factory_make("souphttpsrc", NULL)));
+    m_appSource = GST_ELEMENT(gst_object_ref_sink(gst_element_factory_make("appsrc", NULL)));
+    m_source = m_httpSource;
+
+    GstCaps *caps = gst_caps_new_simple("audio/mpeg", "mpegversion", G_TYPE_INT, 1, NULL);
+    g_object_set(G_OBJECT(m_appSource), "caps", caps, "format", GST_FORMAT_BYTES, NULL);
+    gst_caps_unref(caps);
+    g_signal_connect(m_appSource, "need-data", G_CALLBACK(onNeedData), this);
+
+    GstPad *pad = gst_element_get_static_pad(m_httpSource, "src");
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, onFetchedBuffer, this, NULL);
+    gst_object_unref(pad);
 
     // create soc specific elements
 #if defined(BCM_NEXUS)
@@ -406,10 +660,12 @@ void TTSSpeaker::createPipeline() {
     bool result = TRUE;
 #if defined(BCM_NEXUS)
     gst_bin_add_many(GST_BIN(m_pipeline), m_source, decodebin, m_audioSink, NULL);
+    m_sourcePeer = decodebin;
     result &= gst_element_link (m_source, decodebin);
     result &= gst_element_link (decodebin, m_audioSink);
 #elif defined(PLATCO)
     gst_bin_add_many(GST_BIN(m_pipeline), m_source, parser, decodebin, convert, resample, m_audioSink, NULL);
+    m_sourcePeer = parser;
     result &= gst_element_link (m_source, parser);
     result &= gst_element_link (parser, decodebin);
     result &= gst_element_link (decodebin, convert);
@@ -420,7 +676,10 @@ void TTSSpeaker::createPipeline() {
     if(!result) {
         TTSLOG_ERROR("failed to link elements!");
         gst_object_unref(m_pipeline);
+        gst_object_unref(m_httpSource);
+        gst_object_unref(m_appSource);
         m_pipeline = NULL;
+        m_source = m_httpSource = m_appSource = m_sourcePeer = NULL;
         m_pipelineConstructionFailures++;
         return;
     }
@@ -469,15 +728,102 @@ void TTSSpeaker::destroyPipeline() {
         waitForStatus(GST_STATE_NULL, 1*1000);
         g_source_remove(m_busWatch);
         gst_object_unref(m_pipeline);
+        gst_object_unref(m_httpSource);
+        gst_object_unref(m_appSource);
     }
 
     m_busWatch = 0;
     m_pipeline = NULL;
+    m_source = m_httpSource = m_appSource = m_sourcePeer = NULL;
     m_pipelineConstructionFailures = 0;
     m_condition.notify_one();
 }
 
-void TTSSpeaker::waitForAudioToFinishTimeout(float timeout_s) {
+void TTSSpeaker::switchSource(GstElement *source) {
+    if(!m_pipeline || !m_sourcePeer || source == m_source)
+        return;
+
+    // Pipeline is in NULL state between utterances, elements can be swapped freely
+    gst_element_unlink(m_source, m_sourcePeer);
+    gst_bin_remove(GST_BIN(m_pipeline), m_source);
+    gst_bin_add(GST_BIN(m_pipeline), source);
+    if(!gst_element_link(source, m_sourcePeer)) {
+        TTSLOG_ERROR("Failed to link %s", GST_ELEMENT_NAME(source));
+        m_pipelineError = true;
+    }
+    m_source = source;
+}
+
+// Caps of the cached audio, from the content type the TTS engine served it with
+static GstCaps *capsForContentType(const std::string &contentType) {
+    std::string type = contentType.substr(0, contentType.find(';'));
+    type.erase(std::remove_if(type.begin(), type.end(), ::isspace), type.end());
+    std::transform(type.begin(), type.end(), type.begin(), ::tolower);
+
+    GstCaps *caps = NULL;
+    if(type != "audio/mpeg" && type != "audio/mp3" && !type.empty())
+        caps = gst_caps_from_string(type.c_str());
+    if(!caps || gst_caps_is_empty(caps) || gst_caps_is_any(caps)) {
+        if(caps)
+            gst_caps_unref(caps);
+        caps = gst_caps_new_simple("audio/mpeg", "mpegversion", G_TYPE_INT, 1, NULL);
+    }
+    return caps;
+}
+
+void TTSSpeaker::setCachedAudio(AudioData &data, const std::string &contentType) {
+    GstCaps *caps = capsForContentType(contentType);
+    g_object_set(G_OBJECT(m_appSource), "caps", caps, NULL);
+    gst_caps_unref(caps);
+
+    std::lock_guard<std::mutex> lock(m_fetchMutex);
+    m_cachedAudio = std::move(data);
+}
+
+void TTSSpeaker::onNeedData(GstElement *source, guint, gpointer data) {
+    TTSSpeaker *speaker = (TTSSpeaker*)data;
+
+    // Called from the streaming thread, the audio is handed over as a whole
+    AudioData audio;
+    {
+        std::lock_guard<std::mutex> lock(speaker->m_fetchMutex);
+        audio.swap(speaker->m_cachedAudio);
+    }
+
+    if(!audio.empty()) {
+        GstFlowReturn ret;
+        GstBuffer *buffer = gst_buffer_new_allocate(NULL, audio.size(), NULL);
+        gst_buffer_fill(buffer, 0, audio.data(), audio.size());
+        g_signal_emit_by_name(source, "push-buffer", buffer, &ret);
+        gst_buffer_unref(buffer);
+    }
+
+    GstFlowReturn ret;
+    g_signal_emit_by_name(source, "end-of-stream", &ret);
+}
+
+GstPadProbeReturn TTSSpeaker::onFetchedBuffer(GstPad *, GstPadProbeInfo *info, gpointer data) {
+    TTSSpeaker *speaker = (TTSSpeaker*)data;
+
+    std::lock_guard<std::mutex> lock(speaker->m_fetchMutex);
+    if(speaker->m_captureFetched) {
+        GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+        size_t offset = speaker->m_fetchedAudio.size();
+        size_t size = gst_buffer_get_size(buffer);
+
+        if(offset + size > speaker->m_cache.maxEntrySize()) {
+            // Too long to be worth caching
+            speaker->m_captureFetched = false;
+            speaker->m_fetchedAudio.clear();
+        } else {
+            speaker->m_fetchedAudio.resize(offset + size);
+            gst_buffer_extract(buffer, 0, speaker->m_fetchedAudio.data() + offset, size);
+        }
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+bool TTSSpeaker::waitForAudioToFinishTimeout(float timeout_s) {
     TTSLOG_TRACE("timeout_s=%f", timeout_s);
 
     auto timeout = std::chrono::system_clock::now() + std::chrono::seconds((unsigned long)timeout_s);
@@ -527,9 +873,11 @@ void TTSSpeaker::waitForAudioToFinishTimeout(float timeout_s) {
     if(m_pipeline)
         gst_element_set_state(m_pipeline, GST_STATE_NULL);
 
+    bool reachedEOS = m_isEOS;
     if(!m_isEOS)
         TTSLOG_ERROR("Stopped waiting for audio to finish without hitting EOS!");
     m_isEOS = false;
+    return reachedEOS;
 }
 
 void TTSSpeaker::replaceIfIsolated(std::string& text, const std::string& search, const std::string& replace) {
@@ -657,14 +1005,57 @@ void TTSSpeaker::speakText(TTSConfiguration config, SpeechData &data) {
     if(m_pipeline && !m_pipelineError && !m_flushed) {
         m_currentSpeech = &data;
 
-        g_object_set(G_OBJECT(m_source), "location", constructURL(config, data).c_str(), NULL);
+        std::string key;
+        bool cached = false;
+        if(m_cache.isEnabled())
+            key = TTSCache::key(data.text, config.voice(), config.language(), config.rate());
+
+        AudioData audio;
+        std::string contentType;
+        bool prefetched = takePrefetched(data.id, audio, contentType);
+        if(prefetched) {
+            cached = true;
+        } else if(m_cache.isEnabled()) {
+            cached = m_cache.lookup(key, audio, contentType);
+        }
+
+        if(cached) {
+            TTSLOG_INFO("Playing %s utterance (%zu bytes, %s)", prefetched ? "prefetched" : "cached", audio.size(), contentType.c_str());
+            setCachedAudio(audio, contentType);
+            switchSource(m_appSource);
+        } else {
+            switchSource(m_httpSource);
+            std::lock_guard<std::mutex> lock(m_fetchMutex);
+            m_fetchedAudio.clear();
+            m_fetchedContentType = DEFAULT_CONTENT_TYPE;
+            m_captureFetched = m_cache.isEnabled();
+            g_object_set(G_OBJECT(m_source), "location", constructURL(config, data).c_str(), NULL);
+        }
+
         // PCM Sink seems to be accepting volume change before PLAYING state
         g_object_set(G_OBJECT(m_audioSink), "volume", (double) (data.client->configuration()->volume() / MAX_VOLUME), NULL);
         gst_element_set_state(m_pipeline, GST_STATE_PLAYING);
         TTSLOG_VERBOSE("Speaking.... ( %d, \"%s\")", data.id, data.text.c_str());
 
+        // Start fetching the following utterances while this one plays
+        requestPrefetch();
+
         //Wait for EOS with a timeout incase EOS never comes
-        waitForAudioToFinishTimeout(10);
+        bool completed = waitForAudioToFinishTimeout(10);
+
+        {
+            std::lock_guard<std::mutex> lock(m_stateMutex);
+            std::lock_guard<std::mutex> queueLock(m_queueMutex);
+            m_lastSpeechEnd = std::chrono::steady_clock::now();
+            m_measureGap = completed && !m_flushed && !m_queue.empty();
+        }
+
+        std::lock_guard<std::mutex> lock(m_fetchMutex);
+        if(!cached && m_captureFetched && completed && !m_pipelineError && !m_flushed)
+            m_cache.insert(key, m_fetchedAudio, m_fetchedContentType);
+        m_captureFetched = false;
+        m_fetchedAudio.clear();
+        m_cachedAudio.clear();
     } else {
         TTSLOG_WARNING("m_pipeline=%p, m_pipelineError=%d", m_pipeline, m_pipelineError);
     }
@@ -796,6 +1187,21 @@ bool TTSSpeaker::handleMessage(GstMessage *message) {
             break;
 
 
+        case GST_MESSAGE_ELEMENT: {
+                // Posted by souphttpsrc, the fetched audio is cached with its content type
+                const GstStructure *structure = gst_message_get_structure(message);
+                const GValue *headers = structure && gst_structure_has_name(structure, "http-headers") ?
+                    gst_structure_get_value(structure, "response-headers") : NULL;
+                const gchar *contentType = headers && GST_VALUE_HOLDS_STRUCTURE(headers) ?
+                    gst_structure_get_string(gst_value_get_structure(headers), "Content-Type") : NULL;
+                if(contentType) {
+                    std::lock_guard<std::mutex> lock(m_fetchMutex);
+                    if(m_captureFetched)
+                        m_fetchedContentType = contentType;
+                }
+            }
+            break;
+
         case GST_MESSAGE_DURATION_CHANGED: {
                 gst_element_query_duration(m_pipeline, GST_FORMAT_TIME, &m_duration);
                 TTSLOG_INFO("Duration %" GST_TIME_FORMAT, GST_TIME_ARGS(m_duration));
@@ -833,6 +1239,7 @@ bool TTSSpeaker::handleMessage(GstMessage *message) {
                             m_clientSpeaking->resumed(m_currentSpeech->id);
                             m_condition.notify_one();
                         } else {
+                            updateGapMetrics();
                             m_clientSpeaking->started(m_currentSpeech->id, m_currentSpeech->text);
                         }
                     }
@@ -24,13 +24,16 @@
 #include <gst/audio/audio.h>
 #include <gst/app/gstappsink.h>
 
+#include <atomic>
 #include <map>
 #include <list>
 #include <mutex>
 #include <thread>
 #include <condition_variable>
+#include <chrono>
 
 #include "TTSCommon.h"
+#include "TTSCache.h"
 #include <vector>
 
 // --- //
@@ -149,9 +152,50 @@ private:
     // Private functions
     inline void setSpeakingState(bool state, TTSSpeakerClient *client=NULL);
 
+    // Utterance cache. The audio fed to appsrc is taken from the GStreamer streaming thread,
+    // it is guarded by m_fetchMutex like the audio captured from souphttpsrc
+    TTSCache m_cache;
+    AudioData m_cachedAudio;
+    AudioData m_fetchedAudio;
+    std::string m_fetchedContentType;
+    std::mutex m_fetchMutex;
+    bool m_captureFetched;
+    void configureCache();
+    void setCachedAudio(AudioData &data, const std::string &contentType);
+
+    // Pipelined playback, audio of the next queued utterances is
+    // fetched while the current one is being played
+    uint8_t m_prefetchDepth;
+    std::atomic<bool> m_runPrefetch;    // Also aborts the transfers in progress when cleared
+    bool m_prefetchRequested;
+    struct PrefetchedAudio {
+        std::string contentType;
+        AudioData data;
+    };
+    std::map<uint32_t, PrefetchedAudio> m_prefetched;
+    std::mutex m_prefetchMutex;
+    std::condition_variable m_prefetchCondition;
+    std::thread *m_prefetchThread;
+    static void PrefetchThreadFunc(void *ctx);
+    void requestPrefetch();
+    void clearPrefetched();
+    bool takePrefetched(uint32_t id, AudioData &data, std::string &contentType);
+    bool fetchAudio(const std::string &url, AudioData &data, std::string &contentType);
+
+    // Inter utterance gap metrics (end of one utterance to start of the queued next one)
+    std::chrono::steady_clock::time_point m_lastSpeechEnd;
+    std::atomic<bool> m_measureGap;
+    uint32_t m_gapCount;
+    uint64_t m_gapTotalMs;
+    uint64_t m_gapMaxMs;
+    void updateGapMetrics();
+
     // GStreamer Releated members
     GstElement *m_pipeline;
     GstElement *m_source;
+    GstElement *m_httpSource;
+    GstElement *m_appSource;
+    GstElement *m_sourcePeer;
     GstElement *m_audioSink;
     GMainLoop  *main_loop;
     GMainContext *main_context;
@@ -173,6 +217,7 @@ private:
     void createPipeline();
     void resetPipeline();
     void destroyPipeline();
+    void switchSource(GstElement *source);
 
     // GStreamer Helper functions
     bool needsPipelineUpdate();
@@ -184,9 +229,11 @@ private:
     void sanitizeString(std::string &input, std::string &sanitizedString);
     void speakText(TTSConfiguration config, SpeechData &data);
     bool waitForStatus(GstState expected_state, uint32_t timeout_ms);
-    void waitForAudioToFinishTimeout(float timeout_s);
+    bool waitForAudioToFinishTimeout(float timeout_s);
     bool handleMessage(GstMessage*);
     static int GstBusCallback(GstBus *bus, GstMessage *message, gpointer data);
+    static void onNeedData(GstElement *source, guint length, gpointer data);
+    static GstPadProbeReturn onFetchedBuffer(GstPad *pad, GstPadProbeInfo *info, gpointer data);
     static void event_loop(void *data);
 };
 
@@ -65,6 +65,7 @@ namespace WPEFramework
 
         Timer::Timer()
         : AbstractPlugin()
+        , m_staleEvents(0)
         {
             LOGINFO();
             Timer::_instance = this;
@@ -85,81 +86,115 @@ namespace WPEFramework
             Timer::_instance = nullptr;
         }
 
-        void Timer::checkTimers()
+        bool Timer::isEventValid(const TimerEvent& event)
         {
-            LOGINFO();
+            const TimerItem& item = m_timerItems[event.timerId];
+            return item.state == RUNNING && item.generation == event.generation;
+        }
+
+        void Timer::scheduleTimer(int timerId)
+        {
+            TimerItem& item = m_timerItems[timerId];
+
+            auto deadline = item.lastExpired + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(item.interval));
+            m_schedule.push({deadline, timerId, item.generation, false});
 
-            double minTimeout = 100000;
-            for (auto it = m_runningItems.cbegin(); it != m_runningItems.cend(); ++it)
+            if (!item.reminderSent && item.remindBefore > TIMER_ACCURACY)
             {
-                unsigned int timerId = *it;
-                if (timerId < 0 || timerId >= m_timerItems.size())
+                auto reminder = deadline - std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(item.remindBefore));
+                if (reminder > std::chrono::steady_clock::now())
                 {
-                    LOGERR("Internal error: wrong timerId");
-                    continue;
+                    m_schedule.push({reminder, timerId, item.generation, true});
                 }
-                if (m_timerItems[timerId].state != RUNNING)
+                else
                 {
-                    LOGERR("Internal error: timer %d has wrong state", timerId);
-                    continue;
+                    sendTimerExpiryReminder(timerId);
+                    item.reminderSent = true;
                 }
+            }
+        }
 
-                std::chrono::duration<double> elapsed = std::chrono::system_clock::now() - m_timerItems[timerId].lastExpired;
-                double timeout =  m_timerItems[timerId].interval - elapsed.count();
+        void Timer::compactSchedule()
+        {
+            std::vector<TimerEvent> events;
+            events.reserve(m_schedule.size() - m_staleEvents);
 
-                if (!m_timerItems[timerId].reminderSent && m_timerItems[timerId].remindBefore > TIMER_ACCURACY)
-                {
-                    if (timeout > m_timerItems[timerId].remindBefore)
-                    {
-                        timeout -= m_timerItems[timerId].remindBefore;
-                    }
-                    else
-                    {
-                        sendTimerExpiryReminder(timerId);
-                        m_timerItems[timerId].reminderSent = true;
-                    }
-                }
+            while (!m_schedule.empty())
+            {
+                if (isEventValid(m_schedule.top()))
+                    events.push_back(m_schedule.top());
+                m_schedule.pop();
+            }
+
+            m_schedule = std::priority_queue <TimerEvent, std::vector<TimerEvent>, std::greater<TimerEvent> >(std::greater<TimerEvent>(), std::move(events));
+            m_staleEvents = 0;
+        }
+
+        void Timer::armTimer()
+        {
+            // Entries of canceled / suspended timers are dropped lazily, rebuild
+            // the heap once they make up most of it to keep it bounded
+            if (m_staleEvents > 64 && m_staleEvents > m_schedule.size() / 2)
+                compactSchedule();
 
-                if (timeout < minTimeout)
-                    minTimeout = timeout;
+            while (!m_schedule.empty() && !isEventValid(m_schedule.top()))
+            {
+                m_schedule.pop();
+                if (m_staleEvents > 0)
+                    m_staleEvents--;
             }
 
+            if (m_schedule.empty())
+            {
+                m_timer.stop();
+                return;
+            }
+
+            std::chrono::duration<double> timeout = m_schedule.top().deadline - std::chrono::steady_clock::now();
+            double minTimeout = timeout.count();
+
             if (minTimeout < TIMER_ACCURACY)
                 minTimeout = TIMER_ACCURACY;
 
-            if (minTimeout < 100000)
-            {
-                if (!m_timer.isActive())
-                    m_timer.start(int(minTimeout * 1000));
-                else
-                    m_timer.setInterval(int(minTimeout * 1000));
-            }
+            if (!m_timer.isActive())
+                m_timer.start(int(minTimeout * 1000));
             else
-                m_timer.stop();
+                m_timer.setInterval(int(minTimeout * 1000));
+        }
+
+        void Timer::releaseTimerId(int timerId)
+        {
+            // Ids are reused oldest first, so that a stale id held by a client
+            // keeps pointing to its finished timer for as long as possible
+            m_freeTimerIds.push_back(timerId);
         }
 
         void Timer::startTimer(int timerId)
         {
-            m_runningItems.push_back(timerId);
-            m_timerItems[timerId].state = RUNNING;
+            TimerItem& item = m_timerItems[timerId];
 
-            m_timerItems[timerId].lastExpired = std::chrono::system_clock::now();
-            m_timerItems[timerId].lastExpiryReminder = std::chrono::system_clock::now();
-            m_timerItems[timerId].reminderSent = false;
+            item.state = RUNNING;
+            item.generation++;
+            item.lastExpired = std::chrono::steady_clock::now();
+            item.reminderSent = false;
 
-            checkTimers();
+            scheduleTimer(timerId);
+            armTimer();
         }
 
         bool Timer::cancelTimer(int timerId)
         {
+            TimerState state = m_timerItems[timerId].state;
             m_timerItems[timerId].state = CANCELED;
 
-            auto it = std::find(m_runningItems.begin(), m_runningItems.end(), timerId);
-            if (m_runningItems.end() != it)
+            if (EXPIRED != state)
+                releaseTimerId(timerId);
+
+            if (RUNNING == state)
             {
-                m_runningItems.erase(it);
-                m_timer.stop();
-                checkTimers();
+                m_timerItems[timerId].generation++;
+                m_staleEvents++;
+                armTimer();
                 return true;
             }
 
@@ -168,83 +203,74 @@ namespace WPEFramework
 
         bool Timer::suspendTimer(int timerId)
         {
-            m_timerItems[timerId].state = SUSPENDED;
+            if (RUNNING != m_timerItems[timerId].state)
+                return false;
 
-            auto it = std::find(m_runningItems.begin(), m_runningItems.end(), timerId);
-            if (m_runningItems.end() != it)
-            {
-                m_runningItems.erase(it);
-                m_timer.stop();
-                checkTimers();
-                return true;
-            }
+            m_timerItems[timerId].state = SUSPENDED;
+            m_timerItems[timerId].generation++;
+            m_staleEvents++;
+            armTimer();
 
-            return false;
+            return true;
         }
 
         void Timer::onTimerCallback()
         {
             std::lock_guard<std::mutex> guard(m_callMutex);
 
-            LOGINFO();
+            auto now = std::chrono::steady_clock::now();
+            auto due = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(TIMER_ACCURACY));
 
-            std::list <int> itemsToDelete;
+            // Repeating timers are put back only after the due ones are processed,
+            // so each of them expires at most once per wakeup
+            std::list <int> rescheduled;
 
-            for (auto it = m_runningItems.cbegin(); it != m_runningItems.cend(); ++it)
+            while (!m_schedule.empty() && m_schedule.top().deadline <= due)
             {
-                unsigned int timerId = *it;
-                if (timerId < 0 || timerId >= m_timerItems.size())
-                {
-                    LOGERR("Internal error: wrong timerId");
-                    continue;
-                }
-                if (m_timerItems[timerId].state != RUNNING)
+                TimerEvent event = m_schedule.top();
+                m_schedule.pop();
+
+                if (!isEventValid(event))
                 {
-                    LOGERR("Internal error: timer %d has wrong state", timerId);
+                    if (m_staleEvents > 0)
+                        m_staleEvents--;
                     continue;
                 }
 
-                std::chrono::duration<double> elapsed = std::chrono::system_clock::now() - m_timerItems[timerId].lastExpired;
-                double timeout =  m_timerItems[timerId].interval - elapsed.count();
+                TimerItem& item = m_timerItems[event.timerId];
 
-                if (!m_timerItems[timerId].reminderSent && m_timerItems[timerId].remindBefore > TIMER_ACCURACY)
+                if (event.reminder)
                 {
-                    if (timeout < m_timerItems[timerId].remindBefore + TIMER_ACCURACY)
+                    if (!item.reminderSent)
                     {
-                        sendTimerExpiryReminder(timerId);
-                        m_timerItems[timerId].reminderSent = true;
+                        sendTimerExpiryReminder(event.timerId);
+                        item.reminderSent = true;
                     }
+                    continue;
                 }
 
-                if (timeout <= TIMER_ACCURACY)
-                {
-                    sendTimerExpired(timerId);
+                sendTimerExpired(event.timerId);
 
-                    m_timerItems[timerId].lastExpired = std::chrono::system_clock::now();
+                item.lastExpired = now;
+                item.reminderSent = false;
 
-                    if (m_timerItems[timerId].repeatInterval > 0)
-                    {
-                        m_timerItems[timerId].interval = m_timerItems[timerId].repeatInterval;
-                    }
-                    else
-                    {
-                        m_timerItems[timerId].state = EXPIRED;
-                        itemsToDelete.push_back(timerId);
-                    }
-
-                    m_timerItems[timerId].reminderSent = false;
+                if (item.repeatInterval > 0)
+                {
+                    item.interval = item.repeatInterval;
+                    rescheduled.push_back(event.timerId);
+                }
+                else
+                {
+                    item.state = EXPIRED;
+                    item.generation++;
+                    releaseTimerId(event.timerId);
                 }
             }
 
-            for (auto delIt = itemsToDelete.cbegin(); delIt != itemsToDelete.cend(); ++delIt)
-            {
-                auto it = std::find(m_runningItems.begin(), m_runningItems.end(), *delIt);
-                if (m_runningItems.end() != it)
-                    m_runningItems.erase(it);
+            for (auto it = rescheduled.cbegin(); it != rescheduled.cend(); ++it)
+                scheduleTimer(*it);
 
-            }
-
-            checkTimers();
+            armTimer();
         }
 
         void Timer::getTimerStatus(int timerId, JsonObject& output, bool writeTimerId)
@@ -255,7 +281,7 @@ namespace WPEFramework
             output["state"] = stateStrings[m_timerItems[timerId].state];
             output["mode"] = modeStrings[m_timerItems[timerId].mode];
 
-            std::chrono::duration<double> elapsed = std::chrono::system_clock::now() - m_timerItems[timerId].lastExpired;
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_timerItems[timerId].lastExpired;
             double timeRemaining =  m_timerItems[timerId].interval - elapsed.count();
 
             char buf[256];
@@ -285,6 +311,8 @@ namespace WPEFramework
             TimerItem item;
 
             item.state = INITIAL;
+            item.reminderSent = false;
+            item.generation = 0;
             item.interval = std::stod(parameters["interval"].String());
 
             item.mode = GENERIC;
@@ -299,10 +327,24 @@ namespace WPEFramework
             item.repeatInterval = parameters.HasLabel("repeatInterval") ? std::stod(parameters["repeatInterval"].String()) : 0.0;
             item.remindBefore = parameters.HasLabel("remindBefore") ? std::stod(parameters["remindBefore"].String()) : 0.0;
 
-            m_timerItems.push_back(item);
+            int timerId;
+            if (!m_freeTimerIds.empty())
+            {
+                timerId = m_freeTimerIds.front();
+                m_freeTimerIds.pop_front();
+
+                // Keep the generation, heap entries of the previous owner must stay invalid
+                item.generation = m_timerItems[timerId].generation;
+                m_timerItems[timerId] = item;
+            }
+            else
+            {
+                timerId = m_timerItems.size();
+                m_timerItems.push_back(item);
+            }
 
-            startTimer(m_timerItems.size() - 1);
-            response["timerId"] = m_timerItems.size() - 1;
+            startTimer(timerId);
+            response["timerId"] = timerId;
 
             returnResponse(true);
         }
@@ -477,7 +519,7 @@ namespace WPEFramework
             params["timerId"] = timerId;
             params["mode"] = modeStrings[m_timerItems[timerId].mode];
 
-            std::chrono::duration<double> elapsed = std::chrono::system_clock::now() - m_timerItems[timerId].lastExpired;
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_timerItems[timerId].lastExpired;
 
             params["timeRemaining"] = (int)(m_timerItems[timerId].interval - elapsed.count() + 0.5);
             sendNotify(TIMER_EVT_TIMER_EXPIRY_REMINDER, params);
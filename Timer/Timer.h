@@ -20,6 +20,8 @@
 #pragma once
 
 #include <mutex>
+#include <deque>
+#include <queue>
 
 #include "Module.h"
 #include "utils.h"
@@ -52,9 +54,23 @@ namespace WPEFramework {
             TimerMode mode;
             double repeatInterval;
             double remindBefore;
-            std::chrono::system_clock::time_point lastExpired;
-            std::chrono::system_clock::time_point lastExpiryReminder;
+            std::chrono::steady_clock::time_point lastExpired;
             bool reminderSent;
+            unsigned int generation;
+        };
+
+        // Entry of the deadline heap. Cancel / suspend / restart bump the timer
+        // generation, which invalidates the entries already in the heap.
+        struct TimerEvent {
+            std::chrono::steady_clock::time_point deadline;
+            int timerId;
+            unsigned int generation;
+            bool reminder;
+
+            bool operator>(const TimerEvent& other) const
+            {
+                return deadline > other.deadline;
+            }
         };
 
 		// This is a server for a JSONRPC communication channel.
@@ -90,7 +106,11 @@ namespace WPEFramework {
             void sendTimerExpiryReminder(int timerId);
             //End events
 
-            void checkTimers();
+            void scheduleTimer(int timerId);
+            void armTimer();
+            bool isEventValid(const TimerEvent& event);
+            void compactSchedule();
+            void releaseTimerId(int timerId);
 
             void startTimer(int timerId);
             bool cancelTimer(int timerId);
@@ -108,7 +128,9 @@ namespace WPEFramework {
         private:
             TpTimer m_timer;
             std::vector <TimerItem> m_timerItems;
-            std::list <int> m_runningItems;
+            std::priority_queue <TimerEvent, std::vector<TimerEvent>, std::greater<TimerEvent> > m_schedule;
+            std::deque <int> m_freeTimerIds;
+            size_t m_staleEvents;
             std::mutex m_callMutex;
         };
 	} // namespace Plugin
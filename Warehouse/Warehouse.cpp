@@ -31,6 +31,7 @@
 #endif
 
 #include "utils.h"
+#include "ProcessRunner.h"
 
 #include "frontpanel.h"
 
@@ -57,7 +58,8 @@
 #define PARAM_SUCCESS "success"
 #define PARAM_ERROR "error"
 
-#define DEVICE_INFO_SCRIPT "sh /lib/rdk/getDeviceDetails.sh read"
+#define DEVICE_INFO_SCRIPT "/lib/rdk/getDeviceDetails.sh"
+#define DEVICE_PROPERTIES_CACHE_TTL_MS (60 * 1000)
 #define VERSION_FILE_NAME "/version.txt"
 #define CUSTOM_DATA_FILE "/lib/rdk/wh_api_5.conf"
 
@@ -244,31 +246,23 @@ namespace WPEFramework
          */
         void Warehouse::getDeviceInfo(JsonObject &params)
         {
-            char buf[256];
+            Utils::ProcessRunner::Result result = Utils::ProcessRunner::run({"sh", DEVICE_INFO_SCRIPT, "read"});
 
-            FILE *p = popen(DEVICE_INFO_SCRIPT, "r");
-
-            if(!p)
+            if (result.exitCode < 0 && result.output.empty())
             {
-                LOGWARN("failed to run %s:%s", DEVICE_INFO_SCRIPT, strerror(errno));
+                LOGWARN("failed to run %s", DEVICE_INFO_SCRIPT);
                 return;
             }
 
-            std::string res;
-            while(fgets(buf, sizeof(buf), p) != NULL)
-                res += buf;
-
-            int errCode = pclose(p);
-
-            if (0 != errCode)
+            if (0 != result.exitCode)
             {
                 params[PARAM_SUCCESS] = false;
-                params[PARAM_ERROR] = (const char *)strerror(errno);
+                params[PARAM_ERROR] = result.timedOut ? "timed out" : ("exited with " + std::to_string(result.exitCode)).c_str();
             }
 
-            LOGINFO("'%s' returned: %s", DEVICE_INFO_SCRIPT, res.c_str());
+            LOGINFO("'%s' returned: %s", DEVICE_INFO_SCRIPT, result.output.c_str());
 
-            std::stringstream ss(res);
+            std::stringstream ss(result.output);
             std::string line;
             while(std::getline(ss, line))
             {
@@ -443,23 +437,28 @@ namespace WPEFramework
                 if ("SD_CARD_MOUNT_PATH" == var && (!envVar || 0 == *envVar))
                 {
 
-                    FILE *p = popen("cat  /proc/mounts | grep mmcblk0p1 | awk '{print $2}' ", "r");
+                    std::ifstream mounts("/proc/mounts");
 
-                    if(!p)
+                    if(!mounts)
                     {
-                        LOGWARN("failed to run script to get SD_CARD_MOUNT_PATH");
+                        LOGWARN("failed to read /proc/mounts to get SD_CARD_MOUNT_PATH");
                     }
                     else
                     {
-                        char buf[256];
-                        while(fgets(buf, sizeof(buf), p) != NULL)
-                            scmp += buf;
-
-                        scmp.erase(0, scmp.find_first_not_of(" \n\r\t"));
-                        scmp.erase(scmp.find_last_not_of(" \n\r\t") + 1);
+                        // Mount point of the first mmcblk0p1 mount
+                        std::string mount;
+                        while(std::getline(mounts, mount))
+                        {
+                            if (mount.find("mmcblk0p1") != std::string::npos)
+                            {
+                                std::stringstream fields(mount);
+                                std::string device;
+                                fields >> device >> scmp;
+                                break;
+                            }
+                        }
 
                         envVar = scmp.c_str();
-                        pclose(p);
                     }
                 }
 
@@ -552,16 +551,19 @@ namespace WPEFramework
                 // if script's variable in path is empty, then skip it
                 if (path.find('$') != std::string::npos)
                 {
+                    // name of the first variable: what follows the first run of '$' and '{', up to one of "${}/"
                     std::string variable;
-                    std::string script = "echo '" + path + "' | sed -r \"s/([^$]*)([$\\{]*)([^$\\{\\}\\/]*)(.*)/\\3/\"";
-                    variable = Utils::cRunScript(script.c_str());
+                    size_t nameStart = path.find_first_not_of("${", path.find('$'));
+                    if (nameStart != std::string::npos)
+                        variable = path.substr(nameStart, path.find_first_of("${}/", nameStart) - nameStart);
                     Utils::String::trim(variable);
 
+                    // the name is passed as an argument, so it is never interpreted by the shell
                     std::string value;
                     if (variable.length() > 0)
                     {
-                        script = ". /etc/device.properties; echo \"$" + variable + "\"";
-                        value = Utils::cRunScript(script.c_str());
+                        value = Utils::ProcessRunner::runCached({"/bin/sh", "-c", "set -a; . /etc/device.properties; exec printenv \"$1\"", "sh", variable},
+                                DEVICE_PROPERTIES_CACHE_TTL_MS).output;
                         Utils::String::trim(value);
                     }
 
@@ -618,7 +620,7 @@ namespace WPEFramework
                     }
 
                     script += " 2>/dev/null | head -n 10";
-                    std::string result = Utils::cRunScript(script.c_str());
+                    std::string result = Utils::ProcessRunner::run({"/bin/sh", "-c", script}, 0).output;
                     Utils::String::trim(result);
 
                     totalPathsCounter++;
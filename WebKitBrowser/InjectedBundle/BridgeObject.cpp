@@ -52,6 +52,57 @@ const char kBadgerEventSrc[] = R"jssrc(
   window.$badger.event(obj.handlerId, obj.json)
 )jssrc";
 
+// Asynchronous bridge: queries return a promise settled by the matching reply,
+// queries issued within one task are flushed together in a single message and
+// payloads travel as plain strings.
+const char kServiceManagerAsyncSrc[] = R"jssrc(
+(function() {
+  var queue = []
+  var pending = {}
+  function flush() {
+    var batch = queue
+    queue = []
+    window.ServiceManager.BridgeQueries(batch)
+  }
+  function query(msg) {
+    if (queue.push(msg) === 1)
+      Promise.resolve().then(flush)
+    var pid
+    try { pid = JSON.parse(msg).pid } catch (e) { }
+    if (pid === undefined)
+      return Promise.resolve()
+    return new Promise((resolve) => { pending[pid] = resolve })
+  }
+  window.ServiceManager = {
+    version: 2.1,
+    getServiceForJavaScript: function(name,readyCb) {
+      if (name === 'com.comcast.BridgeObject_1')
+        readyCb({ JSMessageChanged: query })
+      else
+        console.error('Requested service not supported')
+    },
+    BridgeSettle: function(obj) {
+      var resolve = pending[obj.pid]
+      if (resolve) {
+        delete pending[obj.pid]
+        resolve(obj)
+      }
+    }
+  }
+})()
+)jssrc";
+
+const char kBadgerReplyAsyncSrc[] = R"jssrc(
+  var obj = JSON.parse(payload)
+  window.ServiceManager.BridgeSettle(obj)
+  window.$badger.callback(obj.pid, obj.success, obj.json)
+)jssrc";
+
+const char kBadgerEventAsyncSrc[] = R"jssrc(
+  var obj = JSON.parse(payload)
+  window.$badger.event(obj.handlerId, obj.json)
+)jssrc";
+
 static string JSStringToString(JSStringRef str)
 {
   if (!str)
@@ -70,6 +121,65 @@ static void LogException(JSContextRef ctx, JSValueRef exception)
     TRACE_GLOBAL(Trace::Error, (_T("Got Exception: %s"), errorStr.c_str()));
 }
 
+// Bridge mode is taken from the "badgerbridge" bundle configuration, "async" selects the asynchronous bridge.
+static bool IsAsync()
+{
+    static int async = -1;
+
+    if (async < 0) {
+        WKStringRef messageName = WKStringCreateWithUTF8CString((string(Tags::Config) + "badgerbridge").c_str());
+        WKMutableArrayRef messageBody = WKMutableArrayCreate();
+        WKTypeRef returnData = nullptr;
+
+        WKBundlePostSynchronousMessage(g_Bundle, messageName, messageBody, &returnData);
+
+        async = 0;
+        if (returnData != nullptr) {
+            if (WKGetTypeID(returnData) == WKStringGetTypeID()) {
+                async = (WKStringIsEqualToUTF8CString(static_cast<WKStringRef>(returnData), "async") ? 1 : 0);
+            }
+            WKRelease(returnData);
+        }
+        WKRelease(messageBody);
+        WKRelease(messageName);
+    }
+
+    return (async == 1);
+}
+
+static JSValueRef OnBridgeQueries(
+    JSContextRef context, JSObjectRef,
+    JSObjectRef, size_t argumentCount,
+    const JSValueRef arguments[], JSValueRef*)
+{
+    if (argumentCount > 0 && JSValueIsObject(context, arguments[0])) {
+        JSObjectRef queries = JSValueToObject(context, arguments[0], nullptr);
+        JSStringRef lengthStr = JSStringCreateWithUTF8CString("length");
+        unsigned count = static_cast<unsigned>(JSValueToNumber(context, JSObjectGetProperty(context, queries, lengthStr, nullptr), nullptr));
+        JSStringRelease(lengthStr);
+
+        WKMutableArrayRef messageBody = WKMutableArrayCreate();
+        for (unsigned index = 0; index < count; index++) {
+            JSValueRef query = JSObjectGetPropertyAtIndex(context, queries, index, nullptr);
+            if (JSValueIsString(context, query)) {
+                JSStringRef jsString = JSValueToStringCopy(context, query, nullptr);
+                WKStringRef item = WKStringCreateWithJSString(jsString);
+                JSStringRelease(jsString);
+                WKArrayAppendItem(messageBody, item);
+                WKRelease(item);
+            }
+        }
+
+        if (WKArrayGetSize(messageBody) > 0) {
+            WKStringRef messageName = WKStringCreateWithUTF8CString(Tags::BridgeObjectQueries);
+            WKBundlePostMessage(g_Bundle, messageName, messageBody);
+            WKRelease(messageName);
+        }
+        WKRelease(messageBody);
+    }
+    return JSValueMakeUndefined(context);
+}
+
 static JSValueRef OnBridgeQuery(
     JSContextRef context, JSObjectRef,
     JSObjectRef, size_t argumentCount,
@@ -124,9 +234,11 @@ void InjectJS(WKBundleFrameRef frame)
     if (!WKBundleFrameIsMainFrame(frame))
         return;
 
+    const bool async = IsAsync();
+
     JSValueRef exception = nullptr;
     JSGlobalContextRef context = WKBundleFrameGetJavaScriptContext(frame);
-    JSStringRef smScriptStr = JSStringCreateWithUTF8CString(kServiceManagerSrc);
+    JSStringRef smScriptStr = JSStringCreateWithUTF8CString(async ? kServiceManagerAsyncSrc : kServiceManagerSrc);
     JSEvaluateScript(context, smScriptStr, nullptr, nullptr, 0, &exception);
     JSStringRelease(smScriptStr);
     if (exception) {
@@ -143,8 +255,8 @@ void InjectJS(WKBundleFrameRef frame)
         return;
     }
 
-    JSStringRef bridgeQueryStr = JSStringCreateWithUTF8CString("BridgeQuery");
-    JSValueRef  bridgeQueryFun = JSObjectMakeFunctionWithCallback(context, bridgeQueryStr, OnBridgeQuery);
+    JSStringRef bridgeQueryStr = JSStringCreateWithUTF8CString(async ? "BridgeQueries" : "BridgeQuery");
+    JSValueRef  bridgeQueryFun = JSObjectMakeFunctionWithCallback(context, bridgeQueryStr, async ? OnBridgeQueries : OnBridgeQuery);
     JSObjectSetProperty(context, smObject, bridgeQueryStr, bridgeQueryFun,
         kJSPropertyAttributeReadOnly | kJSPropertyAttributeDontDelete | kJSPropertyAttributeDontEnum, &exception);
     JSStringRelease(bridgeQueryStr);
@@ -157,11 +269,11 @@ void InjectJS(WKBundleFrameRef frame)
 bool HandleMessageToPage(WKBundlePageRef page, WKStringRef messageName, WKTypeRef messageBody)
 {
     if (WKStringIsEqualToUTF8CString(messageName, Tags::BridgeObjectReply)) {
-        CallBridge(page, kBadgerReplySrc, messageBody);
+        CallBridge(page, IsAsync() ? kBadgerReplyAsyncSrc : kBadgerReplySrc, messageBody);
         return true;
     }
     else if (WKStringIsEqualToUTF8CString(messageName, Tags::BridgeObjectEvent)) {
-        CallBridge(page, kBadgerEventSrc, messageBody);
+        CallBridge(page, IsAsync() ? kBadgerEventAsyncSrc : kBadgerEventSrc, messageBody);
         return true;
     }
     return false;
@@ -19,6 +19,7 @@
  
 #include "Milestone.h"
 
+#include "Tags.h"
 #include "Utils.h"
 
 #include <iostream>
@@ -78,6 +79,16 @@ namespace JavaScript {
 
             TRACE_GLOBAL(Trace::Information, (ssMessage.str()));
 
+            // Let the browser add the milestone to the timeline of the current load.
+            WKStringRef messageName = WKStringCreateWithUTF8CString(Tags::Milestone);
+            WKMutableArrayRef messageBody = WKMutableArrayCreate();
+            for (const string& argString : argStrings) {
+                WebKit::Utils::AppendStringToWKArray(argString, messageBody);
+            }
+            WKBundlePostMessage(g_Bundle, messageName, messageBody);
+            WKRelease(messageBody);
+            WKRelease(messageName);
+
             return JSValueMakeNull(context);
         }
 
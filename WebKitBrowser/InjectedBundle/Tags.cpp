@@ -27,9 +27,11 @@ const char* const Config = "Config.";
 const char* const Notification = "Notification";
 const char* const URL = "URL";
 const char* const BridgeObjectQuery = "BridgeObjectQuery";
+const char* const BridgeObjectQueries = "BridgeObjectQueries";
 const char* const BridgeObjectReply = "BridgeObjectReply";
 const char* const BridgeObjectEvent = "BridgeObjectEvent";
 const char* const Headers = "Headers";
+const char* const Milestone = "Milestone";
 
 } } ;
 
@@ -27,9 +27,11 @@ extern const char* const Config;
 extern const char* const Notification;
 extern const char* const URL;
 extern const char* const BridgeObjectQuery;
+extern const char* const BridgeObjectQueries;
 extern const char* const BridgeObjectReply;
 extern const char* const BridgeObjectEvent;
 extern const char* const Headers;
+extern const char* const Milestone;
 
 } } ;
 
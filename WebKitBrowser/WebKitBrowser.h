@@ -232,6 +232,8 @@ namespace Plugin {
         uint32_t set_headers(const Core::JSON::ArrayType<JsonData::WebKitBrowser::HeadersData>& param);
         uint32_t endpoint_bridgereply(const Core::JSON::String& params);
         uint32_t endpoint_bridgeevent(const Core::JSON::String& params);
+        uint32_t get_memoryreclaim(Core::JSON::ArrayType<JsonData::WebKitBrowser::MemoryreclaimData>& response) const;
+        uint32_t get_loadtimings(Core::JSON::ArrayType<JsonData::WebKitBrowser::LoadtimingsData>& response) const;
         uint32_t get_localstorageenabled(Core::JSON::Boolean& response) const;
         uint32_t set_localstorageenabled(const Core::JSON::Boolean& param);
         uint32_t get_httpcookieacceptpolicy(Core::JSON::EnumType<JsonData::WebKitBrowser::HttpcookieacceptpolicyType>& response) const;
@@ -49,6 +49,8 @@ namespace Plugin {
         Property<Core::JSON::Boolean>(_T("localstorageenabled"), &WebKitBrowser::get_localstorageenabled, &WebKitBrowser::set_localstorageenabled, this);
         Property<Core::JSON::ArrayType<Core::JSON::String>>(_T("languages"), &WebKitBrowser::get_languages, &WebKitBrowser::set_languages, this);
         Property<Core::JSON::ArrayType<HeadersData>>(_T("headers"), &WebKitBrowser::get_headers, &WebKitBrowser::set_headers, this);
+        Property<Core::JSON::ArrayType<MemoryreclaimData>>(_T("memoryreclaim"), &WebKitBrowser::get_memoryreclaim, nullptr, this);
+        Property<Core::JSON::ArrayType<LoadtimingsData>>(_T("loadtimings"), &WebKitBrowser::get_loadtimings, nullptr, this);
         Register<Core::JSON::String,void>(_T("bridgereply"), &WebKitBrowser::endpoint_bridgereply, this);
         Register<Core::JSON::String,void>(_T("bridgeevent"), &WebKitBrowser::endpoint_bridgeevent, this);
     }
@@ -59,6 +61,8 @@ namespace Plugin {
         Unregister(_T("fps"));
         Unregister(_T("visibility"));
         Unregister(_T("url"));
+        Unregister(_T("loadtimings"));
+        Unregister(_T("memoryreclaim"));
         Unregister(_T("headers"));
         Unregister(_T("languages"));
         Unregister(_T("localstorageenabled"));
@@ -410,6 +414,28 @@ namespace Plugin {
         return Core::ERROR_NONE;
     }
 
+    // Property: memoryreclaim - Memory reclaimed by the memory governor, per stage
+    // Return codes:
+    //  - ERROR_NONE: Success
+    uint32_t WebKitBrowser::get_memoryreclaim(Core::JSON::ArrayType<JsonData::WebKitBrowser::MemoryreclaimData>& response) const
+    {
+        ASSERT(_browser != nullptr);
+        string reclaim = _browser->GetMemoryReclaim();
+        response.FromString(reclaim);
+        return Core::ERROR_NONE;
+    }
+
+    // Property: loadtimings - Milestones of the most recent page loads
+    // Return codes:
+    //  - ERROR_NONE: Success
+    uint32_t WebKitBrowser::get_loadtimings(Core::JSON::ArrayType<JsonData::WebKitBrowser::LoadtimingsData>& response) const
+    {
+        ASSERT(_browser != nullptr);
+        string timings = _browser->GetLoadTimings();
+        response.FromString(timings);
+        return Core::ERROR_NONE;
+    }
+
     // Event: loadfinished - Signals initial HTML document has been completely loaded and parsed
     void WebKitBrowser::event_loadfinished(const string& url, const int32_t& httpstatus)
     {
@@ -32,6 +32,7 @@
 #include <WPE/WebKit/WKNotificationManager.h>
 #include <WPE/WebKit/WKNotificationPermissionRequest.h>
 #include <WPE/WebKit/WKNotificationProvider.h>
+#include <WPE/WebKit/WKResourceCacheManager.h>
 #include <WPE/WebKit/WKSoupSession.h>
 #include <WPE/WebKit/WKUserMediaPermissionRequest.h>
 #include <WPE/WebKit/WKErrorRef.h>
@@ -60,6 +61,9 @@ typedef pid_t WKProcessID;
 typedef void (*WKPageIsWebProcessResponsiveFunction)(bool isWebProcessResponsive, void* context);
 WK_EXPORT void WKPageIsWebProcessResponsive(WKPageRef page, void* context, WKPageIsWebProcessResponsiveFunction function);
 WK_EXPORT WKProcessID WKPageGetProcessIdentifier(WKPageRef page);
+WK_EXPORT void WKContextGarbageCollectJavaScriptObjects(WKContextRef context);
+// Only available in WebKit builds with memory pressure notification support, resolved at runtime.
+WK_EXPORT void WKContextSendMemoryPressureEvent(WKContextRef context, bool isCritical) __attribute__((weak));
 
 #ifdef __cplusplus
 }
@@ -68,11 +72,15 @@ WK_EXPORT WKProcessID WKPageGetProcessIdentifier(WKPageRef page);
 namespace WPEFramework {
 namespace Plugin {
 
+    static void onDidReceiveMessageFromInjectedBundle(WKContextRef context, WKStringRef messageName,
+        WKTypeRef messageBodyObj, const void* clientInfo);
     static void onDidReceiveSynchronousMessageFromInjectedBundle(WKContextRef context, WKStringRef messageName,
         WKTypeRef messageBodyObj, WKTypeRef* returnData, const void* clientInfo);
     static void onNotificationShow(WKPageRef page, WKNotificationRef notification, const void* clientInfo);
     static void didStartProvisionalNavigation(WKPageRef page, WKNavigationRef navigation, WKTypeRef userData, const void* clientInfo);
     static void didFinishDocumentLoad(WKPageRef page, WKNavigationRef navigation, WKTypeRef userData, const void* clientInfo);
+    static void didFinishNavigation(WKPageRef page, WKNavigationRef navigation, WKTypeRef userData, const void* clientInfo);
+    static void renderingProgressDidChange(WKPageRef page, WKPageRenderingProgressEvents progressEvents, WKTypeRef userData, const void* clientInfo);
     static void onFrameDisplayed(WKViewRef view, const void* clientInfo);
     static void didSameDocumentNavigation(const OpaqueWKPage* page, const OpaqueWKNavigation* nav, unsigned int count, const void* clientInfo, const void* info);
     static void requestClosure(const void* clientInfo);
@@ -102,12 +110,12 @@ namespace Plugin {
         nullptr, // didReceiveServerRedirectForProvisionalNavigation
         didFailProvisionalNavigation,
         nullptr, // didCommitNavigation
-        nullptr, // didFinishNavigation
+        didFinishNavigation,
         didFailNavigation,
         nullptr, // didFailProvisionalLoadInSubframe
         didFinishDocumentLoad,
         didSameDocumentNavigation, // didSameDocumentNavigation
-        nullptr, // renderingProgressDidChange
+        renderingProgressDidChange,
         nullptr, // canAuthenticateAgainstProtectionSpace
         nullptr, // didReceiveAuthenticationChallenge
         webProcessDidCrash,
@@ -120,7 +128,8 @@ namespace Plugin {
 
     static WKContextInjectedBundleClientV1 _handlerInjectedBundle = {
         { 1, nullptr },
-        nullptr, // didReceiveMessageFromInjectedBundle
+        // didReceiveMessageFromInjectedBundle
+        onDidReceiveMessageFromInjectedBundle,
         // didReceiveSynchronousMessageFromInjectedBundle
         onDidReceiveSynchronousMessageFromInjectedBundle,
         nullptr, // getInjectedBundleInitializationUserData
@@ -451,6 +460,34 @@ static GSourceFuncs _handlerIntervention =
                 Core::JSON::String DumpOptions;
             };
 
+            class MemoryGovernorSettings : public Core::JSON::Container {
+            public:
+                MemoryGovernorSettings(const MemoryGovernorSettings&) = delete;
+                MemoryGovernorSettings& operator=(const MemoryGovernorSettings&) = delete;
+
+                MemoryGovernorSettings()
+                    : Core::JSON::Container()
+                    , Interval(0)
+                    , LowWatermark(0)
+                    , HighWatermark(0)
+                    , BlankPage(false)
+                {
+                    Add(_T("interval"), &Interval);
+                    Add(_T("lowwatermark"), &LowWatermark);
+                    Add(_T("highwatermark"), &HighWatermark);
+                    Add(_T("blankpage"), &BlankPage);
+                }
+                ~MemoryGovernorSettings()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt16 Interval;      // How often to sample the WebKit processes RSS in seconds (0 - disable)
+                Core::JSON::DecUInt32 LowWatermark;  // RSS in MB to reclaim down to while hidden or suspended (0 - run all stages)
+                Core::JSON::DecUInt32 HighWatermark; // RSS in MB that triggers reclamation while visible (0 - never)
+                Core::JSON::Boolean BlankPage;       // Load 'about:blank' as the last stage when suspended
+            };
+
         public:
             Config()
                 : Core::JSON::Container()
@@ -495,6 +532,7 @@ static GSourceFuncs _handlerIntervention =
                 , WatchDogCheckTimeoutInSeconds(0)
                 , WatchDogHangThresholdInSeconds(0)
                 , LoadBlankPageOnSuspendEnabled(false)
+                , MemoryGovernor()
             {
                 Add(_T("useragent"), &UserAgent);
                 Add(_T("url"), &URL);
@@ -539,6 +577,7 @@ static GSourceFuncs _handlerIntervention =
                 Add(_T("watchdogchecktimeoutinseconds"), &WatchDogCheckTimeoutInSeconds);
                 Add(_T("watchdoghangthresholdtinseconds"), &WatchDogHangThresholdInSeconds);
                 Add(_T("loadblankpageonsuspendenabled"), &LoadBlankPageOnSuspendEnabled);
+                Add(_T("memorygovernor"), &MemoryGovernor);
             }
             ~Config()
             {
@@ -588,6 +627,7 @@ static GSourceFuncs _handlerIntervention =
             Core::JSON::DecUInt16 WatchDogCheckTimeoutInSeconds;   // How often to check main event loop for responsiveness
             Core::JSON::DecUInt16 WatchDogHangThresholdInSeconds;  // The amount of time to give a process to recover before declaring a hang state
             Core::JSON::Boolean LoadBlankPageOnSuspendEnabled;
+            MemoryGovernorSettings MemoryGovernor;
         };
 
         class HangDetector
@@ -681,6 +721,418 @@ static GSourceFuncs _handlerIntervention =
             }
         };
 
+        // Fixed ring of per-load milestones, in milliseconds relative to the load start.
+        class LoadTimeline
+        {
+        public:
+            enum { MAX_LOADS = 16, MAX_MILESTONES = 16 };
+
+        private:
+            struct Load {
+                string URL;
+                uint32_t Navigation;
+                gint64 Start;
+                gint64 URLChange;
+                gint64 FirstPaint;
+                gint64 DOMContentLoaded;
+                gint64 LoadFinished;
+                gint64 Responsiveness;
+                bool Failed;
+                std::vector<string> Milestones;
+            };
+
+            mutable Core::CriticalSection _lock;
+            Load _loads[MAX_LOADS];
+            uint32_t _count { 0 }; // Loads started so far, the newest one is at (_count - 1) % MAX_LOADS
+            gint64 _requested { 0 };
+            gint64 _probe { 0 };
+
+            Load* Current()
+            {
+                return (_count == 0 ? nullptr : &_loads[(_count - 1) % MAX_LOADS]);
+            }
+            static uint32_t Elapsed(const gint64 from, const gint64 to)
+            {
+                return (static_cast<uint32_t>((to - from) / 1000));
+            }
+            void Mark(gint64 Load::*field)
+            {
+                gint64 now = g_get_monotonic_time();
+
+                _lock.Lock();
+                Load* load = Current();
+                if ((load != nullptr) && ((load->*field) == 0)) {
+                    (load->*field) = now;
+                }
+                _lock.Unlock();
+            }
+
+        public:
+            LoadTimeline(const LoadTimeline&) = delete;
+            LoadTimeline& operator=(const LoadTimeline&) = delete;
+
+            LoadTimeline()
+            {
+            }
+            ~LoadTimeline()
+            {
+            }
+
+            // A new URL was requested through the plugin
+            void Requested()
+            {
+                _lock.Lock();
+                _requested = g_get_monotonic_time();
+                _lock.Unlock();
+            }
+            void Started(const string& URL)
+            {
+                gint64 now = g_get_monotonic_time();
+
+                _lock.Lock();
+                Load& load(_loads[_count % MAX_LOADS]);
+                load.URL = URL;
+                load.Navigation = ++_count;
+                load.Start = now;
+                load.URLChange = _requested;
+                load.FirstPaint = 0;
+                load.DOMContentLoaded = 0;
+                load.LoadFinished = 0;
+                load.Responsiveness = 0;
+                load.Failed = false;
+                load.Milestones.clear();
+                _requested = 0;
+                _lock.Unlock();
+            }
+            void FirstPaint()
+            {
+                Mark(&Load::FirstPaint);
+            }
+            void DOMContentLoaded()
+            {
+                Mark(&Load::DOMContentLoaded);
+            }
+            void LoadFinished()
+            {
+                Mark(&Load::LoadFinished);
+            }
+            void Failed()
+            {
+                _lock.Lock();
+                Load* load = Current();
+                if (load != nullptr) {
+                    load->Failed = true;
+                }
+                _lock.Unlock();
+            }
+            void Milestone(const std::vector<string>& text)
+            {
+                gint64 now = g_get_monotonic_time();
+                string name;
+
+                for (const string& part : text) {
+                    name += (name.empty() ? part : ' ' + part);
+                }
+
+                _lock.Lock();
+                Load* load = Current();
+                if ((load != nullptr) && (load->Milestones.size() < MAX_MILESTONES)) {
+                    load->Milestones.push_back(name + ':' + std::to_string(Elapsed(load->Start, now)));
+                }
+                _lock.Unlock();
+            }
+            // HangDetector sent a responsiveness probe to the web process
+            void ProbeSent()
+            {
+                _probe = g_get_monotonic_time();
+            }
+            void ProbeReplied()
+            {
+                gint64 now = g_get_monotonic_time();
+
+                if (_probe != 0) {
+                    _lock.Lock();
+                    Load* load = Current();
+                    if ((load != nullptr) && ((now - _probe) > load->Responsiveness)) {
+                        load->Responsiveness = (now - _probe);
+                    }
+                    _lock.Unlock();
+                    _probe = 0;
+                }
+            }
+
+            string Report() const
+            {
+                Core::JSON::ArrayType<JsonData::WebKitBrowser::LoadtimingsData> response;
+
+                _lock.Lock();
+                uint32_t first = (_count > MAX_LOADS ? _count - MAX_LOADS : 0);
+                for (uint32_t index = first; index < _count; index++) {
+                    const Load& load(_loads[index % MAX_LOADS]);
+                    JsonData::WebKitBrowser::LoadtimingsData& entry(response.Add());
+
+                    entry.Url = load.URL;
+                    entry.Navigation = load.Navigation;
+                    entry.Failed = load.Failed;
+                    if (load.URLChange != 0) {
+                        entry.Urlchange = Elapsed(load.URLChange, load.Start);
+                    }
+                    if (load.FirstPaint != 0) {
+                        entry.Firstpaint = Elapsed(load.Start, load.FirstPaint);
+                    }
+                    if (load.DOMContentLoaded != 0) {
+                        entry.Domcontentloaded = Elapsed(load.Start, load.DOMContentLoaded);
+                    }
+                    if (load.LoadFinished != 0) {
+                        entry.Loadfinished = Elapsed(load.Start, load.LoadFinished);
+                    }
+                    if (load.Responsiveness != 0) {
+                        entry.Responsiveness = static_cast<uint32_t>(load.Responsiveness / 1000);
+                    }
+                    for (const string& milestone : load.Milestones) {
+                        entry.Milestones.Add() = milestone;
+                    }
+                }
+                _lock.Unlock();
+
+                string result;
+                response.ToString(result);
+                return (result);
+            }
+        };
+
+        // Samples the RSS of the web and network process and, once the page is
+        // hidden or suspended or the RSS crosses a watermark, reclaims memory in
+        // stages: one stage per sample, until the RSS is below the watermark.
+        class MemoryGovernor
+        {
+        public:
+            enum stage : uint8_t {
+                PRESSURE,
+                CACHES,
+                GARBAGECOLLECT,
+                BLANKPAGE,
+                STAGES
+            };
+
+        private:
+            struct Statistics {
+                uint32_t Count;
+                uint64_t Reclaimed; // in bytes
+                uint64_t Time;      // in microseconds
+            };
+
+            WebKitImplementation* _browser { nullptr };
+            GSource* _timerSource { nullptr };
+            mutable Core::CriticalSection _lock;
+
+            uint64_t _lowWatermark { 0 };
+            uint64_t _highWatermark { 0 };
+            bool _blankPage { false };
+
+            uint8_t _next { STAGES };       // Next stage to run, STAGES when idle
+            uint8_t _measuring { STAGES };  // Stage waiting for its RSS outcome
+            uint64_t _before { 0 };
+            bool _armed { true };
+            Statistics _statistics[STAGES];
+
+            static const TCHAR* Name(const uint8_t stage)
+            {
+                static const TCHAR* names[] = { _T("pressure"), _T("caches"), _T("garbagecollect"), _T("blankpage") };
+                return (names[stage]);
+            }
+
+            uint64_t Resident() const
+            {
+                uint64_t result = 0;
+
+                pid_t webprocessPID = WKPageGetProcessIdentifier(_browser->_page);
+                if (webprocessPID > 0) {
+                    result += Core::ProcessInfo(webprocessPID).Resident();
+                }
+
+                Core::ProcessInfo::Iterator children(Core::ProcessInfo().Id());
+                while (children.Next() == true) {
+                    if (children.Current().Name() == _T("WPENetworkProcess")) {
+                        result += children.Current().Resident();
+                        break;
+                    }
+                }
+
+                return (result);
+            }
+
+            bool Background() const
+            {
+                return ((_browser->_hidden == true) || (_browser->_state == PluginHost::IStateControl::SUSPENDED));
+            }
+
+            // Returns false if the stage is not applicable, so the next one can run right away.
+            bool Reclaim(const uint8_t stage)
+            {
+                WKContextRef context = WKPageGetContext(_browser->_page);
+                bool result = true;
+
+                switch (stage) {
+                case PRESSURE:
+                    if (WKContextSendMemoryPressureEvent != nullptr) {
+                        WKContextSendMemoryPressureEvent(context, Background());
+                    } else {
+                        result = false;
+                    }
+                    break;
+                case CACHES:
+                    WKResourceCacheManagerClearCacheForAllOrigins(WKContextGetResourceCacheManager(context), WKResourceCachesToClearInMemoryOnly);
+                    break;
+                case GARBAGECOLLECT:
+                    WKContextGarbageCollectJavaScriptObjects(context);
+                    break;
+                case BLANKPAGE: {
+                    const char kBlankURL[] = "about:blank";
+                    if ((_blankPage == true) && (_browser->_state == PluginHost::IStateControl::SUSPENDED) && (GetPageActiveURL(_browser->_page) != kBlankURL)) {
+                        _browser->SetURL(kBlankURL);
+                    } else {
+                        result = false;
+                    }
+                    break;
+                }
+                default:
+                    result = false;
+                    break;
+                }
+
+                return (result);
+            }
+
+            void Sample()
+            {
+                uint64_t resident = Resident();
+
+                if (_measuring != STAGES) {
+                    _lock.Lock();
+                    _statistics[_measuring].Reclaimed += (_before > resident ? _before - resident : 0);
+                    _lock.Unlock();
+                    _measuring = STAGES;
+                }
+
+                uint64_t watermark = (Background() == true ? _lowWatermark : _highWatermark);
+
+                if ((watermark != 0) && (resident <= watermark)) {
+                    _armed = true;
+                    _next = STAGES;
+                } else if ((_next == STAGES) && (watermark != 0) && (_armed == true)) {
+                    TRACE(Trace::Information, (_T("Memory watermark crossed, RSS %u KB"), static_cast<uint32_t>(resident / 1024)));
+                    _armed = false;
+                    _next = PRESSURE;
+                }
+
+                while (_next < STAGES) {
+                    uint8_t stage = _next++;
+
+                    // Never blank a page that can be seen
+                    if ((stage == BLANKPAGE) && (Background() == false)) {
+                        _next = STAGES;
+                        break;
+                    }
+
+                    uint64_t start = Core::Time::Now().Ticks();
+                    if (Reclaim(stage) == true) {
+                        uint64_t duration = Core::Time::Now().Ticks() - start;
+
+                        _lock.Lock();
+                        _statistics[stage].Count++;
+                        _statistics[stage].Time += duration;
+                        _lock.Unlock();
+
+                        TRACE(Trace::Information, (_T("Memory reclaim stage %s, RSS %u KB"), Name(stage), static_cast<uint32_t>(resident / 1024)));
+
+                        // The outcome is measured on the next sample
+                        _measuring = stage;
+                        _before = resident;
+                        break;
+                    }
+                }
+            }
+
+        public:
+            MemoryGovernor(const MemoryGovernor&) = delete;
+            MemoryGovernor& operator=(const MemoryGovernor&) = delete;
+
+            MemoryGovernor(WebKitImplementation* browser)
+                : _browser(browser)
+            {
+                ::memset(_statistics, 0, sizeof(_statistics));
+            }
+            ~MemoryGovernor()
+            {
+                Stop();
+            }
+
+            void Start()
+            {
+                const MemoryGovernorSettings& settings(_browser->_config.MemoryGovernor);
+
+                if (settings.Interval.Value() == 0)
+                    return;
+
+                _lowWatermark = static_cast<uint64_t>(settings.LowWatermark.Value()) * 1024 * 1024;
+                _highWatermark = static_cast<uint64_t>(settings.HighWatermark.Value()) * 1024 * 1024;
+                _blankPage = settings.BlankPage.Value();
+
+                _timerSource = g_timeout_source_new_seconds(settings.Interval.Value());
+                g_source_set_callback(
+                    _timerSource,
+                    [](gpointer data) -> gboolean {
+                        static_cast<MemoryGovernor*>(data)->Sample();
+                        return G_SOURCE_CONTINUE;
+                    },
+                    this,
+                    nullptr);
+                g_source_attach(_timerSource, _browser->_context);
+            }
+            void Stop()
+            {
+                if (_timerSource != nullptr) {
+                    g_source_destroy(_timerSource);
+                    g_source_unref(_timerSource);
+                    _timerSource = nullptr;
+                }
+            }
+
+            // Page went to the background, reclaim from the first stage on the next sample.
+            void Trigger()
+            {
+                if (_timerSource != nullptr) {
+                    _next = PRESSURE;
+                }
+            }
+            // Page is in the foreground again, stop reclaiming.
+            void Cancel()
+            {
+                _next = STAGES;
+                _armed = true;
+            }
+
+            string Report() const
+            {
+                Core::JSON::ArrayType<JsonData::WebKitBrowser::MemoryreclaimData> response;
+
+                _lock.Lock();
+                for (uint8_t stage = 0; stage < STAGES; stage++) {
+                    JsonData::WebKitBrowser::MemoryreclaimData& entry(response.Add());
+                    entry.Stage = Name(stage);
+                    entry.Count = _statistics[stage].Count;
+                    entry.Reclaimed = static_cast<uint32_t>(_statistics[stage].Reclaimed / 1024);
+                    entry.Time = static_cast<uint32_t>(_statistics[stage].Time);
+                }
+                _lock.Unlock();
+
+                string result;
+                response.ToString(result);
+                return (result);
+            }
+        };
+
 
     private:
         WebKitImplementation(const WebKitImplementation&) = delete;
@@ -703,6 +1155,8 @@ static GSourceFuncs _handlerIntervention =
             , _time(0)
             , _compliant(false)
             , _automationSession(nullptr)
+            , _memoryGovernor(this)
+            , _loadTimeline()
         {
 
             // Register an @Exit, in case we are killed, with an incorrect ref count !!
@@ -967,6 +1421,16 @@ static GSourceFuncs _handlerIntervention =
                 this);
         }
 
+        virtual string GetMemoryReclaim() const final
+        {
+            return (_memoryGovernor.Report());
+        }
+
+        virtual string GetLoadTimings() const final
+        {
+            return (_loadTimeline.Report());
+        }
+
         virtual void BridgeReply(const string& payload) final
         {
             SendToBridge(Tags::BridgeObjectReply, payload);
@@ -1030,6 +1494,7 @@ static GSourceFuncs _handlerIntervention =
             TRACE(Trace::Information, (_T("New URL: %s"), URL.c_str()));
 
             if (_context != nullptr) {
+                _loadTimeline.Requested();
                 using SetURLData = std::tuple<WebKitImplementation*, string>;
                 auto *data = new SetURLData(this, URL);
                 g_main_context_invoke_full(
@@ -1290,6 +1755,34 @@ static GSourceFuncs _handlerIntervention =
             _navigationRef = ref;
         }
 
+        // Load timeline milestones, reported by the page and navigation callbacks
+        void OnProvisionalNavigationStarted(const string& URL)
+        {
+            _loadTimeline.Started(URL);
+        }
+        void OnDocumentLoaded(WKNavigationRef navigation)
+        {
+            if (_navigationRef == navigation)
+                _loadTimeline.DOMContentLoaded();
+        }
+        void OnNavigationFinished(WKNavigationRef navigation)
+        {
+            if (_navigationRef == navigation)
+                _loadTimeline.LoadFinished();
+        }
+        void OnFirstPaint()
+        {
+            _loadTimeline.FirstPaint();
+        }
+        void OnNavigationFailed()
+        {
+            _loadTimeline.Failed();
+        }
+        void OnLoadMilestone(const std::vector<string>& lines)
+        {
+            _loadTimeline.Milestone(lines);
+        }
+
         void OnNotificationShown(uint64_t notificationID) const
         {
             WKNotificationManagerProviderDidShowNotification(_notificationManager, notificationID);
@@ -1500,6 +1993,7 @@ static GSourceFuncs _handlerIntervention =
 
                         WKViewSetViewState(object->_view, (object->_state == PluginHost::IStateControl::RESUMED ? kWKViewStateIsInWindow : 0));
                         object->Hidden(true);
+                        object->_memoryGovernor.Trigger();
 
                         TRACE_L1("Internal Hide Notification took %d mS.", static_cast<uint32_t>(Core::Time::Now().Ticks() - object->_time));
 
@@ -1519,6 +2013,8 @@ static GSourceFuncs _handlerIntervention =
 
                         WKViewSetViewState(object->_view, (object->_state == PluginHost::IStateControl::RESUMED ? kWKViewStateIsInWindow : 0) | kWKViewStateIsVisible);
                         object->Hidden(false);
+                        if (object->_state == PluginHost::IStateControl::RESUMED)
+                            object->_memoryGovernor.Cancel();
 
                         TRACE_L1("Internal Show Notification took %d mS.", static_cast<uint32_t>(Core::Time::Now().Ticks() - object->_time));
 
@@ -1547,6 +2043,7 @@ static GSourceFuncs _handlerIntervention =
 
                         WKViewSetViewState(object->_view, (object->_hidden ? 0 : kWKViewStateIsVisible));
                         object->OnStateChange(PluginHost::IStateControl::SUSPENDED);
+                        object->_memoryGovernor.Trigger();
 
                         TRACE_L1("Internal Suspend Notification took %d mS.", static_cast<uint32_t>(Core::Time::Now().Ticks() - object->_time));
 
@@ -1569,6 +2066,8 @@ static GSourceFuncs _handlerIntervention =
 
                         WKViewSetViewState(object->_view, (object->_hidden ? 0 : kWKViewStateIsVisible) | kWKViewStateIsInWindow);
                         object->OnStateChange(PluginHost::IStateControl::RESUMED);
+                        if (object->_hidden == false)
+                            object->_memoryGovernor.Cancel();
 
                         TRACE_L1("Internal Resume Notification took %d mS.", static_cast<uint32_t>(Core::Time::Now().Ticks() - object->_time));
 
@@ -1719,6 +2218,7 @@ static GSourceFuncs _handlerIntervention =
             // Register handlers for page navigation and message from injected bundle.
             _handlerWebKit.base.clientInfo = static_cast<void*>(this);
             WKPageSetPageNavigationClient(_page, &_handlerWebKit.base);
+            WKPageListenForLayoutMilestones(_page, kWKDidFirstVisuallyNonEmptyLayout);
 
             _handlerInjectedBundle.base.clientInfo = static_cast<void*>(this);
             WKContextSetInjectedBundleClient(context, &_handlerInjectedBundle.base);
@@ -1767,8 +2267,12 @@ static GSourceFuncs _handlerIntervention =
 
             _configurationCompleted.SetState(true);
 
+            _memoryGovernor.Start();
+
             g_main_loop_run(_loop);
 
+            _memoryGovernor.Stop();
+
             // Seems if we stop the mainloop but are not in a suspended state, there is a crash.
             // Force suspended state first.
             if (_state == PluginHost::IStateControl::RESUMED) {
@@ -1796,6 +2300,7 @@ static GSourceFuncs _handlerIntervention =
             if ( _webProcessCheckInProgress )
                 return;
             _webProcessCheckInProgress = true;
+            _loadTimeline.ProbeSent();
 
             WKPageIsWebProcessResponsive(
                 _page,
@@ -1818,6 +2323,7 @@ static GSourceFuncs _handlerIntervention =
             if (!_webProcessCheckInProgress)
                 return;
             _webProcessCheckInProgress = false;
+            _loadTimeline.ProbeReplied();
 
             if (isWebProcessResponsive && _unresponsiveReplyNum == 0)
                 return;
@@ -1894,10 +2400,38 @@ static GSourceFuncs _handlerIntervention =
         bool _webProcessCheckInProgress { false };
         uint32_t _unresponsiveReplyNum { 0 };
         WKNavigationRef _navigationRef { nullptr };
+        MemoryGovernor _memoryGovernor;
+        LoadTimeline _loadTimeline;
     };
 
     SERVICE_REGISTRATION(WebKitImplementation, 1, 0);
 
+    // Handles asynchronous messages from injected bundle.
+    /* static */ void onDidReceiveMessageFromInjectedBundle(WKContextRef context, WKStringRef messageName,
+        WKTypeRef messageBodyObj, const void* clientInfo)
+    {
+        WebKitImplementation* browser = const_cast<WebKitImplementation*>(static_cast<const WebKitImplementation*>(clientInfo));
+
+        string name = WKStringToString(messageName);
+
+        if (name == Tags::BridgeObjectQueries) {
+            // Message contains all bridge queries the page issued within one task.
+            WKArrayRef messageQueries = static_cast<WKArrayRef>(messageBodyObj);
+
+            for (const string& query : ConvertWKArrayToStringVector(messageQueries)) {
+                browser->OnBridgeQuery(query);
+            }
+        } else if (name == Tags::Milestone) {
+            // Message contains the arguments of the JS "automation" milestone handler.
+            WKArrayRef messageLines = static_cast<WKArrayRef>(messageBodyObj);
+
+            browser->OnLoadMilestone(ConvertWKArrayToStringVector(messageLines));
+        } else {
+            // Unexpected message name.
+            std::cerr << "WebBridge received asynchronous message (" << name << "), but didn't process it." << std::endl;
+        }
+    }
+
     // Handles synchronous messages from injected bundle.
     /* static */ void onDidReceiveSynchronousMessageFromInjectedBundle(WKContextRef context, WKStringRef messageName,
         WKTypeRef messageBodyObj, WKTypeRef* returnData, const void* clientInfo)
@@ -1940,6 +2474,7 @@ static GSourceFuncs _handlerIntervention =
         string url = WKStringToString(urlStringRef);
 
         browser->SetNavigationRef(navigation);
+        browser->OnProvisionalNavigationStarted(url);
         browser->OnURLChanged(url);
 
         WKRelease(urlRef);
@@ -1973,12 +2508,28 @@ static GSourceFuncs _handlerIntervention =
 
         string url = WKStringToString(urlStringRef);
 
+        browser->OnDocumentLoaded(navigation);
         browser->OnLoadFinished(url, navigation);
 
         WKRelease(urlRef);
         WKRelease(urlStringRef);
     }
 
+    /* static */ void didFinishNavigation(WKPageRef, WKNavigationRef navigation, WKTypeRef, const void* clientInfo)
+    {
+        WebKitImplementation* browser = const_cast<WebKitImplementation*>(static_cast<const WebKitImplementation*>(clientInfo));
+
+        browser->OnNavigationFinished(navigation);
+    }
+
+    /* static */ void renderingProgressDidChange(WKPageRef, WKPageRenderingProgressEvents progressEvents, WKTypeRef, const void* clientInfo)
+    {
+        WebKitImplementation* browser = const_cast<WebKitImplementation*>(static_cast<const WebKitImplementation*>(clientInfo));
+
+        if ((progressEvents & kWKDidFirstVisuallyNonEmptyLayout) != 0)
+            browser->OnFirstPaint();
+    }
+
     /* static */ void requestClosure(const void* clientInfo)
     {
         // WebKitImplementation* browser = const_cast<WebKitImplementation*>(static_cast<const WebKitImplementation*>(clientInfo));
@@ -2068,6 +2619,7 @@ static GSourceFuncs _handlerIntervention =
             return;
 
         WebKitImplementation* browser = const_cast<WebKitImplementation*>(static_cast<const WebKitImplementation*>(clientInfo));
+        browser->OnNavigationFailed();
         browser->OnLoadFailed();
     }
 
@@ -86,5 +86,8 @@ namespace Exchange {
 
         virtual void BridgeReply(const string& payload) = 0;
         virtual void BridgeEvent(const string& payload) = 0;
+
+        virtual string GetMemoryReclaim() const = 0;
+        virtual string GetLoadTimings() const = 0;
     };
 }}
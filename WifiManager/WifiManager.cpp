@@ -46,6 +46,7 @@ namespace {
         {"getQuirks", &WifiManager::getQuirks},
         {"getCurrentState", &WifiManager::getCurrentState},
         {"startScan", &WifiManager::startScan},
+        {"getAvailableSSIDs", &WifiManager::getAvailableSSIDs},
         {"getConnectedSSID", &WifiManager::getConnectedSSID},
         {"getPairedSSID", &WifiManager::getPairedSSID},
         {"getPairedSSIDInfo", &WifiManager::getPairedSSIDInfo},
@@ -158,6 +159,16 @@ namespace WPEFramework
             return result;
         }
 
+        uint32_t WifiManager::getAvailableSSIDs(const JsonObject &parameters, JsonObject &response) const
+        {
+            LOGINFOMETHOD();
+
+            uint32_t const result = wifiScan.getAvailableSSIDs(parameters, response);
+
+            LOGTRACEMETHODFIN();
+            return result;
+        }
+
         uint32_t WifiManager::getConnectedSSID(const JsonObject &parameters, JsonObject &response) const
         {
             LOGINFOMETHOD();
@@ -308,6 +319,10 @@ namespace WPEFramework
             {
                 wifiSignalThreshold.setWifiStateConnected(false);
             }
+            if (state == WifiState::DISABLED)
+            {
+                wifiScan.clearAvailableSSIDs();
+            }
         }
 
         /**
@@ -348,6 +363,17 @@ namespace WPEFramework
             sendNotify("onAvailableSSIDs", ssids);
         }
 
+        /**
+         * \brief Send an event with the access points added, changed or removed since the previous scans.
+         *
+         * \param changes The 'added', 'changed' and 'removed' arrays, and 'moreData'.
+         *
+         */
+        void WifiManager::onAvailableSSIDsChanged(JsonObject const& changes)
+        {
+            sendNotify("onAvailableSSIDsChanged", changes);
+        }
+
         /**
         * \brief Get the current WifiManager instance
         *
@@ -56,6 +56,7 @@ namespace WPEFramework {
             virtual uint32_t getCurrentState(const JsonObject& parameters, JsonObject& response) const override;
             virtual uint32_t startScan(const JsonObject& parameters, JsonObject& response) const override;
             virtual uint32_t stopScan(const JsonObject& parameters, JsonObject& response) override;
+            virtual uint32_t getAvailableSSIDs(const JsonObject& parameters, JsonObject& response) const override;
             virtual uint32_t getConnectedSSID(const JsonObject& parameters, JsonObject& response) const override;
             virtual uint32_t setEnabled(const JsonObject& parameters, JsonObject& response) override;
             virtual uint32_t connect(const JsonObject& parameters, JsonObject& response) override;
@@ -77,6 +78,7 @@ namespace WPEFramework {
             virtual void onSSIDsChanged() override;
             virtual void onWifiSignalThresholdChanged(float signalStrength, const std::string &strength) override;
             virtual void onAvailableSSIDs(JsonObject const& ssids) override;
+            virtual void onAvailableSSIDsChanged(JsonObject const& changes) override;
             //End events
 
             //Build QueryInterface implementation, specifying all possible interfaces to be returned.
@@ -0,0 +1,222 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+/**
+ * WifiManager table of the access points found by the scans.
+ *
+ */
+
+#include "WifiManagerBssTable.h"
+
+#include "utils.h"
+
+#include <cmath>
+#include <cstdlib>
+
+using namespace WPEFramework;
+using namespace WPEFramework::Plugin;
+
+namespace WPEJ = WPEFramework::Core::JSON;
+
+namespace
+{
+    char const* const g_ssid = "ssid";
+    char const* const g_bssid = "bssid";
+    char const* const g_frequency = "frequency";
+    char const* const g_security = "security";
+    char const* const g_signalStrength = "signalStrength";
+    char const* const g_lastSeen = "lastSeen";
+
+    // Weight of a new measurement in the smoothed signal strength
+    const double signalSmoothing = 0.5;
+    // A smoothed change smaller than this is not reported
+    const double signalChangeThreshold = 5.0;
+    // Complete scans an access point can be missing from before it is removed
+    const unsigned maxMissedScans = 2;
+
+    double signalStrengthOf(const JsonObject &accessPoint)
+    {
+        return std::strtod(accessPoint[g_signalStrength].String().c_str(), nullptr);
+    }
+}
+
+WifiManagerBssTable::WifiManagerBssTable()
+    : scan(0),
+      scanning(false)
+{
+}
+
+/**
+ * \brief Merge the access points of a scan result event into the table.
+ *
+ * Incremental scans report the access points in several events, 'moreData' is false on the last one.
+ * Access points are only removed when a scan completes, as a partial result says nothing about them.
+ *
+ * When the filter is not the one of the previous delta, what the client knows is of no use: every access point
+ * matching the new filter is reported as added, nothing as changed or removed.
+ *
+ * \param ssids         The 'getAvailableSSIDs' array sent by service manager.
+ * \param moreData      Whether more results of the same scan are to come.
+ * \param filter        The access points the client is interested in, the delta only reports those.
+ * \param filterChanged Whether 'filter' differs from the one of the previous update.
+ * \param[out] delta    What changed for the client.
+ *
+ */
+void WifiManagerBssTable::update(const JsonArray &ssids, bool moreData, const Filter &filter, bool filterChanged, Delta &delta)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto const now = std::chrono::system_clock::now();
+
+    for (int i = 0; i < ssids.Length(); i++) {
+        const JsonObject accessPoint = ssids[i].Object();
+        const std::string key = keyOf(accessPoint);
+        const double signalStrength = signalStrengthOf(accessPoint);
+        const bool wanted = !filterChanged && (!filter || filter(accessPoint));
+
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            Entry &entry = entries[key];
+            entry.accessPoint = accessPoint;
+            entry.signalStrength = signalStrength;
+            entry.reportedSignalStrength = signalStrength;
+            entry.security = accessPoint[g_security].String();
+            entry.lastSeen = now;
+            entry.scan = scan;
+            entry.missedScans = 0;
+
+            if (wanted)
+                delta.added.Add(toJson(entry));
+            continue;
+        }
+
+        Entry &entry = it->second;
+        entry.accessPoint = accessPoint;
+        entry.signalStrength += signalSmoothing * (signalStrength - entry.signalStrength);
+        entry.lastSeen = now;
+        entry.scan = scan;
+        entry.missedScans = 0;
+
+        const std::string security = accessPoint[g_security].String();
+        if ((security != entry.security) || (std::fabs(entry.signalStrength - entry.reportedSignalStrength) >= signalChangeThreshold)) {
+            entry.security = security;
+            entry.reportedSignalStrength = entry.signalStrength;
+            if (wanted)
+                delta.changed.Add(toJson(entry));
+        }
+    }
+
+    scanning = moreData;
+    if (!moreData) {
+        // The scan is complete, anything it did not report has been missed
+        for (auto it = entries.begin(); it != entries.end(); ) {
+            Entry &entry = it->second;
+            if ((entry.scan != scan) && (++entry.missedScans >= maxMissedScans)) {
+                if (!filterChanged && (!filter || filter(entry.accessPoint))) {
+                    JsonObject removed;
+                    removed[g_ssid] = entry.accessPoint[g_ssid];
+                    removed[g_frequency] = entry.accessPoint[g_frequency];
+                    if (entry.accessPoint.HasLabel(g_bssid))
+                        removed[g_bssid] = entry.accessPoint[g_bssid];
+                    delta.removed.Add(removed);
+                }
+                it = entries.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+        scan++;
+    }
+
+    if (filterChanged) {
+        for (auto &entry : entries) {
+            if (!filter || filter(entry.second.accessPoint)) {
+                entry.second.reportedSignalStrength = entry.second.signalStrength;
+                delta.added.Add(toJson(entry.second));
+            }
+        }
+    }
+}
+
+/**
+ * \brief The access points currently known, without scanning.
+ *
+ * \param filter        The access points to return, all of them when empty.
+ * \param[out] ssids    The access points, with the smoothed 'signalStrength' and 'lastSeen' in seconds since the epoch.
+ * \param[out] scanning Whether a scan has only delivered part of its results so far.
+ *
+ */
+void WifiManagerBssTable::getAvailableSSIDs(const Filter &filter, JsonArray &ssids, bool &scanning) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (const auto &entry : entries) {
+        if (!filter || filter(entry.second.accessPoint))
+            ssids.Add(toJson(entry.second));
+    }
+    scanning = this->scanning;
+}
+
+/**
+ * \brief The current scan was stopped, the rest of its results will not come.
+ *
+ * The access points it reported are kept. The next scan completing decides about the ones it missed.
+ *
+ */
+void WifiManagerBssTable::scanStopped()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    scanning = false;
+}
+
+/**
+ * \brief Forget every access point, e.g. when wifi is disabled.
+ *
+ */
+void WifiManagerBssTable::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    entries.clear();
+    scanning = false;
+}
+
+std::string WifiManagerBssTable::keyOf(const JsonObject &accessPoint)
+{
+    if (accessPoint.HasLabel(g_bssid))
+        return accessPoint[g_bssid].String();
+
+    return accessPoint[g_ssid].String() + '\n' + accessPoint[g_frequency].String();
+}
+
+JsonObject WifiManagerBssTable::toJson(const Entry &entry)
+{
+    JsonObject accessPoint = entry.accessPoint;
+    const int signalStrength = static_cast<int>(std::lround(entry.signalStrength));
+
+    // Keep the type service manager used for the value
+    if (entry.accessPoint[g_signalStrength].Content() == WPEJ::Variant::type::STRING)
+        accessPoint[g_signalStrength] = std::to_string(signalStrength);
+    else
+        accessPoint[g_signalStrength] = signalStrength;
+
+    accessPoint[g_lastSeen] = static_cast<int64_t>(std::chrono::duration_cast<std::chrono::seconds>(entry.lastSeen.time_since_epoch()).count());
+    return accessPoint;
+}
@@ -0,0 +1,85 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include "../Module.h"
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace WPEFramework {
+    namespace Plugin {
+        /**
+         * The access points found by the scans, kept between scans.
+         *
+         * Access points are identified by their BSSID when service manager reports one, by SSID and frequency
+         * otherwise. Their signal strength is smoothed over the scans, so a change is only reported when it
+         * moves by a few dB. An access point missing from several complete scans in a row is removed.
+         */
+        class WifiManagerBssTable {
+        public:
+            typedef std::function<bool(const JsonObject &accessPoint)> Filter;
+
+            /**
+             * The networks added, changed or removed by one scan result, as arrays of access points.
+             * Removed ones only carry their identification: 'ssid', 'frequency' and 'bssid' when known.
+             */
+            struct Delta {
+                JsonArray added;
+                JsonArray changed;
+                JsonArray removed;
+
+                bool isEmpty() const { return (added.Length() == 0) && (changed.Length() == 0) && (removed.Length() == 0); }
+            };
+
+            WifiManagerBssTable();
+            virtual ~WifiManagerBssTable() = default;
+            WifiManagerBssTable(WifiManagerBssTable const&) = delete;
+            WifiManagerBssTable& operator=(WifiManagerBssTable const&) = delete;
+
+            void update(const JsonArray &ssids, bool moreData, const Filter &filter, bool filterChanged, Delta &delta);
+            void getAvailableSSIDs(const Filter &filter, JsonArray &ssids, bool &scanning) const;
+            void scanStopped();
+            void clear();
+
+        private:
+            struct Entry {
+                JsonObject accessPoint;     // As last reported by service manager
+                double signalStrength;      // Smoothed
+                double reportedSignalStrength;
+                std::string security;
+                std::chrono::system_clock::time_point lastSeen;
+                unsigned scan;              // Last scan the access point was part of
+                unsigned missedScans;
+            };
+
+            static std::string keyOf(const JsonObject &accessPoint);
+            static JsonObject toJson(const Entry &entry);
+
+            mutable std::mutex mutex;
+            std::map<std::string, Entry> entries;
+            unsigned scan;                  // Incremented when a scan completes
+            bool scanning;                  // Some results of the current scan have been received
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -32,7 +32,6 @@
 
 // std
 #include <sstream>
-#include <regex>
 
 using namespace WPEFramework;
 using namespace WPEFramework::Plugin;
@@ -53,9 +52,15 @@ namespace
     char const* const g_ssids = "ssids";
     char const* const g_SSID_name = "SSID_name";
     char const* const g_timeout = "timeout";
+    char const* const g_added = "added";
+    char const* const g_changed = "changed";
+    char const* const g_removed = "removed";
 }
 
-WifiManagerScan::Filter WifiManagerScan::filter = {};
+std::mutex WifiManagerScan::filterMutex;
+std::shared_ptr<const WifiManagerScan::Filter> WifiManagerScan::filter;
+std::shared_ptr<const WifiManagerScan::Filter> WifiManagerScan::deltaFilter;
+WifiManagerBssTable WifiManagerScan::bssTable;
 
 /**
  * \brief Register event handlers.
@@ -104,23 +109,10 @@ uint32_t WifiManagerScan::startScan(const JsonObject &parameters, JsonObject &re
     returnIfBooleanParamNotFound(parameters, g_incremental);
     const bool incremental = parameters[g_incremental].Boolean();
 
-    filter = {};
-
-    if (parameters.HasLabel(g_ssid)) {
-        std::string ssid;
-        getStringParameter(g_ssid, ssid);
-        if (ssid.length()) {
-            filter.onSsid = true;
-            filter.ssid = ssid;
-        }
-    }
-    if (parameters.HasLabel(g_frequency)) {
-        std::string frequency;
-        getStringParameter(g_frequency, frequency);
-        if (frequency.length()) {
-            filter.onFrequency = true;
-            filter.frequency = frequency;
-        }
+    std::shared_ptr<const Filter> scanFilter = makeFilter(parameters);
+    {
+        std::lock_guard<std::mutex> lock(filterMutex);
+        filter = scanFilter;
     }
 
     if (incremental)
@@ -229,9 +221,47 @@ uint32_t WifiManagerScan::stopScan(const JsonObject& parameters, JsonObject& res
                     reinterpret_cast<void*>(&param),
                     sizeof(IARM_Bus_WiFiSrvMgr_Param_t)) );
 
+    if (res == IARM_RESULT_SUCCESS)
+        bssTable.scanStopped();
+
     returnResponse(res == IARM_RESULT_SUCCESS);
 }
 
+/**
+ * \brief Get the access points found by the previous scans, without scanning.
+ *
+ * The access points are kept between scans, with their signal strength smoothed over the scans and when they
+ * were last seen. Changes are published via the "onAvailableSSIDsChanged" event.
+ *
+ * \param parameters        Optionally includes 'ssid' and/or 'frequency', as for 'startScan'.
+ * \param[out] response     'ssids' with the access points and 'moreData' while a scan is in progress.
+ * \return                  A code indicating success.
+ *
+ */
+uint32_t WifiManagerScan::getAvailableSSIDs(const JsonObject &parameters, JsonObject &response) const
+{
+    LOGINFOMETHOD();
+
+    std::shared_ptr<const Filter> const requestFilter = makeFilter(parameters);
+    JsonArray ssids;
+    bool scanning = false;
+
+    bssTable.getAvailableSSIDs([&requestFilter](const JsonObject &accessPoint) { return requestFilter->matches(accessPoint); }, ssids, scanning);
+
+    response[g_ssids] = ssids;
+    response[g_moreData] = scanning;
+    returnResponse(true);
+}
+
+/**
+ * \brief Forget the access points found so far, they can not be seen any more.
+ *
+ */
+void WifiManagerScan::clearAvailableSSIDs()
+{
+    bssTable.clear();
+}
+
 /**
  * \brief Handle events from the IARM bus relating to wireless scanning.
  *
@@ -265,48 +295,97 @@ void WifiManagerScan::iarmEventHandler(char const* owner, IARM_EventId_t eventId
             return;
         }
 
-        JsonArray ssids = eventDocument[g_getAvailableSSIDs].Array();
-        applyFilter(ssids, filter);
+        JsonArray const ssids = eventDocument[g_getAvailableSSIDs].Array();
+        bool const moreData = eventData->data.wifiSSIDList.more_data;
+
+        std::shared_ptr<const Filter> scanFilter;
+        bool filterChanged = false;
+        {
+            std::lock_guard<std::mutex> lock(filterMutex);
+            scanFilter = filter;
+            filterChanged = (scanFilter && deltaFilter) ? !(*scanFilter == *deltaFilter) : (scanFilter != deltaFilter);
+            deltaFilter = scanFilter;
+        }
+        WifiManagerBssTable::Filter matches;
+        if (scanFilter)
+            matches = [&scanFilter](const JsonObject &accessPoint) { return scanFilter->matches(accessPoint); };
+
+        // Every access point of this result, as before the table existed
+        JsonArray filtered;
+        for (int i = 0; i < ssids.Length(); i++) {
+            JsonObject const accessPoint = ssids[i].Object();
+            if (!matches || matches(accessPoint))
+                filtered.Add(accessPoint);
+        }
+
+        WifiManagerBssTable::Delta delta;
+        bssTable.update(ssids, moreData, matches, filterChanged, delta);
 
         JsonObject params;
-        params[g_ssids] = ssids;
-        params[g_moreData] = eventData->data.wifiSSIDList.more_data;
+        params[g_ssids] = filtered;
+        params[g_moreData] = moreData;
         WifiManager::getInstance().onAvailableSSIDs(params);
-    }
-}
 
-void WifiManagerScan::applyFilter(JsonArray &ssids, const WifiManagerScan::Filter &filter) {
-    JsonArray result;
-    std::regex re;
-    std::smatch m;
-    if(filter.onSsid)
-    {
-        try
-        {
-            re = std::regex(filter.ssid);
-        }
-        catch(const std::regex_error &e)
-        {
-           LOGERR("Incorrect regex: %s", e.what());
+        // Sent even when empty after a filter change, the client has nothing matching the new one
+        if (!delta.isEmpty() || filterChanged) {
+            JsonObject changes;
+            changes[g_added] = delta.added;
+            changes[g_changed] = delta.changed;
+            changes[g_removed] = delta.removed;
+            changes[g_moreData] = moreData;
+            WifiManager::getInstance().onAvailableSSIDsChanged(changes);
         }
     }
+}
 
-    for(int i=0; i<ssids.Length(); i++) {
-        JsonObject object = ssids[i].Object();
-        if(filter.onSsid) {
-            std::string str = object[g_ssid].String();
+/**
+ * \brief Build the filter of a scan or query from its optional 'ssid' (a regular expression) and 'frequency' parameters.
+ *
+ */
+std::shared_ptr<const WifiManagerScan::Filter> WifiManagerScan::makeFilter(const JsonObject &parameters)
+{
+    std::shared_ptr<Filter> result = std::make_shared<Filter>();
 
-            if(!std::regex_match(str, m, re)){
-                LOGINFO("SSID filter out %s ~= %s", str.c_str(), filter.ssid.c_str());
-                continue;
+    if (parameters.HasLabel(g_ssid)) {
+        std::string ssid;
+        getStringParameter(g_ssid, ssid);
+        if (ssid.length()) {
+            result->onSsid = true;
+            result->ssid = ssid;
+            try
+            {
+                result->ssidRegex = std::regex(ssid);
+            }
+            catch(const std::regex_error &e)
+            {
+               LOGERR("Incorrect regex: %s", e.what());
             }
         }
-        if(filter.onFrequency && object[g_frequency].String() != filter.frequency) {
-            LOGINFO("Frequency filter out %s != %s", object[g_frequency].String().c_str(), filter.frequency.c_str());
-            continue;
+    }
+    if (parameters.HasLabel(g_frequency)) {
+        std::string frequency;
+        getStringParameter(g_frequency, frequency);
+        if (frequency.length()) {
+            result->onFrequency = true;
+            result->frequency = frequency;
         }
-
-        result.Add(object);
     }
-    ssids = result;
+
+    return result;
+}
+
+bool WifiManagerScan::Filter::operator==(const Filter &other) const
+{
+    return (onSsid == other.onSsid) && (ssid == other.ssid) && (onFrequency == other.onFrequency) && (frequency == other.frequency);
+}
+
+bool WifiManagerScan::Filter::matches(const JsonObject &accessPoint) const
+{
+    if (onSsid && !std::regex_match(accessPoint[g_ssid].String(), ssidRegex))
+        return false;
+
+    if (onFrequency && (accessPoint[g_frequency].String() != frequency))
+        return false;
+
+    return true;
 }
@@ -20,7 +20,11 @@
 #pragma once
 
 #include "../Module.h"
+#include "WifiManagerBssTable.h"
 
+#include <memory>
+#include <mutex>
+#include <regex>
 #include <string>
 
 // Forward declaration
@@ -44,6 +48,8 @@ namespace WPEFramework {
 
             uint32_t startScan(const JsonObject& parameters, JsonObject& response) const;
             uint32_t stopScan(const JsonObject& parameters, JsonObject& response);
+            uint32_t getAvailableSSIDs(const JsonObject& parameters, JsonObject& response) const;
+            void clearAvailableSSIDs();
 
         private:
             uint32_t getAvailableSSIDsAsync(const JsonObject& parameters, JsonObject& response) const;
@@ -54,12 +60,20 @@ namespace WPEFramework {
             struct Filter {
                 bool onSsid = false;
                 std::string ssid;
+                std::regex ssidRegex;   // Compiled once, when the scan is started
                 bool onFrequency = false;
                 std::string frequency;
+
+                bool matches(const JsonObject &accessPoint) const;
+                bool operator==(const Filter &other) const;
             };
 
-            static void applyFilter(JsonArray &object, const WifiManagerScan::Filter &filter);
-            static Filter filter;
+            static std::shared_ptr<const Filter> makeFilter(const JsonObject &parameters);
+
+            static std::mutex filterMutex;
+            static std::shared_ptr<const Filter> filter;    // Of the last scan started
+            static std::shared_ptr<const Filter> deltaFilter;   // Of the last onAvailableSSIDsChanged
+            static WifiManagerBssTable bssTable;
         };
     } // namespace Plugin
 } // namespace WPEFramework
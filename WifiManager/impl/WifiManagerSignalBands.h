@@ -0,0 +1,87 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+namespace WPEFramework {
+    namespace Plugin {
+        /*
+         * Signal strength bands signalled by onWifiSignalThresholdChanged, and the
+         * wpa_supplicant threshold watching the edges of the current band.
+         */
+        namespace WifiSignalBands {
+            const float thresholdExcellent = -50.0f;
+            const float thresholdGood = -60.0f;
+            const float thresholdFair = -67.0f;
+
+            // dB the signal has to go past a band edge before the band changes
+            const int hysteresis = 2;
+
+            enum Band { BAND_WEAK, BAND_FAIR, BAND_GOOD, BAND_EXCELLENT };
+            const char* const names[] = { "Weak", "Fair", "Good", "Excellent" };
+            // Lower edge of each band above Weak
+            const float edges[] = { 0.0f, thresholdFair, thresholdGood, thresholdExcellent };
+
+            inline int getBand(float signalStrength) {
+                if (signalStrength >= thresholdExcellent && signalStrength < 0)
+                    return BAND_EXCELLENT;
+                else if (signalStrength >= thresholdGood && signalStrength < thresholdExcellent)
+                    return BAND_GOOD;
+                else if (signalStrength >= thresholdFair && signalStrength < thresholdGood)
+                    return BAND_FAIR;
+                else
+                    return BAND_WEAK;
+            }
+
+            // Leaves 'band' only once the signal is 'hysteresis' dB past its edge
+            inline int getBand(int band, float signalStrength) {
+                if (band < 0)
+                    return getBand(signalStrength);
+
+                int up = getBand(signalStrength - hysteresis);
+                int down = getBand(signalStrength + hysteresis);
+                if (signalStrength < 0 && up > band)
+                    return up;
+                if (down < band)
+                    return down;
+                return band;
+            }
+
+            // wpa_supplicant threshold reporting the signal leaving 'band'. The signal is reported once below
+            // threshold - thresholdHysteresis or above threshold + thresholdHysteresis: never before getBand()
+            // leaves the band, since the band would not be re-armed then, and at most 1 dB after it.
+            inline void getThreshold(int band, int &threshold, int &thresholdHysteresis) {
+                // First signals outside the band, below and above
+                int low = (band == BAND_WEAK) ? -1000 : static_cast<int>(edges[band]) - hysteresis - 1;
+                int high = (band == BAND_EXCELLENT) ? 0 : static_cast<int>(edges[band + 1]) + hysteresis;
+
+                if (band == BAND_WEAK) {
+                    thresholdHysteresis = hysteresis;
+                    threshold = high - 1 - thresholdHysteresis;
+                } else if (band == BAND_EXCELLENT) {
+                    thresholdHysteresis = hysteresis;
+                    threshold = low + 1 + thresholdHysteresis;
+                } else {
+                    thresholdHysteresis = (high - low - 1) / 2;
+                    threshold = low + 1 + thresholdHysteresis;
+                }
+            }
+        }
+    }
+}
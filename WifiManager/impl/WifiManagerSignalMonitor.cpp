@@ -0,0 +1,418 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+
+#include "WifiManagerSignalMonitor.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+
+using namespace WPEFramework::Plugin;
+
+namespace
+{
+    const char* const g_clientPrefix = "/tmp/wifimanager_ctrl_";
+    const char* const g_signalChange = "CTRL-EVENT-SIGNAL-CHANGE";
+    const char* const g_connected = "CTRL-EVENT-CONNECTED";
+    const char* const g_disconnected = "CTRL-EVENT-DISCONNECTED";
+    const char* const g_terminating = "CTRL-EVENT-TERMINATING";
+
+    bool startsWith(const std::string &text, const char *prefix)
+    {
+        return text.compare(0, strlen(prefix), prefix) == 0;
+    }
+
+    // Value of 'name=<int>' in a space or newline separated list
+    bool findValue(const std::string &text, const std::string &name, int &value)
+    {
+        const std::string key = name + "=";
+        for (size_t pos = text.find(key); pos != std::string::npos; pos = text.find(key, pos + 1)) {
+            if ((pos != 0) && (text[pos - 1] != ' ') && (text[pos - 1] != '\n'))
+                continue;
+            const char *start = text.c_str() + pos + key.size();
+            char *end = nullptr;
+            long number = strtol(start, &end, 10);
+            if (end == start)
+                return false;
+            value = static_cast<int>(number);
+            return true;
+        }
+        return false;
+    }
+}
+
+WifiManagerSignalMonitor::WifiManagerSignalMonitor(const std::string &controlPath)
+    : controlPath(controlPath),
+      fd(-1),
+      wakeFd(-1),
+      running(false),
+      threshold(0),
+      hysteresis(0),
+      thresholdPending(false),
+      armed(false),
+      pollInterval(0),
+      polling(false),
+      polledThreshold(0),
+      polledHysteresis(0),
+      polledAbove(-1)
+{
+}
+
+WifiManagerSignalMonitor::~WifiManagerSignalMonitor()
+{
+    stop();
+}
+
+bool WifiManagerSignalMonitor::start(const Handler &handler, int pollIntervalMs)
+{
+    if (thread.joinable())
+        return true;
+
+    pollInterval = std::max(pollIntervalMs, 1);
+
+    wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeFd < 0)
+        return false;
+
+    this->handler = handler;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = true;
+        threshold = 0;
+        hysteresis = 0;
+        thresholdPending = false;
+    }
+
+    if (!attach()) {
+        close(wakeFd);
+        wakeFd = -1;
+        running = false;
+        return false;
+    }
+
+    thread = std::thread(&WifiManagerSignalMonitor::loop, this);
+    return true;
+}
+
+void WifiManagerSignalMonitor::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake();
+
+    if (thread.joinable())
+        thread.join();
+
+    if (wakeFd >= 0) {
+        close(wakeFd);
+        wakeFd = -1;
+    }
+}
+
+void WifiManagerSignalMonitor::setThreshold(int threshold, int hysteresis)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if ((this->threshold == threshold) && (this->hysteresis == hysteresis) && !thresholdPending && armed)
+            return;
+        this->threshold = threshold;
+        this->hysteresis = hysteresis;
+        thresholdPending = true;
+    }
+    wake();
+}
+
+bool WifiManagerSignalMonitor::attach()
+{
+    static std::atomic<unsigned> counter(0);
+
+    fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return false;
+
+    struct sockaddr_un local;
+    memset(&local, 0, sizeof(local));
+    local.sun_family = AF_UNIX;
+    localPath = g_clientPrefix + std::to_string(getpid()) + "-" + std::to_string(counter++);
+    strncpy(local.sun_path, localPath.c_str(), sizeof(local.sun_path) - 1);
+    unlink(localPath.c_str());
+
+    struct sockaddr_un remote;
+    memset(&remote, 0, sizeof(remote));
+    remote.sun_family = AF_UNIX;
+    strncpy(remote.sun_path, controlPath.c_str(), sizeof(remote.sun_path) - 1);
+
+    std::string reply;
+    if ((bind(fd, (struct sockaddr *)&local, sizeof(local)) != 0) ||
+        (connect(fd, (struct sockaddr *)&remote, sizeof(remote)) != 0) ||
+        !request("ATTACH", reply) || !startsWith(reply, "OK")) {
+        detach();
+        return false;
+    }
+
+    // A new wpa_supplicant knows nothing about the threshold
+    std::lock_guard<std::mutex> lock(mutex);
+    thresholdPending = (threshold != 0);
+    return true;
+}
+
+void WifiManagerSignalMonitor::detach()
+{
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+        unlink(localPath.c_str());
+    }
+    events.clear();
+    replies.clear();
+    armed = false;
+    polling = false;
+}
+
+/**
+ * \brief Send a command and wait for its reply, events received meanwhile are queued.
+ *
+ */
+bool WifiManagerSignalMonitor::request(const std::string &command, std::string &reply)
+{
+    if (fd < 0)
+        return false;
+
+    replies.clear();
+    if (send(fd, command.c_str(), command.size(), 0) < 0) {
+        detach();
+        return false;
+    }
+
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(WIFI_SIGNAL_MONITOR_REPLY_TIMEOUT_MS);
+    while (replies.empty() && (fd >= 0)) {
+        auto const left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (left <= 0)
+            return false;
+        receive(static_cast<int>(left));
+    }
+    if (replies.empty())
+        return false;
+
+    reply = replies.front();
+    replies.pop_front();
+    return true;
+}
+
+void WifiManagerSignalMonitor::receive(int timeoutMs)
+{
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    if (poll(&pfd, 1, timeoutMs) <= 0)
+        return;
+
+    char buffer[4096];
+    while (fd >= 0) {
+        ssize_t length = recv(fd, buffer, sizeof(buffer) - 1, MSG_DONTWAIT);
+        if (length < 0) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+                detach();
+            return;
+        }
+
+        std::string message(buffer, length);
+        while (!message.empty() && (message.back() == '\n'))
+            message.pop_back();
+
+        // Unsolicited messages start with their level, e.g. "<3>CTRL-EVENT-..."
+        if (!message.empty() && (message[0] == '<')) {
+            size_t end = message.find('>');
+            events.push_back(end == std::string::npos ? message : message.substr(end + 1));
+        }
+        else {
+            replies.push_back(message);
+        }
+    }
+}
+
+void WifiManagerSignalMonitor::dispatch(const std::string &event)
+{
+    int signal;
+
+    if (startsWith(event, g_signalChange)) {
+        if (findValue(event, "signal", signal) && handler)
+            handler(signal);
+    }
+    else if (startsWith(event, g_connected)) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            thresholdPending = (threshold != 0);
+        }
+        pollSignal();
+    }
+    else if (startsWith(event, g_disconnected)) {
+        armed = false;
+        polling = false;
+    }
+    else if (startsWith(event, g_terminating)) {
+        detach();
+    }
+}
+
+void WifiManagerSignalMonitor::pollSignal()
+{
+    std::string reply;
+    int signal;
+
+    // Fails while not associated, the next CTRL-EVENT-CONNECTED polls again
+    if (request("SIGNAL_POLL", reply) && findValue(reply, "RSSI", signal) && handler)
+        handler(signal);
+}
+
+void WifiManagerSignalMonitor::applyThreshold()
+{
+    int threshold, hysteresis;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!thresholdPending)
+            return;
+        thresholdPending = false;
+        threshold = this->threshold;
+        hysteresis = this->hysteresis;
+    }
+
+    char command[64];
+    snprintf(command, sizeof(command), "SIGNAL_MONITOR THRESHOLD=%d HYSTERESIS=%d", threshold, hysteresis);
+
+    std::string reply;
+    bool replied = request(command, reply);
+    armed = replied && startsWith(reply, "OK");
+
+    // Without CQM support in the driver wpa_supplicant answers FAIL, watch the threshold from here
+    polling = replied && !armed && (threshold != 0);
+    if (polling) {
+        polledThreshold = threshold;
+        polledHysteresis = hysteresis;
+        polledAbove = -1;
+        nextPoll = std::chrono::steady_clock::now() + std::chrono::milliseconds(pollInterval);
+    }
+}
+
+/**
+ * \brief Poll the signal, the handler is called when it went past the threshold, as with CQM.
+ *
+ */
+void WifiManagerSignalMonitor::pollThreshold()
+{
+    std::string reply;
+    int signal;
+
+    nextPoll = std::chrono::steady_clock::now() + std::chrono::milliseconds(pollInterval);
+    if (!request("SIGNAL_POLL", reply) || !findValue(reply, "RSSI", signal))
+        return;
+
+    int above = (signal > polledThreshold + polledHysteresis) ? 1 : (signal < polledThreshold - polledHysteresis) ? 0 : -1;
+    if ((above != -1) && (above != polledAbove)) {
+        polledAbove = above;
+        if (handler)
+            handler(signal);
+    }
+}
+
+void WifiManagerSignalMonitor::loop()
+{
+    pollSignal();
+
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running)
+                break;
+        }
+
+        if (fd < 0) {
+            struct pollfd pfd = { wakeFd, POLLIN, 0 };
+            poll(&pfd, 1, WIFI_SIGNAL_MONITOR_RECONNECT_MS);
+            eventfd_t value;
+            eventfd_read(wakeFd, &value);
+            if (attach())
+                pollSignal();
+            continue;
+        }
+
+        applyThreshold();
+        while (!events.empty() && (fd >= 0)) {
+            const std::string event = events.front();
+            events.pop_front();
+            dispatch(event);
+        }
+
+        {
+            // The handler may have moved the threshold
+            std::lock_guard<std::mutex> lock(mutex);
+            if (thresholdPending || !running)
+                continue;
+        }
+        if (fd < 0)
+            continue;
+
+        int timeout = -1;
+        if (polling) {
+            auto const left = std::chrono::duration_cast<std::chrono::milliseconds>(nextPoll - std::chrono::steady_clock::now()).count();
+            if (left <= 0) {
+                pollThreshold();
+                continue;
+            }
+            timeout = static_cast<int>(left);
+        }
+
+        struct pollfd pfds[2] = { { fd, POLLIN, 0 }, { wakeFd, POLLIN, 0 } };
+        if (poll(pfds, 2, timeout) < 0)
+            continue;
+
+        if (pfds[1].revents & POLLIN) {
+            eventfd_t value;
+            eventfd_read(wakeFd, &value);
+        }
+        if (pfds[0].revents & (POLLERR | POLLHUP | POLLNVAL))
+            detach();
+        else if (pfds[0].revents & POLLIN)
+            receive(0);
+    }
+
+    if (fd >= 0) {
+        std::string reply;
+        if (armed)
+            request("SIGNAL_MONITOR THRESHOLD=0 HYSTERESIS=0", reply);
+        request("DETACH", reply);
+        detach();
+    }
+}
+
+void WifiManagerSignalMonitor::wake()
+{
+    if (wakeFd >= 0)
+        eventfd_write(wakeFd, 1);
+}
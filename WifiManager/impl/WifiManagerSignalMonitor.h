@@ -0,0 +1,106 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#define WIFI_SIGNAL_MONITOR_CONTROL_PATH        "/var/run/wpa_supplicant/wlan0"
+#define WIFI_SIGNAL_MONITOR_REPLY_TIMEOUT_MS    1000
+#define WIFI_SIGNAL_MONITOR_RECONNECT_MS        5000    // While wpa_supplicant is away
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        /*
+         * Signal strength of the current connection, as reported by wpa_supplicant.
+         *
+         * Attaches to the wpa_supplicant control socket and arms its signal monitor
+         * (SIGNAL_MONITOR, nl80211 CQM RSSI underneath), so the thread only wakes up when
+         * the driver reports the signal crossed the threshold, or on (re)association.
+         * The handler is called on the monitor thread with the signal in dBm.
+         *
+         * When wpa_supplicant goes away the monitor keeps trying to attach again, the
+         * threshold is re-armed once it is back. When it refuses the threshold, because
+         * the driver has no CQM support, the monitor polls the signal (SIGNAL_POLL) every
+         * pollIntervalMs and calls the handler when it crosses the threshold.
+         */
+        class WifiManagerSignalMonitor
+        {
+        public:
+            typedef std::function<void(int signalStrength)> Handler;
+
+            explicit WifiManagerSignalMonitor(const std::string &controlPath = WIFI_SIGNAL_MONITOR_CONTROL_PATH);
+            ~WifiManagerSignalMonitor();
+            WifiManagerSignalMonitor(const WifiManagerSignalMonitor&) = delete;
+            WifiManagerSignalMonitor& operator=(const WifiManagerSignalMonitor&) = delete;
+
+            // False when the control socket can not be attached to, nothing is started then
+            bool start(const Handler &handler, int pollIntervalMs);
+            void stop();
+
+            // Asks for an event when the signal goes below threshold - hysteresis or above threshold + hysteresis
+            void setThreshold(int threshold, int hysteresis);
+
+        private:
+            bool attach();
+            void detach();
+            bool request(const std::string &command, std::string &reply);
+            void receive(int timeoutMs);
+            void dispatch(const std::string &event);
+            void pollSignal();
+            void pollThreshold();
+            void applyThreshold();
+            void loop();
+            void wake();
+
+            const std::string controlPath;
+            std::string localPath;
+            int fd;
+            int wakeFd;
+            Handler handler;
+            std::thread thread;
+
+            std::mutex mutex;               // Guards the fields below, set from other threads
+            bool running;
+            int threshold;                  // 0 when not set
+            int hysteresis;
+            bool thresholdPending;          // Not sent to wpa_supplicant yet
+
+            std::deque<std::string> events; // Received while waiting for a reply
+            std::deque<std::string> replies;
+            std::atomic<bool> armed;        // The threshold is active in wpa_supplicant
+
+            // Threshold refused by wpa_supplicant, polled instead
+            int pollInterval;
+            bool polling;
+            int polledThreshold;
+            int polledHysteresis;
+            int polledAbove;                // -1 until the signal is seen past the threshold
+            std::chrono::steady_clock::time_point nextPoll;
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
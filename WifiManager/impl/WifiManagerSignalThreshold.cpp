@@ -18,6 +18,7 @@
 **/
 
 #include "WifiManagerSignalThreshold.h"
+#include "WifiManagerSignalBands.h"
 
 #include "utils.h"
 
@@ -26,48 +27,30 @@
 using namespace WPEFramework::Plugin;
 
 namespace {
-    const float signalStrengthThresholdExcellent = -50.0f;
-    const float signalStrengthThresholdGood = -60.0f;
-    const float signalStrengthThresholdFair = -67.0f;
-
-    void getSignalData(WifiManagerInterface &wifiManager, float &signalStrengthOut, std::string &strengthOut) {
+    float getSignalStrength(WifiManagerInterface &wifiManager) {
         JsonObject response;
         wifiManager.getConnectedSSID(JsonObject(), response);
 
-        signalStrengthOut = 0.0f;
+        float signalStrength = 0.0f;
         if (response.HasLabel("signalStrength")) {
-            signalStrengthOut = std::stof(response["signalStrength"].String());
-        }
-
-        if (signalStrengthOut >= signalStrengthThresholdExcellent && signalStrengthOut < 0)
-        {
-            strengthOut = "Excellent";
-        }
-        else if (signalStrengthOut >= signalStrengthThresholdGood && signalStrengthOut < signalStrengthThresholdExcellent)
-        {
-            strengthOut = "Good";
-        }
-        else if (signalStrengthOut >= signalStrengthThresholdFair && signalStrengthOut < signalStrengthThresholdGood)
-        {
-            strengthOut = "Fair";
+            signalStrength = std::stof(response["signalStrength"].String());
         }
-        else
-        {
-            strengthOut = "Weak";
-        };
+        return signalStrength;
     }
 }
 
 WifiManagerSignalThreshold::WifiManagerSignalThreshold(WifiManagerInterface &wifiManager):
     changeEnabled(false),
     wifiManager(wifiManager),
-    running(false)
+    running(false),
+    band(-1)
 {
 }
 
 WifiManagerSignalThreshold::~WifiManagerSignalThreshold()
 {
     stopThread();
+    monitor.stop();
 }
 
 uint32_t WifiManagerSignalThreshold::setSignalThresholdChangeEnabled(const JsonObject &parameters, JsonObject &response)
@@ -103,14 +86,26 @@ uint32_t WifiManagerSignalThreshold::isSignalThresholdChangeEnabled(const JsonOb
 void WifiManagerSignalThreshold::setSignalThresholdChangeEnabled(bool enabled, int interval)
 {
     stopThread();
+    monitor.stop();
 
     changeEnabled = enabled;
-
-    WifiState state;
-    getWifiState(state);
+    {
+        std::lock_guard<std::mutex> lock(bandMutex);
+        band = -1;
+    }
 
     if(changeEnabled)
     {
+        if (monitor.start([this](int signalStrength){ onSignalStrength(signalStrength); }, interval))
+        {
+            LOGINFO("signal strength reported by wpa_supplicant");
+            return;
+        }
+        LOGWARN("wpa_supplicant control socket not available, polling the signal strength every %d ms", interval);
+
+        WifiState state;
+        getWifiState(state);
+
         if (state == WifiState::CONNECTED)
             running = true;
         startThread(interval);
@@ -128,18 +123,9 @@ void WifiManagerSignalThreshold::loop(int interval)
     while(changeEnabled) {
         LOGINFO("WifiManagerSignalThreashold::loop");
 
-        float signalStrength;
-        std::string strength;
-        std::string lastStrength = "";
         if (running)
         {
-            getSignalData(wifiManager, signalStrength, strength);
-
-            if (strength.compare(lastStrength) != 0)
-            {
-                wifiManager.onWifiSignalThresholdChanged(signalStrength, strength);
-                lastStrength = strength;
-            }
+            onSignalStrength(getSignalStrength(wifiManager));
             cv.wait_for(lk, std::chrono::milliseconds(interval), [this](){ return changeEnabled == false; });
         } else {
             cv.wait(lk, [this](){ return running || changeEnabled == false; });
@@ -166,6 +152,36 @@ void WifiManagerSignalThreshold::setWifiStateConnected(bool connected)
     {
         cv.notify_one();
     }
+    else
+    {
+        // Signal the band again once connected
+        std::lock_guard<std::mutex> lock(bandMutex);
+        band = -1;
+    }
+}
+
+/**
+ * \brief Signal the band of a new signal strength reading, when it changed.
+ *
+ * Called from the polling thread, or from the wpa_supplicant monitor thread.
+ *
+ */
+void WifiManagerSignalThreshold::onSignalStrength(float signalStrength)
+{
+    int threshold, hysteresis;
+    std::string strength;
+    {
+        std::lock_guard<std::mutex> lock(bandMutex);
+        int newBand = WifiSignalBands::getBand(band, signalStrength);
+        if (newBand == band)
+            return;
+        band = newBand;
+        strength = WifiSignalBands::names[band];
+        WifiSignalBands::getThreshold(band, threshold, hysteresis);
+    }
+
+    monitor.setThreshold(threshold, hysteresis);
+    wifiManager.onWifiSignalThresholdChanged(signalStrength, strength);
 }
 
 void WifiManagerSignalThreshold::getWifiState(WifiState &state)
@@ -22,6 +22,7 @@
 #include "../Module.h"
 #include "../WifiManagerDefines.h"
 #include "../WifiManagerInterface.h"
+#include "WifiManagerSignalMonitor.h"
 
 #include <atomic>
 #include <condition_variable>
@@ -38,8 +39,14 @@ namespace WPEFramework {
             // - onWifiSignalTresholdChanged
             // From WifiManager module.
             //
-            // As the onWifiSignalTresholdChanged event is signalled periodically,
-            // it has to be handled with an additional thread.
+            // The event is only signalled when the signal moves to another band
+            // (Excellent, Good, Fair, Weak), with a few dB of hysteresis around the
+            // band edges. wpa_supplicant is asked to report the signal crossing the
+            // edges of the current band, so nothing runs while the signal is stable.
+            // When the driver can not watch the threshold, the signal is polled from
+            // wpa_supplicant every 'interval' ms. When its control socket is not
+            // available the signal is polled every 'interval' ms with an additional
+            // thread instead.
         public:
             WifiManagerSignalThreshold(WifiManagerInterface &wifiManager);
             virtual ~WifiManagerSignalThreshold();
@@ -58,6 +65,7 @@ namespace WPEFramework {
             void stopThread();
             void startThread(int interval);
             void getWifiState(WifiState &state);
+            void onSignalStrength(float signalStrength);
 
         private:
             std::thread thread;
@@ -66,6 +74,10 @@ namespace WPEFramework {
             std::condition_variable cv;
             WifiManagerInterface &wifiManager;
             bool running;
+
+            WifiManagerSignalMonitor monitor;
+            std::mutex bandMutex;
+            int band;                       // Last band signalled, -1 when none yet
         };
     }
 }
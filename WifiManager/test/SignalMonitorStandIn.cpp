@@ -0,0 +1,452 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+
+/*
+ * Stands in for wpa_supplicant behind the WifiManager signal monitor. The
+ * control socket is emulated in process: ATTACH / DETACH, SIGNAL_POLL and
+ * SIGNAL_MONITOR are answered, and CTRL-EVENT-SIGNAL-CHANGE is sent when
+ * the signal of a scripted trace crosses threshold +/- hysteresis, the way
+ * the nl80211 CQM RSSI threshold notifications reach wpa_supplicant.
+ *
+ * The monitor client re-arms the threshold around every reading it gets,
+ * so it must be told about exactly the moves larger than the hysteresis.
+ * A reconnection must be polled and re-armed, and so must a restart of
+ * the emulated wpa_supplicant. A wpa_supplicant refusing SIGNAL_MONITOR,
+ * as it does with a driver without CQM support, must be polled instead.
+ *
+ * The signal bands of WifiManagerSignalThreshold are checked too: their
+ * hysteresis, and the thresholds armed to watch them.
+ */
+
+#include "WifiManagerSignalMonitor.h"
+#include "WifiManagerSignalBands.h"
+
+#include <getopt.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace WPEFramework::Plugin;
+
+namespace
+{
+    const int clientHysteresis = 3;
+
+    class Supplicant
+    {
+    public:
+        explicit Supplicant(const std::string &path) : path(path), fd(-1), running(false), connected(true),
+            monitorSupported(true), signal(-50), threshold(0), hysteresis(0), above(-1) { }
+        ~Supplicant() { stop(); }
+
+        bool start()
+        {
+            fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+            struct sockaddr_un address;
+            memset(&address, 0, sizeof(address));
+            address.sun_family = AF_UNIX;
+            strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+            unlink(path.c_str());
+            if ((fd < 0) || (bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0))
+                return false;
+
+            running = true;
+            thread = std::thread(&Supplicant::loop, this);
+            return true;
+        }
+
+        void stop()
+        {
+            if (!running)
+                return;
+            broadcast("<2>CTRL-EVENT-TERMINATING");
+            running = false;
+            thread.join();
+            close(fd);
+            unlink(path.c_str());
+
+            std::lock_guard<std::mutex> lock(mutex);
+            clients.clear();
+            threshold = 0;
+            above = -1;
+        }
+
+        void setSignal(int value)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            signal = value;
+            if (connected && (threshold != 0))
+                check();
+        }
+
+        void setConnected(bool value)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            connected = value;
+            above = -1;
+            sendLocked(value ? "<3>CTRL-EVENT-CONNECTED - Connection to 00:11:22:33:44:55 completed [id=0 id_str=]"
+                             : "<3>CTRL-EVENT-DISCONNECTED bssid=00:11:22:33:44:55 reason=3 locally_generated=1");
+        }
+
+        // Without CQM support in the driver, SIGNAL_MONITOR fails
+        void setMonitorSupported(bool value)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            monitorSupported = value;
+            threshold = 0;
+            above = -1;
+        }
+
+        unsigned armings() const { return armCount; }
+        unsigned polls() const { return pollCount; }
+
+    private:
+        // Called with the mutex held
+        void check()
+        {
+            int now = (signal > threshold + hysteresis) ? 1 : (signal < threshold - hysteresis) ? 0 : -1;
+            if ((now != -1) && (now != above)) {
+                above = now;
+                char event[128];
+                snprintf(event, sizeof(event), "<3>CTRL-EVENT-SIGNAL-CHANGE above=%d signal=%d noise=-95 txrate=65000", now, signal);
+                sendLocked(event);
+            }
+        }
+
+        void broadcast(const char *message)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            sendLocked(message);
+        }
+
+        void sendLocked(const std::string &message)
+        {
+            for (const struct sockaddr_un &client : clients)
+                sendto(fd, message.c_str(), message.size(), 0, (const struct sockaddr *)&client, sizeof(client));
+        }
+
+        std::string handle(const std::string &command, const struct sockaddr_un &from)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (command == "ATTACH") {
+                clients.push_back(from);
+                return "OK\n";
+            }
+            if (command == "DETACH") {
+                clients.erase(std::remove_if(clients.begin(), clients.end(),
+                    [&from](const struct sockaddr_un &client) { return strcmp(client.sun_path, from.sun_path) == 0; }), clients.end());
+                return "OK\n";
+            }
+            if (command == "SIGNAL_POLL") {
+                pollCount++;
+                if (!connected)
+                    return "FAIL\n";
+                return "RSSI=" + std::to_string(signal) + "\nLINKSPEED=65\nNOISE=-95\nFREQUENCY=5180\n";
+            }
+            int t, h;
+            if (sscanf(command.c_str(), "SIGNAL_MONITOR THRESHOLD=%d HYSTERESIS=%d", &t, &h) == 2) {
+                if (!connected || !monitorSupported)
+                    return "FAIL\n";
+                threshold = t;
+                hysteresis = h;
+                above = (signal > t + h) ? 1 : (signal < t - h) ? 0 : -1;
+                armCount++;
+                return "OK\n";
+            }
+            return "UNKNOWN COMMAND\n";
+        }
+
+        void loop()
+        {
+            char buffer[256];
+            while (running) {
+                struct pollfd pfd = { fd, POLLIN, 0 };
+                if (poll(&pfd, 1, 50) <= 0)
+                    continue;
+
+                struct sockaddr_un from;
+                socklen_t fromLength = sizeof(from);
+                memset(&from, 0, sizeof(from));
+                ssize_t length = recvfrom(fd, buffer, sizeof(buffer) - 1, 0, (struct sockaddr *)&from, &fromLength);
+                if (length <= 0)
+                    continue;
+
+                std::string reply = handle(std::string(buffer, length), from);
+                sendto(fd, reply.c_str(), reply.size(), 0, (struct sockaddr *)&from, fromLength);
+            }
+        }
+
+        const std::string path;
+        int fd;
+        std::atomic<bool> running;
+        std::thread thread;
+
+        std::mutex mutex;
+        std::vector<struct sockaddr_un> clients;
+        bool connected;
+        bool monitorSupported;
+        int signal;
+        int threshold;
+        int hysteresis;
+        int above;
+        std::atomic<unsigned> armCount { 0 };
+        std::atomic<unsigned> pollCount { 0 };
+    };
+
+    class Readings
+    {
+    public:
+        void add(int signal)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            values.push_back(signal);
+            cv.notify_all();
+        }
+
+        bool waitFor(size_t count, int timeoutMs)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            return cv.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this, count]() { return values.size() >= count; });
+        }
+
+        std::vector<int> get()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return values;
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<int> values;
+    };
+
+    /*
+     * A band is only left once the signal is WifiSignalBands::hysteresis dB past its edge, and
+     * the threshold armed for a band reports the signal leaving it. Never before the band is
+     * left, the band would not be re-armed, and at most 1 dB after.
+     */
+    int checkBands()
+    {
+        using namespace WifiSignalBands;
+        int failures = 0;
+
+        const struct { float signal; int band; } plain[] = {
+            { -45, BAND_EXCELLENT }, { -50, BAND_EXCELLENT }, { -51, BAND_GOOD }, { -60, BAND_GOOD },
+            { -61, BAND_FAIR }, { -67, BAND_FAIR }, { -68, BAND_WEAK }, { -90, BAND_WEAK } };
+        for (const auto &step : plain) {
+            if (getBand(-1, step.signal) != step.band) {
+                printf("bands        %.0f dBm is not %s\n", step.signal, names[step.band]);
+                failures++;
+            }
+        }
+
+        for (int band = BAND_WEAK; band <= BAND_EXCELLENT; band++) {
+            int threshold, thresholdHysteresis;
+            getThreshold(band, threshold, thresholdHysteresis);
+
+            for (int signal = -100; signal <= -20; signal++) {
+                int moved = getBand(band, signal);
+                bool reported = (signal < threshold - thresholdHysteresis) || (signal > threshold + thresholdHysteresis);
+                bool inside = (band == BAND_WEAK || signal >= edges[band] - hysteresis) &&
+                              (band == BAND_EXCELLENT || signal < edges[band + 1] + hysteresis);
+
+                // Hysteresis: the band is kept up to 'hysteresis' dB past its edges
+                if ((moved == band) != inside) {
+                    printf("bands        %s %s at %d dBm\n", names[band], (moved == band) ? "kept" : "left", signal);
+                    failures++;
+                }
+                // Spurious reports are only allowed beyond the lowest and highest band
+                if (reported && (moved == band) && !(band == BAND_WEAK && signal < edges[BAND_FAIR]) &&
+                    !(band == BAND_EXCELLENT && signal >= edges[BAND_EXCELLENT])) {
+                    printf("bands        %s threshold %d/%d reports %d dBm, still in the band\n", names[band], threshold, thresholdHysteresis, signal);
+                    failures++;
+                }
+                if (moved != band) {
+                    int further = (moved > band) ? signal + 1 : signal - 1;
+                    bool reportedLate = (further < threshold - thresholdHysteresis) || (further > threshold + thresholdHysteresis);
+                    if (!reported && !reportedLate) {
+                        printf("bands        %s threshold %d/%d misses %d dBm, band left\n", names[band], threshold, thresholdHysteresis, signal);
+                        failures++;
+                    }
+                }
+            }
+        }
+
+        printf("%-12s %s\n", "bands", failures ? "FAILED" : "ok");
+        return failures;
+    }
+
+    std::string toString(const std::vector<int> &values)
+    {
+        std::ostringstream stream;
+        for (size_t i = 0; i < values.size(); i++)
+            stream << (i ? " " : "") << values[i];
+        return stream.str();
+    }
+}
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [options]\n"
+        "  -p <path>    control socket to emulate (default /tmp/wifimanager-standin-wlan0)\n"
+        "  -s <list>    comma separated signal trace in dBm\n"
+        "  -i <ms>      between the trace steps (default 50)\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    std::string path = "/tmp/wifimanager-standin-wlan0";
+    std::vector<int> trace = { -50, -51, -52, -54, -55, -58, -59, -63, -70, -71, -69, -66, -60, -55, -45 };
+    int interval = 50;
+    int option;
+
+    while ((option = getopt(argc, argv, "p:s:i:")) != -1) {
+        switch (option) {
+        case 'p': path = optarg; break;
+        case 's': {
+            trace.clear();
+            std::istringstream stream(optarg);
+            std::string value;
+            while (std::getline(stream, value, ','))
+                trace.push_back(atoi(value.c_str()));
+            break;
+        }
+        case 'i': interval = std::max(1, atoi(optarg)); break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (trace.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Supplicant supplicant(path);
+    supplicant.setSignal(trace[0]);
+    if (!supplicant.start()) {
+        fprintf(stderr, "Could not bind %s\n", path.c_str());
+        return 1;
+    }
+
+    Readings readings;
+    WifiManagerSignalMonitor monitor(path);
+    if (!monitor.start([&readings, &monitor](int signal) {
+            readings.add(signal);
+            monitor.setThreshold(signal, clientHysteresis);
+        }, interval)) {
+        fprintf(stderr, "Could not attach to %s\n", path.c_str());
+        return 1;
+    }
+
+    int failures = checkBands();
+    auto expect = [&failures, &readings](const char *step, const std::vector<int> &expected) {
+        readings.waitFor(expected.size(), WIFI_SIGNAL_MONITOR_RECONNECT_MS + 2000);
+        // Give unexpected extra readings a chance to show up
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        std::vector<int> got = readings.get();
+        bool valid = got == expected;
+        if (!valid)
+            failures++;
+        printf("%-12s %s%s\n", step, toString(got).c_str(), valid ? "" : ("  EXPECTED " + toString(expected)).c_str());
+    };
+
+    // The first reading comes from SIGNAL_POLL, then one per move past the hysteresis
+    std::vector<int> expected = { trace[0] };
+    expect("poll", expected);
+
+    for (size_t i = 1; i < trace.size(); i++) {
+        supplicant.setSignal(trace[i]);
+        if (std::abs(trace[i] - expected.back()) > clientHysteresis)
+            expected.push_back(trace[i]);
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+    }
+    expect("trace", expected);
+
+    // Signal changes while disconnected are not reported, the reconnection is polled
+    supplicant.setConnected(false);
+    supplicant.setSignal(expected.back() - 20);
+    std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+    supplicant.setConnected(true);
+    expected.push_back(expected.back() - 20);
+    expect("reconnect", expected);
+
+    supplicant.setSignal(expected.back() + 10);
+    expected.push_back(expected.back() + 10);
+    expect("rearmed", expected);
+
+    // A restarted wpa_supplicant knows nothing about the client
+    supplicant.stop();
+    supplicant.setSignal(expected.back() - 10);
+    if (!supplicant.start()) {
+        fprintf(stderr, "Could not bind %s again\n", path.c_str());
+        return 1;
+    }
+    expected.push_back(expected.back() - 10);
+    expect("restart", expected);
+
+    supplicant.setSignal(expected.back() + 10);
+    expected.push_back(expected.back() + 10);
+    expect("restarted", expected);
+
+    // SIGNAL_MONITOR refused: the same readings, from SIGNAL_POLL every 'interval'
+    supplicant.stop();
+    supplicant.setMonitorSupported(false);
+    supplicant.setSignal(expected.back() - 10);
+    if (!supplicant.start()) {
+        fprintf(stderr, "Could not bind %s again\n", path.c_str());
+        return 1;
+    }
+    expected.push_back(expected.back() - 10);
+    expect("unsupported", expected);
+
+    unsigned polls = supplicant.polls();
+    for (int step : { 2, -2, 10, 1, -10 }) {
+        supplicant.setSignal(expected.back() + step);
+        if (std::abs(step) > clientHysteresis)
+            expected.push_back(expected.back() + step);
+        std::this_thread::sleep_for(std::chrono::milliseconds(3 * interval));
+    }
+    expect("polled", expected);
+    polls = supplicant.polls() - polls;
+    if (polls < 10) {
+        printf("%-12s only %u polls\n", "polled", polls);
+        failures++;
+    }
+
+    monitor.stop();
+
+    printf("%zu trace steps, %zu readings, %u thresholds armed, %u polls\n", trace.size(), readings.get().size(), supplicant.armings(), supplicant.polls());
+    return failures ? 2 : 0;
+}
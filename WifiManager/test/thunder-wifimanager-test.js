@@ -383,6 +383,13 @@ px.import({
           "Expected an array of access points in 'getAvaiableSSIDs'");
       });
     })
+    .then( () => {
+      // The access points of the scan are kept
+      return invoke('getAvailableSSIDs', {}, undefined, (result) => {
+        testResults.isTrue(result.success && (typeof(result.ssids) === 'object') && (result.ssids.length > 1) && ('lastSeen' in result.ssids[0]),
+          "Expected the access points found by the scan in 'ssids'");
+      });
+    })
     .then( () => {
       return invoke('startScan', {incremental: true}, undefined, (result) => {
         testResults.isTrue(result.success, 'Expected to succeed');
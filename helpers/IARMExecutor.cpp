@@ -0,0 +1,247 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+
+/**
+ *  Asynchronous IARM bus calls, see IARMExecutor.h.
+ *
+ */
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "IARMExecutor.h"
+#include "utils.h"
+
+using namespace WPEFramework;
+
+Utils::IARMExecutor& Utils::IARMExecutor::instance()
+{
+    static IARMExecutor executor;
+    return executor;
+}
+
+Utils::IARMExecutor::IARMExecutor()
+    : m_stopping(false)
+{
+}
+
+Utils::IARMExecutor::~IARMExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        for (auto& bus : m_buses)
+            bus.second->wakeup.notify_all();
+    }
+
+    for (auto& bus : m_buses)
+    {
+        if (bus.second->thread.joinable())
+            bus.second->thread.join();
+    }
+}
+
+IARM_Result_t Utils::IARMExecutor::call(const char *owner, const char *method, void *arg, size_t argLen, int timeoutMs, bool read)
+{
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    std::string key(method);
+    key.push_back('\0');
+    key.append(static_cast<const char *>(arg), arg ? argLen : 0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_stopping)
+        return IARM_RESULT_INVALID_STATE;
+
+    Bus& bus = getBus(owner);
+    std::shared_ptr<Call> call;
+
+    if (read)
+    {
+        auto it = bus.reads.find(key);
+        if (it != bus.reads.end())
+        {
+            call = it->second;
+            statisticsOf(bus, call->method).coalesced++;
+        }
+    }
+
+    if (!call)
+    {
+        call = std::make_shared<Call>();
+        call->method = method;
+        call->key = key;
+        if (arg)
+            call->arg.assign(static_cast<const char *>(arg), static_cast<const char *>(arg) + argLen);
+        call->read = read;
+        call->state = State::QUEUED;
+        call->result = IARM_RESULT_IPCCORE_FAIL;
+        call->waiters = 0;
+
+        bus.queue.push_back(call);
+        if (read)
+            bus.reads[key] = call;
+        bus.wakeup.notify_one();
+    }
+
+    call->waiters++;
+    bool done = bus.done.wait_until(lock, deadline, [&call]() { return call->state == State::DONE; });
+    call->waiters--;
+
+    if (done)
+    {
+        if (arg)
+            memcpy(arg, call->arg.data(), argLen);
+        return call->result;
+    }
+
+    statisticsOf(bus, call->method).timeouts++;
+
+    // Nobody is interested in the result any more, do not make the call at all
+    if ((call->state == State::QUEUED) && (call->waiters == 0))
+    {
+        auto it = std::find(bus.queue.begin(), bus.queue.end(), call);
+        if (it != bus.queue.end())
+            bus.queue.erase(it);
+        if (read && (bus.reads[key] == call))
+            bus.reads.erase(key);
+    }
+
+    LOGWARN("IARM %s %s: no answer after %d ms", owner, method, timeoutMs);
+    return IARM_RESULT_IPCCORE_FAIL;
+}
+
+std::vector<Utils::IARMExecutor::Statistics> Utils::IARMExecutor::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Statistics> result;
+
+    for (auto& bus : m_buses)
+    {
+        for (auto& method : bus.second->statistics)
+            result.push_back(method.second);
+    }
+    return result;
+}
+
+void Utils::IARMExecutor::logStatistics() const
+{
+    for (const Statistics& statistics : getStatistics())
+    {
+        std::string histogram;
+        for (int i = 0; i < IARM_EXECUTOR_HISTOGRAM_BUCKETS; i++)
+        {
+            if (statistics.histogram[i] == 0)
+                continue;
+            histogram += histogram.empty() ? ", latency" : "";
+            if (i < IARM_EXECUTOR_HISTOGRAM_BUCKETS - 1)
+                histogram += " <" + std::to_string(1 << i) + "ms:" + std::to_string(statistics.histogram[i]);
+            else
+                histogram += " more:" + std::to_string(statistics.histogram[i]);
+        }
+
+        LOGINFO("IARM %s %s: %llu calls, %llu coalesced, %llu timeouts, %llu failures%s",
+            statistics.owner.c_str(), statistics.method.c_str(),
+            (unsigned long long)statistics.calls, (unsigned long long)statistics.coalesced,
+            (unsigned long long)statistics.timeouts, (unsigned long long)statistics.failures, histogram.c_str());
+    }
+}
+
+// Called with m_mutex held
+Utils::IARMExecutor::Bus& Utils::IARMExecutor::getBus(const char *owner)
+{
+    std::unique_ptr<Bus>& bus = m_buses[owner];
+    if (!bus)
+    {
+        bus.reset(new Bus());
+        bus->owner = owner;
+        Bus *created = bus.get();
+        bus->thread = std::thread([this, created]() { loop(*created); });
+    }
+    return *bus;
+}
+
+// Called with m_mutex held
+Utils::IARMExecutor::Statistics& Utils::IARMExecutor::statisticsOf(Bus& bus, const std::string& method)
+{
+    auto it = bus.statistics.find(method);
+    if (it == bus.statistics.end())
+    {
+        Statistics statistics;
+        memset(statistics.histogram, 0, sizeof(statistics.histogram));
+        statistics.owner = bus.owner;
+        statistics.method = method;
+        statistics.calls = statistics.coalesced = statistics.timeouts = statistics.failures = 0;
+        it = bus.statistics.insert(std::make_pair(method, statistics)).first;
+    }
+    return it->second;
+}
+
+void Utils::IARMExecutor::loop(Bus& bus)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        bus.wakeup.wait(lock, [this, &bus]() { return m_stopping || !bus.queue.empty(); });
+        if (m_stopping)
+            break;
+
+        std::shared_ptr<Call> call = bus.queue.front();
+        bus.queue.pop_front();
+        call->state = State::RUNNING;
+
+        lock.unlock();
+        auto const start = std::chrono::steady_clock::now();
+        IARM_Result_t result = IARM_Bus_Call(bus.owner.c_str(), call->method.c_str(), call->arg.empty() ? nullptr : call->arg.data(), call->arg.size());
+        auto const elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        lock.lock();
+
+        call->result = result;
+        call->state = State::DONE;
+        if (call->read)
+        {
+            auto it = bus.reads.find(call->key);
+            if ((it != bus.reads.end()) && (it->second == call))
+                bus.reads.erase(it);
+        }
+
+        Statistics& statistics = statisticsOf(bus, call->method);
+        statistics.calls++;
+        if (result != IARM_RESULT_SUCCESS)
+            statistics.failures++;
+        int bucket = 0;
+        while ((bucket < IARM_EXECUTOR_HISTOGRAM_BUCKETS - 1) && (elapsedMs >= (1LL << bucket)))
+            bucket++;
+        statistics.histogram[bucket]++;
+
+        bus.done.notify_all();
+    }
+}
+
+IARM_Result_t Utils::IARMCall(const char *owner, const char *method, void *arg, size_t argLen, int timeoutMs)
+{
+    return IARMExecutor::instance().call(owner, method, arg, argLen, timeoutMs, false);
+}
+
+IARM_Result_t Utils::IARMCallRead(const char *owner, const char *method, void *arg, size_t argLen, int timeoutMs)
+{
+    return IARMExecutor::instance().call(owner, method, arg, argLen, timeoutMs, true);
+}
@@ -0,0 +1,129 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "libIBus.h"
+
+#define IARM_EXECUTOR_DEFAULT_TIMEOUT_MS    5000
+#define IARM_EXECUTOR_HISTOGRAM_BUCKETS     16      // Bucket i counts calls under 2^i ms, the last one the slower ones
+
+namespace Utils
+{
+    /**
+     * @brief Runs IARM bus calls away from the calling thread.
+     *
+     * Every IARM bus owner (IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_DSMGR_NAME, ...) gets its own worker
+     * thread, so a daemon which is slow to answer only holds up the calls made to it. Calls to one
+     * owner run in the order they were made.
+     *
+     * The caller waits for its call up to a deadline. A call still queued when all its callers gave
+     * up is never made; one already running completes in the background, on a copy of the argument.
+     *
+     * Calls flagged as reads are coalesced: a read identical to one queued or running (same owner,
+     * method and argument bytes) waits for that one and gets its result.
+     *
+     * A latency histogram is kept per owner and method.
+     */
+    class IARMExecutor
+    {
+    public:
+        struct Statistics
+        {
+            std::string owner;
+            std::string method;
+            uint64_t calls;         // Made on the bus
+            uint64_t coalesced;     // Answered by another identical call
+            uint64_t timeouts;      // Callers which gave up waiting
+            uint64_t failures;      // Calls which did not return IARM_RESULT_SUCCESS
+            uint64_t histogram[IARM_EXECUTOR_HISTOGRAM_BUCKETS];
+        };
+
+        static IARMExecutor& instance();
+
+        IARM_Result_t call(const char *owner, const char *method, void *arg, size_t argLen, int timeoutMs, bool read);
+        std::vector<Statistics> getStatistics() const;
+        void logStatistics() const;
+
+        ~IARMExecutor();
+
+    private:
+        enum class State { QUEUED, RUNNING, DONE };
+
+        struct Call
+        {
+            std::string method;
+            std::string key;            // Method and argument, for coalescing
+            std::vector<char> arg;
+            bool read;
+            State state;
+            IARM_Result_t result;
+            int waiters;
+        };
+
+        struct Bus
+        {
+            std::string owner;
+            std::thread thread;
+            std::condition_variable wakeup;
+            std::condition_variable done;
+            std::deque<std::shared_ptr<Call> > queue;
+            std::map<std::string, std::shared_ptr<Call> > reads;   // Queued or running, by key
+            std::map<std::string, Statistics> statistics;           // By method
+        };
+
+        IARMExecutor();
+        IARMExecutor(const IARMExecutor&) = delete;
+        IARMExecutor& operator=(const IARMExecutor&) = delete;
+
+        Bus& getBus(const char *owner);
+        Statistics& statisticsOf(Bus& bus, const std::string& method);
+        void loop(Bus& bus);
+
+        // One mutex for everything, the calls themselves run without it
+        mutable std::mutex m_mutex;
+        std::map<std::string, std::unique_ptr<Bus> > m_buses;
+        bool m_stopping;
+    };
+
+    /**
+     * @brief Drop-in replacements for IARM_Bus_Call going through the executor.
+     *
+     * IARMCallRead is for calls which only read state, identical ones made at the same time are coalesced.
+     *
+     * @return The IARM_Bus_Call result, IARM_RESULT_IPCCORE_FAIL when the deadline passed.
+     *
+     */
+    IARM_Result_t IARMCall(const char *owner, const char *method, void *arg, size_t argLen, int timeoutMs = IARM_EXECUTOR_DEFAULT_TIMEOUT_MS);
+    IARM_Result_t IARMCallRead(const char *owner, const char *method, void *arg, size_t argLen, int timeoutMs = IARM_EXECUTOR_DEFAULT_TIMEOUT_MS);
+}
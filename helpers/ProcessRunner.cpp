@@ -0,0 +1,266 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+/**
+ *  Shell-less process execution, see ProcessRunner.h.
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+
+#include "ProcessRunner.h"
+#include "utils.h"
+
+#define PROCESS_RUNNER_EXIT_CHECK_MS    100
+#define PROCESS_RUNNER_REAP_CHECK_MS    1       // Once both streams closed the program is about to exit
+
+extern char **environ;
+
+using namespace WPEFramework;
+
+namespace
+{
+    struct CacheEntry
+    {
+        Utils::ProcessRunner::Result result;
+        std::chrono::steady_clock::time_point expiry;
+    };
+
+    std::mutex cacheMutex;
+    std::map<std::string, CacheEntry> cache;
+
+    std::string cacheKey(const std::vector<std::string>& argv)
+    {
+        std::string key;
+        for (auto& arg : argv)
+        {
+            key += arg;
+            key += '\0';
+        }
+        return key;
+    }
+
+    // Returns false once the stream is closed
+    bool readStream(int fd, std::string& into)
+    {
+        char buffer[4096];
+        for (;;)
+        {
+            ssize_t n = read(fd, buffer, sizeof(buffer));
+            if (n > 0)
+            {
+                size_t room = PROCESS_RUNNER_MAX_OUTPUT - std::min(into.size(), (size_t)PROCESS_RUNNER_MAX_OUTPUT);
+                into.append(buffer, std::min((size_t)n, room));
+                continue;
+            }
+            if (n < 0 && EINTR == errno)
+                continue;
+            return n < 0 && EAGAIN == errno;
+        }
+    }
+
+    int exitCodeOf(int status)
+    {
+        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+}
+
+Utils::ProcessRunner::Result Utils::ProcessRunner::run(const std::vector<std::string>& argv, int timeoutMs)
+{
+    Result result = { -1, false, "", "" };
+
+    if (argv.empty())
+        return result;
+
+    int outPipe[2] = { -1, -1 };
+    int errPipe[2] = { -1, -1 };
+    if (0 != pipe2(outPipe, O_CLOEXEC) || 0 != pipe2(errPipe, O_CLOEXEC))
+    {
+        LOGERR("pipe2 failed for %s: %s", argv[0].c_str(), strerror(errno));
+        for (int fd : { outPipe[0], outPipe[1], errPipe[0], errPipe[1] })
+            if (fd >= 0)
+                close(fd);
+        return result;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, outPipe[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, errPipe[1], STDERR_FILENO);
+
+    // The plugin host blocks and ignores signals the program expects in their default state
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t signals;
+    sigemptyset(&signals);
+    posix_spawnattr_setsigmask(&attr, &signals);
+    sigaddset(&signals, SIGPIPE);
+    sigaddset(&signals, SIGCHLD);
+    posix_spawnattr_setsigdefault(&attr, &signals);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    std::vector<char *> args;
+    for (auto& arg : argv)
+        args.push_back(const_cast<char *>(arg.c_str()));
+    args.push_back(nullptr);
+
+    pid_t pid = -1;
+    int err = (std::string::npos != argv[0].find('/'))
+        ? posix_spawn(&pid, args[0], &actions, &attr, args.data(), environ)
+        : posix_spawnp(&pid, args[0], &actions, &attr, args.data(), environ);
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    close(outPipe[1]);
+    close(errPipe[1]);
+
+    if (0 != err)
+    {
+        LOGERR("Failed to start %s: %s", argv[0].c_str(), strerror(err));
+        close(outPipe[0]);
+        close(errPipe[0]);
+        return result;
+    }
+
+    fcntl(outPipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(errPipe[0], F_SETFL, O_NONBLOCK);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    struct pollfd fds[2] = { { outPipe[0], POLLIN, 0 }, { errPipe[0], POLLIN, 0 } };
+    bool open[2] = { true, true };
+    int status = 0;
+    bool exited = false;
+    bool reaped = false;
+
+    while (!exited)
+    {
+        int wait = (open[0] || open[1]) ? PROCESS_RUNNER_EXIT_CHECK_MS : PROCESS_RUNNER_REAP_CHECK_MS;
+        if (timeoutMs > 0)
+        {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            if (left <= 0)
+            {
+                result.timedOut = true;
+                break;
+            }
+            wait = std::min<int>(wait, left);
+        }
+
+        // A closed stream is left out of the poll set through a negative fd
+        fds[0].fd = open[0] ? outPipe[0] : -1;
+        fds[1].fd = open[1] ? errPipe[0] : -1;
+
+        int ready = poll(fds, 2, wait);
+        if (ready < 0 && EINTR != errno)
+        {
+            LOGERR("poll failed for %s: %s", argv[0].c_str(), strerror(errno));
+            break;
+        }
+
+        if (ready > 0)
+        {
+            if (open[0] && fds[0].revents)
+                open[0] = readStream(outPipe[0], result.output);
+            if (open[1] && fds[1].revents)
+                open[1] = readStream(errPipe[0], result.error);
+        }
+
+        // The streams may stay open after the program exited, when it left a child behind.
+        // ECHILD means the host reaps its children itself, the exit status is then lost.
+        pid_t waited = waitpid(pid, &status, WNOHANG);
+        if (waited == pid)
+        {
+            exited = true;
+            reaped = true;
+        }
+        else if (waited < 0 && EINTR != errno)
+        {
+            LOGERR("waitpid failed for %s: %s, exit status unknown", argv[0].c_str(), strerror(errno));
+            exited = true;
+        }
+    }
+
+    if (exited)
+    {
+        // Whatever the program wrote right before exiting
+        if (open[0])
+            readStream(outPipe[0], result.output);
+        if (open[1])
+            readStream(errPipe[0], result.error);
+        // An unknown outcome is not a success
+        result.exitCode = reaped ? exitCodeOf(status) : -1;
+    }
+    else
+    {
+        if (result.timedOut)
+            LOGWARN("%s did not complete within %d ms, killing it", argv[0].c_str(), timeoutMs);
+        kill(pid, SIGKILL);
+        while (waitpid(pid, &status, 0) < 0 && EINTR == errno);
+    }
+
+    close(outPipe[0]);
+    close(errPipe[0]);
+
+    return result;
+}
+
+Utils::ProcessRunner::Result Utils::ProcessRunner::runCached(const std::vector<std::string>& argv, int ttlMs, int timeoutMs)
+{
+    std::string key = cacheKey(argv);
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = cache.find(key);
+        if (it != cache.end())
+        {
+            if (std::chrono::steady_clock::now() < it->second.expiry)
+                return it->second.result;
+            cache.erase(it);
+        }
+    }
+
+    Result result = run(argv, timeoutMs);
+
+    if (result.succeeded())
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        cache[key] = { result, std::chrono::steady_clock::now() + std::chrono::milliseconds(ttlMs) };
+    }
+
+    return result;
+}
+
+void Utils::ProcessRunner::invalidate(const std::vector<std::string>& argv)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cache.erase(cacheKey(argv));
+}
@@ -0,0 +1,62 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#define PROCESS_RUNNER_DEFAULT_TIMEOUT_MS   10000
+#define PROCESS_RUNNER_MAX_OUTPUT           (64 * 1024)     // Per stream, the rest is read and dropped
+
+namespace Utils
+{
+    /**
+     * @brief Runs an external program without going through a shell.
+     *
+     * The program is started with posix_spawn from an argument vector, so nothing in the
+     * arguments is ever interpreted by a shell. Its stdout and stderr are captured through
+     * pipes, stdin is /dev/null. When the deadline passes the program is killed.
+     *
+     * Output is collected until the program exits, not until the pipes close: a daemon it
+     * left running in the background does not hold up the caller.
+     *
+     * Results of idempotent queries (mfr_util, getPartnerId, ...) can be cached for a while
+     * with runCached, only successful runs are cached.
+     */
+    class ProcessRunner
+    {
+    public:
+        struct Result
+        {
+            int exitCode;           // -1 when the program could not be started, was killed, timed out or could not be reaped
+            bool timedOut;
+            std::string output;
+            std::string error;
+
+            bool succeeded() const { return !timedOut && 0 == exitCode; }
+        };
+
+        // timeoutMs <= 0 waits for the program however long it takes
+        static Result run(const std::vector<std::string>& argv, int timeoutMs = PROCESS_RUNNER_DEFAULT_TIMEOUT_MS);
+        static Result runCached(const std::vector<std::string>& argv, int ttlMs, int timeoutMs = PROCESS_RUNNER_DEFAULT_TIMEOUT_MS);
+        static void invalidate(const std::vector<std::string>& argv);
+    };
+}
@@ -21,11 +21,13 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <sstream>
 #include <sys/stat.h>
 #include <algorithm>
 
 #include "utils.h"
 #include "SystemServicesHelper.h"
+#include "ProcessRunner.h"
 
 /* Helper Functions */
 using namespace std;
@@ -106,6 +108,45 @@ bool readFromFile(const char* filename, string &content)
     return retStatus;
 }
 
+/***
+ * @brief	: Used to read the download percentage from a curl progress meter file
+ * @param1[in]	: Complete file name with path
+ * @return	: <string>; third column of the last progress line, empty if not found.
+ */
+std::string getCurlProgressPercent(const char* filename)
+{
+    /* curl rewrites its meter line with '\r', only the tail of the file matters. */
+    const std::streamoff tailSize = 1024;
+    std::string field;
+
+    ifstream ifile(filename, ios::in | ios::binary | ios::ate);
+    if (!ifile.is_open()) {
+        return field;
+    }
+
+    std::streamoff size = ifile.tellg();
+    std::streamoff offset = (size > tailSize) ? (size - tailSize) : 0;
+    std::string tail(size - offset, '\0');
+    ifile.seekg(offset);
+    ifile.read(&tail[0], tail.size());
+    tail.resize(ifile.gcount());
+
+    size_t end = tail.find_last_not_of("\r\n");
+    if (string::npos == end) {
+        return field;
+    }
+    size_t begin = tail.find_last_of("\r\n", end);
+    begin = (string::npos == begin) ? 0 : begin + 1;
+
+    std::istringstream line(tail.substr(begin, end - begin + 1));
+    for (int column = 0; column < 3; column++) {
+        if (!(line >> field)) {
+            return "";
+        }
+    }
+    return field;
+}
+
 namespace WPEFramework {
     namespace Plugin {
         /***
@@ -165,25 +206,17 @@ namespace WPEFramework {
 
         string getModel()
         {
-            const char * pipeName = "PATH=${PATH}:/sbin:/usr/sbin /lib/rdk/getDeviceDetails.sh read";
-            FILE* pipe = popen(pipeName, "r");
-            LOGWARN("%s: opened pipe for command '%s', with result %s : %s\n",
-                    __FUNCTION__ , pipeName, pipe ? "sucess" : "failure", strerror(errno));
-            if (!pipe) {
-                LOGERR("%s: SERVICEMANAGER_FILE_ERROR: Can't open pipe for command '%s' for read mode: %s\n"
-                        , __FUNCTION__, pipeName, strerror(errno));
+            const char* path = getenv("PATH");
+            string pathVariable = string("PATH=") + (path ? path : "") + ":/sbin:/usr/sbin";
+            Utils::ProcessRunner::Result run = Utils::ProcessRunner::run({"/usr/bin/env",
+                    pathVariable, "/lib/rdk/getDeviceDetails.sh", "read"});
+            LOGWARN("%s: getDeviceDetails.sh read exited with %d\n", __FUNCTION__, run.exitCode);
+            if (run.exitCode < 0) {
+                LOGERR("%s: SERVICEMANAGER_FILE_ERROR: Can't run getDeviceDetails.sh\n", __FUNCTION__);
                 return "ERROR";
             }
 
-            char buffer[128] = {'\0'};
-            string result;
-
-            while (!feof(pipe)) {
-                if (fgets(buffer, 128, pipe) != NULL) {
-                    result += buffer;
-                }
-            }
-            pclose(pipe);
+            string result = run.output;
 
             string tri = caseInsensitive(result);
             string ret = tri.c_str();
@@ -322,16 +355,17 @@ bool getFileContentToCharBuffer(std::string fileName, char* pBuffer)
  */
 std::vector<std::string> searchAndGetFilesList(std::string path, std::string filter)
 {
-    int retStat = -1;
-    char buff[4096 + 1];
-    std::string command,totalStr;
     std::vector<std::string> FileList;
-
-    memset(buff, 0, 4096);
-    command = "find "+path+" -iname "+filter+" > /tmp/tempBuffer.dat";
-    retStat = system(command.c_str());
-    fprintf(stdout, "searchAndGetFilesList : retStat = %d\n", retStat);
-    getFileContent("/tmp/tempBuffer.dat", FileList);
+    std::string fileName;
+
+    Utils::ProcessRunner::Result result = Utils::ProcessRunner::run({"find", path, "-iname", filter});
+    fprintf(stdout, "searchAndGetFilesList : retStat = %d\n", result.exitCode);
+    std::istringstream files(result.output);
+    while (std::getline(files, fileName)) {
+        if (fileName.size() > 0) {
+            FileList.push_back(fileName);
+        }
+    }
 
     return FileList;
 }
@@ -63,6 +63,7 @@
 #define XCONF_OVERRIDE_FILE						"/opt/swupdate.conf"
 #define	URL_XCONF								"http://xconf.xcal.tv/xconf/swu/stb"
 #define TZ_FILE									"/opt/persistent/timeZoneDST"
+#define CURL_PROGRESS_FILE                      "/opt/curl_progress"
 
 #define MODE_TIMER_UPDATE_INTERVAL	1000
 #define CURL_BUFFER_SIZE	(64 * 1024) /* 256kB */
@@ -74,8 +75,6 @@
 #define MODE_EAS        "EAS"
 #define MODE_WAREHOUSE  "WAREHOUSE"
 
-#define CAT_DWNLDPROGRESSFILE_AND_GET_INFO "cat /opt/curl_progress | tr -s '\r' '\n' | tail -n 1 | sed 's/^ *//g' | tr -s ' ' | cut -d ' ' -f3"
-
 enum eRetval { E_NOK = -1,
     E_OK };
 
@@ -143,6 +142,13 @@ bool dirExists(std::string fname);
  */
 bool readFromFile(const char* filename, string &content);
 
+/***
+ * @brief	: Used to read the download percentage from a curl progress meter file
+ * @param1[in]	: Complete file name with path
+ * @return	: <string>; third column of the last progress line, empty if not found.
+ */
+std::string getCurlProgressPercent(const char* filename);
+
 namespace WPEFramework {
     namespace Plugin {
         /***